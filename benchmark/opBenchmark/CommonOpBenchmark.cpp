@@ -0,0 +1,195 @@
+//
+//  CommonOpBenchmark.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/18.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/ExprCreator.hpp>
+#include "OpBenchmark.hpp"
+using namespace MNN::Express;
+
+// shape: [e, l, h], C[e, h] = A[e, l] * B[l, h]
+class MatMulBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {{64, 64, 64}, {256, 256, 256}, {540, 320, 540}, {1024, 1024, 1024}, {1, 1024, 1024}};
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        auto a = _Input({shape[0], shape[1]}, NHWC);
+        auto b = _Input({shape[1], shape[2]}, NHWC);
+        inputs  = {a, b};
+        outputs = {_MatMul(a, b)};
+        return true;
+    }
+    virtual double flops(const std::vector<int>& shape) const override {
+        return 2.0 * shape[0] * shape[1] * shape[2];
+    }
+};
+MNNOpBenchmarkSuiteRegister(MatMulBenchmark, "MatMul");
+
+// shape: [batch, e, l, h], batched MatMul with the same shape for each batch
+class BatchMatMulBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {{8, 64, 64, 64}, {12, 128, 64, 128}, {16, 256, 64, 256}};
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        auto a = _Input({shape[0], shape[1], shape[2]}, NHWC);
+        auto b = _Input({shape[0], shape[2], shape[3]}, NHWC);
+        inputs  = {a, b};
+        outputs = {_BatchMatMul(a, b)};
+        return true;
+    }
+    virtual double flops(const std::vector<int>& shape) const override {
+        return 2.0 * shape[0] * shape[1] * shape[2] * shape[3];
+    }
+};
+MNNOpBenchmarkSuiteRegister(BatchMatMulBenchmark, "BatchMatMul");
+
+// shape: [inputChannel, outputChannel, size, kernel, stride, group], SAME padding, batch = 1
+class ConvolutionBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {
+            {3, 32, 224, 3, 2, 1},    {32, 64, 112, 1, 1, 1},   {128, 128, 56, 3, 1, 1}, {256, 256, 28, 3, 1, 1},
+            {512, 512, 14, 1, 1, 1},  {64, 64, 56, 3, 1, 64},   {256, 256, 28, 3, 1, 256},
+        };
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        int ic = shape[0], oc = shape[1], size = shape[2], kernel = shape[3], stride = shape[4], group = shape[5];
+        if (ic % group != 0 || oc % group != 0) {
+            return false;
+        }
+        std::vector<float> weight(oc * (ic / group) * kernel * kernel);
+        std::vector<float> bias(oc);
+        for (int i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)(i % 17 - 8) / 64.0f;
+        }
+        for (int i = 0; i < oc; ++i) {
+            bias[i] = (float)(i % 5) / 10.0f;
+        }
+        auto x  = _Input({1, ic, size, size}, NC4HW4);
+        inputs  = {x};
+        outputs = {_Conv(std::move(weight), std::move(bias), x, {ic, oc}, {kernel, kernel}, SAME, {stride, stride},
+                         {1, 1}, group)};
+        return true;
+    }
+    virtual double flops(const std::vector<int>& shape) const override {
+        double outputSize = (double)((shape[2] + shape[4] - 1) / shape[4]);
+        return 2.0 * outputSize * outputSize * shape[1] * (shape[0] / shape[5]) * shape[3] * shape[3];
+    }
+};
+MNNOpBenchmarkSuiteRegister(ConvolutionBenchmark, "Convolution");
+
+// shape: [size]
+class ReluBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {{4096}, {1 << 20}, {5001 * 1001}};
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        auto x  = _Input({shape[0]}, NHWC);
+        inputs  = {x};
+        outputs = {_Relu(x), _Relu6(x)};
+        return true;
+    }
+};
+MNNOpBenchmarkSuiteRegister(ReluBenchmark, "Relu");
+
+// shape: [outside, inside], x[outside, inside] + y[1, inside] with broadcast, and x * x
+class BinaryBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {{1, 1 << 20}, {1024, 1024}, {65536, 16}};
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        auto x  = _Input({shape[0], shape[1]}, NHWC);
+        auto y  = _Input({1, shape[1]}, NHWC);
+        inputs  = {x, y};
+        outputs = {_Add(x, y), _Multiply(x, x)};
+        return true;
+    }
+};
+MNNOpBenchmarkSuiteRegister(BinaryBenchmark, "Binary");
+
+// shape: [outside, axis, inside]
+class SoftmaxBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {{1, 1000, 1}, {128, 1024, 1}, {12 * 128, 128, 1}, {1, 21, 128 * 128}};
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        auto x  = _Input({shape[0], shape[1], shape[2]}, NHWC);
+        inputs  = {x};
+        outputs = {_Softmax(x, 1)};
+        return true;
+    }
+};
+MNNOpBenchmarkSuiteRegister(SoftmaxBenchmark, "Softmax");
+
+// shape: [outside, axis, inside], reduce the middle axis
+class ReduceBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {{1, 1 << 20, 1}, {1024, 1024, 1}, {1, 1024, 1024}, {64, 256, 64}};
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        auto x  = _Input({shape[0], shape[1], shape[2]}, NHWC);
+        inputs  = {x};
+        outputs = {_ReduceSum(x, {1}), _ReduceMax(x, {1})};
+        return true;
+    }
+};
+MNNOpBenchmarkSuiteRegister(ReduceBenchmark, "Reduce");
+
+// shape: [channel, height, width], NCHW -> NHWC
+class TransposeBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {{3, 224, 224}, {64, 112, 112}, {512, 14, 14}};
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        auto x  = _Input({1, shape[0], shape[1], shape[2]}, NCHW);
+        inputs  = {x};
+        outputs = {_Transpose(x, {0, 2, 3, 1})};
+        return true;
+    }
+};
+MNNOpBenchmarkSuiteRegister(TransposeBenchmark, "Transpose");
+
+// shape: [channel, height, width], NCHW <-> NC4HW4
+class ConvertBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {{3, 224, 224}, {64, 112, 112}, {512, 14, 14}};
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        auto x  = _Input({1, shape[0], shape[1], shape[2]}, NCHW);
+        inputs  = {x};
+        outputs = {_Convert(_Convert(x, NC4HW4), NCHW)};
+        return true;
+    }
+};
+MNNOpBenchmarkSuiteRegister(ConvertBenchmark, "Convert");
+
+// shape: [rows, dim, indices], gather indices rows of [rows, dim]
+class GatherBenchmark : public MNNOpBenchmark {
+public:
+    virtual std::vector<std::vector<int>> shapes() const override {
+        return {{30000, 128, 512}, {100000, 64, 4096}};
+    }
+    virtual bool build(const std::vector<int>& shape, std::vector<VARP>& inputs, std::vector<VARP>& outputs) override {
+        auto table = _Input({shape[0], shape[1]}, NHWC);
+        std::vector<int> indiceData(shape[2]);
+        for (int i = 0; i < shape[2]; ++i) {
+            indiceData[i] = (int)(((int64_t)i * 7919) % shape[0]);
+        }
+        auto indices = _Const(indiceData.data(), {shape[2]}, NHWC, halide_type_of<int>());
+        inputs       = {table};
+        outputs      = {_GatherV2(table, indices, _Scalar<int>(0))};
+        return true;
+    }
+};
+MNNOpBenchmarkSuiteRegister(GatherBenchmark, "Gather");
@@ -0,0 +1,331 @@
+//
+//  OpBenchmark.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/18.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "OpBenchmark.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <MNN/AutoTime.hpp>
+#include <MNN/expr/Executor.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "rapidjson/document.h"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+MNNOpBenchmarkSuite* MNNOpBenchmarkSuite::get() {
+    static MNNOpBenchmarkSuite gInstance;
+    return &gInstance;
+}
+
+MNNOpBenchmarkSuite::~MNNOpBenchmarkSuite() {
+    for (auto& item : mItems) {
+        delete item.bench;
+    }
+    mItems.clear();
+}
+
+void MNNOpBenchmarkSuite::add(MNNOpBenchmark* bench, const char* name) {
+    mItems.emplace_back(Item{name, bench});
+}
+
+struct BenchOption {
+    std::string filter;
+    std::vector<int> threads = {1};
+    int warmup               = 5;
+    int repeat               = 50;
+    std::string output;
+    std::string baseline;
+    float threshold            = 0.1f;
+    MNNForwardType forwardType = MNN_FORWARD_CPU;
+    int precision              = BackendConfig::Precision_High;
+};
+
+struct BenchResult {
+    std::string name;
+    std::string shape;
+    int threads;
+    double minMs;
+    double maxMs;
+    double meanMs;
+    double medianMs;
+    double p90Ms;
+    double stddevMs;
+    double gflops;
+    // Filled in compare mode, 0 means no baseline
+    double baselineMs = 0.0;
+};
+
+static std::vector<int> _splitInts(const char* text) {
+    std::vector<int> res;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            res.emplace_back(::atoi(item.c_str()));
+        }
+    }
+    return res;
+}
+
+static std::string _shapeName(const std::vector<int>& shape) {
+    std::string res;
+    for (int i = 0; i < shape.size(); ++i) {
+        if (i > 0) {
+            res += "x";
+        }
+        res += std::to_string(shape[i]);
+    }
+    return res;
+}
+
+static std::string _key(const std::string& name, const std::string& shape, int threads) {
+    return name + "|" + shape + "|" + std::to_string(threads);
+}
+
+static void _fillInputs(const std::vector<VARP>& inputs) {
+    for (auto& input : inputs) {
+        auto info = input->getInfo();
+        if (nullptr == info) {
+            continue;
+        }
+        if (info->type.code == halide_type_float) {
+            auto ptr = input->writeMap<float>();
+            for (int i = 0; i < info->size; ++i) {
+                ptr[i] = (float)((i * 17 + 7) % 255) / 127.5f - 1.0f;
+            }
+        } else {
+            ::memset(input->writeMap<void>(), 0, info->size * info->type.bytes());
+        }
+    }
+}
+
+static void _runOnce(const std::vector<VARP>& inputs, const std::vector<VARP>& outputs) {
+    // Write map mark the inputs dirty, so that the outputs are computed again
+    for (auto& input : inputs) {
+        input->writeMap<void>();
+    }
+    for (auto& output : outputs) {
+        output->readMap<void>();
+    }
+}
+
+static bool _benchOne(const std::string& name, MNNOpBenchmark* bench, const std::vector<int>& shape, int threads,
+                      const BenchOption& option, BenchResult& result) {
+    BackendConfig config;
+    config.precision = (BackendConfig::PrecisionMode)option.precision;
+    auto exe         = Executor::getGlobalExecutor();
+    exe->setGlobalExecutorConfig(option.forwardType, config, threads);
+    exe->gc(Executor::FULL);
+    std::vector<VARP> inputs, outputs;
+    if (!bench->build(shape, inputs, outputs) || outputs.empty()) {
+        MNN_ERROR("Can't build %s for shape %s\n", name.c_str(), _shapeName(shape).c_str());
+        return false;
+    }
+    _fillInputs(inputs);
+    Variable::prepareCompute(outputs);
+    for (auto& output : outputs) {
+        if (nullptr == output->getInfo()) {
+            MNN_ERROR("Compute shape error for %s, shape %s\n", name.c_str(), _shapeName(shape).c_str());
+            return false;
+        }
+    }
+    for (int i = 0; i < option.warmup; ++i) {
+        _runOnce(inputs, outputs);
+    }
+    std::vector<double> costs(option.repeat);
+    Timer timer;
+    for (int i = 0; i < option.repeat; ++i) {
+        timer.reset();
+        _runOnce(inputs, outputs);
+        costs[i] = timer.durationInUs() / 1000.0;
+    }
+    std::sort(costs.begin(), costs.end());
+    double sum = 0.0;
+    for (auto c : costs) {
+        sum += c;
+    }
+    double mean = sum / costs.size();
+    double var  = 0.0;
+    for (auto c : costs) {
+        var += (c - mean) * (c - mean);
+    }
+    result.name     = name;
+    result.shape    = _shapeName(shape);
+    result.threads  = threads;
+    result.minMs    = costs.front();
+    result.maxMs    = costs.back();
+    result.meanMs   = mean;
+    result.medianMs = costs[costs.size() / 2];
+    result.p90Ms    = costs[std::min(costs.size() - 1, costs.size() * 9 / 10)];
+    result.stddevMs = sqrt(var / costs.size());
+    result.gflops   = 0.0;
+    auto flops      = bench->flops(shape);
+    if (flops > 0.0 && result.medianMs > 0.0) {
+        result.gflops = flops / (result.medianMs * 1000000.0);
+    }
+    return true;
+}
+
+static bool _loadBaseline(const std::string& fileName, std::map<std::string, double>& baseline) {
+    std::ifstream input(fileName);
+    if (input.fail()) {
+        MNN_ERROR("Can't open baseline %s\n", fileName.c_str());
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    auto content = buffer.str();
+    rapidjson::Document document;
+    document.Parse(content.c_str());
+    if (document.HasParseError() || !document.IsObject() || !document.HasMember("results") ||
+        !document["results"].IsArray()) {
+        MNN_ERROR("Invalid baseline %s\n", fileName.c_str());
+        return false;
+    }
+    for (auto& item : document["results"].GetArray()) {
+        if (!item.HasMember("name") || !item.HasMember("shape") || !item.HasMember("threads") ||
+            !item.HasMember("median_ms")) {
+            continue;
+        }
+        baseline[_key(item["name"].GetString(), item["shape"].GetString(), item["threads"].GetInt())] =
+            item["median_ms"].GetDouble();
+    }
+    return true;
+}
+
+static std::string _toJson(const BenchOption& option, const std::vector<BenchResult>& results) {
+    std::ostringstream os;
+    os << "{\n  \"forward_type\": " << (int)option.forwardType << ",\n  \"precision\": " << option.precision
+       << ",\n  \"warmup\": " << option.warmup << ",\n  \"repeat\": " << option.repeat << ",\n  \"results\": [";
+    for (int i = 0; i < results.size(); ++i) {
+        auto& r = results[i];
+        os << (i > 0 ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"shape\": \"" << r.shape
+           << "\", \"threads\": " << r.threads << ", \"min_ms\": " << r.minMs << ", \"median_ms\": " << r.medianMs
+           << ", \"mean_ms\": " << r.meanMs << ", \"p90_ms\": " << r.p90Ms << ", \"max_ms\": " << r.maxMs
+           << ", \"stddev_ms\": " << r.stddevMs << ", \"gflops\": " << r.gflops;
+        if (r.baselineMs > 0.0) {
+            os << ", \"baseline_median_ms\": " << r.baselineMs << ", \"ratio\": " << r.medianMs / r.baselineMs;
+        }
+        os << "}";
+    }
+    os << "\n  ]\n}\n";
+    return os.str();
+}
+
+static void _usage() {
+    MNN_PRINT("Usage: ./opBenchmark.out [-f name_prefix] [-t 1,2,4] [-w warmup=5] [-r repeat=50] [-o result.json] "
+              "[-b baseline.json] [-e threshold=0.1] [-m forwardType=0] [-p precision=1] [-l]\n");
+    MNN_PRINT("  -b: compare the median with the baseline, return 1 if any case is slower than (1 + threshold)\n");
+    MNN_PRINT("  -l: list the registered benchmarks and shapes\n");
+}
+
+int main(int argc, const char* argv[]) {
+    BenchOption option;
+    bool listOnly = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-l") {
+            listOnly = true;
+            continue;
+        }
+        if (arg == "-h" || i + 1 >= argc) {
+            _usage();
+            return 0;
+        }
+        const char* value = argv[++i];
+        if (arg == "-f") {
+            option.filter = value;
+        } else if (arg == "-t") {
+            option.threads = _splitInts(value);
+        } else if (arg == "-w") {
+            option.warmup = std::max(0, ::atoi(value));
+        } else if (arg == "-r") {
+            option.repeat = std::max(1, ::atoi(value));
+        } else if (arg == "-o") {
+            option.output = value;
+        } else if (arg == "-b") {
+            option.baseline = value;
+        } else if (arg == "-e") {
+            option.threshold = ::atof(value);
+        } else if (arg == "-m") {
+            option.forwardType = (MNNForwardType)::atoi(value);
+        } else if (arg == "-p") {
+            option.precision = ::atoi(value);
+        } else {
+            _usage();
+            return 0;
+        }
+    }
+    if (option.threads.empty()) {
+        option.threads = {1};
+    }
+    auto& items = MNNOpBenchmarkSuite::get()->items();
+    if (listOnly) {
+        for (auto& item : items) {
+            MNN_PRINT("%s:", item.name.c_str());
+            for (auto& shape : item.bench->shapes()) {
+                MNN_PRINT(" %s", _shapeName(shape).c_str());
+            }
+            MNN_PRINT("\n");
+        }
+        return 0;
+    }
+    std::map<std::string, double> baseline;
+    if (!option.baseline.empty() && !_loadBaseline(option.baseline, baseline)) {
+        return -1;
+    }
+    std::vector<BenchResult> results;
+    int regressions = 0;
+    for (auto& item : items) {
+        if (item.name.find(option.filter) != 0) {
+            continue;
+        }
+        for (auto& shape : item.bench->shapes()) {
+            for (auto threads : option.threads) {
+                BenchResult result;
+                if (!_benchOne(item.name, item.bench, shape, threads, option, result)) {
+                    continue;
+                }
+                std::string mark;
+                auto iter = baseline.find(_key(result.name, result.shape, result.threads));
+                if (iter != baseline.end() && iter->second > 0.0) {
+                    result.baselineMs = iter->second;
+                    auto ratio        = result.medianMs / result.baselineMs;
+                    if (ratio > 1.0f + option.threshold) {
+                        mark = " REGRESSION";
+                        regressions++;
+                    } else if (ratio < 1.0f - option.threshold) {
+                        mark = " improved";
+                    }
+                    mark = " vs " + std::to_string(result.baselineMs) + " ms" + mark;
+                }
+                MNN_PRINT("%-24s %-20s thread %2d: median %.4f ms, min %.4f, p90 %.4f, stddev %.4f, %.2f GFLOPS%s\n",
+                          result.name.c_str(), result.shape.c_str(), threads, result.medianMs, result.minMs,
+                          result.p90Ms, result.stddevMs, result.gflops, mark.c_str());
+                results.emplace_back(result);
+            }
+        }
+    }
+    auto json = _toJson(option, results);
+    if (option.output.empty()) {
+        MNN_PRINT("%s", json.c_str());
+    } else {
+        std::ofstream output(option.output);
+        output << json;
+    }
+    if (regressions > 0) {
+        MNN_PRINT("%d regressions larger than %.1f%%\n", regressions, option.threshold * 100.0f);
+        return 1;
+    }
+    return 0;
+}
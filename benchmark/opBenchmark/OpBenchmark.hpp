@@ -0,0 +1,72 @@
+//
+//  OpBenchmark.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/18.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef OpBenchmark_hpp
+#define OpBenchmark_hpp
+
+#include <MNN/expr/Expr.hpp>
+#include <string>
+#include <vector>
+
+/**
+ A microbenchmark of one op / kernel. The runner sweeps every shape returned by shapes() and every thread number,
+ for each of them the graph is built again, then run `warmup` times and timed `repeat` times.
+ */
+class MNNOpBenchmark {
+public:
+    virtual ~MNNOpBenchmark() = default;
+    /**
+     * @brief shapes to sweep, the meaning of the numbers is decided by the benchmark
+     */
+    virtual std::vector<std::vector<int>> shapes() const = 0;
+    /**
+     * @brief build the graph of one shape
+     * @param shape     one of shapes()
+     * @param inputs    variables that are rewritten before each run, so that the outputs are recomputed
+     * @param outputs   variables that are read in each run
+     * @return false if the shape is not supported
+     */
+    virtual bool build(const std::vector<int>& shape, std::vector<MNN::Express::VARP>& inputs,
+                       std::vector<MNN::Express::VARP>& outputs) = 0;
+    /**
+     * @brief float operations of one run, used to report GFLOPS, 0 means unknown
+     */
+    virtual double flops(const std::vector<int>& shape) const {
+        return 0.0;
+    }
+};
+
+/** registered op benchmarks */
+class MNNOpBenchmarkSuite {
+public:
+    struct Item {
+        std::string name;
+        MNNOpBenchmark* bench;
+    };
+    ~MNNOpBenchmarkSuite();
+    static MNNOpBenchmarkSuite* get();
+    void add(MNNOpBenchmark* bench, const char* name);
+    const std::vector<Item>& items() const {
+        return mItems;
+    }
+
+private:
+    std::vector<Item> mItems;
+};
+
+template <class Bench>
+class MNNOpBenchmarkRegister {
+public:
+    MNNOpBenchmarkRegister(const char* name) {
+        MNNOpBenchmarkSuite::get()->add(new Bench, name);
+    }
+};
+
+#define MNNOpBenchmarkSuiteRegister(Bench, name) static MNNOpBenchmarkRegister<Bench> __b##Bench(name)
+
+#endif /* OpBenchmark_hpp */
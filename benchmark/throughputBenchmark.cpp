@@ -0,0 +1,361 @@
+//
+//  throughputBenchmark.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/14.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(_MSC_VER)
+#include <Windows.h>
+#include <Psapi.h>
+#undef min
+#undef max
+#else
+#include <sys/resource.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <MNN/Interpreter.hpp>
+#include <MNN/MNNDefine.h>
+#include <MNN/Tensor.hpp>
+#include "revertMNNModel.hpp"
+
+/**
+ Load generation benchmark: M workers run requests concurrently for a fixed duration, and report
+ throughput / tail latency / memory as JSON.
+
+ Each worker owns its Interpreter and Session, Interpreter::runSession is serialized by the interpreter's lock,
+ so sessions created from one interpreter can't run in parallel.
+
+ closed-loop (rate = 0): each worker sends the next request as soon as the previous one returns.
+ open-loop (rate > 0): requests are scheduled at fixed interval 1/rate for all workers together, and the latency
+ is measured from the scheduled time, so the queueing delay is counted when the workers can't keep up.
+ */
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::vector<std::string> models;
+    float duration = 10.0f;
+    std::vector<int> sessions{1};
+    std::vector<int> threads{1};
+    float rate  = 0.0f;
+    int forward = MNN_FORWARD_CPU;
+    int warmup  = 5;
+    std::string output;
+};
+
+struct Worker {
+    std::shared_ptr<MNN::Interpreter> net;
+    MNN::Session* session = nullptr;
+    MNN::Tensor* input    = nullptr;
+    MNN::Tensor* output   = nullptr;
+    std::shared_ptr<MNN::Tensor> inputUser;
+    std::shared_ptr<MNN::Tensor> outputUser;
+    int modelIndex = 0;
+    std::vector<float> latency;
+};
+
+static std::vector<std::string> _split(const std::string& str) {
+    std::vector<std::string> res;
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            res.emplace_back(item);
+        }
+    }
+    return res;
+}
+
+static std::vector<int> _splitInt(const std::string& str) {
+    std::vector<int> res;
+    for (auto& s : _split(str)) {
+        res.emplace_back(::atoi(s.c_str()));
+    }
+    return res;
+}
+
+// Reset the peak rss (VmHWM) of process, only supported by linux, elsewhere the peak is of the whole process
+static void _resetPeakRSS() {
+#if defined(__linux__)
+#if defined(__GLIBC__)
+    // VmHWM is reset to the current rss, give the memory freed by the previous case back first
+    malloc_trim(0);
+#endif
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (nullptr != f) {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+}
+
+static float _peakRSSInMB() {
+#if defined(__linux__)
+    // ru_maxrss is not reset by clear_refs, VmHWM is
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (0 == line.compare(0, 6, "VmHWM:")) {
+            return ::atol(line.c_str() + 6) / 1024.0f;
+        }
+    }
+#endif
+#if defined(_MSC_VER)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize / 1024.0f / 1024.0f;
+    }
+    return -1.0f;
+#else
+    struct rusage usage;
+    if (0 != getrusage(RUSAGE_SELF, &usage)) {
+        return -1.0f;
+    }
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024.0f / 1024.0f;
+#else
+    return usage.ru_maxrss / 1024.0f;
+#endif
+#endif
+}
+
+static std::string _escape(const std::string& str) {
+    std::string res;
+    for (auto c : str) {
+        if (c == '"' || c == '\\') {
+            res.push_back('\\');
+        }
+        res.push_back(c);
+    }
+    return res;
+}
+
+static float _percentile(const std::vector<float>& sorted, float p) {
+    if (sorted.empty()) {
+        return 0.0f;
+    }
+    size_t pos = (size_t)(p * (sorted.size() - 1) + 0.5f);
+    return sorted[std::min(pos, sorted.size() - 1)];
+}
+
+static std::string _latencyJson(std::vector<float> costs) {
+    std::sort(costs.begin(), costs.end());
+    double sum = 0.0;
+    for (auto v : costs) {
+        sum += v;
+    }
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+             "{\"avg\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"p999\": %.4f, \"max\": %.4f}",
+             costs.empty() ? 0.0 : sum / costs.size(), costs.empty() ? 0.0f : costs[0], _percentile(costs, 0.5f),
+             _percentile(costs, 0.9f), _percentile(costs, 0.99f), _percentile(costs, 0.999f),
+             costs.empty() ? 0.0f : costs.back());
+    return buffer;
+}
+
+static bool _createWorker(Worker& worker, const std::vector<std::pair<std::shared_ptr<uint8_t>, size_t>>& buffers,
+                          int modelIndex, int numThread, int forward) {
+    auto& buffer      = buffers[modelIndex];
+    worker.modelIndex = modelIndex;
+    worker.net.reset(MNN::Interpreter::createFromBuffer(buffer.first.get(), buffer.second));
+    if (nullptr == worker.net) {
+        return false;
+    }
+    worker.net->setSessionMode(MNN::Interpreter::Session_Release);
+    MNN::ScheduleConfig config;
+    config.numThread = numThread;
+    config.type      = (MNNForwardType)forward;
+    MNN::BackendConfig backendConfig;
+    backendConfig.power  = MNN::BackendConfig::Power_High;
+    config.backendConfig = &backendConfig;
+    worker.session       = worker.net->createSession(config);
+    if (nullptr == worker.session) {
+        return false;
+    }
+    worker.net->releaseModel();
+    worker.input  = worker.net->getSessionInput(worker.session, nullptr);
+    worker.output = worker.net->getSessionOutput(worker.session, nullptr);
+    worker.inputUser.reset(MNN::Tensor::createHostTensorFromDevice(worker.input, false));
+    worker.outputUser.reset(MNN::Tensor::createHostTensorFromDevice(worker.output, false));
+    if (worker.inputUser->getType() == halide_type_of<float>()) {
+        auto data = worker.inputUser->host<float>();
+        for (int i = 0; i < worker.inputUser->elementSize(); ++i) {
+            data[i] = Revert::getRandValue();
+        }
+    }
+    return true;
+}
+
+static void _request(Worker& worker) {
+    worker.input->copyFromHostTensor(worker.inputUser.get());
+    worker.net->runSession(worker.session);
+    worker.output->copyToHostTensor(worker.outputUser.get());
+}
+
+static std::string _runCase(const Options& options,
+                            const std::vector<std::pair<std::shared_ptr<uint8_t>, size_t>>& buffers, int sessionNumber,
+                            int numThread) {
+    _resetPeakRSS();
+    std::vector<Worker> workers(sessionNumber);
+    float sessionMemory = 0.0f;
+    for (int i = 0; i < sessionNumber; ++i) {
+        if (!_createWorker(workers[i], buffers, i % buffers.size(), numThread, options.forward)) {
+            MNN_ERROR("Create session for %s failed\n", options.models[i % buffers.size()].c_str());
+            return "";
+        }
+        float memory = 0.0f;
+        if (workers[i].net->getSessionInfo(workers[i].session, MNN::Interpreter::MEMORY, &memory)) {
+            sessionMemory += memory;
+        }
+        for (int w = 0; w < options.warmup; ++w) {
+            _request(workers[i]);
+        }
+    }
+    const bool openLoop = options.rate > 0.0f;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(openLoop ? 1.0 / options.rate : 0.0));
+    std::atomic<int64_t> scheduled(0);
+    std::atomic<int> ready(0);
+    std::atomic<bool> started(false);
+    Clock::time_point start, end;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < sessionNumber; ++i) {
+        threads.emplace_back([&, i]() {
+            auto& worker = workers[i];
+            ready++;
+            while (!started.load()) {
+                std::this_thread::yield();
+            }
+            while (true) {
+                Clock::time_point begin;
+                if (openLoop) {
+                    begin = start + interval * scheduled.fetch_add(1);
+                    if (begin >= end) {
+                        break;
+                    }
+                    std::this_thread::sleep_until(begin);
+                } else {
+                    begin = Clock::now();
+                    if (begin >= end) {
+                        break;
+                    }
+                }
+                _request(worker);
+                auto cost = std::chrono::duration<float, std::milli>(Clock::now() - begin).count();
+                worker.latency.emplace_back(cost);
+            }
+        });
+    }
+    while (ready.load() < sessionNumber) {
+        std::this_thread::yield();
+    }
+    start = Clock::now();
+    end   = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+    started.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto elapse = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<float> all;
+    std::vector<std::vector<float>> perModel(buffers.size());
+    for (auto& worker : workers) {
+        all.insert(all.end(), worker.latency.begin(), worker.latency.end());
+        perModel[worker.modelIndex].insert(perModel[worker.modelIndex].end(), worker.latency.begin(),
+                                           worker.latency.end());
+    }
+    std::ostringstream os;
+    os << "{\"sessions\": " << sessionNumber << ", \"numThread\": " << numThread << ", \"mode\": \""
+       << (openLoop ? "open" : "closed") << "\", \"rate\": " << options.rate << ", \"requests\": " << all.size()
+       << ", \"seconds\": " << elapse << ", \"qps\": " << (elapse > 0.0 ? all.size() / elapse : 0.0)
+       << ", \"latency_ms\": " << _latencyJson(all) << ", \"peak_rss_mb\": " << _peakRSSInMB()
+       << ", \"session_memory_mb\": " << sessionMemory << ", \"models\": [";
+    for (int i = 0; i < perModel.size(); ++i) {
+        if (i > 0) {
+            os << ", ";
+        }
+        os << "{\"model\": \"" << _escape(options.models[i]) << "\", \"requests\": " << perModel[i].size()
+           << ", \"latency_ms\": " << _latencyJson(perModel[i]) << "}";
+    }
+    os << "]}";
+    return os.str();
+}
+
+int main(int argc, const char* argv[]) {
+    if (argc < 2) {
+        MNN_PRINT("Usage: %s model0.mnn[,model1.mnn...] [duration_seconds=10] [sessions=1[,2,4...]] "
+                  "[numThread=1[,2...]] [rate=0 (closed-loop), >0 requests per second (open-loop)] [forwardtype=0] "
+                  "[warmup=5] [output.json]\n",
+                  argv[0]);
+        return 1;
+    }
+    Options options;
+    options.models = _split(argv[1]);
+    if (argc > 2) {
+        options.duration = ::atof(argv[2]);
+    }
+    if (argc > 3) {
+        options.sessions = _splitInt(argv[3]);
+    }
+    if (argc > 4) {
+        options.threads = _splitInt(argv[4]);
+    }
+    if (argc > 5) {
+        options.rate = ::atof(argv[5]);
+    }
+    if (argc > 6) {
+        options.forward = ::atoi(argv[6]);
+    }
+    if (argc > 7) {
+        options.warmup = ::atoi(argv[7]);
+    }
+    if (argc > 8) {
+        options.output = argv[8];
+    }
+    std::vector<std::pair<std::shared_ptr<uint8_t>, size_t>> buffers;
+    for (auto& name : options.models) {
+        // Revert fills random weights for models saved without them, keep a copy for creating interpreters
+        std::unique_ptr<Revert> revertor(new Revert(name.c_str()));
+        revertor->initialize();
+        auto size = revertor->getBufferSize();
+        std::shared_ptr<uint8_t> buffer(new uint8_t[size], std::default_delete<uint8_t[]>());
+        ::memcpy(buffer.get(), revertor->getBuffer(), size);
+        buffers.emplace_back(std::make_pair(buffer, size));
+    }
+    std::vector<std::string> results;
+    for (auto numThread : options.threads) {
+        for (auto sessionNumber : options.sessions) {
+            auto res = _runCase(options, buffers, sessionNumber, numThread);
+            if (res.empty()) {
+                return 1;
+            }
+            MNN_PRINT("%s\n", res.c_str());
+            results.emplace_back(res);
+        }
+    }
+    if (!options.output.empty()) {
+        std::ofstream output(options.output.c_str());
+        output << "[\n";
+        for (int i = 0; i < results.size(); ++i) {
+            output << "  " << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        output << "]\n";
+    }
+    return 0;
+}
@@ -271,7 +271,7 @@ void Executor::ComputeCache::setContentDirty() {
     mContentDirty = true;
 }
 
-Executor::ComputeCache::ComputeCache(std::shared_ptr<Backend> backend, std::shared_ptr<Backend> backupBackend) : mContext(backupBackend) {
+Executor::ComputeCache::ComputeCache(std::shared_ptr<Backend> backend, std::shared_ptr<Backend> backupBackend) : mContext(backupBackend, true, backend->type()) {
     mBackend = backend;
     mBackupBackend = backupBackend;
 }
@@ -726,6 +726,128 @@ void Executor::_visit(EXPRP expr, std::set<std::shared_ptr<Executor::ComputeCach
     //MNN_PRINT("Create %p, %s\n", expr.get(), EnumNameOpType(expr->get()->type()));
     expr->inside()->mUnit = unitP;
 }
+// Not yet computed op, it's safe to change the graph around it
+static bool _uncomputed(EXPRP expr) {
+    return nullptr != expr->get() && nullptr == expr->inside()->mCache && nullptr == expr->inside()->mUnit;
+}
+
+// Dest format of an uncomputed ConvertTensor, or -1
+static int _convertDest(EXPRP expr) {
+    if (!_uncomputed(expr) || OpType_ConvertTensor != expr->get()->type()) {
+        return -1;
+    }
+    auto info = expr->get()->main_as_TensorConvertInfo();
+    if (nullptr == info) {
+        return -1;
+    }
+    return info->dest();
+}
+
+static int _liveOutputNumber(EXPRP expr) {
+    std::set<Expr*> outputs;
+    for (auto& o : expr->outputs()) {
+        auto ref = o.lock();
+        if (nullptr != ref) {
+            outputs.insert(ref.get());
+        }
+    }
+    return (int)outputs.size();
+}
+
+static bool _sameOrder(VARP x, int dest) {
+    auto info = x->getInfo();
+    return nullptr != info && Utils::convertFormat(info->order) == dest;
+}
+
+/* Fold the ConvertTensor producing var with the ones before it:
+ Convert(Convert(x)) -> x if x is already in the dest format, else Convert(x)
+ Convert(U(Convert(x))) -> U(x) if x is already in the dest format
+ U must follow the layout of its input and process the whole buffer with U(0) = 0, so the zero padding of NC4HW4 is
+ kept. Only ReLU satisfies it on CPU, the other unary executions compute elementSize() values without the padding.
+ Return nullptr if nothing can be folded.
+ */
+static VARP _foldConvert(VARP var) {
+    auto convert = var->expr().first;
+    auto dest    = _convertDest(convert);
+    if (dest < 0) {
+        return nullptr;
+    }
+    auto middle = convert->inputs()[0]->expr().first;
+    if (_convertDest(middle) >= 0) {
+        auto x = middle->inputs()[0];
+        if (_sameOrder(x, dest)) {
+            return x;
+        }
+        if (nullptr == x->getInfo()) {
+            return nullptr;
+        }
+        auto res = Variable::create(Expr::create(convert->extra(), {x}));
+        return nullptr != res->getInfo() ? res : nullptr;
+    }
+    if (!_uncomputed(middle) || OpType_ReLU != middle->get()->type() || 1 != middle->inputs().size() ||
+        1 != middle->outputSize() || 1 != _liveOutputNumber(middle)) {
+        return nullptr;
+    }
+    auto inner = middle->inputs()[0]->expr().first;
+    if (_convertDest(inner) < 0 || !_sameOrder(inner->inputs()[0], dest)) {
+        return nullptr;
+    }
+    auto res = Variable::create(Expr::create(middle->extra(), {inner->inputs()[0]}));
+    return nullptr != res->getInfo() ? res : nullptr;
+}
+
+void Executor::_optimizeLayout(EXPRP expr, std::set<Expr*>& visited, std::map<Expr*, VARP>& folded) {
+    if (visited.find(expr.get()) != visited.end()) {
+        return;
+    }
+    visited.insert(expr.get());
+    if (!_uncomputed(expr)) {
+        return;
+    }
+    for (auto& input : expr->inputs()) {
+        _optimizeLayout(input->expr().first, visited, folded);
+    }
+    for (int i = 0; i < expr->mInputs.size(); ++i) {
+        auto origin  = expr->mInputs[i];
+        VARP current = origin;
+        while (true) {
+            auto key  = current->expr().first.get();
+            auto iter = folded.find(key);
+            VARP next;
+            if (iter != folded.end()) {
+                next = iter->second;
+            } else {
+                next = _foldConvert(current);
+                if (nullptr == next) {
+                    break;
+                }
+                folded.insert(std::make_pair(key, next));
+            }
+            current = next;
+        }
+        if (current.get() == origin.get()) {
+            continue;
+        }
+        expr->mInputs[i] = current;
+        current->expr().first->mTo.emplace_back(WeakEXPRP(expr));
+        // Unlink the origin input if no other input use it
+        bool stillUsed = false;
+        for (auto& input : expr->mInputs) {
+            if (input->expr().first == origin->expr().first) {
+                stillUsed = true;
+                break;
+            }
+        }
+        if (!stillUsed) {
+            for (auto& o : origin->expr().first->mTo) {
+                if (o.lock().get() == expr.get()) {
+                    o.reset();
+                }
+            }
+        }
+    }
+}
+
 void Executor::_makeCache(const std::vector<EXPRP>& expr, bool forceCPU) {
     std::set<std::shared_ptr<Executor::ComputeCache>> inputCaches;
     std::set<std::shared_ptr<Expr::Inside>> inputNode;
@@ -736,6 +858,15 @@ void Executor::_makeCache(const std::vector<EXPRP>& expr, bool forceCPU) {
 }
 
 void Executor::makeCache(const std::vector<EXPRP>& expr, bool forceCPU) {
+    {
+        // Cancel and sink the redundant ConvertTensor before building units. It may compute info of new exprs, which
+        // can read content, so it must be done out of the lock
+        std::set<Expr*> visited;
+        std::map<Expr*, VARP> folded;
+        for (auto e : expr) {
+            _optimizeLayout(e, visited, folded);
+        }
+    }
     std::lock_guard<std::mutex> _l(mMutex);
     //FUNC_PRINT(mCaches.size());
     _makeCache(expr, forceCPU);
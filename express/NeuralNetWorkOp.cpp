@@ -471,6 +471,21 @@ VARP _Softmax(VARP logits, int axis) {
     softmax->main.AsAxis()->axis = axis;
     return (Variable::create(Expr::create(softmax.get(), {logits})));
 }
+/*Computes log softmax: logits - max - log(sum(exp(logits - max))) along axis, numerically stable.
+Args:
+logits: A non-empty variable. Must be Halide_Type_Float.
+axis: The dimension softmax would be performed on. The default is -1 which indicates the last dimension.
+Returns:
+output: A variable with the same type as `logits`.
+*/
+VARP _LogSoftmax(VARP logits, int axis) {
+    std::unique_ptr<OpT> logSoftmax(new OpT);
+    logSoftmax->type                = OpType_LogSoftmax;
+    logSoftmax->main.type           = OpParameter_Axis;
+    logSoftmax->main.value          = new AxisT;
+    logSoftmax->main.AsAxis()->axis = axis;
+    return (Variable::create(Expr::create(logSoftmax.get(), {logits})));
+}
 /*Computes softplus: log(exp(features) + 1).
 Args:
 features: A variable. Must be Halide_Type_Float.
@@ -1022,6 +1037,39 @@ VARP _GatherND(VARP params, VARP indices) {
     return (Variable::create(Expr::create(std::move(op), {params, indices})));
 }
 
+/*Gather rows of weight and pool them per bag, without materializing the gathered rows.
+Args:
+weight: A variable of shape [num, d1, ...], Halide_Type_Float.
+indices: A 1-D variable of Halide_Type_Int, rows of weight to look up.
+offsets: A 1-D variable of Halide_Type_Int, bag b pools indices[offsets[b] : offsets[b + 1]], the last bag ends at the end of indices.
+perSampleWeights: Optional, a variable of the same size as indices, each looked up row is multiplied by it before pooling.
+mode: BAG_SUM, BAG_MEAN or BAG_MAX.
+Returns:
+A variable of shape [bags, d1, ...], an empty bag is zero.
+*/
+VARP _EmbeddingBag(VARP weight, VARP indices, VARP offsets, VARP perSampleWeights, EmbeddingBagMode mode) {
+    std::unique_ptr<OpT> op(new OpT);
+    op->type       = OpType_EmbeddingBag;
+    op->main.type  = OpParameter_ReductionParam;
+    auto param     = new ReductionParamT;
+    op->main.value = param;
+    switch (mode) {
+        case BAG_MEAN:
+            param->operation = ReductionType_MEAN;
+            break;
+        case BAG_MAX:
+            param->operation = ReductionType_MAXIMUM;
+            break;
+        default:
+            param->operation = ReductionType_SUM;
+            break;
+    }
+    if (nullptr == perSampleWeights) {
+        return (Variable::create(Expr::create(std::move(op), {weight, indices, offsets})));
+    }
+    return (Variable::create(Expr::create(std::move(op), {weight, indices, offsets, perSampleWeights})));
+}
+
 /*BatchToSpace for N-D variables
 This operation reshapes the "batch" dimension 0 into M + 1 dimensions of shape block_shape + [batch], 
 interleaves these blocks back into the grid defined by the spatial dimensions [1, ..., M], 
@@ -1475,6 +1523,62 @@ VARP _ZeroGrad(VARP x) {
     return Variable::create(Expr::create(std::move(op), {x}));
 }
 
+/*GRU over a time major sequence, gates are r, z, n and n = tanh(x * wxn + bxn + r * (h * whn + bhn)).
+Args:
+x: A variable of shape [T, N, I].
+wx: A variable of shape [I, 3H], weights of gates r, z, n for x.
+wh: A variable of shape [H, 3H], weights of gates r, z, n for h.
+bias: A variable of shape [2, 3H], biases for x and h.
+h0: A variable of shape [N, H], the initial hidden state.
+Returns:
+The hidden states of all steps, a variable of shape [T, N, H].
+*/
+VARP _GRUSequence(VARP x, VARP wx, VARP wh, VARP bias, VARP h0) {
+    std::unique_ptr<OpT> op(new OpT);
+    op->type = OpType_GRUSequence;
+    return Variable::create(Expr::create(op.get(), {x, wx, wh, bias, h0}, 2), 0);
+}
+
+/*LSTM over a time major sequence, gates are i, f, g, o.
+Args:
+x: A variable of shape [T, N, I].
+wx: A variable of shape [I, 4H], weights of gates i, f, g, o for x.
+wh: A variable of shape [H, 4H], weights of gates i, f, g, o for h.
+bias: A variable of shape [4H].
+h0: A variable of shape [N, H], the initial hidden state.
+c0: A variable of shape [N, H], the initial cell state.
+Returns:
+The hidden states and the cell states of all steps, two variables of shape [T, N, H].
+*/
+std::vector<VARP> _LSTMSequence(VARP x, VARP wx, VARP wh, VARP bias, VARP h0, VARP c0) {
+    std::unique_ptr<OpT> op(new OpT);
+    op->type  = OpType_LSTMSequence;
+    auto expr = Expr::create(op.get(), {x, wx, wh, bias, h0, c0}, 3);
+    return {Variable::create(expr, 0), Variable::create(expr, 1)};
+}
+
+/*Generalized advantage estimation of N trajectories, it has no grad, so the outputs can be used as targets directly.
+Args:
+reward: A variable of shape [T, N].
+value: A variable of shape [T, N], the value prediction of each step.
+done: A variable of shape [T, N], 1 if the episode ends after the step, else 0.
+bootstrap: A variable of N elements, the value prediction of the state after the last step.
+gamma: The discount.
+lambda: The GAE lambda, 1 gives the discounted return minus value.
+Returns:
+The advantages and the returns (advantage + value), two variables of shape [T, N].
+*/
+std::vector<VARP> _GAE(VARP reward, VARP value, VARP done, VARP bootstrap, float gamma, float lambda) {
+    std::unique_ptr<OpT> op(new OpT);
+    op->type       = OpType_GAE;
+    op->main.type  = OpParameter_GAEParam;
+    op->main.value = new GAEParamT;
+    op->main.AsGAEParam()->gamma  = gamma;
+    op->main.AsGAEParam()->lambda = lambda;
+    auto expr = Expr::create(op.get(), {reward, value, done, bootstrap}, 2);
+    return {Variable::create(expr, 0), Variable::create(expr, 1)};
+}
+
 VARP _Conv(std::vector<int8_t>&& weight, std::vector<int>&& bias, std::vector<float>&& scale, VARP x, INTS channel, INTS kernelSize,
                               PaddingMode pad, INTS stride, INTS dilate, int group, INTS pads, bool relu, int nbits) {
     std::unique_ptr<OpT> convOp(new OpT);
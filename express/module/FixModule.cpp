@@ -8,6 +8,7 @@
 
 #include "FixModule.hpp"
 #include <MNN/expr/ExprCreator.hpp>
+#include <map>
 using namespace MNN::Express;
 namespace MNN {
 namespace Express {
@@ -35,15 +36,52 @@ std::vector<Express::VARP> FixModule::onForward(const std::vector<Express::VARP>
     return mOutput;
 }
 
+// Rebuild the graph of var on the replicas of its leaves, the maps keep the replicas of visited vars and exprs
+static VARP _cloneGraph(VARP var, Module::CloneContext* ctx, std::map<const Variable*, VARP>& vars,
+                        std::map<const Expr*, EXPRP>& exprs) {
+    auto iter = vars.find(var.get());
+    if (iter != vars.end()) {
+        return iter->second;
+    }
+    auto expr = var->expr();
+    VARP replica;
+    if (nullptr == expr.first->get()) {
+        replica = ctx->getOrClone(var);
+    } else {
+        auto exprIter = exprs.find(expr.first.get());
+        if (exprIter == exprs.end()) {
+            std::vector<VARP> inputs;
+            for (auto& input : expr.first->inputs()) {
+                inputs.emplace_back(_cloneGraph(input, ctx, vars, exprs));
+            }
+            auto replicaExpr = Expr::create(expr.first->extra(), std::move(inputs), expr.first->outputSize());
+            replicaExpr->setName(expr.first->name());
+            exprIter = exprs.insert(std::make_pair(expr.first.get(), replicaExpr)).first;
+        }
+        replica = Variable::create(exprIter->second, expr.second);
+    }
+    vars[var.get()] = replica;
+    return replica;
+}
+
 Module* FixModule::clone(CloneContext* ctx) const {
     FixModule* module(new FixModule);
+    // The inputs are never shared, each replica is fed by its own forward
+    std::map<const Variable*, VARP> vars;
+    std::map<const Expr*, EXPRP> exprs;
     for (auto& it : mInputs) {
-        VARP v = ctx->getOrClone(it.first);
+        auto info = it.first->getInfo();
+        VARP v    = ctx->getOrClone(it.first);
+        if (nullptr != info && v.get() == it.first.get()) {
+            v = _Input(info->dim, info->order, info->type);
+            v->setName(it.first->name());
+        }
+        vars[it.first.get()] = v;
         module->mInputs.push_back(std::make_pair(v, it.second));
     }
+    // The outputs compute on the replicas of the inputs and parameters
     for (auto& it : mOutput) {
-        VARP v = ctx->getOrClone(it);
-        module->mOutput.push_back(v);
+        module->mOutput.push_back(_cloneGraph(it, ctx, vars, exprs));
     }
     return this->cloneBaseTo(ctx, module);
 }
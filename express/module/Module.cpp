@@ -154,10 +154,22 @@ EXPRP Module::CloneContext::getOrClone(EXPRP expr) {
 }
 
 VARP Module::CloneContext::getOrClone(VARP var) {
+    if (nullptr == var.get()) {
+        return var;
+    }
     auto it = mVarMap.find(var.get());
-    if (it != mVarMap.end()) {
-        // TODO(hjchen2): Clone variable.
+    if (it == mVarMap.end()) {
         VARP replica = var;
+        // Copy the content of parameters if not shared
+        if (!mShareParams && nullptr == var->expr().first->get()) {
+            auto info = var->getInfo();
+            auto ptr  = var->readMap<void>();
+            if (nullptr != info && nullptr != ptr) {
+                Variable::Info replicaInfo = *info;
+                replica = Variable::create(Expr::create(std::move(replicaInfo), ptr, var->expr().first->inputType()));
+                replica->setName(var->name());
+            }
+        }
         it = mVarMap.emplace(var.get(), replica).first;
     }
     return it->second;
@@ -45,15 +45,17 @@ public:
         Express::VARP x = inputs[0];
 
         if (getIsTraining()) {
-            float scale  = 1. / (1. - mDropRatio);
-            auto mask    = _Input(x->getInfo()->dim, x->getInfo()->order, x->getInfo()->type);
-            auto maskPtr = mask->writeMap<float>();
-            auto eltSize = x->getInfo()->size;
-            Distributions::uniform(eltSize, 0, 1, maskPtr, RandomGenerator::generator());
-            for (int i = 0; i < eltSize; i++) {
-                maskPtr[i] = maskPtr[i] < mDropRatio ? 0.0f : scale;
-            }
-            x = x * mask;
+            // The op generates mask by counter-based random and output it bit-packed for backward
+            std::unique_ptr<OpT> dropout(new OpT);
+            dropout->type       = OpType_Dropout;
+            dropout->main.type  = OpParameter_DropoutParam;
+            dropout->main.value = new DropoutParamT;
+            auto param          = dropout->main.AsDropoutParam();
+            auto& generator     = RandomGenerator::generator();
+            param->ratio        = mDropRatio;
+            param->seed         = (int)generator();
+            param->seed2        = (int)generator();
+            x = Variable::create(Expr::create(dropout.get(), {x}, 2), 0);
         }
 
         return {x};
@@ -150,22 +152,27 @@ public:
         auto dimFormat = x->getInfo()->order;
         VARP outputData = nullptr;
         if (getIsTraining()) {
-            if (dimFormat == NC4HW4 || dimFormat == NHWC) {
-                x = _Convert(x, NCHW);
+            // Fused op computes batch statistics, normalization and running statistics on NC4HW4 directly
+            if (dimFormat != NC4HW4) {
+                x = _Convert(x, NC4HW4);
             }
             MNN_ASSERT(x->getInfo()->dim[1] == mChannels);
-            auto sampleMean     = _ReduceMean(x, mReductionDims, true); // mean for each channel in the batch
-            auto xSub = x - sampleMean;
-            auto sampleVar      = _ReduceMean(_Square(xSub), mReductionDims,
-                                         true); // variance for each channel in the batch
-            auto rSampleStd     = _Reciprocal(_Sqrt(sampleVar + _Const(mEps)));
-            auto normalizedData = xSub * rSampleStd;
-            outputData          = normalizedData * mScale + mBias;
-
-            mRunningMean = _Const(mMomentum) * mRunningMean + _Const(1 - mMomentum) * sampleMean;
-            mRunningVariance = _Const(mMomentum) * mRunningVariance + _Const(1 - mMomentum) * sampleVar;
+            std::unique_ptr<OpT> bn(new OpT);
+            bn->type       = OpType_BatchNormTrain;
+            bn->main.type  = OpParameter_BatchNorm;
+            bn->main.value = new BatchNormT;
+            auto param      = bn->main.AsBatchNorm();
+            param->channels = mChannels;
+            param->epsilon  = mEps;
+            param->momentum = mMomentum;
+            auto bnExpr = Expr::create(bn.get(), {x, mScale, mBias, mRunningMean, mRunningVariance}, 5);
+            outputData  = Variable::create(bnExpr, 0);
             outputData->setName(name());
-            outputData = _Convert(outputData, dimFormat);
+            mRunningMean     = Variable::create(bnExpr, 3);
+            mRunningVariance = Variable::create(bnExpr, 4);
+            if (dimFormat != NC4HW4) {
+                outputData = _Convert(outputData, dimFormat);
+            }
             setParameter(mRunningMean, mRunningMeanPos);
             setParameter(mRunningVariance, mRunningVariancePos);
             return {outputData};
@@ -288,6 +295,87 @@ private:
 
     NN::ConvParameters mParameter;
 };
+class RecurrentModule : public Module {
+public:
+    RecurrentModule(VARP wx, VARP wh, VARP bias, bool lstm) {
+        mWx   = wx;
+        mWh   = wh;
+        mBias = bias;
+        mLSTM = lstm;
+        addParameter(mWx);
+        addParameter(mWh);
+        addParameter(mBias);
+        setType(lstm ? "LSTM" : "GRU");
+    }
+    virtual std::vector<VARP> onForward(const std::vector<VARP>& inputs) override {
+        auto x    = inputs[0];
+        auto info = x->getInfo();
+        MNN_ASSERT(nullptr != info && info->dim.size() == 3);
+        const int hidden = mWh->getInfo()->dim[0];
+        auto initState   = [&](int index) {
+            if (inputs.size() > index) {
+                return inputs[index];
+            }
+            return _Const(0.0f, {info->dim[1], hidden}, NCHW);
+        };
+        auto last = _Scalar<int>(info->dim[0] - 1);
+        if (mLSTM) {
+            auto outputs = _LSTMSequence(x, mWx, mWh, mBias, initState(1), initState(2));
+            outputs[0]->setName(name());
+            return {outputs[0], _Gather(outputs[0], last), _Gather(outputs[1], last)};
+        }
+        auto y = _GRUSequence(x, mWx, mWh, mBias, initState(1));
+        y->setName(name());
+        return {y, _Gather(y, last)};
+    }
+
+private:
+    RecurrentModule() = default;
+
+    Module* clone(CloneContext* ctx) const override {
+        RecurrentModule* module(new RecurrentModule);
+        module->mWx   = ctx->getOrClone(mWx);
+        module->mWh   = ctx->getOrClone(mWh);
+        module->mBias = ctx->getOrClone(mBias);
+        module->mLSTM = mLSTM;
+        return this->cloneBaseTo(ctx, module);
+    }
+
+    VARP mWx;
+    VARP mWh;
+    VARP mBias;
+    bool mLSTM = false;
+};
+
+static Module* _createRecurrent(int inputSize, int hiddenSize, bool lstm, std::shared_ptr<Initializer> weightInit,
+                                std::shared_ptr<Initializer> biasInit) {
+    if (nullptr == weightInit) {
+        weightInit.reset(Initializer::xavier());
+    }
+    if (nullptr == biasInit) {
+        biasInit.reset(Initializer::constValue(0.0f));
+    }
+    const int gates = lstm ? 4 : 3;
+    auto wx         = weightInit->createConstVar({inputSize, gates * hiddenSize}, NCHW);
+    auto wh         = weightInit->createConstVar({hiddenSize, gates * hiddenSize}, NCHW);
+    // GRU has separated biases for x and h
+    auto bias = biasInit->createConstVar({lstm ? 1 : 2, gates * hiddenSize}, NCHW);
+    wx.fix(VARP::TRAINABLE);
+    wh.fix(VARP::TRAINABLE);
+    bias.fix(VARP::TRAINABLE);
+    return new RecurrentModule(wx, wh, bias, lstm);
+}
+
+Module* NN::GRU(int inputSize, int hiddenSize, std::shared_ptr<Initializer> weightInit,
+                std::shared_ptr<Initializer> biasInit) {
+    return _createRecurrent(inputSize, hiddenSize, false, weightInit, biasInit);
+}
+
+Module* NN::LSTM(int inputSize, int hiddenSize, std::shared_ptr<Initializer> weightInit,
+                 std::shared_ptr<Initializer> biasInit) {
+    return _createRecurrent(inputSize, hiddenSize, true, weightInit, biasInit);
+}
+
 static std::tuple<VARP, VARP, int> _initParameters(const NN::ConvOption& option, bool hasBias,
                                                    std::shared_ptr<Initializer> weightInit,
                                                    std::shared_ptr<Initializer> biasInit) {
@@ -115,6 +115,217 @@ WhileModule* WhileModule::create(const Op* op, const std::map<std::string, SubGr
     return module;
 }
 
+/** Loop-carried state alternates between two compiled phases of cond / body:
+ phase 0 reads persistent input placeholders, phase 1 reads the outputs of phase 0 in place,
+ and the outputs of phase 1 are copied back to the placeholders of phase 0.
+ So the subgraphs are built only once and the state is copied once every two iterations.
+ */
+struct WhileModule::Phase {
+    std::vector<VARP> condInputs;
+    std::vector<VARP> bodyInputs;
+    VARP cond;
+    std::vector<VARP> bodyOutputs;
+};
+
+struct WhileModule::Plan {
+    struct Alias {
+        VARP var;
+        VARP source;
+        const void* ptr;
+    };
+    std::vector<Variable::Info> inputInfos;
+    Phase phases[2];
+    bool secondValid = false;
+    std::vector<Alias> aliases;
+};
+
+static bool _sameInfo(const Variable::Info* a, const Variable::Info* b) {
+    if (nullptr == a || nullptr == b) {
+        return false;
+    }
+    return a->order == b->order && a->dim == b->dim && a->type == b->type;
+}
+
+static VARP _cloneContent(VARP p) {
+    auto info = p->getInfo();
+    if (nullptr == info) {
+        return nullptr;
+    }
+    auto ptr = p->readMap<void>();
+    auto newV = Express::_Input(info->dim, info->order, info->type);
+    if (nullptr != ptr) {
+        ::memcpy(newV->writeMap<void>(), ptr, info->type.bytes() * info->size);
+    }
+    return newV;
+}
+
+static bool _copyContent(VARP dst, VARP src) {
+    auto info = src->getInfo();
+    auto srcPtr = src->readMap<void>();
+    if (nullptr == info || nullptr == srcPtr) {
+        return false;
+    }
+    if (dst->readMap<void>() == srcPtr) {
+        return true;
+    }
+    ::memcpy(dst->writeMap<void>(), srcPtr, info->type.bytes() * info->size);
+    return true;
+}
+
+bool WhileModule::_compile(const std::vector<Express::VARP>& inputs) {
+    std::vector<Variable::Info> infos(inputs.size());
+    for (int i=0; i<inputs.size(); ++i) {
+        if (nullptr == inputs[i]) {
+            continue;
+        }
+        auto info = inputs[i]->getInfo();
+        if (nullptr == info) {
+            return false;
+        }
+        infos[i] = *info;
+    }
+    if (nullptr != mPlan && mPlan->inputInfos.size() == infos.size()) {
+        bool same = true;
+        for (int i=0; i<infos.size(); ++i) {
+            if (!_sameInfo(&infos[i], &mPlan->inputInfos[i])) {
+                same = false;
+                break;
+            }
+        }
+        if (same) {
+            return true;
+        }
+    }
+    mPlan = nullptr;
+    std::shared_ptr<Plan> plan(new Plan);
+    auto& first = plan->phases[0];
+    first.condInputs.resize(mCondInputNumber);
+    first.bodyInputs.resize(mBodyInputNumber);
+    for (auto& p : mInputForCond) {
+        if (nullptr != inputs[p.second]) {
+            auto& info = infos[p.second];
+            first.condInputs[p.first] = _Input(info.dim, info.order, info.type);
+        }
+    }
+    for (auto& p : mInputForBody) {
+        if (nullptr != inputs[p.second]) {
+            auto& info = infos[p.second];
+            first.bodyInputs[p.first] = _Input(info.dim, info.order, info.type);
+        }
+    }
+    for (auto& v : first.condInputs) {
+        if (nullptr == v) {
+            return false;
+        }
+    }
+    for (auto& v : first.bodyInputs) {
+        if (nullptr == v) {
+            return false;
+        }
+    }
+    // The content is needed if some shapes are computed from it
+    for (auto& p : mInputForCond) {
+        _copyContent(first.condInputs[p.first], inputs[p.second]);
+    }
+    for (auto& p : mInputForBody) {
+        _copyContent(first.bodyInputs[p.first], inputs[p.second]);
+    }
+    first.cond = mCond->onForward(first.condInputs)[0];
+    first.bodyOutputs = mBody->onForward(first.bodyInputs);
+    // The plan recomputes the outputs when the placeholders change, so they must be expressions of them.
+    // Static submodules compute at once and return the values, state passed through is the input itself.
+    auto isComputed = [](VARP v) {
+        return v->expr().first->get() != nullptr;
+    };
+    if (!isComputed(first.cond)) {
+        return false;
+    }
+    for (auto& v : first.bodyOutputs) {
+        if (!isComputed(v)) {
+            return false;
+        }
+    }
+    Variable::prepareCompute({first.cond});
+    Variable::prepareCompute(first.bodyOutputs);
+    plan->inputInfos = std::move(infos);
+    mPlan = plan;
+    return true;
+}
+
+void WhileModule::_bindSecondPhase() {
+    auto plan = mPlan.get();
+    if (plan->secondValid) {
+        bool same = true;
+        for (auto& a : plan->aliases) {
+            if (a.source->readMap<void>() != a.ptr) {
+                same = false;
+                break;
+            }
+        }
+        if (same) {
+            for (auto& a : plan->aliases) {
+                // Only mark the content dirty, the memory is shared
+                a.var->writeMap<void>();
+            }
+            return;
+        }
+    }
+    auto& first = plan->phases[0];
+    auto& second = plan->phases[1];
+    plan->aliases.clear();
+    auto makeAlias = [plan](VARP source) {
+        auto info = *source->getInfo();
+        auto ptr = source->readMap<void>();
+        auto var = Variable::create(Expr::create(std::move(info), ptr, VARP::INPUT, false));
+        plan->aliases.emplace_back(Plan::Alias{var, source, ptr});
+        return var;
+    };
+    second.condInputs = first.condInputs;
+    second.bodyInputs = first.bodyInputs;
+    for (auto& p : mUpdateForCond) {
+        second.condInputs[p.first] = makeAlias(first.bodyOutputs[p.second]);
+    }
+    for (auto& p : mUpdateForBody) {
+        second.bodyInputs[p.first] = makeAlias(first.bodyOutputs[p.second]);
+    }
+    for (auto& p : mCondUpdateForCond) {
+        second.condInputs[p.first] = makeAlias(first.cond);
+    }
+    for (auto& p : mCondUpdateForBody) {
+        second.bodyInputs[p.first] = makeAlias(first.cond);
+    }
+    second.cond = mCond->onForward(second.condInputs)[0];
+    second.bodyOutputs = mBody->onForward(second.bodyInputs);
+    Variable::prepareCompute({second.cond});
+    Variable::prepareCompute(second.bodyOutputs);
+    plan->secondValid = true;
+}
+
+bool WhileModule::_loopCarriedFixed(const Phase& phase) const {
+    auto& first = mPlan->phases[0];
+    for (auto& p : mUpdateForCond) {
+        if (!_sameInfo(phase.bodyOutputs[p.second]->getInfo(), first.condInputs[p.first]->getInfo())) {
+            return false;
+        }
+    }
+    for (auto& p : mUpdateForBody) {
+        if (!_sameInfo(phase.bodyOutputs[p.second]->getInfo(), first.bodyInputs[p.first]->getInfo())) {
+            return false;
+        }
+    }
+    for (auto& p : mCondUpdateForCond) {
+        if (!_sameInfo(phase.cond->getInfo(), first.condInputs[p.first]->getInfo())) {
+            return false;
+        }
+    }
+    for (auto& p : mCondUpdateForBody) {
+        if (!_sameInfo(phase.cond->getInfo(), first.bodyInputs[p.first]->getInfo())) {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::vector<Express::VARP> WhileModule::onForward(const std::vector<Express::VARP>& inputsI) {
     std::vector<Express::VARP> condInputs(mCondInputNumber);
     std::vector<Express::VARP> bodyInputs(mBodyInputNumber);
@@ -125,8 +336,110 @@ std::vector<Express::VARP> WhileModule::onForward(const std::vector<Express::VAR
     for (auto& p : mInputForBody) {
         bodyInputs[p.first] = inputs[p.second];
     }
-
     std::vector<Express::VARP> outputs(mOutputFromBody.size());
+    // Without any iteration the outputs are the initial value of loop-carried state
+    for (int i=0; i<mOutputFromBody.size(); ++i) {
+        for (auto& u : mUpdateForBody) {
+            if (u.second != mOutputFromBody[i]) {
+                continue;
+            }
+            for (auto& p : mInputForBody) {
+                if (p.first == u.first) {
+                    outputs[i] = inputs[p.second];
+                }
+            }
+        }
+        for (auto& u : mUpdateForCond) {
+            if (u.second != mOutputFromBody[i]) {
+                continue;
+            }
+            for (auto& p : mInputForCond) {
+                if (p.first == u.first) {
+                    outputs[i] = inputs[p.second];
+                }
+            }
+        }
+    }
+    auto lastPlan = mPlan;
+    if (!_compile(inputs)) {
+        return _forwardDynamic(condInputs, bodyInputs, outputs);
+    }
+    auto& first = mPlan->phases[0];
+    if (lastPlan == mPlan) {
+        for (auto& p : mInputForCond) {
+            _copyContent(first.condInputs[p.first], inputs[p.second]);
+        }
+        for (auto& p : mInputForBody) {
+            _copyContent(first.bodyInputs[p.first], inputs[p.second]);
+        }
+    }
+    const std::vector<VARP>* lastOutputs = nullptr;
+    int current = 0;
+    while (true) {
+        auto& phase = mPlan->phases[current];
+        auto resPtr = phase.cond->readMap<int>();
+        if (nullptr == resPtr) {
+            MNN_ERROR("Compute cond of while failed\n");
+            return {};
+        }
+        if (resPtr[0] <= 0) {
+            break;
+        }
+        for (auto& v : phase.bodyOutputs) {
+            if (nullptr == v->readMap<void>() && v->getInfo() != nullptr && v->getInfo()->size > 0) {
+                MNN_ERROR("Compute body of while failed\n");
+                return {};
+            }
+        }
+        lastOutputs = &phase.bodyOutputs;
+        if (!_loopCarriedFixed(phase)) {
+            // The shape of loop-carried state changes, continue with the dynamic path
+            for (int i=0; i<mOutputFromBody.size(); ++i) {
+                outputs[i] = _cloneContent(phase.bodyOutputs[mOutputFromBody[i]]);
+            }
+            for (auto& p : mUpdateForCond) {
+                condInputs[p.first] = _cloneContent(phase.bodyOutputs[p.second]);
+            }
+            for (auto& p : mUpdateForBody) {
+                bodyInputs[p.first] = _cloneContent(phase.bodyOutputs[p.second]);
+            }
+            auto res = _cloneContent(phase.cond);
+            for (auto& p : mCondUpdateForCond) {
+                condInputs[p.first] = res;
+            }
+            for (auto& p : mCondUpdateForBody) {
+                bodyInputs[p.first] = res;
+            }
+            return _forwardDynamic(condInputs, bodyInputs, outputs);
+        }
+        if (0 == current) {
+            _bindSecondPhase();
+        } else {
+            for (auto& p : mUpdateForCond) {
+                _copyContent(first.condInputs[p.first], phase.bodyOutputs[p.second]);
+            }
+            for (auto& p : mUpdateForBody) {
+                _copyContent(first.bodyInputs[p.first], phase.bodyOutputs[p.second]);
+            }
+            for (auto& p : mCondUpdateForCond) {
+                _copyContent(first.condInputs[p.first], phase.cond);
+            }
+            for (auto& p : mCondUpdateForBody) {
+                _copyContent(first.bodyInputs[p.first], phase.cond);
+            }
+        }
+        current = 1 - current;
+    }
+    if (nullptr != lastOutputs) {
+        // The memory of plan is reused by next iteration / forward, so copy the results
+        for (int i=0; i<mOutputFromBody.size(); ++i) {
+            outputs[i] = _cloneContent((*lastOutputs)[mOutputFromBody[i]]);
+        }
+    }
+    return outputs;
+}
+
+std::vector<Express::VARP> WhileModule::_forwardDynamic(std::vector<Express::VARP>& condInputs, std::vector<Express::VARP>& bodyInputs, std::vector<Express::VARP>& outputs) {
     while (true) {
         auto res = mCond->onForward(condInputs)[0];
         auto resPtr = res->readMap<int>();
@@ -138,13 +451,7 @@ std::vector<Express::VARP> WhileModule::onForward(const std::vector<Express::VAR
         for (int i=0; i<bodyOutputs.size(); ++i) {
             auto p = bodyOutputs[i];
             if (p->expr().first->get() != nullptr) {
-                auto ptr = p->readMap<void>();
-                auto info = p->getInfo();
-                auto newV = Express::_Input(info->dim, info->order, info->type);
-                if (nullptr != ptr) {
-                    ::memcpy(newV->writeMap<void>(), ptr, info->type.bytes() * info->size);
-                }
-                bodyOutputs[i] = newV;
+                bodyOutputs[i] = _cloneContent(p);
             }
         }
         for (int i=0; i<mOutputFromBody.size(); ++i) {
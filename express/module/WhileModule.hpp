@@ -23,6 +23,15 @@ private:
 
     Module* clone(CloneContext* ctx) const override;
 
+    struct Phase;
+    struct Plan;
+    // Build the execution plan of cond / body for the inputs' shape, return false if it can't be compiled
+    bool _compile(const std::vector<Express::VARP>& inputs);
+    // Let the second phase read the outputs of first phase in place, rebuild it if their memory changed
+    void _bindSecondPhase();
+    bool _loopCarriedFixed(const Phase& phase) const;
+    std::vector<Express::VARP> _forwardDynamic(std::vector<Express::VARP>& condInputs, std::vector<Express::VARP>& bodyInputs, std::vector<Express::VARP>& outputs);
+
     int mCondInputNumber;
     int mBodyInputNumber;
 
@@ -40,6 +49,8 @@ private:
 
     std::shared_ptr<Module> mCond;
     std::shared_ptr<Module> mBody;
+
+    std::shared_ptr<Plan> mPlan;
 };
 }
 }
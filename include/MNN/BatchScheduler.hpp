@@ -0,0 +1,85 @@
+//
+//  BatchScheduler.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/21.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef BatchScheduler_hpp
+#define BatchScheduler_hpp
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <MNN/Interpreter.hpp>
+
+namespace MNN {
+
+struct BatchContent;
+
+/**
+ Coalesce single-sample requests into batches. The model is resized once for each batch bucket, the first dimension
+ of every input and output must be the batch. Requests are queued by submit, a worker thread takes up to the largest
+ bucket of them, or less if the oldest one has waited maxWaitUs, runs the smallest bucket that can hold them and
+ scatters the outputs back through the futures.
+ */
+class MNN_PUBLIC BatchScheduler {
+public:
+    struct Config {
+        /** batch sizes to prepare sessions for, a batch runs the smallest one that is large enough */
+        std::vector<int> batchBuckets = {1, 2, 4, 8};
+        /** max time the oldest request waits for more requests, in microseconds */
+        int maxWaitUs = 2000;
+        /** schedule config of the sessions, all of the buckets share one runtime */
+        ScheduleConfig schedule;
+    };
+    /** host tensors of one sample, keyed by the input / output name, batch is 1 */
+    typedef std::map<std::string, std::shared_ptr<Tensor>> TensorMap;
+    struct Result {
+        ErrorCode code = NO_ERROR;
+        TensorMap outputs;
+    };
+
+    /**
+     * @brief create scheduler from model file.
+     * @param file  model file path.
+     * @param config    bucket and wait config.
+     * @return created scheduler, nullptr if the model can't be loaded or resized for the buckets.
+     */
+    static BatchScheduler* createFromFile(const char* file, const Config& config);
+    /**
+     * @brief create scheduler from model buffer.
+     */
+    static BatchScheduler* createFromBuffer(const void* buffer, size_t size, const Config& config);
+    /**
+     * @brief stop accepting requests, finish the queued ones and release the sessions.
+     */
+    ~BatchScheduler();
+
+    /**
+     * @brief create a host tensor of one sample for the given input, in the dimension type of the session.
+     * @return nullptr if the input doesn't exist.
+     */
+    std::shared_ptr<Tensor> createInput(const std::string& name) const;
+    /**
+     * @brief queue one sample, thread safe.
+     * @param inputs    one host tensor for each input of the model, the size must match createInput.
+     * @return future of the outputs, code is INPUT_DATA_ERROR if the inputs don't match the model.
+     */
+    std::future<Result> submit(const TensorMap& inputs);
+
+    const std::vector<std::string>& inputNames() const;
+    const std::vector<std::string>& outputNames() const;
+
+private:
+    BatchScheduler(BatchContent* content);
+    void _run();
+    BatchContent* mContent;
+};
+
+} // namespace MNN
+
+#endif /* BatchScheduler_hpp */
@@ -0,0 +1,2 @@
+#define MNN_REVISION "1155570389a8c00dbfc0997b91e35ca70b94ca79"
+#define MNN_REPOSITORY "/root/repo"
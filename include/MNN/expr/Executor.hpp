@@ -14,6 +14,7 @@
 #include <vector>
 #include <mutex>
 #include <set>
+#include <map>
 #include <MNN/MNNForwardType.h>
 namespace MNN {
 class Backend;
@@ -60,6 +61,7 @@ private:
     void _create(const std::vector<EXPRP>& outputs, std::set<std::shared_ptr<Executor::ComputeCache>>&& inputCaches, std::set<std::shared_ptr<Expr::Inside>>&& inputNode, bool forceCPU);
 
     void _visit(EXPRP expr, std::set<std::shared_ptr<Executor::ComputeCache>>& inputCaches, std::set<std::shared_ptr<Expr::Inside>>& inputNode);
+    void _optimizeLayout(EXPRP expr, std::set<Expr*>& visited, std::map<Expr*, VARP>& folded);
 
     Executor(std::shared_ptr<Runtime> backend, MNNForwardType type);
     std::pair<std::shared_ptr<Runtime>, MNNForwardType> mRuntime;
@@ -241,6 +241,7 @@ private:
 
     friend class Variable;
     friend class VARP;
+    friend class Executor;
     VARP::InputType mType;
     const Op* mOp;
     std::vector<VARP> mInputs;
@@ -56,6 +56,12 @@ public:
     static Module* Dropout(const float dropRatio);
     static Module* BatchNorm(const int channels, const int dims = 4, const float m = 0.999,
                                              const float e = 1e-5);
+    // Time major, inputs: x [T, N, I] and optional initial states [N, H] (h0, c0 for LSTM)
+    // outputs: y [T, N, H] and the states of the last step (h, c for LSTM)
+    static Module* GRU(int inputSize, int hiddenSize, std::shared_ptr<Initializer> weightInit = nullptr,
+                       std::shared_ptr<Initializer> biasInit = nullptr);
+    static Module* LSTM(int inputSize, int hiddenSize, std::shared_ptr<Initializer> weightInit = nullptr,
+                        std::shared_ptr<Initializer> biasInit = nullptr);
 
     static Module* ConvInt8(const ConvOption& option, int bits = 8, bool bias = true,
                                             std::shared_ptr<Initializer> weightInit = nullptr,
@@ -57,6 +57,7 @@ MNN_PUBLIC VARP _Relu(VARP x, float slope = 0.0f);
 MNN_PUBLIC VARP _Relu6(VARP x, float minValue = 0.0f, float maxValue = 6.0f);
 MNN_PUBLIC VARP _PRelu(VARP x, std::vector<float> &&slopes);
 MNN_PUBLIC VARP _Softmax(VARP logits, int axis = -1);
+MNN_PUBLIC VARP _LogSoftmax(VARP logits, int axis = -1);
 MNN_PUBLIC VARP _Softplus(VARP features);
 MNN_PUBLIC VARP _Softsign(VARP features);
 MNN_PUBLIC std::vector<VARP> _Split(VARP value, INTS size_splits, int axis = 0);
@@ -94,6 +95,9 @@ MNN_PUBLIC VARP _Squeeze(VARP input, INTS axis = {});
 MNN_PUBLIC VARP _Unsqueeze(VARP input, INTS axis = {});
 MNN_PUBLIC VARP _BatchToSpaceND(VARP input, VARP block_shape, VARP crops);
 MNN_PUBLIC VARP _GatherND(VARP params, VARP indices);
+enum EmbeddingBagMode {BAG_SUM, BAG_MEAN, BAG_MAX};
+MNN_PUBLIC VARP _EmbeddingBag(VARP weight, VARP indices, VARP offsets, VARP perSampleWeights = nullptr,
+                              EmbeddingBagMode mode = BAG_SUM);
 MNN_PUBLIC VARP _Selu(VARP features, float scale, float alpha);
 MNN_PUBLIC VARP _Size(VARP input);
 MNN_PUBLIC VARP _Elu(VARP features, float alpha=1.0);
@@ -126,6 +130,9 @@ MNN_PUBLIC  std::vector<VARP> _DetectionPostProcess(VARP encode_boxes, VARP clas
 MNN_PUBLIC VARP _Interp(VARPS xs, float widthScale, float heightScale, int outputWidth, int outputHeight, int resizeType, bool alignCorners);
 
 MNN_PUBLIC VARP _ZeroGrad(VARP x);
+MNN_PUBLIC VARP _GRUSequence(VARP x, VARP wx, VARP wh, VARP bias, VARP h0);
+MNN_PUBLIC std::vector<VARP> _LSTMSequence(VARP x, VARP wx, VARP wh, VARP bias, VARP h0, VARP c0);
+MNN_PUBLIC std::vector<VARP> _GAE(VARP reward, VARP value, VARP done, VARP bootstrap, float gamma = 0.99f, float lambda = 0.95f);
 
 // Int8 Inference
 MNN_PUBLIC VARP _Conv(std::vector<int8_t>&& weight, std::vector<int>&& bias, std::vector<float>&& scale, VARP x, INTS channel, INTS kernelSize,
@@ -64,6 +64,25 @@ typedef struct {
     Interpreter *interpreter;
 } PyMNNInterpreter;
 
+#ifndef USE_PRIVATE
+/** Numpy arrays wrapped by expr.from_numpy, an array is released after the Expr using its memory is destroyed.
+ Expr has no hook for it, so the expired ones are released on next wrap, called with GIL held.
+ */
+static void holdNumpyArray(EXPRP expr, PyObject *array) {
+    static std::vector<std::pair<std::weak_ptr<Expr>, PyObject*>> holders;
+    for (auto iter = holders.begin(); iter != holders.end();) {
+        if (iter->first.expired()) {
+            Py_DECREF(iter->second);
+            iter = holders.erase(iter);
+        } else {
+            iter++;
+        }
+    }
+    Py_INCREF(array);
+    holders.emplace_back(std::make_pair(std::weak_ptr<Expr>(expr), array));
+}
+#endif
+
 typedef struct {
     PyObject_HEAD
     std::string *modelPath;
@@ -74,6 +93,8 @@ typedef struct {
     PyObject_HEAD
     Tensor *tensor;
     int owner;
+    // The numpy array whose memory is used by tensor without copy
+    PyObject *base;
 } PyMNNTensor;
 
 typedef struct {
@@ -307,6 +328,15 @@ static PyObject* PyMNNTensor_getHost(PyMNNTensor *self, PyObject *args);
 static PyObject* PyMNNTensor_copyFrom(PyMNNTensor *self, PyObject *args);
 static PyObject* PyMNNTensor_copyToHostTensor(PyMNNTensor *self, PyObject *args);
 
+#ifndef USE_PRIVATE
+static int PyMNNTensor_getbuffer(PyMNNTensor *self, Py_buffer *view, int flags);
+static void PyMNNTensor_releasebuffer(PyMNNTensor *self, Py_buffer *view);
+static PyBufferProcs PyMNNTensor_as_buffer = {
+    (getbufferproc)PyMNNTensor_getbuffer,
+    (releasebufferproc)PyMNNTensor_releasebuffer,
+};
+#endif
+
 static PyMethodDef PyMNNTensor_methods[] = {
 #ifndef USE_PRIVATE
     {"fromNumpy", (PyCFunction)PyMNNTensor_fromNumpy, METH_VARARGS, "copy data from numpy"},
@@ -342,7 +372,11 @@ static PyTypeObject PyMNNTensorType = {
     0,                                        /*tp_str*/
     0,                                        /*tp_getattro*/
     0,                                        /*tp_setattro*/
+    #ifndef USE_PRIVATE
+    &PyMNNTensor_as_buffer,                   /*tp_as_buffer*/
+#else
     0,                                        /*tp_as_buffer*/
+#endif
     Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /*tp_flags*/
     "MNN Tensor objects",                    /* tp_doc */
     0,                                        /* tp_traverse */
@@ -622,7 +656,10 @@ static PyObject* PyMNNInterpreter_createSession(PyMNNInterpreter *self, PyObject
 
     }
 
-    Session *s = instance->interpreter->createSession(config);
+    Session *s = NULL;
+    Py_BEGIN_ALLOW_THREADS
+    s = instance->interpreter->createSession(config);
+    Py_END_ALLOW_THREADS
     if (!s) {
         PyErr_SetString(PyExc_Exception,
                         "PyMNNInterpreter_createSession: NetInstance createSession failed");
@@ -647,7 +684,9 @@ static PyObject* PyMNNInterpreter_resizeSession(PyMNNInterpreter *self, PyObject
         return NULL;
     }
 
+    Py_BEGIN_ALLOW_THREADS
     self->interpreter->resizeSession(session->session);
+    Py_END_ALLOW_THREADS
     Py_RETURN_TRUE;
 }
 
@@ -807,10 +846,23 @@ static PyObject* PyMNNInterpreter_runSessionWithCallBack(PyMNNInterpreter *self,
         return ret;
     };
 
+    // The callbacks are called without GIL, take it before touching python objects
+    TensorCallBack beginWithGIL = [&begin](const std::vector<Tensor*>& tensors, const std::string& name) {
+        PyGILState_STATE state = PyGILState_Ensure();
+        auto res = begin(tensors, name);
+        PyGILState_Release(state);
+        return res;
+    };
+    TensorCallBack endWithGIL = [&end](const std::vector<Tensor*>& tensors, const std::string& name) {
+        PyGILState_STATE state = PyGILState_Ensure();
+        auto res = end(tensors, name);
+        PyGILState_Release(state);
+        return res;
+    };
     ErrorCode r = NO_ERROR;
-    //Py_BEGIN_ALLOW_THREADS
-    r = self->interpreter->runSessionWithCallBack(session->session, begin, end);
-    //Py_END_ALLOW_THREADS
+    Py_BEGIN_ALLOW_THREADS
+    r = self->interpreter->runSessionWithCallBack(session->session, beginWithGIL, endWithGIL);
+    Py_END_ALLOW_THREADS
     return PyLong_FromLong(r);
 }
 
@@ -926,10 +978,23 @@ static PyObject* PyMNNInterpreter_runSessionWithCallBackInfo(PyMNNInterpreter *s
         return ret;
     };
 
+    // The callbacks are called without GIL, take it before touching python objects
+    TensorCallBackWithInfo beginWithGIL = [&begin](const std::vector<Tensor*>& tensors, const OperatorInfo* info) {
+        PyGILState_STATE state = PyGILState_Ensure();
+        auto res = begin(tensors, info);
+        PyGILState_Release(state);
+        return res;
+    };
+    TensorCallBackWithInfo endWithGIL = [&end](const std::vector<Tensor*>& tensors, const OperatorInfo* info) {
+        PyGILState_STATE state = PyGILState_Ensure();
+        auto res = end(tensors, info);
+        PyGILState_Release(state);
+        return res;
+    };
     ErrorCode r = NO_ERROR;
-    //Py_BEGIN_ALLOW_THREADS
-    r = self->interpreter->runSessionWithCallBackInfo(session->session, begin, end);
-    //Py_END_ALLOW_THREADS
+    Py_BEGIN_ALLOW_THREADS
+    r = self->interpreter->runSessionWithCallBackInfo(session->session, beginWithGIL, endWithGIL);
+    Py_END_ALLOW_THREADS
     return PyLong_FromLong(r);
 }
 
@@ -1197,7 +1262,10 @@ static PyObject* PyMNNTensor_new(struct _typeobject *type, PyObject *args, PyObj
 }
 
 static void PyMNNTensor_dealloc(PyMNNTensor *self) {
-    if (self->owner) {
+    if (self->base) {
+        delete self->tensor;
+        Py_DECREF(self->base);
+    } else if (self->owner) {
         if (self->tensor->host<void *>()) {
             free(self->tensor->host<void *>());
         }
@@ -1311,6 +1379,13 @@ static int PyMNNTensor_init(PyMNNTensor *self, PyObject *args, PyObject *kwds) {
         }
     }
 #ifndef USE_PRIVATE
+    else if (PyArray_IS_C_CONTIGUOUS((PyArrayObject*)data) && PyArray_ISALIGNED((PyArrayObject*)data)
+             && getitemsize(dtype, PyArray_TYPE(data)) == htt.bytes()) {
+        // Use the memory of numpy directly, keep the array alive with the tensor
+        pData = PyArray_DATA((PyArrayObject*)data);
+        Py_INCREF(data);
+        self->base = data;
+    }
     else {
         int npy_type = PyArray_TYPE(data);
         int itemsize = getitemsize(dtype, npy_type);
@@ -1372,6 +1447,67 @@ static PyObject* PyMNNTensor_fromNumpy(PyMNNTensor *self, PyObject *args) {
     Py_RETURN_NONE;
 }
 #endif
+// Expose the host memory of tensor by buffer protocol, so numpy.asarray(tensor) is a view without copy
+static int PyMNNTensor_getbuffer(PyMNNTensor *self, Py_buffer *view, int flags) {
+    view->obj = NULL;
+    auto tensor = self->tensor;
+    if (nullptr == tensor || nullptr == tensor->host<void>()) {
+        PyErr_SetString(PyExc_BufferError, "PyMNNTensor_getbuffer: tensor has no host memory");
+        return -1;
+    }
+    if (tensor->getDimensionType() == Tensor::CAFFE_C4) {
+        PyErr_SetString(PyExc_BufferError, "PyMNNTensor_getbuffer: NC4HW4 tensor is not supported");
+        return -1;
+    }
+    auto t = tensor->getType();
+    const char* format = nullptr;
+    if (t == *httFloat()) {
+        format = "f";
+    } else if (t == *httDouble()) {
+        format = "d";
+    } else if (t == *httInt()) {
+        format = "i";
+    } else if (t == *httInt64()) {
+        format = "q";
+    } else if (t == *httUint8()) {
+        format = "B";
+    } else if (t == halide_type_of<int8_t>()) {
+        format = "b";
+    } else {
+        PyErr_SetString(PyExc_BufferError, "PyMNNTensor_getbuffer: unsupported data type");
+        return -1;
+    }
+    int dims = tensor->dimensions();
+    // shape and strides must be valid until the buffer is released
+    auto shapes = (Py_ssize_t*)malloc(sizeof(Py_ssize_t) * (2 * dims + 1));
+    if (nullptr == shapes) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    auto strides = shapes + dims;
+    for (int i = 0; i < dims; ++i) {
+        shapes[i]  = tensor->length(i);
+        strides[i] = (Py_ssize_t)tensor->stride(i) * t.bytes();
+    }
+    view->buf        = tensor->host<void>();
+    view->len        = (Py_ssize_t)tensor->elementSize() * t.bytes();
+    view->readonly   = 0;
+    view->itemsize   = t.bytes();
+    view->format     = (flags & PyBUF_FORMAT) ? (char*)format : NULL;
+    view->ndim       = dims;
+    view->shape      = (flags & PyBUF_ND) ? shapes : NULL;
+    view->strides    = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? strides : NULL;
+    view->suboffsets = NULL;
+    view->internal   = shapes;
+    view->obj        = (PyObject*)self;
+    Py_INCREF(self);
+    return 0;
+}
+
+static void PyMNNTensor_releasebuffer(PyMNNTensor *self, Py_buffer *view) {
+    free(view->internal);
+}
+
 static PyObject* PyMNNTensor_printTensorData(PyMNNTensor *self, PyObject *args) {
     if (self->tensor) {
         // Do nothing
@@ -1458,21 +1594,27 @@ static PyObject* PyMNNTensor_getData(PyMNNTensor *self, PyObject *args) {
          for(const auto dim : self->tensor->shape()) {
             npy_dims.push_back(dim);
          }
+         int npy_type = -1;
          if (t == *httInt()) {
-            auto data = self->tensor->host<int32_t>();
-            return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_INT32, data);
+            npy_type = NPY_INT32;
          } else if (t == *httUint8()) {
-            auto data = self->tensor->host<uint8_t>();
-            return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_UINT8, data);
+            npy_type = NPY_UINT8;
          } else if (t == *httInt64()) {
-            auto data = self->tensor->host<int64_t>();
-            return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_INT64, data);
+            npy_type = NPY_INT64;
          } else if (t == *httFloat()) {
-            auto data = self->tensor->host<float>();
-            return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_FLOAT, data);
+            npy_type = NPY_FLOAT;
          } else if (t == *httDouble()) {
-            auto data = self->tensor->host<double>();
-            return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_DOUBLE, data);
+            npy_type = NPY_DOUBLE;
+         }
+         if (npy_type >= 0) {
+            // The array is a view of tensor memory, it holds a reference of the tensor object
+            auto array = PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), npy_type, self->tensor->host<void>());
+            if (nullptr == array) {
+                return NULL;
+            }
+            Py_INCREF(self);
+            PyArray_SetBaseObject((PyArrayObject*)array, (PyObject*)self);
+            return array;
          } else if (t == *httString()) {
             auto data = self->tensor->host<char *>();
             PyObject *outputData = PyTuple_New(size);
@@ -1507,7 +1649,10 @@ static PyObject* PyMNNTensor_copyFrom(PyMNNTensor *self, PyObject *args) {
                         "PyMNNTensor_copyFrom: source or destination tensor is null");
     }
 
-    bool r = self->tensor->copyFromHostTensor(fromTensor->tensor);
+    bool r = false;
+    Py_BEGIN_ALLOW_THREADS
+    r = self->tensor->copyFromHostTensor(fromTensor->tensor);
+    Py_END_ALLOW_THREADS
     if (!r) {
         Py_RETURN_FALSE;
     }
@@ -1525,7 +1670,10 @@ static PyObject* PyMNNTensor_copyToHostTensor(PyMNNTensor *self, PyObject *args)
                         "PyMNNTensor_copyTo: source or destination tensor is null");
     }
 
-    bool r = self->tensor->copyToHostTensor(toTensor->tensor);
+    bool r = false;
+    Py_BEGIN_ALLOW_THREADS
+    r = self->tensor->copyToHostTensor(toTensor->tensor);
+    Py_END_ALLOW_THREADS
     if (!r) {
         Py_RETURN_FALSE;
     }
@@ -1641,6 +1789,15 @@ static PyObject* PyMNNCVImageProcess_setMatrix(PyMNNCVImageProcess *self, PyObje
     Py_RETURN_NONE;
 }
 
+static ErrorCode convertWithoutGIL(PyMNNCVImageProcess *self, const uint8_t *source, int iw, int ih, int stride,
+                                   Tensor *dest) {
+    ErrorCode ret = NO_ERROR;
+    Py_BEGIN_ALLOW_THREADS
+    ret = self->imageProcess->convert(source, iw, ih, stride, dest);
+    Py_END_ALLOW_THREADS
+    return ret;
+}
+
 static PyObject* PyMNNCVImageProcess_convert(PyMNNCVImageProcess *self, PyObject *args) {
     PyObject *source, *dest;
     int iw, ih, stride;
@@ -1656,9 +1813,9 @@ static PyObject* PyMNNCVImageProcess_convert(PyMNNCVImageProcess *self, PyObject
 
     if (PyCapsule_CheckExact(source)) {
         // Capsule Pointer
-        ErrorCode ret = self->imageProcess->convert((const uint8_t *)PyCapsule_GetPointer(source, NULL),
-                                                    iw, ih, stride,
-                                                    ((PyMNNTensor *)dest)->tensor);
+        ErrorCode ret = convertWithoutGIL(self, (const uint8_t *)PyCapsule_GetPointer(source, NULL),
+                                          iw, ih, stride,
+                                          ((PyMNNTensor *)dest)->tensor);
         return PyLong_FromLong(ret);
     } else if (PyTuple_Check(source)) {
         // Tuple Data
@@ -1669,9 +1826,9 @@ static PyObject* PyMNNCVImageProcess_convert(PyMNNCVImageProcess *self, PyObject
             ((uint8_t *)pData)[i] = (uint8_t)PyLong_AsLong(PyTuple_GetItem(source, i));
         }
 
-        ErrorCode ret = self->imageProcess->convert((const uint8_t *)pData,
-                                                    iw, ih, stride,
-                                                    ((PyMNNTensor *)dest)->tensor);
+        ErrorCode ret = convertWithoutGIL(self, (const uint8_t *)pData,
+                                          iw, ih, stride,
+                                          ((PyMNNTensor *)dest)->tensor);
 
         free(pData);
 
@@ -1700,9 +1857,9 @@ static PyObject* PyMNNCVImageProcess_convert(PyMNNCVImageProcess *self, PyObject
              PyErr_SetString(PyExc_Exception,"PyMNNTensor_init: ndarry failed to get buffer data");
              return NULL;
         }
-        ErrorCode ret = self->imageProcess->convert((const uint8_t *)tmpBuffer,
-                                                    iw, ih, stride,
-                                                    ((PyMNNTensor *)dest)->tensor);
+        ErrorCode ret = convertWithoutGIL(self, (const uint8_t *)tmpBuffer,
+                                          iw, ih, stride,
+                                          ((PyMNNTensor *)dest)->tensor);
         Py_XDECREF(data_cont);
         return PyLong_FromLong(ret); 
     }
@@ -2444,26 +2601,50 @@ MOD_INIT(_mnncengine)
                 auto shape = info->dim;
                 int64_t total_length = info->size;
                 auto readptr = [self](DType dtype, INTS shape, int64_t total_length) {
-                    void *dataPtr = (void *) (*self)->readMap<void>();
+                    void *dataPtr = nullptr;
+                    {
+                        // readMap may run the whole graph
+                        py::gil_scoped_release release;
+                        dataPtr = (void *) (*self)->readMap<void>();
+                    }
 #ifndef USE_PRIVATE
                     std::vector<npy_intp> npy_dims;
                     for(const auto dim: shape) {
                         npy_dims.push_back(dim);
                     }
+                    int npy_type;
                     switch(dtype) {
                        case DType_FLOAT:
-                           return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_FLOAT, dataPtr);
+                           npy_type = NPY_FLOAT;
+                           break;
                        case DType_DOUBLE:
-                           return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_DOUBLE, dataPtr);
+                           npy_type = NPY_DOUBLE;
+                           break;
                        case DType_INT32:
-                           return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_INT32, dataPtr);
+                           npy_type = NPY_INT32;
+                           break;
                        case DType_INT64:
-                           return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_INT64, dataPtr);
+                           npy_type = NPY_INT64;
+                           break;
                        case DType_UINT8:
-                           return PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), NPY_UINT8, dataPtr);
+                           npy_type = NPY_UINT8;
+                           break;
                        default:
                           throw std::runtime_error("does not support this dtype");
                     }
+                    if (nullptr == dataPtr) {
+                        throw std::runtime_error("call to readMap meet a error");
+                    }
+                    // The array is a view of Var memory, its base holds the Var
+                    auto array = PyArray_SimpleNewFromData(npy_dims.size(), npy_dims.data(), npy_type, dataPtr);
+                    if (nullptr == array) {
+                        throw std::runtime_error("create numpy array failed");
+                    }
+                    auto holder = PyCapsule_New(new VARP(*self), NULL, [](PyObject *capsule) {
+                        delete (VARP*)PyCapsule_GetPointer(capsule, NULL);
+                    });
+                    PyArray_SetBaseObject((PyArrayObject*)array, holder);
+                    return array;
 #endif
                     if (nullptr == dataPtr) {
                         throw std::runtime_error("call to readMap meet a error");
@@ -2535,7 +2716,10 @@ MOD_INIT(_mnncengine)
                         if (nullptr == data) {
                             throw std::runtime_error("call to writeMap meet a error");
                         }
-                        memcpy(data, tmpBuffer, total_length * itemsize);
+                        // Var from from_numpy shares memory with the array, only need to mark it dirty
+                        if (data != tmpBuffer) {
+                            memcpy(data, tmpBuffer, total_length * itemsize);
+                        }
                         Py_XDECREF(obj_cont);
                         return;
                     }
@@ -2743,6 +2927,46 @@ MOD_INIT(_mnncengine)
                    [](VARP source, bool deepCopy) {
 			return _Clone(source, deepCopy);
                    }, py::arg("source"), py::arg("deep_copy")=false);
+#ifndef USE_PRIVATE
+    expr_module.def("from_numpy",
+            [](py::object value, Dimensionformat data_format) {
+                PyObject *obj = value.ptr();
+                if (!PyArray_Check(obj)) {
+                    throw std::runtime_error("from_numpy: input is not a numpy array");
+                }
+                auto array = (PyArrayObject*)obj;
+                if (!PyArray_IS_C_CONTIGUOUS(array) || !PyArray_ISALIGNED(array)) {
+                    throw std::runtime_error("from_numpy: need an aligned and C-contiguous array, use const instead");
+                }
+                if (data_format == NC4HW4) {
+                    throw std::runtime_error("from_numpy: NC4HW4 is not supported");
+                }
+                Variable::Info info;
+                switch (PyArray_TYPE(array)) {
+                    case NPY_FLOAT:
+                        info.type = halide_type_of<float>();
+                        break;
+                    case NPY_INT32:
+                        info.type = halide_type_of<int32_t>();
+                        break;
+                    case NPY_UINT8:
+                        info.type = halide_type_of<uint8_t>();
+                        break;
+                    case NPY_INT8:
+                        info.type = halide_type_of<int8_t>();
+                        break;
+                    default:
+                        throw std::runtime_error("from_numpy: only float32 / int32 / uint8 / int8 are supported");
+                }
+                info.order = data_format;
+                for (int i = 0; i < PyArray_NDIM(array); ++i) {
+                    info.dim.push_back((int)PyArray_DIM(array, i));
+                }
+                auto expr = Expr::create(std::move(info), PyArray_DATA(array), VARP::INPUT, false);
+                holdNumpyArray(expr, obj);
+                return Variable::create(expr);
+            }, py::arg("array"), py::arg("data_format")=NCHW);
+#endif
     INTS default_pads = {0, 0};
     INTS default_axis = {};
     expr_module.def("const",
@@ -3053,6 +3277,11 @@ MOD_INIT(_mnncengine)
                 }
             )
             .def("step", [](ParameterOptimizer* self, Express::VARP loss) {
+                {
+                    // Only the compute of the forward drops the GIL, the grad graph is built with it
+                    py::gil_scoped_release release;
+                    loss->readMap<void>();
+                }
                 return self->step(loss);
             })
         ;
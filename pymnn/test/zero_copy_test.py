@@ -0,0 +1,164 @@
+"""Tests of the memory shared between MNN and numpy, and of the GIL release in compute.
+
+Run with the built _mnncengine on PYTHONPATH:
+    python zero_copy_test.py
+"""
+from __future__ import print_function
+import gc
+import sys
+import threading
+import time
+import unittest
+import numpy as np
+import MNN
+nn = MNN.nn
+F = MNN.expr
+
+
+class VarZeroCopyTest(unittest.TestCase):
+    def test_writes_visible_both_ways(self):
+        a = np.arange(6, dtype=np.float32).reshape(2, 3)
+        v = F.from_numpy(a, F.NCHW)
+        a[0, 0] = 100.0
+        r = v.read()
+        self.assertEqual(r[0, 0], 100.0)
+        r[1, 1] = -5.0
+        self.assertEqual(a[1, 1], -5.0)
+
+    def test_write_marks_dirty(self):
+        a = np.ones((2, 3), dtype=np.float32)
+        v = F.from_numpy(a, F.NCHW)
+        y = v * 2.0
+        np.testing.assert_array_equal(y.read(), np.full((2, 3), 2.0, np.float32))
+        a[...] = 3.0
+        v.write(a)
+        np.testing.assert_array_equal(y.read(), np.full((2, 3), 6.0, np.float32))
+
+    def test_array_outlives_var(self):
+        v = F.from_numpy(np.arange(4, dtype=np.float32), F.NCHW)
+        r = v.read()
+        del v
+        gc.collect()
+        np.testing.assert_array_equal(r, np.arange(4, dtype=np.float32))
+        r[0] = 10.0
+        self.assertEqual(r[0], 10.0)
+
+    def test_var_outlives_array(self):
+        a = np.arange(4, dtype=np.int32)
+        v = F.from_numpy(a, F.NCHW)
+        del a
+        gc.collect()
+        np.testing.assert_array_equal(v.read(), np.arange(4, dtype=np.int32))
+
+    def test_array_released_after_var(self):
+        a = np.zeros(4, dtype=np.float32)
+        count = sys.getrefcount(a)
+        v = F.from_numpy(a, F.NCHW)
+        self.assertGreater(sys.getrefcount(a), count)
+        del v
+        gc.collect()
+        # The expired arrays are released on the next wrap
+        F.from_numpy(np.zeros(1, dtype=np.float32), F.NCHW)
+        self.assertEqual(sys.getrefcount(a), count)
+
+    def test_reject_non_contiguous(self):
+        a = np.zeros((4, 4), dtype=np.float32)
+        with self.assertRaises(RuntimeError):
+            F.from_numpy(a[:, 1], F.NCHW)
+
+
+class TensorZeroCopyTest(unittest.TestCase):
+    def test_writes_visible_both_ways(self):
+        a = np.ones((2, 3), dtype=np.float32)
+        t = MNN.Tensor((2, 3), MNN.Halide_Type_Float, a, MNN.Tensor_DimensionType_Caffe)
+        a[0, 0] = 7.0
+        self.assertEqual(t.getData()[0, 0], 7.0)
+        m = np.asarray(t)
+        m[1, 2] = 9.0
+        self.assertEqual(a[1, 2], 9.0)
+
+    def test_view_outlives_tensor(self):
+        t = MNN.Tensor((2, 2), MNN.Halide_Type_Float, np.full((2, 2), 4.0, np.float32),
+                       MNN.Tensor_DimensionType_Caffe)
+        m = np.asarray(t)
+        d = t.getData()
+        del t
+        gc.collect()
+        np.testing.assert_array_equal(m, np.full((2, 2), 4.0, np.float32))
+        np.testing.assert_array_equal(d, np.full((2, 2), 4.0, np.float32))
+
+
+class Net(nn.Module):
+    def __init__(self):
+        super(Net, self).__init__()
+        self.fc1 = nn.linear(16, 32)
+        self.fc2 = nn.linear(32, 4)
+
+    def forward(self, x):
+        return self.fc2(F.relu(self.fc1(x)))
+
+
+class GILTest(unittest.TestCase):
+    def test_read_releases_gil(self):
+        x = F.const(np.random.rand(512, 512).astype(np.float32), [512, 512])
+        y = x
+        for _ in range(32):
+            y = F.matmul(y, x) * 0.001
+        done = []
+        ticks = [0]
+
+        def count():
+            while not done:
+                ticks[0] += 1
+        thread = threading.Thread(target=count)
+        thread.start()
+        # The speed of the other thread when this one doesn't hold the GIL
+        before = ticks[0]
+        start = time.time()
+        time.sleep(0.05)
+        rate = (ticks[0] - before) / (time.time() - start)
+        before = ticks[0]
+        start = time.time()
+        y.read()
+        cost = time.time() - start
+        after = ticks[0]
+        done.append(True)
+        thread.join()
+        # Holding the GIL, the other thread only runs in a switch interval around the read.
+        # Released, it shares the cores with the compute, so half of the speed on a single core.
+        self.assertGreater(after - before, 0.2 * rate * cost)
+
+    def test_module_forward_in_threads(self):
+        net = Net()
+        x = np.random.rand(8, 16).astype(np.float32)
+        expect = net.forward(F.const(x, [8, 16])).read().copy()
+        results = [None] * 4
+
+        def run(i):
+            for _ in range(10):
+                results[i] = net.forward(F.const(x, [8, 16])).read().copy()
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(len(results))]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        for r in results:
+            np.testing.assert_allclose(r, expect, rtol=1e-5)
+
+    def test_optimizer_step(self):
+        net = Net()
+        net.train(True)
+        opt = MNN.optim.SGD(net, 0.01, 0.9, 0.0)
+        x = F.const(np.random.rand(8, 16).astype(np.float32), [8, 16])
+        target = F.const(np.random.rand(8, 4).astype(np.float32), [8, 4])
+        losses = []
+        for _ in range(20):
+            diff = net.forward(x) - target
+            loss = F.reduce_mean(diff * diff, [])
+            losses.append(float(loss.read()))
+            opt.step(loss)
+        self.assertLess(losses[-1], losses[0])
+
+
+if __name__ == '__main__':
+    unittest.main()
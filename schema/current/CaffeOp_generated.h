@@ -2817,9 +2817,11 @@ struct BatchNormT : public flatbuffers::NativeTable {
   std::vector<float> Adata;
   std::vector<float> Bdata;
   float epsilon;
+  float momentum;
   BatchNormT()
       : channels(0),
-        epsilon(0.001f) {
+        epsilon(0.001f),
+        momentum(0.99f) {
   }
 };
 
@@ -2836,7 +2838,8 @@ struct BatchNorm FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_BIASDATA = 12,
     VT_ADATA = 14,
     VT_BDATA = 16,
-    VT_EPSILON = 18
+    VT_EPSILON = 18,
+    VT_MOMENTUM = 20
   };
   int32_t channels() const {
     return GetField<int32_t>(VT_CHANNELS, 0);
@@ -2862,6 +2865,9 @@ struct BatchNorm FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   float epsilon() const {
     return GetField<float>(VT_EPSILON, 0.001f);
   }
+  float momentum() const {
+    return GetField<float>(VT_MOMENTUM, 0.99f);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int32_t>(verifier, VT_CHANNELS) &&
@@ -2878,6 +2884,7 @@ struct BatchNorm FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyOffset(verifier, VT_BDATA) &&
            verifier.VerifyVector(Bdata()) &&
            VerifyField<float>(verifier, VT_EPSILON) &&
+           VerifyField<float>(verifier, VT_MOMENTUM) &&
            verifier.EndTable();
   }
   BatchNormT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -2912,6 +2919,9 @@ struct BatchNormBuilder {
   void add_epsilon(float epsilon) {
     fbb_.AddElement<float>(BatchNorm::VT_EPSILON, epsilon, 0.001f);
   }
+  void add_momentum(float momentum) {
+    fbb_.AddElement<float>(BatchNorm::VT_MOMENTUM, momentum, 0.99f);
+  }
   explicit BatchNormBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -2933,8 +2943,10 @@ inline flatbuffers::Offset<BatchNorm> CreateBatchNorm(
     flatbuffers::Offset<flatbuffers::Vector<float>> biasData = 0,
     flatbuffers::Offset<flatbuffers::Vector<float>> Adata = 0,
     flatbuffers::Offset<flatbuffers::Vector<float>> Bdata = 0,
-    float epsilon = 0.001f) {
+    float epsilon = 0.001f,
+    float momentum = 0.99f) {
   BatchNormBuilder builder_(_fbb);
+  builder_.add_momentum(momentum);
   builder_.add_epsilon(epsilon);
   builder_.add_Bdata(Bdata);
   builder_.add_Adata(Adata);
@@ -2955,7 +2967,8 @@ inline flatbuffers::Offset<BatchNorm> CreateBatchNormDirect(
     const std::vector<float> *biasData = nullptr,
     const std::vector<float> *Adata = nullptr,
     const std::vector<float> *Bdata = nullptr,
-    float epsilon = 0.001f) {
+    float epsilon = 0.001f,
+    float momentum = 0.99f) {
   auto slopeData__ = slopeData ? _fbb.CreateVector<float>(*slopeData) : 0;
   auto meanData__ = meanData ? _fbb.CreateVector<float>(*meanData) : 0;
   auto varData__ = varData ? _fbb.CreateVector<float>(*varData) : 0;
@@ -2971,7 +2984,8 @@ inline flatbuffers::Offset<BatchNorm> CreateBatchNormDirect(
       biasData__,
       Adata__,
       Bdata__,
-      epsilon);
+      epsilon,
+      momentum);
 }
 
 flatbuffers::Offset<BatchNorm> CreateBatchNorm(flatbuffers::FlatBufferBuilder &_fbb, const BatchNormT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
@@ -5193,6 +5207,7 @@ inline void BatchNorm::UnPackTo(BatchNormT *_o, const flatbuffers::resolver_func
   { auto _e = Adata(); if (_e) { _o->Adata.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->Adata[_i] = _e->Get(_i); } } };
   { auto _e = Bdata(); if (_e) { _o->Bdata.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->Bdata[_i] = _e->Get(_i); } } };
   { auto _e = epsilon(); _o->epsilon = _e; };
+  { auto _e = momentum(); _o->momentum = _e; };
 }
 
 inline flatbuffers::Offset<BatchNorm> BatchNorm::Pack(flatbuffers::FlatBufferBuilder &_fbb, const BatchNormT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
@@ -5211,6 +5226,7 @@ inline flatbuffers::Offset<BatchNorm> CreateBatchNorm(flatbuffers::FlatBufferBui
   auto _Adata = _o->Adata.size() ? _fbb.CreateVector(_o->Adata) : 0;
   auto _Bdata = _o->Bdata.size() ? _fbb.CreateVector(_o->Bdata) : 0;
   auto _epsilon = _o->epsilon;
+  auto _momentum = _o->momentum;
   return MNN::CreateBatchNorm(
       _fbb,
       _channels,
@@ -5220,7 +5236,8 @@ inline flatbuffers::Offset<BatchNorm> CreateBatchNorm(flatbuffers::FlatBufferBui
       _biasData,
       _Adata,
       _Bdata,
-      _epsilon);
+      _epsilon,
+      _momentum);
 }
 
 inline ScaleT *Scale::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
@@ -6330,6 +6347,7 @@ inline const flatbuffers::TypeTable *BatchNormTypeTable() {
     { flatbuffers::ET_FLOAT, 1, -1 },
     { flatbuffers::ET_FLOAT, 1, -1 },
     { flatbuffers::ET_FLOAT, 1, -1 },
+    { flatbuffers::ET_FLOAT, 0, -1 },
     { flatbuffers::ET_FLOAT, 0, -1 }
   };
   static const char * const names[] = {
@@ -6340,10 +6358,11 @@ inline const flatbuffers::TypeTable *BatchNormTypeTable() {
     "biasData",
     "Adata",
     "Bdata",
-    "epsilon"
+    "epsilon",
+    "momentum"
   };
   static const flatbuffers::TypeTable tt = {
-    flatbuffers::ST_TABLE, 8, type_codes, nullptr, nullptr, names
+    flatbuffers::ST_TABLE, 9, type_codes, nullptr, nullptr, names
   };
   return &tt;
 }
@@ -30,6 +30,12 @@ struct WhileParamT;
 struct IfParam;
 struct IfParamT;
 
+struct DropoutParam;
+struct DropoutParamT;
+
+struct GAEParam;
+struct GAEParamT;
+
 struct Op;
 struct OpT;
 
@@ -58,6 +64,10 @@ inline const flatbuffers::TypeTable *WhileParamTypeTable();
 
 inline const flatbuffers::TypeTable *IfParamTypeTable();
 
+inline const flatbuffers::TypeTable *DropoutParamTypeTable();
+
+inline const flatbuffers::TypeTable *GAEParamTypeTable();
+
 inline const flatbuffers::TypeTable *OpTypeTable();
 
 inline const flatbuffers::TypeTable *ViewTypeTable();
@@ -198,6 +208,7 @@ enum OpType {
   OpType_ArgMin = 130,
   OpType_LinSpace = 131,
   OpType_RandomUniform = 132,
+  OpType_EmbeddingBag = 133,
   OpType_Plugin = 256,
   OpType_Select = 257,
   OpType_ZerosLike = 258,
@@ -211,6 +222,17 @@ enum OpType {
   OpType_TrainableParam = 266,
   OpType_BatchNorm = 267,
   OpType_ZeroGrad = 268,
+  OpType_SoftmaxCrossEntropy = 269,
+  OpType_SoftmaxCrossEntropyGrad = 270,
+  OpType_LogSoftmax = 271,
+  OpType_DropoutGrad = 272,
+  OpType_BatchNormTrain = 273,
+  OpType_BatchNormTrainGrad = 274,
+  OpType_GRUSequence = 275,
+  OpType_GRUSequenceGrad = 276,
+  OpType_LSTMSequence = 277,
+  OpType_LSTMSequenceGrad = 278,
+  OpType_GAE = 279,
   OpType_Extra = 512,
   OpType_ConvInt8 = 513,
   OpType_Int8ToFloat = 514,
@@ -225,7 +247,7 @@ enum OpType {
   OpType_MAX = OpType_LayerNorm
 };
 
-inline const OpType (&EnumValuesOpType())[150] {
+inline const OpType (&EnumValuesOpType())[162] {
   static const OpType values[] = {
     OpType_AbsVal,
     OpType_QuantizedAdd,
@@ -354,6 +376,7 @@ inline const OpType (&EnumValuesOpType())[150] {
     OpType_ArgMin,
     OpType_LinSpace,
     OpType_RandomUniform,
+    OpType_EmbeddingBag,
     OpType_Plugin,
     OpType_Select,
     OpType_ZerosLike,
@@ -367,6 +390,17 @@ inline const OpType (&EnumValuesOpType())[150] {
     OpType_TrainableParam,
     OpType_BatchNorm,
     OpType_ZeroGrad,
+    OpType_SoftmaxCrossEntropy,
+    OpType_SoftmaxCrossEntropyGrad,
+    OpType_LogSoftmax,
+    OpType_DropoutGrad,
+    OpType_BatchNormTrain,
+    OpType_BatchNormTrainGrad,
+    OpType_GRUSequence,
+    OpType_GRUSequenceGrad,
+    OpType_LSTMSequence,
+    OpType_LSTMSequenceGrad,
+    OpType_GAE,
     OpType_Extra,
     OpType_ConvInt8,
     OpType_Int8ToFloat,
@@ -516,7 +550,7 @@ inline const char * const *EnumNamesOpType() {
     "ArgMin",
     "LinSpace",
     "RandomUniform",
-    "",
+    "EmbeddingBag",
     "",
     "",
     "",
@@ -652,17 +686,17 @@ inline const char * const *EnumNamesOpType() {
     "TrainableParam",
     "BatchNorm",
     "ZeroGrad",
-    "",
-    "",
-    "",
-    "",
-    "",
-    "",
-    "",
-    "",
-    "",
-    "",
-    "",
+    "SoftmaxCrossEntropy",
+    "SoftmaxCrossEntropyGrad",
+    "LogSoftmax",
+    "DropoutGrad",
+    "BatchNormTrain",
+    "BatchNormTrainGrad",
+    "GRUSequence",
+    "GRUSequenceGrad",
+    "LSTMSequence",
+    "LSTMSequenceGrad",
+    "GAE",
     "",
     "",
     "",
@@ -1088,11 +1122,13 @@ enum OpParameter {
   OpParameter_IfParam = 86,
   OpParameter_RandomUniform = 87,
   OpParameter_LayerNorm = 88,
+  OpParameter_DropoutParam = 89,
+  OpParameter_GAEParam = 90,
   OpParameter_MIN = OpParameter_NONE,
-  OpParameter_MAX = OpParameter_LayerNorm
+  OpParameter_MAX = OpParameter_GAEParam
 };
 
-inline const OpParameter (&EnumValuesOpParameter())[89] {
+inline const OpParameter (&EnumValuesOpParameter())[91] {
   static const OpParameter values[] = {
     OpParameter_NONE,
     OpParameter_QuantizedAdd,
@@ -1182,7 +1218,9 @@ inline const OpParameter (&EnumValuesOpParameter())[89] {
     OpParameter_WhileParam,
     OpParameter_IfParam,
     OpParameter_RandomUniform,
-    OpParameter_LayerNorm
+    OpParameter_LayerNorm,
+    OpParameter_DropoutParam,
+    OpParameter_GAEParam
   };
   return values;
 }
@@ -1278,13 +1316,15 @@ inline const char * const *EnumNamesOpParameter() {
     "IfParam",
     "RandomUniform",
     "LayerNorm",
+    "DropoutParam",
+    "GAEParam",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameOpParameter(OpParameter e) {
-  if (e < OpParameter_NONE || e > OpParameter_LayerNorm) return "";
+  if (e < OpParameter_NONE || e > OpParameter_GAEParam) return "";
   const size_t index = static_cast<int>(e);
   return EnumNamesOpParameter()[index];
 }
@@ -1645,6 +1685,14 @@ template<> struct OpParameterTraits<LayerNorm> {
   static const OpParameter enum_value = OpParameter_LayerNorm;
 };
 
+template<> struct OpParameterTraits<DropoutParam> {
+  static const OpParameter enum_value = OpParameter_DropoutParam;
+};
+
+template<> struct OpParameterTraits<GAEParam> {
+  static const OpParameter enum_value = OpParameter_GAEParam;
+};
+
 struct OpParameterUnion {
   OpParameter type;
   void *value;
@@ -2380,6 +2428,22 @@ struct OpParameterUnion {
     return type == OpParameter_LayerNorm ?
       reinterpret_cast<const LayerNormT *>(value) : nullptr;
   }
+  DropoutParamT *AsDropoutParam() {
+    return type == OpParameter_DropoutParam ?
+      reinterpret_cast<DropoutParamT *>(value) : nullptr;
+  }
+  const DropoutParamT *AsDropoutParam() const {
+    return type == OpParameter_DropoutParam ?
+      reinterpret_cast<const DropoutParamT *>(value) : nullptr;
+  }
+  GAEParamT *AsGAEParam() {
+    return type == OpParameter_GAEParam ?
+      reinterpret_cast<GAEParamT *>(value) : nullptr;
+  }
+  const GAEParamT *AsGAEParam() const {
+    return type == OpParameter_GAEParam ?
+      reinterpret_cast<const GAEParamT *>(value) : nullptr;
+  }
 };
 
 bool VerifyOpParameter(flatbuffers::Verifier &verifier, const void *obj, OpParameter type);
@@ -2960,6 +3024,156 @@ inline flatbuffers::Offset<IfParam> CreateIfParamDirect(
 
 flatbuffers::Offset<IfParam> CreateIfParam(flatbuffers::FlatBufferBuilder &_fbb, const IfParamT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct DropoutParamT : public flatbuffers::NativeTable {
+  typedef DropoutParam TableType;
+  float ratio;
+  int32_t seed;
+  int32_t seed2;
+  DropoutParamT()
+      : ratio(0.5f),
+        seed(0),
+        seed2(0) {
+  }
+};
+
+struct DropoutParam FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef DropoutParamT NativeTableType;
+  static const flatbuffers::TypeTable *MiniReflectTypeTable() {
+    return DropoutParamTypeTable();
+  }
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_RATIO = 4,
+    VT_SEED = 6,
+    VT_SEED2 = 8
+  };
+  float ratio() const {
+    return GetField<float>(VT_RATIO, 0.5f);
+  }
+  int32_t seed() const {
+    return GetField<int32_t>(VT_SEED, 0);
+  }
+  int32_t seed2() const {
+    return GetField<int32_t>(VT_SEED2, 0);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<float>(verifier, VT_RATIO) &&
+           VerifyField<int32_t>(verifier, VT_SEED) &&
+           VerifyField<int32_t>(verifier, VT_SEED2) &&
+           verifier.EndTable();
+  }
+  DropoutParamT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(DropoutParamT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<DropoutParam> Pack(flatbuffers::FlatBufferBuilder &_fbb, const DropoutParamT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct DropoutParamBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_ratio(float ratio) {
+    fbb_.AddElement<float>(DropoutParam::VT_RATIO, ratio, 0.5f);
+  }
+  void add_seed(int32_t seed) {
+    fbb_.AddElement<int32_t>(DropoutParam::VT_SEED, seed, 0);
+  }
+  void add_seed2(int32_t seed2) {
+    fbb_.AddElement<int32_t>(DropoutParam::VT_SEED2, seed2, 0);
+  }
+  explicit DropoutParamBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  DropoutParamBuilder &operator=(const DropoutParamBuilder &);
+  flatbuffers::Offset<DropoutParam> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<DropoutParam>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<DropoutParam> CreateDropoutParam(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    float ratio = 0.5f,
+    int32_t seed = 0,
+    int32_t seed2 = 0) {
+  DropoutParamBuilder builder_(_fbb);
+  builder_.add_seed2(seed2);
+  builder_.add_seed(seed);
+  builder_.add_ratio(ratio);
+  return builder_.Finish();
+}
+
+flatbuffers::Offset<DropoutParam> CreateDropoutParam(flatbuffers::FlatBufferBuilder &_fbb, const DropoutParamT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
+struct GAEParamT : public flatbuffers::NativeTable {
+  typedef GAEParam TableType;
+  float gamma;
+  float lambda;
+  GAEParamT()
+      : gamma(0.99f),
+        lambda(0.95f) {
+  }
+};
+
+struct GAEParam FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef GAEParamT NativeTableType;
+  static const flatbuffers::TypeTable *MiniReflectTypeTable() {
+    return GAEParamTypeTable();
+  }
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_GAMMA = 4,
+    VT_LAMBDA = 6
+  };
+  float gamma() const {
+    return GetField<float>(VT_GAMMA, 0.99f);
+  }
+  float lambda() const {
+    return GetField<float>(VT_LAMBDA, 0.95f);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<float>(verifier, VT_GAMMA) &&
+           VerifyField<float>(verifier, VT_LAMBDA) &&
+           verifier.EndTable();
+  }
+  GAEParamT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(GAEParamT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<GAEParam> Pack(flatbuffers::FlatBufferBuilder &_fbb, const GAEParamT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct GAEParamBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_gamma(float gamma) {
+    fbb_.AddElement<float>(GAEParam::VT_GAMMA, gamma, 0.99f);
+  }
+  void add_lambda(float lambda) {
+    fbb_.AddElement<float>(GAEParam::VT_LAMBDA, lambda, 0.95f);
+  }
+  explicit GAEParamBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  GAEParamBuilder &operator=(const GAEParamBuilder &);
+  flatbuffers::Offset<GAEParam> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<GAEParam>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<GAEParam> CreateGAEParam(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    float gamma = 0.99f,
+    float lambda = 0.95f) {
+  GAEParamBuilder builder_(_fbb);
+  builder_.add_lambda(lambda);
+  builder_.add_gamma(gamma);
+  return builder_.Finish();
+}
+
+flatbuffers::Offset<GAEParam> CreateGAEParam(flatbuffers::FlatBufferBuilder &_fbb, const GAEParamT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 struct OpT : public flatbuffers::NativeTable {
   typedef Op TableType;
   std::vector<int32_t> inputIndexes;
@@ -3262,6 +3476,12 @@ struct Op FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const LayerNorm *main_as_LayerNorm() const {
     return main_type() == OpParameter_LayerNorm ? static_cast<const LayerNorm *>(main()) : nullptr;
   }
+  const DropoutParam *main_as_DropoutParam() const {
+    return main_type() == OpParameter_DropoutParam ? static_cast<const DropoutParam *>(main()) : nullptr;
+  }
+  const GAEParam *main_as_GAEParam() const {
+    return main_type() == OpParameter_GAEParam ? static_cast<const GAEParam *>(main()) : nullptr;
+  }
   const flatbuffers::String *name() const {
     return GetPointer<const flatbuffers::String *>(VT_NAME);
   }
@@ -3646,6 +3866,14 @@ template<> inline const LayerNorm *Op::main_as<LayerNorm>() const {
   return main_as_LayerNorm();
 }
 
+template<> inline const DropoutParam *Op::main_as<DropoutParam>() const {
+  return main_as_DropoutParam();
+}
+
+template<> inline const GAEParam *Op::main_as<GAEParam>() const {
+  return main_as_GAEParam();
+}
+
 struct OpBuilder {
   flatbuffers::FlatBufferBuilder &fbb_;
   flatbuffers::uoffset_t start_;
@@ -4532,6 +4760,67 @@ inline flatbuffers::Offset<IfParam> CreateIfParam(flatbuffers::FlatBufferBuilder
       _aliases_outputs);
 }
 
+inline DropoutParamT *DropoutParam::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = new DropoutParamT();
+  UnPackTo(_o, _resolver);
+  return _o;
+}
+
+inline void DropoutParam::UnPackTo(DropoutParamT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = ratio(); _o->ratio = _e; };
+  { auto _e = seed(); _o->seed = _e; };
+  { auto _e = seed2(); _o->seed2 = _e; };
+}
+
+inline flatbuffers::Offset<DropoutParam> DropoutParam::Pack(flatbuffers::FlatBufferBuilder &_fbb, const DropoutParamT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateDropoutParam(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<DropoutParam> CreateDropoutParam(flatbuffers::FlatBufferBuilder &_fbb, const DropoutParamT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const DropoutParamT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _ratio = _o->ratio;
+  auto _seed = _o->seed;
+  auto _seed2 = _o->seed2;
+  return MNN::CreateDropoutParam(
+      _fbb,
+      _ratio,
+      _seed,
+      _seed2);
+}
+
+inline GAEParamT *GAEParam::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = new GAEParamT();
+  UnPackTo(_o, _resolver);
+  return _o;
+}
+
+inline void GAEParam::UnPackTo(GAEParamT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = gamma(); _o->gamma = _e; };
+  { auto _e = lambda(); _o->lambda = _e; };
+}
+
+inline flatbuffers::Offset<GAEParam> GAEParam::Pack(flatbuffers::FlatBufferBuilder &_fbb, const GAEParamT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateGAEParam(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<GAEParam> CreateGAEParam(flatbuffers::FlatBufferBuilder &_fbb, const GAEParamT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const GAEParamT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _gamma = _o->gamma;
+  auto _lambda = _o->lambda;
+  return MNN::CreateGAEParam(
+      _fbb,
+      _gamma,
+      _lambda);
+}
+
 inline OpT *Op::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
   auto _o = new OpT();
   UnPackTo(_o, _resolver);
@@ -5126,6 +5415,14 @@ inline bool VerifyOpParameter(flatbuffers::Verifier &verifier, const void *obj,
       auto ptr = reinterpret_cast<const LayerNorm *>(obj);
       return verifier.VerifyTable(ptr);
     }
+    case OpParameter_DropoutParam: {
+      auto ptr = reinterpret_cast<const DropoutParam *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
+    case OpParameter_GAEParam: {
+      auto ptr = reinterpret_cast<const GAEParam *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
     default: return false;
   }
 }
@@ -5496,6 +5793,14 @@ inline void *OpParameterUnion::UnPack(const void *obj, OpParameter type, const f
       auto ptr = reinterpret_cast<const LayerNorm *>(obj);
       return ptr->UnPack(resolver);
     }
+    case OpParameter_DropoutParam: {
+      auto ptr = reinterpret_cast<const DropoutParam *>(obj);
+      return ptr->UnPack(resolver);
+    }
+    case OpParameter_GAEParam: {
+      auto ptr = reinterpret_cast<const GAEParam *>(obj);
+      return ptr->UnPack(resolver);
+    }
     default: return nullptr;
   }
 }
@@ -5854,6 +6159,14 @@ inline flatbuffers::Offset<void> OpParameterUnion::Pack(flatbuffers::FlatBufferB
       auto ptr = reinterpret_cast<const LayerNormT *>(value);
       return CreateLayerNorm(_fbb, ptr, _rehasher).Union();
     }
+    case OpParameter_DropoutParam: {
+      auto ptr = reinterpret_cast<const DropoutParamT *>(value);
+      return CreateDropoutParam(_fbb, ptr, _rehasher).Union();
+    }
+    case OpParameter_GAEParam: {
+      auto ptr = reinterpret_cast<const GAEParamT *>(value);
+      return CreateGAEParam(_fbb, ptr, _rehasher).Union();
+    }
     default: return 0;
   }
 }
@@ -6212,6 +6525,14 @@ inline OpParameterUnion::OpParameterUnion(const OpParameterUnion &u) FLATBUFFERS
       value = new LayerNormT(*reinterpret_cast<LayerNormT *>(u.value));
       break;
     }
+    case OpParameter_DropoutParam: {
+      value = new DropoutParamT(*reinterpret_cast<DropoutParamT *>(u.value));
+      break;
+    }
+    case OpParameter_GAEParam: {
+      value = new GAEParamT(*reinterpret_cast<GAEParamT *>(u.value));
+      break;
+    }
     default:
       break;
   }
@@ -6659,6 +6980,16 @@ inline void OpParameterUnion::Reset() {
       delete ptr;
       break;
     }
+    case OpParameter_DropoutParam: {
+      auto ptr = reinterpret_cast<DropoutParamT *>(value);
+      delete ptr;
+      break;
+    }
+    case OpParameter_GAEParam: {
+      auto ptr = reinterpret_cast<GAEParamT *>(value);
+      delete ptr;
+      break;
+    }
     default: break;
   }
   value = nullptr;
@@ -6816,12 +7147,24 @@ inline const flatbuffers::TypeTable *OpTypeTypeTable() {
     { flatbuffers::ET_INT, 0, 0 },
     { flatbuffers::ET_INT, 0, 0 },
     { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
+    { flatbuffers::ET_INT, 0, 0 },
     { flatbuffers::ET_INT, 0, 0 }
   };
   static const flatbuffers::TypeFunction type_refs[] = {
     OpTypeTypeTable
   };
-  static const int64_t values[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 128, 129, 130, 131, 132, 256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268, 512, 513, 514, 515, 516, 517, 518, 600, 601, 603 };
+  static const int64_t values[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 128, 129, 130, 131, 132, 133, 256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268, 269, 270, 271, 272, 273, 274, 275, 276, 277, 278, 279, 512, 513, 514, 515, 516, 517, 518, 600, 601, 603 };
   static const char * const names[] = {
     "AbsVal",
     "QuantizedAdd",
@@ -6950,6 +7293,7 @@ inline const flatbuffers::TypeTable *OpTypeTypeTable() {
     "ArgMin",
     "LinSpace",
     "RandomUniform",
+    "EmbeddingBag",
     "Plugin",
     "Select",
     "ZerosLike",
@@ -6963,6 +7307,17 @@ inline const flatbuffers::TypeTable *OpTypeTypeTable() {
     "TrainableParam",
     "BatchNorm",
     "ZeroGrad",
+    "SoftmaxCrossEntropy",
+    "SoftmaxCrossEntropyGrad",
+    "LogSoftmax",
+    "DropoutGrad",
+    "BatchNormTrain",
+    "BatchNormTrainGrad",
+    "GRUSequence",
+    "GRUSequenceGrad",
+    "LSTMSequence",
+    "LSTMSequenceGrad",
+    "GAE",
     "Extra",
     "ConvInt8",
     "Int8ToFloat",
@@ -6975,7 +7330,7 @@ inline const flatbuffers::TypeTable *OpTypeTypeTable() {
     "LayerNorm"
   };
   static const flatbuffers::TypeTable tt = {
-    flatbuffers::ST_ENUM, 150, type_codes, type_refs, values, names
+    flatbuffers::ST_ENUM, 162, type_codes, type_refs, values, names
   };
   return &tt;
 }
@@ -7070,7 +7425,9 @@ inline const flatbuffers::TypeTable *OpParameterTypeTable() {
     { flatbuffers::ET_SEQUENCE, 0, 84 },
     { flatbuffers::ET_SEQUENCE, 0, 85 },
     { flatbuffers::ET_SEQUENCE, 0, 86 },
-    { flatbuffers::ET_SEQUENCE, 0, 87 }
+    { flatbuffers::ET_SEQUENCE, 0, 87 },
+    { flatbuffers::ET_SEQUENCE, 0, 88 },
+    { flatbuffers::ET_SEQUENCE, 0, 89 }
   };
   static const flatbuffers::TypeFunction type_refs[] = {
     QuantizedAddTypeTable,
@@ -7160,7 +7517,9 @@ inline const flatbuffers::TypeTable *OpParameterTypeTable() {
     WhileParamTypeTable,
     IfParamTypeTable,
     RandomUniformTypeTable,
-    LayerNormTypeTable
+    LayerNormTypeTable,
+    DropoutParamTypeTable,
+    GAEParamTypeTable
   };
   static const char * const names[] = {
     "NONE",
@@ -7251,10 +7610,12 @@ inline const flatbuffers::TypeTable *OpParameterTypeTable() {
     "WhileParam",
     "IfParam",
     "RandomUniform",
-    "LayerNorm"
+    "LayerNorm",
+    "DropoutParam",
+    "GAEParam"
   };
   static const flatbuffers::TypeTable tt = {
-    flatbuffers::ST_UNION, 89, type_codes, type_refs, nullptr, names
+    flatbuffers::ST_UNION, 91, type_codes, type_refs, nullptr, names
   };
   return &tt;
 }
@@ -7402,6 +7763,38 @@ inline const flatbuffers::TypeTable *IfParamTypeTable() {
   return &tt;
 }
 
+inline const flatbuffers::TypeTable *DropoutParamTypeTable() {
+  static const flatbuffers::TypeCode type_codes[] = {
+    { flatbuffers::ET_FLOAT, 0, -1 },
+    { flatbuffers::ET_INT, 0, -1 },
+    { flatbuffers::ET_INT, 0, -1 }
+  };
+  static const char * const names[] = {
+    "ratio",
+    "seed",
+    "seed2"
+  };
+  static const flatbuffers::TypeTable tt = {
+    flatbuffers::ST_TABLE, 3, type_codes, nullptr, nullptr, names
+  };
+  return &tt;
+}
+
+inline const flatbuffers::TypeTable *GAEParamTypeTable() {
+  static const flatbuffers::TypeCode type_codes[] = {
+    { flatbuffers::ET_FLOAT, 0, -1 },
+    { flatbuffers::ET_FLOAT, 0, -1 }
+  };
+  static const char * const names[] = {
+    "gamma",
+    "lambda"
+  };
+  static const flatbuffers::TypeTable tt = {
+    flatbuffers::ST_TABLE, 2, type_codes, nullptr, nullptr, names
+  };
+  return &tt;
+}
+
 inline const flatbuffers::TypeTable *OpTypeTable() {
   static const flatbuffers::TypeCode type_codes[] = {
     { flatbuffers::ET_INT, 1, -1 },
@@ -8,111 +8,220 @@
 
 #include "backend/cpu/CPUBatchMatMul.hpp"
 #include "backend/cpu/CPUBackend.hpp"
-#include "math/Matrix.hpp"
-#include "core/TensorUtils.hpp"
-#include "core/BufferAllocator.hpp"
+#include "backend/cpu/compute/CommonOptFunction.h"
 #include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+#include "math/Vec.hpp"
+using Vec4 = MNN::Math::Vec<float, 4>;
 
 namespace MNN {
 
 CPUBatchMatMul::CPUBatchMatMul(Backend* backend, bool adjX, bool adjY) : Execution(backend) {
-    auto threadNumber = static_cast<CPUBackend*>(backend)->threadNumber();
-    for (int i = 0; i < threadNumber; ++i) {
-        Unit unit;
-        unit.mMatrixA.reset(new Tensor);
-        unit.mMatrixB.reset(new Tensor);
-        unit.mMatrixC.reset(new Tensor);
-        unit.mMatMul.reset(new CPUMatMul(backend, adjX, adjY, false));
-        unit.mMatrixB->buffer().dimensions = 2;
-        unit.mMatrixA->buffer().dimensions = 2;
-        unit.mMatrixC->buffer().dimensions = 2;
-        unit.mTempInputs = {unit.mMatrixA.get(), unit.mMatrixB.get()};
-        unit.mTempOutputs = {unit.mMatrixC.get()};
-        mUnits.emplace_back(std::move(unit));
+    mTransposeA = adjX;
+    mTransposeB = adjY;
+}
+
+// Index of the slice in input for each batch of output, the batch dimensions of size 1 are broadcast
+static std::vector<int> _computeBroadcastIndex(const Tensor* input, const Tensor* output) {
+    const int batchDims = output->dimensions() - 2;
+    const int offset    = output->dimensions() - input->dimensions();
+    int batch           = 1;
+    for (int i = 0; i < batchDims; ++i) {
+        batch *= output->length(i);
     }
+    std::vector<int> indexes(batch);
+    for (int b = 0; b < batch; ++b) {
+        int remain = b;
+        int index  = 0;
+        int stride = 1;
+        for (int i = batchDims - 1; i >= 0; --i) {
+            int cord = remain % output->length(i);
+            remain /= output->length(i);
+            if (i >= offset) {
+                auto length = input->length(i - offset);
+                if (length > 1) {
+                    index += cord * stride;
+                }
+                stride *= length;
+            }
+        }
+        indexes[b] = index;
+    }
+    return indexes;
+}
+
+static int _gcd(int a, int b) {
+    return 0 == b ? a : _gcd(b, a % b);
 }
 
 ErrorCode CPUBatchMatMul::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
-    auto input0          = inputs[0];
-    auto input1          = inputs[1];
-    auto output          = outputs[0];
+    auto input0 = inputs[0];
+    auto input1 = inputs[1];
+    auto output = outputs[0];
     // Fill output by zero if one of inputs is empty.
     if (input0->elementSize() == 0 || input1->elementSize() == 0) {
         return NO_ERROR;
     }
-    auto dimensions = input0->dimensions();
-    int threadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
-    int batch = 1;
-    for (int i = 0; i < dimensions - 2; ++i) {
-        batch *= input0->length(i);
+    const int i0Dim = input0->dimensions();
+    const int i1Dim = input1->dimensions();
+    mE = output->length(output->dimensions() - 2);
+    mH = output->length(output->dimensions() - 1);
+    mL = mTransposeA ? input0->length(i0Dim - 2) : input0->length(i0Dim - 1);
+    mAIndex = _computeBroadcastIndex(input0, output);
+    mBIndex = _computeBroadcastIndex(input1, output);
+    mBatch  = (int)mAIndex.size();
+    mBBatch = input1->elementSize() / (input1->length(i1Dim - 1) * input1->length(i1Dim - 2));
+
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    mThreadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    // h block must align to both hP (packed B) and 4 (C4 output of the kernel)
+    const int hUnit  = hP / _gcd(hP, 4) * 4;
+    const int hUnits = UP_DIV(mH, hUnit);
+    mETiles          = UP_DIV(mE, eP);
+    mHBlocks         = 1;
+    if (mBatch * mETiles < mThreadNumber) {
+        mHBlocks = ALIMIN(hUnits, UP_DIV(mThreadNumber, mBatch * mETiles));
     }
-    mBatch = batch;
-    if (threadNumber > batch) {
-        threadNumber = batch;
+    mHBlockSize = UP_DIV(hUnits, mHBlocks) * hUnit;
+    mHBlocks    = UP_DIV(mH, mHBlockSize);
+    mThreadNumber = ALIMIN(mThreadNumber, mBatch * mETiles * mHBlocks);
+
+    // Per thread: A in C4 [lC4, eP, 4], packed A tile [l, eP], C in C4 [hC4, eP, 4], kernel cache
+    const int lC4 = UP_DIV(mL, 4);
+    const int hC4 = UP_DIV(mHBlockSize, 4);
+    mTempSize     = lC4 * 4 * eP + mL * eP + hC4 * eP * 4;
+    if (hP % 4 != 0) {
+        mTempSize += eP * MNNGetC4DivNumber(hP) * 4 + hC4 * eP * 4;
     }
-    auto memoryPool = static_cast<CPUBackend*>(backend())->getBufferAllocator();
-    memoryPool->barrierBegin();
-    std::shared_ptr<void> __a(nullptr, [memoryPool](void *) { memoryPool->barrierEnd(); });
-    for (int i = 0; i < threadNumber; ++i) {
-        memoryPool->beginGroup();
-        std::shared_ptr<void> __b(nullptr, [memoryPool](void *) { memoryPool->endGroup(); });
-        auto& unit = mUnits[i];
-        unit.mMatrixA->setLength(0, input0->length(input0->dimensions()-2));
-        unit.mMatrixA->setLength(1, input0->length(input0->dimensions()-1));
-
-        unit.mMatrixB->setLength(0, input1->length(input1->dimensions()-2));
-        unit.mMatrixB->setLength(1, input1->length(input1->dimensions()-1));
-
-        unit.mMatrixC->setLength(0, output->length(output->dimensions()-2));
-        unit.mMatrixC->setLength(1, output->length(output->dimensions()-1));
-        
-        TensorUtils::setLinearLayout(unit.mMatrixA.get());
-        TensorUtils::setLinearLayout(unit.mMatrixB.get());
-        TensorUtils::setLinearLayout(unit.mMatrixC.get());
-
-        auto res = backend()->onAcquireBuffer(unit.mMatrixA.get(), Backend::DYNAMIC);
-        res = res && backend()->onAcquireBuffer(unit.mMatrixB.get(), Backend::DYNAMIC);
-        res = res && backend()->onAcquireBuffer(unit.mMatrixC.get(), Backend::DYNAMIC);
-
-        if (!res) {
-            return OUT_OF_MEMORY;
-        }
-        auto code = unit.mMatMul->onResize(unit.mTempInputs, unit.mTempOutputs);
-        backend()->onReleaseBuffer(unit.mMatrixA.get(), Backend::DYNAMIC);
-        backend()->onReleaseBuffer(unit.mMatrixB.get(), Backend::DYNAMIC);
-        backend()->onReleaseBuffer(unit.mMatrixC.get(), Backend::DYNAMIC);
+    mPackedBSize = (size_t)UP_DIV(mH, hP) * mL * hP;
+    mPackedB.reset(Tensor::createDevice<float>({mBBatch, (int)mPackedBSize}));
+    mTemp.reset(Tensor::createDevice<float>({mThreadNumber, (int)mTempSize}));
+    auto res = backend()->onAcquireBuffer(mPackedB.get(), Backend::DYNAMIC);
+    res      = res && backend()->onAcquireBuffer(mTemp.get(), Backend::DYNAMIC);
+    if (!res) {
+        return OUT_OF_MEMORY;
     }
+    backend()->onReleaseBuffer(mPackedB.get(), Backend::DYNAMIC);
+    backend()->onReleaseBuffer(mTemp.get(), Backend::DYNAMIC);
     return NO_ERROR;
 }
 
+void CPUBatchMatMul::_computeUnit(const float* A, const float* packedB, float* C, int eStart, int eCount, int hStart,
+                                  int hCount, float* temp) const {
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    const int e   = mE;
+    const int l   = mL;
+    const int h   = mH;
+    const int lC4 = UP_DIV(l, 4);
+    auto aC4      = temp;
+    auto aTile    = aC4 + lC4 * 4 * eP;
+    auto cC4      = aTile + l * eP;
+    float* cache  = nullptr;
+    if (hP % 4 != 0) {
+        cache = cC4 + UP_DIV(mHBlockSize, 4) * eP * 4;
+    }
+    // Rows of A -> [lC4, eCount, 4], read through the stride of the slice directly
+    if (l % 4 != 0) {
+        ::memset(aC4, 0, lC4 * 4 * eCount * sizeof(float));
+    }
+    if (mTransposeA) {
+        // A: [l, e]
+        for (int z = 0; z < l; ++z) {
+            auto src = A + z * e + eStart;
+            auto dst = aC4 + (z / 4) * eCount * 4 + (z % 4);
+            for (int x = 0; x < eCount; ++x) {
+                dst[4 * x] = src[x];
+            }
+        }
+    } else {
+        // A: [e, l]
+        const int lDiv4 = l / 4;
+        for (int x = 0; x < eCount; ++x) {
+            auto src = A + (eStart + x) * l;
+            auto dst = aC4 + 4 * x;
+            for (int z = 0; z < lDiv4; ++z) {
+                Vec4::save(dst + z * eCount * 4, Vec4::load(src + 4 * z));
+            }
+            for (int z = lDiv4 * 4; z < l; ++z) {
+                dst[lDiv4 * eCount * 4 + z % 4] = src[z];
+            }
+        }
+    }
+    MNNPackC4ForMatMul_A(aTile, aC4, eCount, l, eCount);
+
+    size_t parameters[6];
+    parameters[0] = eCount * sizeof(float);
+    parameters[1] = l;
+    parameters[2] = hCount;
+    parameters[3] = eP * 4 * sizeof(float);
+    parameters[4] = 0;
+    parameters[5] = 0;
+    auto bStart   = packedB + (hStart / hP) * l * hP;
+    if (eCount == eP) {
+        MNNPackedMatMul(cC4, aTile, bStart, parameters, cache, nullptr, nullptr);
+    } else {
+        MNNPackedMatMulRemain(cC4, aTile, bStart, eCount, parameters, cache, nullptr, nullptr);
+    }
+
+    // [hC4, eCount, 4] -> rows of C
+    const int hDiv4 = hCount / 4;
+    for (int x = 0; x < eCount; ++x) {
+        auto dst = C + (eStart + x) * h + hStart;
+        auto src = cC4 + 4 * x;
+        for (int y = 0; y < hDiv4; ++y) {
+            Vec4::save(dst + 4 * y, Vec4::load(src + y * eP * 4));
+        }
+        for (int y = hDiv4 * 4; y < hCount; ++y) {
+            dst[y] = src[(y / 4) * eP * 4 + y % 4];
+        }
+    }
+}
+
 ErrorCode CPUBatchMatMul::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
-    auto input0          = inputs[0];
-    auto input1          = inputs[1];
-    auto output          = outputs[0];
+    auto input0 = inputs[0];
+    auto input1 = inputs[1];
+    auto output = outputs[0];
     // Fill output by zero if one of inputs is empty.
     if (input0->elementSize() == 0 || input1->elementSize() == 0) {
         ::memset(output->host<float>(), 0, output->size());
         return NO_ERROR;
     }
-    const int dimensions = input0->dimensions();
-    MNN_ASSERT(dimensions >= 3);
-    const int input0Stride = input0->length(dimensions - 1) * input0->length(dimensions - 2);
-    const int input1Stride = input1->length(dimensions - 1) * input1->length(dimensions - 2);
-    const int outputStride = output->length(dimensions - 1) * output->length(dimensions - 2);
-    const auto input0Ptr   = input0->host<float>();
-    const auto input1Ptr   = input1->host<float>();
-    float* const outputPtr = output->host<float>();
-    int threadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
-    if (threadNumber > mBatch) {
-        threadNumber = mBatch;
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    const int aStride    = mE * mL;
+    const int bStride    = mL * mH;
+    const int cStride    = mE * mH;
+    const auto input0Ptr = input0->host<float>();
+    const auto input1Ptr = input1->host<float>();
+    auto outputPtr       = output->host<float>();
+    auto packedBPtr      = mPackedB->host<float>();
+    auto tempPtr         = mTemp->host<float>();
+    const int threadNumber = mThreadNumber;
+
+    // Pack each distinct B once, a broadcast B is shared by all batches
+    const int packThread = ALIMIN(threadNumber, mBBatch);
+    MNN_CONCURRENCY_BEGIN(tId, packThread) {
+        for (int i = (int)tId; i < mBBatch; i += packThread) {
+            MNNPackForMatMul_B(packedBPtr + i * mPackedBSize, input1Ptr + i * bStride, mH, mL, mTransposeB);
+        }
     }
+    MNN_CONCURRENCY_END();
+
+    const int unitNumber = mBatch * mETiles * mHBlocks;
     MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
-        auto& unit = mUnits[tId];
-        for (int i = (int)tId; i < mBatch; i+=threadNumber) {
-            ::memcpy(unit.mMatrixA->host<float>(), input0Ptr + i * input0Stride, input0Stride * sizeof(float));
-            ::memcpy(unit.mMatrixB->host<float>(), input1Ptr + i * input1Stride, input1Stride * sizeof(float));
-            unit.mMatMul->onExecute(unit.mTempInputs, unit.mTempOutputs);
-            ::memcpy(outputPtr + i * outputStride, unit.mMatrixC->host<float>(), outputStride * sizeof(float));
+        auto temp = tempPtr + tId * mTempSize;
+        for (int u = (int)tId; u < unitNumber; u += threadNumber) {
+            int hBlock = u % mHBlocks;
+            int eTile  = (u / mHBlocks) % mETiles;
+            int b      = u / mHBlocks / mETiles;
+            int eStart = eTile * eP;
+            int hStart = hBlock * mHBlockSize;
+            _computeUnit(input0Ptr + mAIndex[b] * aStride, packedBPtr + mBIndex[b] * mPackedBSize,
+                         outputPtr + b * cStride, eStart, ALIMIN(eP, mE - eStart), hStart,
+                         ALIMIN(mHBlockSize, mH - hStart), temp);
         }
     }
     MNN_CONCURRENCY_END();
@@ -9,10 +9,17 @@
 #ifndef CPUBatchMatMul_hpp
 #define CPUBatchMatMul_hpp
 
-#include "backend/cpu/CPUMatMul.hpp"
+#include <vector>
+#include "core/Execution.hpp"
 
 namespace MNN {
 
+/**
+ Batched GEMM over [..., e, l] x [..., l, h], the batch dimensions can be broadcast.
+ A and C are read / written through the batch offset directly, B of each distinct batch is packed once, so a broadcast
+ B is packed only once for all batches. The work is split into units of (batch, e tile, h block) so that both
+ many-small-matrix and few-large-matrix cases use all threads.
+ */
 class CPUBatchMatMul : public Execution {
 public:
     CPUBatchMatMul(Backend *backend, bool adjX, bool adjY);
@@ -21,16 +28,26 @@ public:
     virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
 
 private:
-    int mBatch;
-    struct Unit {
-        std::shared_ptr<Execution> mMatMul;
-        std::vector<Tensor*> mTempInputs;
-        std::vector<Tensor*> mTempOutputs;
-        std::unique_ptr<Tensor> mMatrixA;
-        std::unique_ptr<Tensor> mMatrixB;
-        std::unique_ptr<Tensor> mMatrixC;
-    };
-    std::vector<Unit> mUnits;
+    void _computeUnit(const float* A, const float* packedB, float* C, int eStart, int eCount, int hStart, int hCount,
+                      float* temp) const;
+    bool mTransposeA;
+    bool mTransposeB;
+    int mE = 0;
+    int mL = 0;
+    int mH = 0;
+    int mBatch = 0;
+    int mThreadNumber = 1;
+    int mETiles  = 0;
+    int mHBlocks = 0;
+    int mHBlockSize = 0;
+    // Slice index of A / B for each output batch
+    std::vector<int> mAIndex;
+    std::vector<int> mBIndex;
+    int mBBatch = 0;
+    size_t mPackedBSize = 0;
+    size_t mTempSize    = 0;
+    std::shared_ptr<Tensor> mPackedB;
+    std::shared_ptr<Tensor> mTemp;
 };
 
 } // namespace MNN
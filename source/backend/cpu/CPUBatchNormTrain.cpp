@@ -0,0 +1,281 @@
+//
+//  CPUBatchNormTrain.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPUBatchNormTrain.hpp"
+#include <math.h>
+#include "backend/cpu/CPUBackend.hpp"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+#include "math/Vec.hpp"
+
+namespace MNN {
+using Vec4 = Math::Vec<float, 4>;
+
+struct C4Shape {
+    int batch;
+    int channel;
+    int area;
+    int cBlocks;
+    int batchStride;
+};
+
+static C4Shape _getShape(const Tensor* x) {
+    C4Shape shape;
+    shape.batch   = x->length(0);
+    shape.channel = x->length(1);
+    shape.area    = 1;
+    for (int i = 2; i < x->dimensions(); ++i) {
+        shape.area *= x->length(i);
+    }
+    shape.cBlocks     = UP_DIV(shape.channel, 4);
+    shape.batchStride = shape.cBlocks * shape.area * 4;
+    return shape;
+}
+
+static void _acquire(Backend* backend, Tensor& tensor, int size) {
+    tensor.buffer().dimensions    = 1;
+    tensor.buffer().dim[0].extent = size;
+    tensor.buffer().type          = halide_type_of<float>();
+    TensorUtils::getDescribe(&tensor)->dimensionFormat = MNN_DATA_FORMAT_NCHW;
+    backend->onAcquireBuffer(&tensor, Backend::DYNAMIC);
+}
+
+CPUBatchNormTrain::CPUBatchNormTrain(Backend* b, float eps, float momentum)
+    : Execution(b), mEps(eps), mMomentum(momentum), mPartial(1), mCoefficient(1) {
+    // Do nothing
+}
+
+ErrorCode CPUBatchNormTrain::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto x = inputs[0];
+    if (TensorUtils::getDescribe(x)->dimensionFormat != MNN_DATA_FORMAT_NC4HW4 || x->dimensions() < 2) {
+        return NOT_SUPPORT;
+    }
+    auto shape = _getShape(x);
+    _acquire(backend(), mPartial, shape.cBlocks * shape.batch * 8);
+    _acquire(backend(), mCoefficient, shape.cBlocks * 8);
+    backend()->onReleaseBuffer(&mPartial, Backend::DYNAMIC);
+    backend()->onReleaseBuffer(&mCoefficient, Backend::DYNAMIC);
+    return NO_ERROR;
+}
+
+ErrorCode CPUBatchNormTrain::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto shape       = _getShape(inputs[0]);
+    auto src         = inputs[0]->host<float>();
+    auto dst         = outputs[0]->host<float>();
+    auto scale       = inputs[1]->host<float>();
+    auto bias        = inputs[2]->host<float>();
+    auto runningMean = inputs[3]->host<float>();
+    auto runningVar  = inputs[4]->host<float>();
+    auto partial     = mPartial.host<float>();
+    auto coefficient = mCoefficient.host<float>();
+    const int area   = shape.area;
+    const int work   = shape.cBlocks * shape.batch;
+    int threadNum    = ((CPUBackend*)backend())->threadNumber();
+
+    // Mean and m2 of each (channel block, batch), the second read hits cache
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        for (int w = (int)tId; w < work; w += threadNum) {
+            int cz   = w / shape.batch;
+            int b    = w % shape.batch;
+            auto x   = src + b * shape.batchStride + cz * area * 4;
+            Vec4 sum(0.0f);
+            for (int i = 0; i < area; ++i) {
+                sum = sum + Vec4::load(x + 4 * i);
+            }
+            auto mean = sum * (1.0f / area);
+            Vec4 m2(0.0f);
+            for (int i = 0; i < area; ++i) {
+                auto diff = Vec4::load(x + 4 * i) - mean;
+                m2        = m2 + diff * diff;
+            }
+            Vec4::save(partial + 8 * w, mean);
+            Vec4::save(partial + 8 * w + 4, m2);
+        }
+    }
+    MNN_CONCURRENCY_END();
+
+    // Merge partial results by Chan's parallel algorithm
+    const float count = (float)shape.batch * area;
+    for (int cz = 0; cz < shape.cBlocks; ++cz) {
+        auto part = partial + 8 * cz * shape.batch;
+        auto mean = Vec4::load(part);
+        auto m2   = Vec4::load(part + 4);
+        float n   = (float)area;
+        for (int b = 1; b < shape.batch; ++b) {
+            auto delta   = Vec4::load(part + 8 * b) - mean;
+            float total  = n + area;
+            mean         = mean + delta * ((float)area / total);
+            m2           = m2 + Vec4::load(part + 8 * b + 4) + delta * delta * (n * area / total);
+            n            = total;
+        }
+        for (int k = 0; k < 4; ++k) {
+            int c        = cz * 4 + k;
+            auto alpha   = coefficient + 8 * cz;
+            auto beta    = alpha + 4;
+            if (c >= shape.channel) {
+                alpha[k] = 0.0f;
+                beta[k]  = 0.0f;
+                continue;
+            }
+            float var    = m2[k] / count;
+            float invStd = 1.0f / sqrtf(var + mEps);
+            alpha[k]     = scale[c] * invStd;
+            beta[k]      = bias[c] - mean[k] * alpha[k];
+            outputs[1]->host<float>()[c] = mean[k];
+            outputs[2]->host<float>()[c] = invStd;
+            outputs[3]->host<float>()[c] = mMomentum * runningMean[c] + (1.0f - mMomentum) * mean[k];
+            outputs[4]->host<float>()[c] = mMomentum * runningVar[c] + (1.0f - mMomentum) * var;
+        }
+    }
+
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        for (int w = (int)tId; w < work; w += threadNum) {
+            int cz     = w / shape.batch;
+            int b      = w % shape.batch;
+            auto x     = src + b * shape.batchStride + cz * area * 4;
+            auto y     = dst + b * shape.batchStride + cz * area * 4;
+            auto alpha = Vec4::load(coefficient + 8 * cz);
+            auto beta  = Vec4::load(coefficient + 8 * cz + 4);
+            for (int i = 0; i < area; ++i) {
+                Vec4::save(y + 4 * i, Vec4::load(x + 4 * i) * alpha + beta);
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+CPUBatchNormTrainGrad::CPUBatchNormTrainGrad(Backend* b) : Execution(b), mPartial(1), mCoefficient(1) {
+    // Do nothing
+}
+
+ErrorCode CPUBatchNormTrainGrad::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto x = inputs[0];
+    if (TensorUtils::getDescribe(x)->dimensionFormat != MNN_DATA_FORMAT_NC4HW4 ||
+        TensorUtils::getDescribe(inputs[1])->dimensionFormat != MNN_DATA_FORMAT_NC4HW4 || x->dimensions() < 2) {
+        return NOT_SUPPORT;
+    }
+    auto shape = _getShape(x);
+    _acquire(backend(), mPartial, shape.cBlocks * shape.batch * 8);
+    _acquire(backend(), mCoefficient, shape.cBlocks * 12);
+    backend()->onReleaseBuffer(&mPartial, Backend::DYNAMIC);
+    backend()->onReleaseBuffer(&mCoefficient, Backend::DYNAMIC);
+    return NO_ERROR;
+}
+
+ErrorCode CPUBatchNormTrainGrad::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto shape       = _getShape(inputs[0]);
+    auto src         = inputs[0]->host<float>();
+    auto srcGrad     = inputs[1]->host<float>();
+    auto scale       = inputs[2]->host<float>();
+    auto saveMean    = inputs[3]->host<float>();
+    auto saveInvStd  = inputs[4]->host<float>();
+    auto dst         = outputs[0]->host<float>();
+    auto scaleGrad   = outputs[1]->host<float>();
+    auto biasGrad    = outputs[2]->host<float>();
+    auto partial     = mPartial.host<float>();
+    auto coefficient = mCoefficient.host<float>();
+    const int area   = shape.area;
+    const int work   = shape.cBlocks * shape.batch;
+    int threadNum    = ((CPUBackend*)backend())->threadNumber();
+
+    auto loadChannel = [&shape](const float* data, int cz) {
+        float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int k = 0; k < 4 && cz * 4 + k < shape.channel; ++k) {
+            value[k] = data[cz * 4 + k];
+        }
+        return Vec4::load(value);
+    };
+
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        for (int w = (int)tId; w < work; w += threadNum) {
+            int cz    = w / shape.batch;
+            int b     = w % shape.batch;
+            auto x    = src + b * shape.batchStride + cz * area * 4;
+            auto dy   = srcGrad + b * shape.batchStride + cz * area * 4;
+            auto mean = loadChannel(saveMean, cz);
+            Vec4 sumDy(0.0f);
+            Vec4 sumDyX(0.0f);
+            for (int i = 0; i < area; ++i) {
+                auto g = Vec4::load(dy + 4 * i);
+                sumDy  = sumDy + g;
+                sumDyX = sumDyX + g * (Vec4::load(x + 4 * i) - mean);
+            }
+            Vec4::save(partial + 8 * w, sumDy);
+            Vec4::save(partial + 8 * w + 4, sumDyX);
+        }
+    }
+    MNN_CONCURRENCY_END();
+
+    // dx = scale * invStd / M * (M * dy - dbias - xhat * dscale)
+    const float count = (float)shape.batch * area;
+    for (int cz = 0; cz < shape.cBlocks; ++cz) {
+        auto part = partial + 8 * cz * shape.batch;
+        Vec4 sumDy(0.0f);
+        Vec4 sumDyX(0.0f);
+        for (int b = 0; b < shape.batch; ++b) {
+            sumDy  = sumDy + Vec4::load(part + 8 * b);
+            sumDyX = sumDyX + Vec4::load(part + 8 * b + 4);
+        }
+        auto a = coefficient + 12 * cz;
+        for (int k = 0; k < 4; ++k) {
+            int c = cz * 4 + k;
+            if (c >= shape.channel) {
+                a[k] = a[4 + k] = a[8 + k] = 0.0f;
+                continue;
+            }
+            float invStd = saveInvStd[c];
+            float dBias  = sumDy[k];
+            float dScale = sumDyX[k] * invStd;
+            float factor = scale[c] * invStd;
+            scaleGrad[c] = dScale;
+            biasGrad[c]  = dBias;
+            a[k]         = factor;
+            a[4 + k]     = -factor * invStd * dScale / count;
+            a[8 + k]     = -factor * dBias / count - a[4 + k] * saveMean[c];
+        }
+    }
+
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        for (int w = (int)tId; w < work; w += threadNum) {
+            int cz  = w / shape.batch;
+            int b   = w % shape.batch;
+            auto x  = src + b * shape.batchStride + cz * area * 4;
+            auto dy = srcGrad + b * shape.batchStride + cz * area * 4;
+            auto dx = dst + b * shape.batchStride + cz * area * 4;
+            auto a  = Vec4::load(coefficient + 12 * cz);
+            auto bx = Vec4::load(coefficient + 12 * cz + 4);
+            auto c  = Vec4::load(coefficient + 12 * cz + 8);
+            for (int i = 0; i < area; ++i) {
+                Vec4::save(dx + 4 * i, Vec4::load(dy + 4 * i) * a + Vec4::load(x + 4 * i) * bx + c);
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+class CPUBatchNormTrainCreator : public CPUBackend::Creator {
+public:
+    virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
+                                const MNN::Op* op, Backend* backend) const override {
+        if (op->type() == OpType_BatchNormTrainGrad) {
+            return new CPUBatchNormTrainGrad(backend);
+        }
+        auto param = op->main_as_BatchNorm();
+        if (nullptr == param) {
+            return nullptr;
+        }
+        return new CPUBatchNormTrain(backend, param->epsilon(), param->momentum());
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPUBatchNormTrainCreator, OpType_BatchNormTrain);
+REGISTER_CPU_OP_CREATOR(CPUBatchNormTrainCreator, OpType_BatchNormTrainGrad);
+} // namespace MNN
@@ -0,0 +1,47 @@
+//
+//  CPUBatchNormTrain.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUBatchNormTrain_hpp
+#define CPUBatchNormTrain_hpp
+
+#include "core/Execution.hpp"
+
+namespace MNN {
+// Batch statistics, normalization and running statistics on NC4HW4 input in one execution
+class CPUBatchNormTrain : public Execution {
+public:
+    CPUBatchNormTrain(Backend *b, float eps, float momentum);
+    virtual ~CPUBatchNormTrain() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    float mEps;
+    float mMomentum;
+    // Partial (mean, m2) of each (channel block, batch)
+    Tensor mPartial;
+    // Fused (alpha, beta) of each channel block, y = x * alpha + beta
+    Tensor mCoefficient;
+};
+
+class CPUBatchNormTrainGrad : public Execution {
+public:
+    CPUBatchNormTrainGrad(Backend *b);
+    virtual ~CPUBatchNormTrainGrad() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    // Partial (sum(dy), sum(dy * (x - mean))) of each (channel block, batch)
+    Tensor mPartial;
+    // Fused (a, b, c) of each channel block, dx = dy * a + x * b + c
+    Tensor mCoefficient;
+};
+} // namespace MNN
+
+#endif /* CPUBatchNormTrain_hpp */
@@ -0,0 +1,338 @@
+//
+//  CPUConv2DBackPropFilter.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/31.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPUConv2DBackPropFilter.hpp"
+#include <string.h>
+#include "backend/cpu/CPUBackend.hpp"
+#include "backend/cpu/compute/CommonOptFunction.h"
+#include "core/Concurrency.h"
+#include "core/ConvolutionCommon.hpp"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+#include "math/Vec.hpp"
+
+// Pixels of output diff reduced by one GEMM
+#define BACKPROP_FILTER_CHUNK 256
+
+namespace MNN {
+using Vec4 = Math::Vec<float, 4>;
+
+static int _gcd(int a, int b) {
+    return 0 == b ? a : _gcd(b, a % b);
+}
+
+CPUConv2DBackPropFilter::CPUConv2DBackPropFilter(const Convolution2DCommon *common, Backend *b)
+    : Execution(b), mCommon(common) {
+    // Do nothing
+}
+
+ErrorCode CPUConv2DBackPropFilter::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto input      = inputs[0];
+    auto outputDiff = inputs[1];
+    auto pads       = ConvolutionCommon::convolutionPad(input, outputDiff, mCommon);
+    mPadX           = pads.first;
+    mPadY           = pads.second;
+    const int oc    = outputDiff->channel();
+    const int plane = outputDiff->width() * outputDiff->height();
+    mRows           = UP_DIV(input->channel(), 4) * mCommon->kernelY() * mCommon->kernelX() * 4;
+
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    mThreadNumber = static_cast<CPUBackend *>(backend())->threadNumber();
+    // h block must align to both hP (packed diff) and 4 (C4 output of the kernel)
+    const int hUnit  = hP / _gcd(hP, 4) * 4;
+    const int hUnits = UP_DIV(oc, hUnit);
+    mRowTiles        = UP_DIV(mRows, eP);
+    mHBlocks         = 1;
+    if (mRowTiles < mThreadNumber) {
+        mHBlocks = ALIMIN(hUnits, UP_DIV(mThreadNumber, mRowTiles));
+    }
+    mHBlockSize = UP_DIV(hUnits, mHBlocks) * hUnit;
+    mHBlocks    = UP_DIV(oc, mHBlockSize);
+    mChunk      = ALIMIN(plane, BACKPROP_FILTER_CHUNK);
+
+    // Per thread: accumulated C [hC4, eP, 4], im2col tile in C4 [lC4, eP, 4], packed A tile [l, eP], C [hC4, eP, 4],
+    // kernel cache. The output diff is transposed to [oc, chunk] before packing, which reuses the same memory
+    const int lC4 = UP_DIV(mChunk, 4);
+    const int hC4 = UP_DIV(mHBlockSize, 4);
+    mTempSize     = hC4 * eP * 4 + lC4 * 4 * eP + mChunk * eP + hC4 * eP * 4;
+    if (hP % 4 != 0) {
+        mTempSize += eP * MNNGetC4DivNumber(hP) * 4 + hC4 * eP * 4;
+    }
+    mTempSize = ALIMAX(mTempSize, (size_t)oc * mChunk);
+    mPackedDiff.reset(Tensor::createDevice<float>({outputDiff->batch() * plane, UP_DIV(oc, hP) * hP}));
+    mTemp.reset(Tensor::createDevice<float>({mThreadNumber, (int)mTempSize}));
+    auto res = backend()->onAcquireBuffer(mPackedDiff.get(), Backend::DYNAMIC);
+    res      = res && backend()->onAcquireBuffer(mTemp.get(), Backend::DYNAMIC);
+    if (!res) {
+        return OUT_OF_MEMORY;
+    }
+    backend()->onReleaseBuffer(mPackedDiff.get(), Backend::DYNAMIC);
+    backend()->onReleaseBuffer(mTemp.get(), Backend::DYNAMIC);
+    return NO_ERROR;
+}
+
+ErrorCode CPUConv2DBackPropFilter::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto input      = inputs[0];
+    auto outputDiff = inputs[1];
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    const int batch = outputDiff->batch();
+    const int ic    = input->channel();
+    const int ih    = input->height();
+    const int iw    = input->width();
+    const int oc    = outputDiff->channel();
+    const int oh    = outputDiff->height();
+    const int ow    = outputDiff->width();
+    const int kh    = mCommon->kernelY();
+    const int kw    = mCommon->kernelX();
+    const int sh    = mCommon->strideY();
+    const int sw    = mCommon->strideX();
+    const int dh    = mCommon->dilateY();
+    const int dw    = mCommon->dilateX();
+    const int padY  = mPadY;
+    const int padX  = mPadX;
+    const int plane = oh * ow;
+    const int chunk = mChunk;
+    const int rows  = mRows;
+    const int hPad  = UP_DIV(oc, hP) * hP;
+    const int hC4Max          = UP_DIV(mHBlockSize, 4);
+    const int inputBatchStride = UP_DIV(ic, 4) * ih * iw * 4;
+    const int diffBatchStride  = UP_DIV(oc, 4) * plane * 4;
+    const int chunkPerBatch    = UP_DIV(plane, chunk);
+    const int chunkNumber      = batch * chunkPerBatch;
+    auto inputPtr      = input->host<float>();
+    auto diffPtr       = outputDiff->host<float>();
+    auto packedDiffPtr = mPackedDiff->host<float>();
+    auto kernelDiffPtr = outputs[0]->host<float>();
+    auto tempPtr       = mTemp->host<float>();
+    const size_t tempSize = mTempSize;
+
+    // Pack each chunk of output diff as B: [chunk pixels, oc]
+    int threadNumber = ALIMIN(mThreadNumber, chunkNumber);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        auto transposed = tempPtr + tId * tempSize;
+        for (int k = (int)tId; k < chunkNumber; k += threadNumber) {
+            const int n      = k / chunkPerBatch;
+            const int pStart = (k % chunkPerBatch) * chunk;
+            const int pCount = ALIMIN(chunk, plane - pStart);
+            for (int o = 0; o < oc; ++o) {
+                auto src = diffPtr + n * diffBatchStride + (o / 4) * plane * 4 + pStart * 4 + (o % 4);
+                auto dst = transposed + o * pCount;
+                for (int p = 0; p < pCount; ++p) {
+                    dst[p] = src[4 * p];
+                }
+            }
+            MNNPackForMatMul_B(packedDiffPtr + (size_t)hPad * (n * plane + pStart), transposed, oc, pCount, true);
+        }
+    }
+    MNN_CONCURRENCY_END();
+
+    const int hBlocks    = mHBlocks;
+    const int hBlockSize = mHBlockSize;
+    const int unitNumber = mRowTiles * hBlocks;
+    threadNumber         = ALIMIN(mThreadNumber, unitNumber);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        auto acc     = tempPtr + tId * tempSize;
+        auto aC4     = acc + hC4Max * eP * 4;
+        auto aTile   = aC4 + UP_DIV(chunk, 4) * 4 * eP;
+        auto cC4     = aTile + chunk * eP;
+        float* cache = nullptr;
+        if (hP % 4 != 0) {
+            cache = cC4 + hC4Max * eP * 4;
+        }
+        for (int u = (int)tId; u < unitNumber; u += threadNumber) {
+            const int rStart = (u / hBlocks) * eP;
+            const int rCount = ALIMIN(eP, rows - rStart);
+            const int hStart = (u % hBlocks) * hBlockSize;
+            const int hCount = ALIMIN(hBlockSize, oc - hStart);
+            const int hC4    = UP_DIV(hCount, 4);
+            ::memset(acc, 0, hC4 * eP * 4 * sizeof(float));
+            for (int k = 0; k < chunkNumber; ++k) {
+                const int n      = k / chunkPerBatch;
+                const int pStart = (k % chunkPerBatch) * chunk;
+                const int pCount = ALIMIN(chunk, plane - pStart);
+                // Gather the im2col rows of this chunk into [pCount / 4, rCount, 4]
+                for (int e = 0; e < rCount; ++e) {
+                    const int r    = rStart + e;
+                    const int lane = r % 4;
+                    const int kx   = (r / 4) % kw;
+                    const int ky   = (r / 4 / kw) % kh;
+                    const int z    = r / 4 / kw / kh;
+                    auto dst       = aC4 + e * 4;
+                    if (z * 4 + lane >= ic) {
+                        for (int p = 0; p < pCount; ++p) {
+                            dst[(p / 4) * rCount * 4 + p % 4] = 0.0f;
+                        }
+                        continue;
+                    }
+                    auto src       = inputPtr + n * inputBatchStride + z * ih * iw * 4 + lane;
+                    const int offY = ky * dh - padY;
+                    const int offX = kx * dw - padX;
+                    int p          = 0;
+                    while (p < pCount) {
+                        const int oy    = (pStart + p) / ow;
+                        const int oxS   = (pStart + p) % ow;
+                        const int count = ALIMIN(ow - oxS, pCount - p);
+                        const int iy    = oy * sh + offY;
+                        if (iy < 0 || iy >= ih) {
+                            for (int i = 0; i < count; ++i, ++p) {
+                                dst[(p / 4) * rCount * 4 + p % 4] = 0.0f;
+                            }
+                            continue;
+                        }
+                        auto srcY = src + iy * iw * 4;
+                        for (int i = 0; i < count; ++i, ++p) {
+                            const int ix = (oxS + i) * sw + offX;
+                            dst[(p / 4) * rCount * 4 + p % 4] = (ix >= 0 && ix < iw) ? srcY[ix * 4] : 0.0f;
+                        }
+                    }
+                }
+                MNNPackC4ForMatMul_A(aTile, aC4, rCount, pCount, rCount);
+                size_t parameters[6];
+                parameters[0] = rCount * sizeof(float);
+                parameters[1] = pCount;
+                parameters[2] = hCount;
+                parameters[3] = eP * 4 * sizeof(float);
+                parameters[4] = 0;
+                parameters[5] = 0;
+                auto bStart   = packedDiffPtr + (size_t)hPad * (n * plane + pStart) + (hStart / hP) * pCount * hP;
+                if (rCount == eP) {
+                    MNNPackedMatMul(cC4, aTile, bStart, parameters, cache, nullptr, nullptr);
+                } else {
+                    MNNPackedMatMulRemain(cC4, aTile, bStart, rCount, parameters, cache, nullptr, nullptr);
+                }
+                for (int y = 0; y < hC4; ++y) {
+                    auto dst = acc + y * eP * 4;
+                    auto src = cC4 + y * eP * 4;
+                    for (int e = 0; e < rCount; ++e) {
+                        Vec4::save(dst + 4 * e, Vec4::load(dst + 4 * e) + Vec4::load(src + 4 * e));
+                    }
+                }
+            }
+            // [hC4, rCount, 4] -> kernelDiff [oc, ic, kh, kw]
+            for (int e = 0; e < rCount; ++e) {
+                const int r  = rStart + e;
+                const int c  = (r / 4 / kw / kh) * 4 + r % 4;
+                const int kx = (r / 4) % kw;
+                const int ky = (r / 4 / kw) % kh;
+                if (c >= ic) {
+                    continue;
+                }
+                auto dst = kernelDiffPtr + (c * kh + ky) * kw + kx;
+                for (int y = 0; y < hCount; ++y) {
+                    dst[(hStart + y) * ic * kh * kw] = acc[(y / 4) * eP * 4 + e * 4 + y % 4];
+                }
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+CPUConv2DBackPropFilterDepthwise::CPUConv2DBackPropFilterDepthwise(const Convolution2DCommon *common, Backend *b)
+    : Execution(b), mCommon(common) {
+    // Do nothing
+}
+
+ErrorCode CPUConv2DBackPropFilterDepthwise::onResize(const std::vector<Tensor *> &inputs,
+                                                     const std::vector<Tensor *> &outputs) {
+    auto pads = ConvolutionCommon::convolutionPad(inputs[0], inputs[1], mCommon);
+    mPadX     = pads.first;
+    mPadY     = pads.second;
+    return NO_ERROR;
+}
+
+// Range [start, end) of output positions whose input position o * stride + offset is inside [0, size)
+static void _validRange(int offset, int stride, int size, int outputSize, int &start, int &end) {
+    start = offset < 0 ? UP_DIV(-offset, stride) : 0;
+    end   = offset >= size ? 0 : ALIMIN(outputSize, (size - 1 - offset) / stride + 1);
+}
+
+ErrorCode CPUConv2DBackPropFilterDepthwise::onExecute(const std::vector<Tensor *> &inputs,
+                                                      const std::vector<Tensor *> &outputs) {
+    auto input      = inputs[0];
+    auto outputDiff = inputs[1];
+    const int batch = outputDiff->batch();
+    const int c     = input->channel();
+    const int cC4   = UP_DIV(c, 4);
+    const int ih    = input->height();
+    const int iw    = input->width();
+    const int oh    = outputDiff->height();
+    const int ow    = outputDiff->width();
+    const int kh    = mCommon->kernelY();
+    const int kw    = mCommon->kernelX();
+    const int sh    = mCommon->strideY();
+    const int sw    = mCommon->strideX();
+    const int dh    = mCommon->dilateY();
+    const int dw    = mCommon->dilateX();
+    const int padY  = mPadY;
+    const int padX  = mPadX;
+    auto inputPtr      = input->host<float>();
+    auto diffPtr       = outputDiff->host<float>();
+    auto kernelDiffPtr = outputs[0]->host<float>();
+    const int unitNumber   = cC4 * kh * kw;
+    const int threadNumber = ALIMIN(static_cast<CPUBackend *>(backend())->threadNumber(), unitNumber);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        for (int u = (int)tId; u < unitNumber; u += threadNumber) {
+            const int kx   = u % kw;
+            const int ky   = (u / kw) % kh;
+            const int z    = u / kw / kh;
+            const int offY = ky * dh - padY;
+            const int offX = kx * dw - padX;
+            int oyStart, oyEnd, oxStart, oxEnd;
+            _validRange(offY, sh, ih, oh, oyStart, oyEnd);
+            _validRange(offX, sw, iw, ow, oxStart, oxEnd);
+            Vec4 sum(0.0f);
+            for (int n = 0; n < batch; ++n) {
+                auto src  = inputPtr + ((n * cC4 + z) * ih * iw) * 4;
+                auto diff = diffPtr + ((n * cC4 + z) * oh * ow) * 4;
+                for (int oy = oyStart; oy < oyEnd; ++oy) {
+                    auto srcY  = src + ((oy * sh + offY) * iw + offX) * 4;
+                    auto diffY = diff + oy * ow * 4;
+                    for (int ox = oxStart; ox < oxEnd; ++ox) {
+                        sum = sum + Vec4::load(diffY + ox * 4) * Vec4::load(srcY + ox * sw * 4);
+                    }
+                }
+            }
+            float result[4];
+            Vec4::save(result, sum);
+            for (int i = 0; i < 4 && z * 4 + i < c; ++i) {
+                kernelDiffPtr[((z * 4 + i) * kh + ky) * kw + kx] = result[i];
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+class CPUConv2DBackPropFilterCreator : public CPUBackend::Creator {
+public:
+    virtual Execution *onCreate(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs,
+                                const MNN::Op *op, Backend *backend) const override {
+        if (inputs.size() != 2) {
+            return nullptr;
+        }
+        auto common = op->main_as_Convolution2D()->common();
+        for (auto t : inputs) {
+            if (TensorUtils::getDescribe(t)->dimensionFormat != MNN_DATA_FORMAT_NC4HW4) {
+                return nullptr;
+            }
+        }
+        if (inputs[0]->channel() == inputs[1]->channel() && inputs[1]->channel() == common->group()) {
+            return new CPUConv2DBackPropFilterDepthwise(common, backend);
+        }
+        if (1 != common->group()) {
+            return nullptr;
+        }
+        return new CPUConv2DBackPropFilter(common, backend);
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPUConv2DBackPropFilterCreator, OpType_Conv2DBackPropFilter);
+} // namespace MNN
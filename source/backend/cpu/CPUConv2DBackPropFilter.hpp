@@ -0,0 +1,66 @@
+//
+//  CPUConv2DBackPropFilter.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/31.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUConv2DBackPropFilter_hpp
+#define CPUConv2DBackPropFilter_hpp
+
+#include "core/Execution.hpp"
+#include "MNN_generated.h"
+
+namespace MNN {
+
+/**
+ Filter grad of a dense convolution, inputs are input [n, ic, ih, iw] and output diff [n, oc, oh, ow] in NC4HW4, output
+ is the kernel diff [oc, ic, kh, kw] in NCHW. It is computed as an implicit GEMM:
+ kernelDiff^T [ic * kh * kw, oc] = im2col(input) [ic * kh * kw, n * oh * ow] x outputDiff^T [n * oh * ow, oc]
+ The output diff is packed once, tiles of im2col rows are gathered from the input on the fly for a chunk of pixels and
+ accumulated, so the whole im2col matrix is never built.
+ */
+class CPUConv2DBackPropFilter : public Execution {
+public:
+    CPUConv2DBackPropFilter(const Convolution2DCommon *common, Backend *b);
+    virtual ~CPUConv2DBackPropFilter() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    const Convolution2DCommon *mCommon;
+    int mPadX = 0;
+    int mPadY = 0;
+    // Rows of im2col: (ic / 4, ky, kx, ic % 4)
+    int mRows = 0;
+    int mRowTiles = 0;
+    int mHBlocks = 0;
+    int mHBlockSize = 0;
+    int mChunk = 0;
+    int mThreadNumber = 1;
+    size_t mTempSize = 0;
+    std::shared_ptr<Tensor> mPackedDiff;
+    std::shared_ptr<Tensor> mTemp;
+};
+
+/**
+ Filter grad of a depthwise convolution, kernelDiff [c, 1, kh, kw] is the sum of outputDiff * input over the batch and
+ the valid output positions of each kernel position, four channels at a time.
+ */
+class CPUConv2DBackPropFilterDepthwise : public Execution {
+public:
+    CPUConv2DBackPropFilterDepthwise(const Convolution2DCommon *common, Backend *b);
+    virtual ~CPUConv2DBackPropFilterDepthwise() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    const Convolution2DCommon *mCommon;
+    int mPadX = 0;
+    int mPadY = 0;
+};
+
+} // namespace MNN
+
+#endif /* CPUConv2DBackPropFilter_hpp */
@@ -228,12 +228,193 @@ ErrorCode CPUDeconvolutionOrigin::onExecute(const std::vector<Tensor*>& inputs,
     }
     return NO_ERROR;
 }
+static int _gcd(int a, int b) {
+    return 0 == b ? a : _gcd(b, a % b);
+}
+
+CPUDeconvolutionMultiInput::CPUDeconvolutionMultiInput(const Tensor* input, const Op* convOp, Backend* b)
+    : CPUDeconvolutionBasic(input, convOp, b) {
+    // Do nothing
+}
+
+ErrorCode CPUDeconvolutionMultiInput::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    CPUDeconvolutionBasic::onResize(inputs, outputs);
+    auto input  = inputs[0];
+    auto output = outputs[0];
+    auto ic     = input->channel();
+    auto ocC4   = UP_DIV(output->channel(), 4);
+    auto batch  = input->batch();
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    mThreadNumber = ((CPUBackend*)backend())->threadNumber();
+    mGroups       = ALIMIN(ocC4, UP_DIV(mThreadNumber, batch));
+    mGroupSize    = UP_DIV(ocC4, mGroups);
+    mGroups       = UP_DIV(ocC4, mGroupSize);
+
+    // Columns of a group: [groupSize, kh, kw, 4]
+    const int hGroup = mGroupSize * mCommon->kernelY() * mCommon->kernelX() * 4;
+    mPackedGroupSize = (size_t)UP_DIV(hGroup, hP) * hP * ic;
+    // Per thread: packed A tile [ic, eP], columns in C4 [hGroup / 4, eP, 4], kernel cache.
+    // The weight of a group is reordered to [ic, hGroup] before packing, which reuses the same memory
+    mTempSize = (size_t)ic * eP + hGroup * eP;
+    if (hP % 4 != 0) {
+        mTempSize += eP * MNNGetC4DivNumber(hP) * 4 + hGroup * eP;
+    }
+    mTempSize = ALIMAX(mTempSize, (size_t)ic * hGroup);
+    mBias.reset(Tensor::createDevice<float>({ocC4 * 4}));
+    mPackedWeight.reset(Tensor::createDevice<float>({mGroups, (int)mPackedGroupSize}));
+    mTemp.reset(Tensor::createDevice<float>({mThreadNumber, (int)mTempSize}));
+    auto res = backend()->onAcquireBuffer(mBias.get(), Backend::DYNAMIC);
+    res      = res && backend()->onAcquireBuffer(mPackedWeight.get(), Backend::DYNAMIC);
+    res      = res && backend()->onAcquireBuffer(mTemp.get(), Backend::DYNAMIC);
+    if (!res) {
+        return OUT_OF_MEMORY;
+    }
+    backend()->onReleaseBuffer(mBias.get(), Backend::DYNAMIC);
+    backend()->onReleaseBuffer(mPackedWeight.get(), Backend::DYNAMIC);
+    backend()->onReleaseBuffer(mTemp.get(), Backend::DYNAMIC);
+    return NO_ERROR;
+}
+
+ErrorCode CPUDeconvolutionMultiInput::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto input  = inputs[0];
+    auto output = outputs[0];
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    const int batch      = input->batch();
+    const int ic         = input->channel();
+    const int icC4       = UP_DIV(ic, 4);
+    const int ih         = input->height();
+    const int iw         = input->width();
+    const int oc         = output->channel();
+    const int ocC4       = UP_DIV(oc, 4);
+    const int oh         = output->height();
+    const int ow         = output->width();
+    const int kh         = mCommon->kernelY();
+    const int kw         = mCommon->kernelX();
+    const int strideY    = mCommon->strideY();
+    const int strideX    = mCommon->strideX();
+    const int dilateY    = mCommon->dilateY();
+    const int dilateX    = mCommon->dilateX();
+    const int padY       = mPadY;
+    const int padX       = mPadX;
+    const int plane      = ih * iw;
+    const int dstPlane   = oh * ow;
+    const int groups     = mGroups;
+    const int groupSize  = mGroupSize;
+    const int hGroup     = groupSize * kh * kw * 4;
+    const size_t tempSize         = mTempSize;
+    const size_t packedGroupSize  = mPackedGroupSize;
+    auto biasPtr   = mBias->host<float>();
+    auto weightPtr = inputs[1]->host<float>();
+    auto packedPtr = mPackedWeight->host<float>();
+    auto tempPtr   = mTemp->host<float>();
+    auto inputPtr  = input->host<float>();
+    auto outputPtr = output->host<float>();
+    ::memset(biasPtr, 0, mBias->size());
+    if (inputs.size() > 2) {
+        ::memcpy(biasPtr, inputs[2]->host<float>(), oc * sizeof(float));
+    }
+
+    // Weight [ic, oc, kh, kw] -> [ic, groupSize, kh, kw, 4] for each group -> packed B
+    int threadNumber = ALIMIN(mThreadNumber, groups);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        auto reorder = tempPtr + tId * tempSize;
+        for (int g = (int)tId; g < groups; g += threadNumber) {
+            const int zStart = g * groupSize;
+            const int zCount = ALIMIN(groupSize, ocC4 - zStart);
+            const int hCount = zCount * kh * kw * 4;
+            ::memset(reorder, 0, ic * hCount * sizeof(float));
+            for (int i = 0; i < ic; ++i) {
+                auto dst = reorder + i * hCount;
+                for (int o = zStart * 4; o < ALIMIN(oc, (zStart + zCount) * 4); ++o) {
+                    auto src  = weightPtr + (i * oc + o) * kh * kw;
+                    auto dstO = dst + (o / 4 - zStart) * kh * kw * 4 + o % 4;
+                    for (int k = 0; k < kh * kw; ++k) {
+                        dstO[4 * k] = src[k];
+                    }
+                }
+            }
+            MNNPackForMatMul_B(packedPtr + g * packedGroupSize, reorder, hCount, ic, false);
+        }
+    }
+    MNN_CONCURRENCY_END();
+
+    const int unitNumber = batch * groups;
+    threadNumber         = ALIMIN(mThreadNumber, unitNumber);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        auto aTile   = tempPtr + tId * tempSize;
+        auto cC4     = aTile + ic * eP;
+        float* cache = nullptr;
+        if (hP % 4 != 0) {
+            cache = cC4 + hGroup * eP;
+        }
+        for (int u = (int)tId; u < unitNumber; u += threadNumber) {
+            const int n      = u / groups;
+            const int g      = u % groups;
+            const int zStart = g * groupSize;
+            const int zCount = ALIMIN(groupSize, ocC4 - zStart);
+            auto src         = inputPtr + n * icC4 * plane * 4;
+            auto dst         = outputPtr + (n * ocC4 + zStart) * dstPlane * 4;
+            ::memset(dst, 0, zCount * dstPlane * 4 * sizeof(float));
+            size_t parameters[6];
+            parameters[1] = ic;
+            parameters[2] = zCount * kh * kw * 4;
+            parameters[3] = eP * 4 * sizeof(float);
+            parameters[4] = 0;
+            parameters[5] = 0;
+            for (int eStart = 0; eStart < plane; eStart += eP) {
+                const int eCount = ALIMIN(eP, plane - eStart);
+                // The input in NC4HW4 is packed as A directly
+                MNNPackC4ForMatMul_A(aTile, src + eStart * 4, eCount, ic, plane);
+                parameters[0] = eCount * sizeof(float);
+                if (eCount == eP) {
+                    MNNPackedMatMul(cC4, aTile, packedPtr + g * packedGroupSize, parameters, cache, nullptr, nullptr);
+                } else {
+                    MNNPackedMatMulRemain(cC4, aTile, packedPtr + g * packedGroupSize, eCount, parameters, cache,
+                                          nullptr, nullptr);
+                }
+                // Col2Im of the tile
+                for (int e = 0; e < eCount; ++e) {
+                    const int srcStartY = ((eStart + e) / iw) * strideY - padY;
+                    const int srcStartX = ((eStart + e) % iw) * strideX - padX;
+                    const int sfy       = ALIMAX(0, (UP_DIV(-srcStartY, dilateY)));
+                    const int efy       = ALIMIN(kh, UP_DIV(oh - srcStartY, dilateY));
+                    const int sfx       = ALIMAX(0, (UP_DIV(-srcStartX, dilateX)));
+                    const int efx       = ALIMIN(kw, UP_DIV(ow - srcStartX, dilateX));
+                    for (int z = 0; z < zCount; ++z) {
+                        auto dstZ = dst + z * dstPlane * 4 + (srcStartY * ow + srcStartX) * 4;
+                        auto srcZ = cC4 + z * kh * kw * eP * 4 + e * 4;
+                        for (int fy = sfy; fy < efy; ++fy) {
+                            auto dstY = dstZ + fy * dilateY * ow * 4;
+                            auto srcY = srcZ + fy * kw * eP * 4;
+                            for (int fx = sfx; fx < efx; ++fx) {
+                                auto dstX = dstY + fx * dilateX * 4;
+                                Vec4::save(dstX, Vec4::load(dstX) + Vec4::load(srcY + fx * eP * 4));
+                            }
+                        }
+                    }
+                }
+            }
+            mPostFunction(dst, biasPtr + zStart * 4, dstPlane, zCount);
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
 class CPUDeconvolutionCreator : public CPUBackend::Creator {
 public:
     virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
                                 const MNN::Op* op, Backend* backend) const {
         auto convOp = op->main_as_Convolution2D();
         auto common = convOp->common();
+        if (inputs.size() > 1) {
+            if (1 != common->group()) {
+                return nullptr;
+            }
+            return new CPUDeconvolutionMultiInput(inputs[0], op, backend);
+        }
         if (common->strideY() > 1 || common->strideX() > 1) {
             if (common->dilateX() == 1 && common->dilateY() == 1) {
                 return new DeconvolutionWithStride(inputs[0], op, backend);
@@ -66,5 +66,30 @@ private:
     std::vector<Tensor *> mTempInputs;
     std::shared_ptr<CPUDeconvolutionOrigin> mOrigin;
 };
+
+/**
+ Deconvolution whose weight [ic, oc, kh, kw] (and bias) are inputs, such as the input grad of a convolution.
+ It is an implicit GEMM + col2im: for each tile of input pixels, the columns [oc / 4, kh, kw, 4] are computed against the
+ packed weight and added to the output at once, so the column matrix of the whole image is never built. Output channels
+ are split into groups so that each thread owns its output region.
+ */
+class CPUDeconvolutionMultiInput : public CPUDeconvolutionBasic {
+public:
+    CPUDeconvolutionMultiInput(const Tensor *input, const Op *convOp, Backend *b);
+    virtual ~CPUDeconvolutionMultiInput() = default;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    int mGroups = 0;
+    // Count of oc / 4 in a group
+    int mGroupSize = 0;
+    int mThreadNumber = 1;
+    size_t mPackedGroupSize = 0;
+    size_t mTempSize = 0;
+    std::shared_ptr<Tensor> mBias;
+    std::shared_ptr<Tensor> mPackedWeight;
+    std::shared_ptr<Tensor> mTemp;
+};
 } // namespace MNN
 #endif /* CPUDeconvolution_hpp */
@@ -18,6 +18,8 @@
 #include <MNN/AutoTime.hpp>
 #include "backend/cpu/CPUBackend.hpp"
 #include "backend/cpu/compute/CommonOptFunction.h"
+#include "backend/cpu/compute/NMSComputer.hpp"
+#include "core/Concurrency.h"
 #include "core/TensorUtils.hpp"
 
 namespace MNN {
@@ -46,54 +48,6 @@ using score_box_t = std::tuple<float, float, float, float, int, float>;
 #define box_label(rect) (std::get<4>(rect))
 #define box_score(rect) (std::get<5>(rect))
 
-static inline float intersectionArea(const score_box_t& a, const score_box_t& b) {
-    float axmin = box_rect_xmin(a), bxmin = box_rect_xmin(b);
-    float axmax = box_rect_xmax(a), bxmax = box_rect_xmax(b);
-    float aymin = box_rect_ymin(a), bymin = box_rect_ymin(b);
-    float aymax = box_rect_ymax(a), bymax = box_rect_ymax(b);
-    if (axmin > bxmax || axmax < bxmin || aymin > bymax || aymax < bymin)
-        return 0.f;
-
-    float interWidth  = fmin(axmax, bxmax) - fmax(axmin, bxmin);
-    float interHeight = fmin(aymax, bymax) - fmax(aymin, bymin);
-    return interWidth * interHeight;
-}
-
-static void pickBoxes(const std::vector<score_box_t> &boxes, std::vector<int> &picked, float nmsThreshold, int topK) {
-    long n = boxes.size();
-    std::vector<float> areas;
-    areas.resize(n);
-    for (int i = 0; i < n; i++) {
-        auto& box     = boxes[i];
-        float width  = box_rect_xmax(box) - box_rect_xmin(box);
-        float height = box_rect_ymax(box) - box_rect_ymin(box);
-        areas[i]     = width * height;
-    }
-
-    for (int i = 0; i < n; i++) {
-        auto& a = boxes[i];
-
-        bool keep = true;
-        for (auto pick : picked) {
-            auto& b = boxes[pick];
-
-            // intersection over union
-            float interArea = intersectionArea(a, b);
-            float unionArea = areas[i] + areas[pick] - interArea;
-            if (interArea / unionArea > nmsThreshold) {
-                keep = false;
-                break;
-            }
-        }
-        if (keep) {
-            picked.push_back(i);
-            if (picked.size() >= topK) {
-                break;
-            }
-        }
-    }
-}
-
 ErrorCode CPUDetectionOutput::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     auto &location = inputs[0];
     auto &priorbox = inputs[2];
@@ -194,37 +148,42 @@ ErrorCode CPUDetectionOutput::onExecute(const std::vector<Tensor *> &inputs, con
         decodeBoxs(priorboxPtr, locationPtr);
     }
 
-    // sort and nms for each class
-    std::vector<score_box_t> allClassBoxes;
-    auto compareFunction = [](const score_box_t &a, const score_box_t &b) { return box_score(a) > box_score(b); };
+    // nms for each class in parallel, all classes share the decoded boxes
+    NMSBoxes nmsBoxes;
+    nmsBoxes.resize(priorCount);
+    for (int j = 0; j < priorCount; j++) {
+        const float *box = boxes.get() + 4 * j;
+        nmsBoxes.set(j, box[0], box[1], box[2], box[3]);
+    }
+    auto classScore = [=](int j, int i) {
+        if (refineDet && (armconfidencePtr[j * 2 + 1] < mObjectnessScoreThreshold)) {
+            return 0.0f;
+        }
+        return confidencePtr[j * mClassCount + i];
+    };
+    std::vector<std::vector<int>> classPicked(mClassCount);
     {
         AUTOTIME;
-        for (int i = 1; i < mClassCount; i++) { // start from 1 to ignore background class
-            std::vector<score_box_t> classBoxes;
-            classBoxes.reserve(priorCount);
-            // filter by confidenceThreshold
-            for (int j = 0; j < priorCount; j++) {
-                float score = confidencePtr[j * mClassCount + i];
-                if (refineDet && (armconfidencePtr[j * 2 + 1] < mObjectnessScoreThreshold)) {
-                    score = 0.0;
-                }
-                if (score > mConfidenceThreshold) {
-                    const float *box = boxes.get() + 4 * j;
-                    classBoxes.push_back(box_rect(box[0], box[1], box[2], box[3], i, score));
+        const int threadNumber = ((CPUBackend *)backend())->threadNumber();
+        MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+            std::vector<float> scores(priorCount);
+            // start from 1 to ignore background class
+            for (int i = (int)tId + 1; i < mClassCount; i += threadNumber) {
+                for (int j = 0; j < priorCount; j++) {
+                    scores[j] = classScore(j, i);
                 }
+                NMSSelect(nmsBoxes, scores.data(), mNMSThreshold, mConfidenceThreshold, -1, mKeepTopK,
+                          classPicked[i]);
             }
-
-            // sort inplace
-            std::sort(classBoxes.begin(), classBoxes.end(), compareFunction);
-
-            // apply nms
-            std::vector<int> picked;
-            pickBoxes(classBoxes, picked, mNMSThreshold, mKeepTopK);
-
-            // select
-            for (auto index : picked) {
-                allClassBoxes.push_back(classBoxes[index]);
-            }
+        }
+        MNN_CONCURRENCY_END();
+    }
+    std::vector<score_box_t> allClassBoxes;
+    auto compareFunction = [](const score_box_t &a, const score_box_t &b) { return box_score(a) > box_score(b); };
+    for (int i = 1; i < mClassCount; i++) {
+        for (auto index : classPicked[i]) {
+            const float *box = boxes.get() + 4 * index;
+            allClassBoxes.push_back(box_rect(box[0], box[1], box[2], box[3], i, classScore(index, i)));
         }
     }
 
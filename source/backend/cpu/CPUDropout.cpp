@@ -0,0 +1,167 @@
+//
+//  CPUDropout.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/09.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPUDropout.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "math/Vec.hpp"
+
+namespace MNN {
+using Vec4 = Math::Vec<float, 4>;
+
+// Philox4x32-10, the random of each element only depends on (key, element index, offset),
+// so any range of elements can be generated independently by different threads.
+// Four consecutive blocks are generated at once, one per lane, so that each round runs on vectors.
+// dst is the 16 randoms of the blocks [block, block + 4) in order.
+static inline void _philox4(uint64_t block, uint64_t offset, const uint32_t* key, uint32_t* dst) {
+    uint32_t c0[4], c1[4], c2[4], c3[4];
+    for (int l = 0; l < 4; ++l) {
+        c0[l] = (uint32_t)(block + l);
+        c1[l] = (uint32_t)((block + l) >> 32);
+        c2[l] = (uint32_t)offset;
+        c3[l] = (uint32_t)(offset >> 32);
+    }
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round) {
+        for (int l = 0; l < 4; ++l) {
+            uint64_t p0 = (uint64_t)0xD2511F53 * c0[l];
+            uint64_t p1 = (uint64_t)0xCD9E8D57 * c2[l];
+            c0[l]       = (uint32_t)(p1 >> 32) ^ c1[l] ^ k0;
+            c1[l]       = (uint32_t)p1;
+            c2[l]       = (uint32_t)(p0 >> 32) ^ c3[l] ^ k1;
+            c3[l]       = (uint32_t)p0;
+        }
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+    }
+    for (int l = 0; l < 4; ++l) {
+        dst[4 * l + 0] = c0[l];
+        dst[4 * l + 1] = c1[l];
+        dst[4 * l + 2] = c2[l];
+        dst[4 * l + 3] = c3[l];
+    }
+}
+
+// y = x * factor, 16 elements (4 vectors) or the size of the tail
+static inline void _scale16(float* y, const float* x, const float* factor, int size) {
+    if (16 == size) {
+        for (int k = 0; k < 4; ++k) {
+            Vec4::save(y + 4 * k, Vec4::load(x + 4 * k) * Vec4::load(factor + 4 * k));
+        }
+        return;
+    }
+    for (int k = 0; k < size; ++k) {
+        y[k] = x[k] * factor[k];
+    }
+}
+
+static uint32_t _threshold(float ratio) {
+    // Drop the element if random < ratio * 2^32
+    double threshold = (double)ratio * 4294967296.0;
+    if (threshold <= 0.0) {
+        return 0;
+    }
+    if (threshold >= 4294967295.0) {
+        return 0xFFFFFFFF;
+    }
+    return (uint32_t)threshold;
+}
+
+CPUDropout::CPUDropout(Backend* b, float ratio, uint32_t seed, uint32_t seed2) : Execution(b), mRatio(ratio) {
+    mKey[0] = seed;
+    mKey[1] = seed2;
+}
+
+ErrorCode CPUDropout::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto src        = inputs[0]->host<float>();
+    auto dst        = outputs[0]->host<float>();
+    auto mask       = outputs[1]->host<uint8_t>();
+    const int count = inputs[0]->size() / sizeof(float);
+    const int bytes = (count + 7) / 8;
+    const float scale        = mRatio < 1.0f ? 1.0f / (1.0f - mRatio) : 0.0f;
+    const uint32_t threshold = _threshold(mRatio);
+    const uint64_t offset    = mOffset;
+    const uint32_t* key      = mKey;
+    int threadNum = ((CPUBackend*)backend())->threadNumber();
+    // Each unit is 16 elements of two mask bytes, generated by four philox blocks
+    const int units = UP_DIV(count, 16);
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        int start = (int)((int64_t)units * tId / threadNum);
+        int end   = (int)((int64_t)units * (tId + 1) / threadNum);
+        uint32_t random[16];
+        float factor[16];
+        for (int i = start; i < end; ++i) {
+            _philox4(4 * (uint64_t)i, offset, key, random);
+            uint32_t bits = 0;
+            for (int k = 0; k < 16; ++k) {
+                bool keep = random[k] >= threshold;
+                bits |= (uint32_t)keep << k;
+                factor[k] = keep ? scale : 0.0f;
+            }
+            mask[2 * i] = (uint8_t)bits;
+            if (2 * i + 1 < bytes) {
+                mask[2 * i + 1] = (uint8_t)(bits >> 8);
+            }
+            _scale16(dst + 16 * i, src + 16 * i, factor, ALIMIN(16, count - 16 * i));
+        }
+    }
+    MNN_CONCURRENCY_END();
+    mOffset++;
+    return NO_ERROR;
+}
+
+ErrorCode CPUDropoutGrad::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto grad       = inputs[0]->host<float>();
+    auto mask       = inputs[1]->host<uint8_t>();
+    auto dst        = outputs[0]->host<float>();
+    const int count = inputs[0]->size() / sizeof(float);
+    const int bytes = (count + 7) / 8;
+    const float scale = mRatio < 1.0f ? 1.0f / (1.0f - mRatio) : 0.0f;
+    int threadNum     = ((CPUBackend*)backend())->threadNumber();
+    const int units   = UP_DIV(count, 16);
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        int start = (int)((int64_t)units * tId / threadNum);
+        int end   = (int)((int64_t)units * (tId + 1) / threadNum);
+        float factor[16];
+        for (int i = start; i < end; ++i) {
+            uint32_t bits = mask[2 * i];
+            if (2 * i + 1 < bytes) {
+                bits |= (uint32_t)mask[2 * i + 1] << 8;
+            }
+            for (int k = 0; k < 16; ++k) {
+                factor[k] = ((bits >> k) & 1) ? scale : 0.0f;
+            }
+            _scale16(dst + 16 * i, grad + 16 * i, factor, ALIMIN(16, count - 16 * i));
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+class CPUDropoutCreator : public CPUBackend::Creator {
+public:
+    virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
+                                const MNN::Op* op, Backend* backend) const override {
+        auto param = op->main_as_DropoutParam();
+        if (nullptr == param) {
+            return nullptr;
+        }
+        if (op->type() == OpType_DropoutGrad) {
+            return new CPUDropoutGrad(backend, param->ratio());
+        }
+        if (outputs.size() != 2) {
+            return nullptr;
+        }
+        return new CPUDropout(backend, param->ratio(), param->seed(), param->seed2());
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPUDropoutCreator, OpType_Dropout);
+REGISTER_CPU_OP_CREATOR(CPUDropoutCreator, OpType_DropoutGrad);
+} // namespace MNN
@@ -0,0 +1,42 @@
+//
+//  CPUDropout.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/09.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUDropout_hpp
+#define CPUDropout_hpp
+
+#include "core/Execution.hpp"
+
+namespace MNN {
+// outputs: x * mask * scale, bit-packed mask
+class CPUDropout : public Execution {
+public:
+    CPUDropout(Backend *b, float ratio, uint32_t seed, uint32_t seed2);
+    virtual ~CPUDropout() = default;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    float mRatio;
+    uint32_t mKey[2];
+    // Counter offset, advanced after each execution so that replaying the same op gives new masks
+    uint64_t mOffset = 0;
+};
+
+// inputs: output grad, bit-packed mask; output: input grad
+class CPUDropoutGrad : public Execution {
+public:
+    CPUDropoutGrad(Backend *b, float ratio) : Execution(b), mRatio(ratio) {
+    }
+    virtual ~CPUDropoutGrad() = default;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    float mRatio;
+};
+} // namespace MNN
+
+#endif /* CPUDropout_hpp */
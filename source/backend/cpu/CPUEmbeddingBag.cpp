@@ -0,0 +1,159 @@
+//
+//  CPUEmbeddingBag.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/29.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPUEmbeddingBag.hpp"
+#include <string.h>
+#include "backend/cpu/CPUBackend.hpp"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "math/Vec.hpp"
+
+// Indices looked up ahead of the current one
+#define EMBEDDING_PREFETCH_DISTANCE 4
+
+namespace MNN {
+using Vec4 = Math::Vec<float, 4>;
+
+CPUEmbeddingBag::CPUEmbeddingBag(Backend *b, ReductionType mode) : Execution(b), mMode(mode) {
+    // nothing to do
+}
+
+ErrorCode CPUEmbeddingBag::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto weight = inputs[0];
+    auto bags   = inputs[2]->length(0);
+    mDim        = 1;
+    for (int i = 1; i < weight->dimensions(); ++i) {
+        mDim *= weight->length(i);
+    }
+    mThreadNumber = static_cast<CPUBackend *>(backend())->threadNumber();
+    mDimBlocks    = 1;
+    if (bags < mThreadNumber) {
+        mDimBlocks = ALIMIN(UP_DIV(mDim, 4), UP_DIV(mThreadNumber, ALIMAX(bags, 1)));
+    }
+    // At least one vector per block, also for empty rows
+    mDimBlockSize = ALIMAX(4, ALIGN_UP4(UP_DIV(mDim, ALIMAX(mDimBlocks, 1))));
+    mDimBlocks    = ALIMAX(1, UP_DIV(mDim, mDimBlockSize));
+    mThreadNumber = ALIMAX(1, ALIMIN(mThreadNumber, bags * mDimBlocks));
+    return NO_ERROR;
+}
+
+static void _rowScale(float *dst, const float *src, float scale, int size) {
+    const int sizeC4 = size / 4;
+    Vec4 s(scale);
+    for (int i = 0; i < sizeC4; ++i) {
+        Vec4::save(dst + 4 * i, Vec4::load(src + 4 * i) * s);
+    }
+    for (int i = sizeC4 * 4; i < size; ++i) {
+        dst[i] = src[i] * scale;
+    }
+}
+
+static void _rowAdd(float *dst, const float *src, float scale, int size) {
+    const int sizeC4 = size / 4;
+    Vec4 s(scale);
+    for (int i = 0; i < sizeC4; ++i) {
+        Vec4::save(dst + 4 * i, Vec4::load(dst + 4 * i) + Vec4::load(src + 4 * i) * s);
+    }
+    for (int i = sizeC4 * 4; i < size; ++i) {
+        dst[i] = dst[i] + src[i] * scale;
+    }
+}
+
+static void _rowMax(float *dst, const float *src, float scale, int size) {
+    const int sizeC4 = size / 4;
+    Vec4 s(scale);
+    for (int i = 0; i < sizeC4; ++i) {
+        Vec4::save(dst + 4 * i, Vec4::max(Vec4::load(dst + 4 * i), Vec4::load(src + 4 * i) * s));
+    }
+    for (int i = sizeC4 * 4; i < size; ++i) {
+        dst[i] = ALIMAX(dst[i], src[i] * scale);
+    }
+}
+
+ErrorCode CPUEmbeddingBag::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto weight        = inputs[0];
+    const int num      = weight->length(0);
+    const int count    = inputs[1]->elementSize();
+    const int bags     = inputs[2]->length(0);
+    auto indicesPtr    = inputs[1]->host<int32_t>();
+    auto offsetsPtr    = inputs[2]->host<int32_t>();
+    auto weightPtr     = weight->host<float>();
+    const float *scale = inputs.size() > 3 ? inputs[3]->host<float>() : nullptr;
+    auto outputPtr     = outputs[0]->host<float>();
+    // Check indices and offsets first, so that the threads below never fail
+    for (int i = 0; i < count; ++i) {
+        if (indicesPtr[i] < 0 || indicesPtr[i] >= num) {
+            return INPUT_DATA_ERROR;
+        }
+    }
+    for (int b = 0; b < bags; ++b) {
+        const int end = b + 1 < bags ? offsetsPtr[b + 1] : count;
+        if (offsetsPtr[b] < 0 || offsetsPtr[b] > end || end > count) {
+            return INPUT_DATA_ERROR;
+        }
+    }
+    const int dim          = mDim;
+    const int dimBlocks    = mDimBlocks;
+    const int dimBlockSize = mDimBlockSize;
+    const int threadNumber = mThreadNumber;
+    const int unitNumber   = bags * dimBlocks;
+    const auto mode        = mMode;
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        for (int u = (int)tId; u < unitNumber; u += threadNumber) {
+            const int b      = u / dimBlocks;
+            const int dStart = (u % dimBlocks) * dimBlockSize;
+            const int dSize  = ALIMIN(dimBlockSize, dim - dStart);
+            const int start  = offsetsPtr[b];
+            const int end    = b + 1 < bags ? offsetsPtr[b + 1] : count;
+            auto dst         = outputPtr + b * dim + dStart;
+            // An empty bag is zero
+            if (start == end) {
+                ::memset(dst, 0, dSize * sizeof(float));
+                continue;
+            }
+            auto src = weightPtr + dStart;
+            _rowScale(dst, src + indicesPtr[start] * dim, nullptr != scale ? scale[start] : 1.0f, dSize);
+            for (int i = start + 1; i < end; ++i) {
+                if (i + EMBEDDING_PREFETCH_DISTANCE < end) {
+                    MNN_PREFETCH(src + indicesPtr[i + EMBEDDING_PREFETCH_DISTANCE] * dim);
+                }
+                auto row = src + indicesPtr[i] * dim;
+                auto s   = nullptr != scale ? scale[i] : 1.0f;
+                if (ReductionType_MAXIMUM == mode) {
+                    _rowMax(dst, row, s, dSize);
+                } else {
+                    _rowAdd(dst, row, s, dSize);
+                }
+            }
+            if (ReductionType_MEAN == mode) {
+                _rowScale(dst, dst, 1.0f / (float)(end - start), dSize);
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+class CPUEmbeddingBagCreator : public CPUBackend::Creator {
+public:
+    virtual Execution *onCreate(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs,
+                                const MNN::Op *op, Backend *backend) const override {
+        auto mode = ReductionType_SUM;
+        if (nullptr != op->main_as_ReductionParam()) {
+            mode = op->main_as_ReductionParam()->operation();
+        }
+        if (ReductionType_SUM != mode && ReductionType_MEAN != mode && ReductionType_MAXIMUM != mode) {
+            MNN_ERROR("EmbeddingBag only supports SUM, MEAN and MAXIMUM\n");
+            return nullptr;
+        }
+        return new CPUEmbeddingBag(backend, mode);
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPUEmbeddingBagCreator, OpType_EmbeddingBag);
+} // namespace MNN
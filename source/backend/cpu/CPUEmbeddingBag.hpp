@@ -0,0 +1,34 @@
+//
+//  CPUEmbeddingBag.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/29.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUEmbeddingBag_hpp
+#define CPUEmbeddingBag_hpp
+
+#include "core/Execution.hpp"
+#include "MNN_generated.h"
+
+namespace MNN {
+// Gather rows of the weight and pool them per bag, the rows are accumulated into the output directly
+class CPUEmbeddingBag : public Execution {
+public:
+    CPUEmbeddingBag(Backend *b, ReductionType mode);
+    virtual ~CPUEmbeddingBag() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    ReductionType mMode;
+    int mDim;
+    int mThreadNumber;
+    // The row is split into blocks when there are fewer bags than threads
+    int mDimBlocks;
+    int mDimBlockSize;
+};
+} // namespace MNN
+
+#endif /* CPUEmbeddingBag_hpp */
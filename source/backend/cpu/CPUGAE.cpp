@@ -0,0 +1,83 @@
+//
+//  CPUGAE.cpp
+//  MNN
+//
+//  Created by MNN on 2021/01/07.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPUGAE.hpp"
+#include "backend/cpu/CPUBackend.hpp"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "math/Vec.hpp"
+
+namespace MNN {
+using Vec4 = Math::Vec<float, 4>;
+
+ErrorCode CPUGAE::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
+    auto reward    = inputs[0]->host<float>();
+    auto value     = inputs[1]->host<float>();
+    auto done      = inputs[2]->host<float>();
+    auto bootstrap = inputs[3]->host<float>();
+    auto advantage = outputs[0]->host<float>();
+    auto returns   = outputs[1]->host<float>();
+    const int T             = inputs[0]->length(0);
+    const int N             = inputs[0]->length(1);
+    const float gamma       = mGamma;
+    const float gammaLambda = mGamma * mLambda;
+
+    // Four environments a vector, the remain ones are computed by the first thread
+    const int nC4    = N / 4;
+    int threadNumber = ALIMIN(((CPUBackend *)backend())->threadNumber(), ALIMAX(nC4, 1));
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        for (int c = (int)tId; c < nC4; c += threadNumber) {
+            const int n = c * 4;
+            Vec4 nextValue = Vec4::load(bootstrap + n);
+            Vec4 nextAdv(0.0f);
+            for (int t = T - 1; t >= 0; --t) {
+                const int offset = t * N + n;
+                auto v           = Vec4::load(value + offset);
+                auto notDone     = Vec4(1.0f) - Vec4::load(done + offset);
+                auto delta       = Vec4::load(reward + offset) + nextValue * notDone * gamma - v;
+                nextAdv          = delta + nextAdv * notDone * gammaLambda;
+                nextValue        = v;
+                Vec4::save(advantage + offset, nextAdv);
+                Vec4::save(returns + offset, nextAdv + v);
+            }
+        }
+        if (0 == tId) {
+            for (int n = nC4 * 4; n < N; ++n) {
+                float nextValue = bootstrap[n];
+                float nextAdv   = 0.0f;
+                for (int t = T - 1; t >= 0; --t) {
+                    const int offset = t * N + n;
+                    auto v           = value[offset];
+                    auto notDone     = 1.0f - done[offset];
+                    auto delta       = reward[offset] + nextValue * notDone * gamma - v;
+                    nextAdv          = delta + nextAdv * notDone * gammaLambda;
+                    nextValue        = v;
+                    advantage[offset] = nextAdv;
+                    returns[offset]   = nextAdv + v;
+                }
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+class CPUGAECreator : public CPUBackend::Creator {
+public:
+    virtual Execution *onCreate(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs,
+                                const MNN::Op *op, Backend *backend) const override {
+        auto param = op->main_as_GAEParam();
+        if (nullptr == param) {
+            return new CPUGAE(backend, 0.99f, 0.95f);
+        }
+        return new CPUGAE(backend, param->gamma(), param->lambda());
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPUGAECreator, OpType_GAE);
+} // namespace MNN
@@ -0,0 +1,35 @@
+//
+//  CPUGAE.hpp
+//  MNN
+//
+//  Created by MNN on 2021/01/07.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUGAE_hpp
+#define CPUGAE_hpp
+
+#include "core/Execution.hpp"
+
+namespace MNN {
+/**
+ GAE(gamma, lambda) in reverse time, environments are independent so four of them are computed by one vector:
+ delta[t] = reward[t] + gamma * (1 - done[t]) * value[t + 1] - value[t]
+ advantage[t] = delta[t] + gamma * lambda * (1 - done[t]) * advantage[t + 1]
+ return[t] = advantage[t] + value[t]
+ with value[T] = bootstrap and advantage[T] = 0.
+ */
+class CPUGAE : public Execution {
+public:
+    CPUGAE(Backend *b, float gamma, float lambda) : Execution(b), mGamma(gamma), mLambda(lambda) {
+    }
+    virtual ~CPUGAE() = default;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    float mGamma;
+    float mLambda;
+};
+} // namespace MNN
+
+#endif /* CPUGAE_hpp */
@@ -9,6 +9,7 @@
 #include "backend/cpu/CPUGatherV2.hpp"
 #include "backend/cpu/CPUBackend.hpp"
 #include "backend/cpu/compute/CommonOptFunction.h"
+#include "core/Concurrency.h"
 #include "core/Macro.h"
 
 namespace MNN {
@@ -35,6 +36,13 @@ ErrorCode CPUGatherV2::onResize(const std::vector<Tensor *> &inputs, const std::
     return NO_ERROR;
 }
 
+// Rows looked up ahead of the current one, they are random accesses that the hardware prefetcher can't predict
+#define GATHER_PREFETCH_DISTANCE 4
+// Bytes of a row to prefetch, the rest of a long row is sequential
+#define GATHER_PREFETCH_BYTES 256
+// Don't split a gather smaller than this into threads
+#define GATHER_MIN_BYTES_PER_THREAD (16 * 1024)
+
 ErrorCode CPUGatherV2::onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     auto params  = inputs[0];
     auto indices = inputs[1];
@@ -57,16 +65,37 @@ ErrorCode CPUGatherV2::onExecute(const std::vector<Tensor *> &inputs, const std:
     const int *indicesPtr    = indices->host<int32_t>();
     const auto inputPtr      = params->host<uint8_t>();
     auto outputPtr           = output->host<uint8_t>();
-    for (int o=0; o<outside; ++o) {
-        auto outputO = outputPtr + outputOutsideStride * o;
-        auto inputO = inputPtr + inputOutsideStride * o;
-        for (int i = 0; i < N; i++) {
-            if (indicesPtr[i] < 0 || indicesPtr[i] > limit) {
-                return INPUT_DATA_ERROR;
+    // Check all indices first, so that the threads below never fail
+    for (int i = 0; i < N; i++) {
+        if (indicesPtr[i] < 0 || indicesPtr[i] >= limit) {
+            return INPUT_DATA_ERROR;
+        }
+    }
+    const int rows = outside * N;
+    const size_t totalBytes = (size_t)rows * insideStride;
+    int threadNumber = static_cast<CPUBackend *>(backend())->threadNumber();
+    threadNumber     = ALIMIN(threadNumber, (int)UP_DIV(totalBytes, (size_t)GATHER_MIN_BYTES_PER_THREAD));
+    threadNumber     = ALIMAX(1, ALIMIN(threadNumber, rows));
+    const int prefetchBytes = ALIMIN(insideStride, GATHER_PREFETCH_BYTES);
+    // Each thread copies a contiguous range of output rows, so that its writes are sequential
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        const int rowStart = (int)((int64_t)rows * tId / threadNumber);
+        const int rowEnd   = (int)((int64_t)rows * (tId + 1) / threadNumber);
+        for (int r = rowStart; r < rowEnd; ++r) {
+            const int ahead = r + GATHER_PREFETCH_DISTANCE;
+            if (ahead < rowEnd) {
+                auto next = inputPtr + inputOutsideStride * (ahead / N) + insideStride * indicesPtr[ahead % N];
+                for (int p = 0; p < prefetchBytes; p += 64) {
+                    MNN_PREFETCH(next + p);
+                }
             }
-            memcpy(outputO + i * insideStride, inputO + insideStride * indicesPtr[i], insideStride);
+            const int o = r / N;
+            const int i = r % N;
+            ::memcpy(outputPtr + outputOutsideStride * o + i * insideStride,
+                     inputPtr + inputOutsideStride * o + insideStride * indicesPtr[i], insideStride);
         }
     }
+    MNN_CONCURRENCY_END();
     return NO_ERROR;
 }
 
@@ -72,6 +72,20 @@ extern void ___CPUPriorBoxCreator__OpType_PriorBox__();
 extern void ___CPUEltwiseInt8Creator__OpType_EltwiseInt8__();
 extern void ___CPUBatchMatMulCreator__OpType_BatchMatMul__();
 extern void ___CPULayerNormCreator__OpType_LayerNorm__();
+extern void ___CPULogSoftmaxCreator__OpType_LogSoftmax__();
+extern void ___CPUSoftmaxCrossEntropyCreator__OpType_SoftmaxCrossEntropy__();
+extern void ___CPUSoftmaxCrossEntropyCreator__OpType_SoftmaxCrossEntropyGrad__();
+extern void ___CPUDropoutCreator__OpType_Dropout__();
+extern void ___CPUDropoutCreator__OpType_DropoutGrad__();
+extern void ___CPUBatchNormTrainCreator__OpType_BatchNormTrain__();
+extern void ___CPUBatchNormTrainCreator__OpType_BatchNormTrainGrad__();
+extern void ___CPUEmbeddingBagCreator__OpType_EmbeddingBag__();
+extern void ___CPUConv2DBackPropFilterCreator__OpType_Conv2DBackPropFilter__();
+extern void ___CPURecurrentSequenceCreator__OpType_GRUSequence__();
+extern void ___CPURecurrentSequenceCreator__OpType_GRUSequenceGrad__();
+extern void ___CPURecurrentSequenceCreator__OpType_LSTMSequence__();
+extern void ___CPURecurrentSequenceCreator__OpType_LSTMSequenceGrad__();
+extern void ___CPUGAECreator__OpType_GAE__();
 
 void registerCPUOps() {
 ___CPUCropAndResizeCreator__OpType_CropAndResize__();
@@ -146,5 +160,19 @@ ___CPUPriorBoxCreator__OpType_PriorBox__();
 ___CPUEltwiseInt8Creator__OpType_EltwiseInt8__();
 ___CPUBatchMatMulCreator__OpType_BatchMatMul__();
 ___CPULayerNormCreator__OpType_LayerNorm__();
+___CPULogSoftmaxCreator__OpType_LogSoftmax__();
+___CPUSoftmaxCrossEntropyCreator__OpType_SoftmaxCrossEntropy__();
+___CPUSoftmaxCrossEntropyCreator__OpType_SoftmaxCrossEntropyGrad__();
+___CPUDropoutCreator__OpType_Dropout__();
+___CPUDropoutCreator__OpType_DropoutGrad__();
+___CPUBatchNormTrainCreator__OpType_BatchNormTrain__();
+___CPUBatchNormTrainCreator__OpType_BatchNormTrainGrad__();
+___CPUEmbeddingBagCreator__OpType_EmbeddingBag__();
+___CPUConv2DBackPropFilterCreator__OpType_Conv2DBackPropFilter__();
+___CPURecurrentSequenceCreator__OpType_GRUSequence__();
+___CPURecurrentSequenceCreator__OpType_GRUSequenceGrad__();
+___CPURecurrentSequenceCreator__OpType_LSTMSequence__();
+___CPURecurrentSequenceCreator__OpType_LSTMSequenceGrad__();
+___CPUGAECreator__OpType_GAE__();
 }
 }
@@ -8,8 +8,10 @@
 
 #include "backend/cpu/CPUProposal.hpp"
 #include <math.h>
+#include <limits>
 #include "backend/cpu/CPUBackend.hpp"
 #include "backend/cpu/compute/CommonOptFunction.h"
+#include "backend/cpu/compute/NMSComputer.hpp"
 #include "core/Concurrency.h"
 //#define MNN_OPEN_TIME_TRACE
 #include <MNN/AutoTime.hpp>
@@ -45,61 +47,6 @@ CPUProposal::CPUProposal(Backend *backend, const Proposal *proposal) : Execution
     }
 }
 
-using score_box_t = std::tuple<float, float, float, float, float>;
-#define box_rect(xmin, ymin, xmax, ymax, score) std::make_tuple((xmin), (ymin), (xmax), (ymax), (score))
-#define box_rect_xmin(box) (std::get<0>(box))
-#define box_rect_ymin(box) (std::get<1>(box))
-#define box_rect_xmax(box) (std::get<2>(box))
-#define box_rect_ymax(box) (std::get<3>(box))
-#define box_score(box) (std::get<4>(box))
-
-static void pickBoxes(const std::vector<score_box_t> &boxes, std::vector<long> &picked, float nmsThreshold, int size) {
-    long n = boxes.size();
-    std::vector<float> areas;
-    {
-        areas.resize(n);
-        for (int i = 0; i < n; i++) {
-            auto box     = boxes[i];
-            float width  = box_rect_xmax(box) - box_rect_xmin(box);
-            float height = box_rect_ymax(box) - box_rect_ymin(box);
-            areas[i]     = width * height;
-        }
-    }
-
-    for (int i = 0; i < n; i++) {
-        auto a = boxes[i];
-
-        int keep = 1;
-        for (int j = 0; j < picked.size(); j++) {
-            auto b = boxes[picked[j]];
-
-            // intersection over union
-            float axmin = box_rect_xmin(a), bxmin = box_rect_xmin(b);
-            float axmax = box_rect_xmax(a), bxmax = box_rect_xmax(b);
-            float aymin = box_rect_ymin(a), bymin = box_rect_ymin(b);
-            float aymax = box_rect_ymax(a), bymax = box_rect_ymax(b);
-            if (axmin > bxmax || axmax < bxmin || aymin > bymax || aymax < bymin) {
-                continue;
-            }
-
-            float interWidth  = fmin(axmax, bxmax) - fmax(axmin, bxmin);
-            float interHeight = fmin(aymax, bymax) - fmax(aymin, bymin);
-            float interArea   = interWidth * interHeight;
-            float unionArea   = areas[i] + areas[picked[j]] - interArea;
-            if (interArea / unionArea > nmsThreshold) {
-                keep = 0;
-                break;
-            }
-        }
-        if (keep) {
-            picked.emplace_back(i);
-            if (picked.size() >= size) {
-                break;
-            }
-        }
-    }
-}
-
 ErrorCode CPUProposal::onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) {
     // score transform space
     auto &score = inputs[0];
@@ -131,13 +78,18 @@ ErrorCode CPUProposal::onResize(const std::vector<Tensor *> &inputs, const std::
         // remove predicted boxes with either height or width < threshold
         auto anchorWidth  = 4;
         auto anchorHeight = mAnchors.size() / 4;
-        std::vector<score_box_t> proposalBoxes;
-        float imScale    = imInfo->host<float>()[2]; // NC/4HW4
-        float minBoxSize = minSize * imScale;
-        proposalBoxes.reserve(boxSize * anchorHeight);
-
-        {
-            for (int ah = 0; ah < anchorHeight; ++ah) {
+        float imScale     = imInfo->host<float>()[2]; // NC/4HW4
+        float minBoxSize  = minSize * imScale;
+        const int proposalCount = (int)anchorHeight * scrSize;
+        NMSBoxes proposalBoxes;
+        proposalBoxes.resize(proposalCount);
+        // removed boxes are never candidates of nms
+        const float removedScore = std::numeric_limits<float>::lowest();
+        std::vector<float> proposalScores(proposalCount, removedScore);
+
+        const int threadNumber = ((CPUBackend *)backend())->threadNumber();
+        MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+            for (int ah = (int)tId; ah < anchorHeight; ah += threadNumber) {
                 auto boxPtr   = boxes->host<float>() + ah * 4 * boxSize;
                 auto scorePtr = mScore.host<float>() + (ah + anchorHeight) * scrSize;
 
@@ -163,8 +115,10 @@ ErrorCode CPUProposal::onResize(const std::vector<Tensor *> &inputs, const std::
                         float minY = std::max(std::min(cy - h * 0.5f, imH - 1), 0.f);
                         float maxX = std::max(std::min(cx + w * 0.5f, imW - 1), 0.f);
                         float maxY = std::max(std::min(cy + h * 0.5f, imH - 1), 0.f);
+                        int index  = ah * scrSize + sh * scrWidth + sw;
+                        proposalBoxes.set(index, minX, minY, maxX, maxY);
                         if (maxX - minX + 1 >= minBoxSize && maxY - minY + 1 >= minBoxSize) {
-                            proposalBoxes.emplace_back(box_rect(minX, minY, maxX, maxY, scorePtr[sh * scrWidth + sw]));
+                            proposalScores[index] = scorePtr[sh * scrWidth + sw];
                         }
                         anchorX += featStride;
                     }
@@ -172,29 +126,11 @@ ErrorCode CPUProposal::onResize(const std::vector<Tensor *> &inputs, const std::
                 }
             }
         }
+        MNN_CONCURRENCY_END();
 
-        {
-            // sort all (proposal, score) pairs by score from highest to lowest
-            // take top preNmsTopN
-            auto compareFunction = [](const score_box_t &a, const score_box_t &b) {
-                return box_score(a) > box_score(b);
-            };
-            if (0 < preNmsTopN && preNmsTopN < (int)proposalBoxes.size()) {
-                std::partial_sort(proposalBoxes.begin(), proposalBoxes.begin() + preNmsTopN, proposalBoxes.end(),
-                                  compareFunction);
-                proposalBoxes.resize(preNmsTopN);
-            } else {
-                std::sort(proposalBoxes.begin(), proposalBoxes.end(), compareFunction);
-            }
-        }
-
-        // apply nms with nmsThreshold
-        // take afterNmsTopN
-        std::vector<long> picked;
-        picked.reserve(afterNmsTopN);
-        {
-            pickBoxes(proposalBoxes, picked, nmsThreshold, afterNmsTopN);
-        }
+        // take top preNmsTopN (proposal, score) pairs by score, apply nms with nmsThreshold and take afterNmsTopN
+        std::vector<int> picked;
+        NMSSelect(proposalBoxes, proposalScores.data(), nmsThreshold, removedScore, preNmsTopN, afterNmsTopN, picked);
 
         int pickedCount = std::min((int)picked.size(), afterNmsTopN);
 
@@ -210,14 +146,14 @@ ErrorCode CPUProposal::onResize(const std::vector<Tensor *> &inputs, const std::
         }
 
         for (int i = 0; i < pickedCount; i++, roiPtr += roiStep, scoresPtr += scoreStep) {
-            auto box  = proposalBoxes[picked[i]];
-            roiPtr[0] = 0;
-            roiPtr[1] = box_rect_xmin(box);
-            roiPtr[2] = box_rect_ymin(box);
-            roiPtr[3] = box_rect_xmax(box);
-            roiPtr[4] = box_rect_ymax(box);
+            auto index = picked[i];
+            roiPtr[0]  = 0;
+            roiPtr[1]  = proposalBoxes.xmin[index];
+            roiPtr[2]  = proposalBoxes.ymin[index];
+            roiPtr[3]  = proposalBoxes.xmax[index];
+            roiPtr[4]  = proposalBoxes.ymax[index];
             if (scoresPtr) {
-                scoresPtr[0] = box_score(box);
+                scoresPtr[0] = proposalScores[index];
             }
         }
     };
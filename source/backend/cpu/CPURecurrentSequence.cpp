@@ -0,0 +1,495 @@
+//
+//  CPURecurrentSequence.cpp
+//  MNN
+//
+//  Created by MNN on 2021/01/04.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPURecurrentSequence.hpp"
+#include <string.h>
+#include "backend/cpu/CPUBackend.hpp"
+#include "backend/cpu/compute/CommonOptFunction.h"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "math/Vec.hpp"
+
+namespace MNN {
+using Vec4 = Math::Vec<float, 4>;
+
+static int _gcd(int a, int b) {
+    return 0 == b ? a : _gcd(b, a % b);
+}
+
+void RecurrentGemm::setup(Backend* backend, int e, int l, int h, bool transposeA, int threadNumber) {
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    mBackend    = backend;
+    mE          = e;
+    mL          = l;
+    mH          = h;
+    mTransposeA = transposeA;
+    // h block must align to both hP (packed B) and 4 (C4 output of the kernel)
+    const int eTiles = UP_DIV(e, eP);
+    const int hUnit  = hP / _gcd(hP, 4) * 4;
+    const int hUnits = UP_DIV(h, hUnit);
+    mHBlocks         = 1;
+    if (eTiles < threadNumber) {
+        mHBlocks = ALIMIN(hUnits, UP_DIV(threadNumber, eTiles));
+    }
+    mHBlockSize = UP_DIV(hUnits, mHBlocks) * hUnit;
+    mHBlocks    = UP_DIV(h, mHBlockSize);
+    mUnits      = eTiles * mHBlocks;
+    // A tile in C4 [lC4, eP, 4], packed A tile [l, eP], C [hC4, eP, 4], kernel cache
+    const int hC4 = UP_DIV(mHBlockSize, 4);
+    mTempSize     = UP_DIV(l, 4) * 4 * eP + l * eP + hC4 * eP * 4;
+    if (hP % 4 != 0) {
+        mTempSize += eP * MNNGetC4DivNumber(hP) * 4 + hC4 * eP * 4;
+    }
+}
+
+size_t RecurrentGemm::packedSize() const {
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    return (size_t)UP_DIV(mH, hP) * hP * mL;
+}
+
+void RecurrentGemm::packB(float* dst, const float* B, bool transposeB) const {
+    MNNPackForMatMul_B(dst, B, mH, mL, transposeB);
+}
+
+void RecurrentGemm::onUnit(float* C, const float* A, const float* packedB, bool accumulate, float* temp,
+                           int unit) const {
+    int eP, lP, hP;
+    MNNGetMatMulPackMode(&eP, &lP, &hP);
+    const int l      = mL;
+    const int eStart = (unit / mHBlocks) * eP;
+    const int eCount = ALIMIN(eP, mE - eStart);
+    const int hStart = (unit % mHBlocks) * mHBlockSize;
+    const int hCount = ALIMIN(mHBlockSize, mH - hStart);
+    auto aC4         = temp;
+    auto aTile       = aC4 + UP_DIV(l, 4) * 4 * eP;
+    auto cC4         = aTile + l * eP;
+    float* cache     = nullptr;
+    if (hP % 4 != 0) {
+        cache = cC4 + UP_DIV(mHBlockSize, 4) * eP * 4;
+    }
+    // A tile -> [lC4, eCount, 4]
+    if (mTransposeA) {
+        for (int x = 0; x < l; ++x) {
+            auto src = A + (size_t)x * mE + eStart;
+            auto dst = aC4 + (x / 4) * eCount * 4 + (x % 4);
+            for (int y = 0; y < eCount; ++y) {
+                dst[4 * y] = src[y];
+            }
+        }
+    } else {
+        const int lC4 = l / 4;
+        for (int y = 0; y < eCount; ++y) {
+            auto src = A + (size_t)(eStart + y) * l;
+            auto dst = aC4 + y * 4;
+            for (int x = 0; x < lC4; ++x) {
+                Vec4::save(dst + x * eCount * 4, Vec4::load(src + 4 * x));
+            }
+            for (int x = lC4 * 4; x < l; ++x) {
+                dst[lC4 * eCount * 4 + (x % 4)] = src[x];
+            }
+        }
+    }
+    MNNPackC4ForMatMul_A(aTile, aC4, eCount, l, eCount);
+    size_t parameters[6];
+    parameters[0] = eCount * sizeof(float);
+    parameters[1] = l;
+    parameters[2] = hCount;
+    parameters[3] = eP * 4 * sizeof(float);
+    parameters[4] = 0;
+    parameters[5] = 0;
+    auto bStart   = packedB + (size_t)(hStart / hP) * l * hP;
+    if (eCount == eP) {
+        MNNPackedMatMul(cC4, aTile, bStart, parameters, cache, nullptr, nullptr);
+    } else {
+        MNNPackedMatMulRemain(cC4, aTile, bStart, eCount, parameters, cache, nullptr, nullptr);
+    }
+    // [hC4, eCount, 4] -> C [e, h]
+    const int hC4 = hCount / 4;
+    for (int y = 0; y < eCount; ++y) {
+        auto dst = C + (size_t)(eStart + y) * mH + hStart;
+        auto src = cC4 + y * 4;
+        if (accumulate) {
+            for (int x = 0; x < hC4; ++x) {
+                Vec4::save(dst + 4 * x, Vec4::load(dst + 4 * x) + Vec4::load(src + x * eP * 4));
+            }
+            for (int x = hC4 * 4; x < hCount; ++x) {
+                dst[x] += src[hC4 * eP * 4 + (x % 4)];
+            }
+        } else {
+            for (int x = 0; x < hC4; ++x) {
+                Vec4::save(dst + 4 * x, Vec4::load(src + x * eP * 4));
+            }
+            for (int x = hC4 * 4; x < hCount; ++x) {
+                dst[x] = src[hC4 * eP * 4 + (x % 4)];
+            }
+        }
+    }
+}
+
+void RecurrentGemm::run(float* C, const float* A, const float* packedB, bool accumulate, float* temp,
+                        int threadNumber) const {
+    const int units   = mUnits;
+    const size_t size = mTempSize;
+    threadNumber      = ALIMIN(threadNumber, units);
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        for (int u = (int)tId; u < units; u += threadNumber) {
+            onUnit(C, A, packedB, accumulate, temp + tId * size, u);
+        }
+    }
+    MNN_CONCURRENCY_END();
+}
+
+// x = sigmoid(x)
+static void _sigmoid(float* x, int size) {
+    MNNExp(x, x, size);
+    for (int i = 0; i < size; ++i) {
+        x[i] = 1.0f / (1.0f + x[i]);
+    }
+}
+
+// x = tanh(x) = 2 * sigmoid(2 * x) - 1
+static void _tanh(float* x, int size) {
+    for (int i = 0; i < size; ++i) {
+        x[i] = 2.0f * x[i];
+    }
+    MNNExp(x, x, size);
+    for (int i = 0; i < size; ++i) {
+        x[i] = 2.0f / (1.0f + x[i]) - 1.0f;
+    }
+}
+
+// gates: [r, z, n, h * whn + bhn], n = tanh(xn + r * (h * whn + bhn)), y = (1 - z) * n + z * h
+static void _gruCell(float* y, float* gates, const float* xg, const float* hg, const float* bx, const float* bh,
+                     const float* hPrev, int H) {
+    for (int j = 0; j < 2 * H; ++j) {
+        gates[j] = xg[j] + bx[j] + hg[j] + bh[j];
+    }
+    _sigmoid(gates, 2 * H);
+    auto r  = gates;
+    auto z  = gates + H;
+    auto n  = gates + 2 * H;
+    auto hn = gates + 3 * H;
+    for (int j = 0; j < H; ++j) {
+        hn[j] = hg[2 * H + j] + bh[2 * H + j];
+        n[j]  = xg[2 * H + j] + bx[2 * H + j] + r[j] * hn[j];
+    }
+    _tanh(n, H);
+    for (int j = 0; j < H; ++j) {
+        y[j] = n[j] + z[j] * (hPrev[j] - n[j]);
+    }
+}
+
+// gates: [i, f, g, o], c = f * c + i * g, y = o * tanh(c)
+static void _lstmCell(float* y, float* c, float* gates, const float* xg, const float* hg, const float* b,
+                      const float* cPrev, int H) {
+    for (int j = 0; j < 4 * H; ++j) {
+        gates[j] = xg[j] + b[j] + hg[j];
+    }
+    _sigmoid(gates, 2 * H);
+    _tanh(gates + 2 * H, H);
+    _sigmoid(gates + 3 * H, H);
+    auto i = gates;
+    auto f = gates + H;
+    auto g = gates + 2 * H;
+    auto o = gates + 3 * H;
+    for (int j = 0; j < H; ++j) {
+        c[j] = f[j] * cPrev[j] + i[j] * g[j];
+        y[j] = c[j];
+    }
+    _tanh(y, H);
+    for (int j = 0; j < H; ++j) {
+        y[j] = y[j] * o[j];
+    }
+}
+
+// Grads of the pre-activated gates, dh is y grad plus the carried hidden grad, which becomes dh * z
+static void _gruCellGrad(float* gx, float* gh, float* carry, const float* dy, const float* gates, const float* hPrev,
+                         int H) {
+    auto r  = gates;
+    auto z  = gates + H;
+    auto n  = gates + 2 * H;
+    auto hn = gates + 3 * H;
+    for (int j = 0; j < H; ++j) {
+        const float dh = dy[j] + carry[j];
+        const float dn = dh * (1.0f - z[j]) * (1.0f - n[j] * n[j]);
+        const float dr = dn * hn[j] * r[j] * (1.0f - r[j]);
+        const float dz = dh * (hPrev[j] - n[j]) * z[j] * (1.0f - z[j]);
+        gx[j]          = dr;
+        gx[H + j]      = dz;
+        gx[2 * H + j]  = dn;
+        gh[j]          = dr;
+        gh[H + j]      = dz;
+        gh[2 * H + j]  = dn * r[j];
+        carry[j]       = dh * z[j];
+    }
+}
+
+// Grads of the pre-activated gates, the carried cell grad becomes dc * f
+static void _lstmCellGrad(float* dg, const float* carryH, float* carryC, const float* dy, const float* dc,
+                          const float* gates, const float* c, const float* cPrev, float* tanhC, int H) {
+    ::memcpy(tanhC, c, H * sizeof(float));
+    _tanh(tanhC, H);
+    auto i = gates;
+    auto f = gates + H;
+    auto g = gates + 2 * H;
+    auto o = gates + 3 * H;
+    for (int j = 0; j < H; ++j) {
+        const float dh  = dy[j] + carryH[j];
+        const float tc  = tanhC[j];
+        const float dct = dc[j] + carryC[j] + dh * o[j] * (1.0f - tc * tc);
+        dg[j]           = dct * g[j] * i[j] * (1.0f - i[j]);
+        dg[H + j]       = dct * cPrev[j] * f[j] * (1.0f - f[j]);
+        dg[2 * H + j]   = dct * i[j] * (1.0f - g[j] * g[j]);
+        dg[3 * H + j]   = dh * tc * o[j] * (1.0f - o[j]);
+        carryC[j]       = dct * f[j];
+    }
+}
+
+// dst [cols] = sum of src [rows, cols] over rows, columns are split across threads four at a time
+static void _columnSum(float* dst, const float* src, int rows, int cols, int tId, int threadNumber) {
+    const int colC4 = UP_DIV(cols, 4);
+    for (int c = tId; c < colC4; c += threadNumber) {
+        const int start = c * 4;
+        if (start + 4 <= cols) {
+            Vec4 sum(0.0f);
+            for (int r = 0; r < rows; ++r) {
+                sum = sum + Vec4::load(src + (size_t)r * cols + start);
+            }
+            Vec4::save(dst + start, sum);
+            continue;
+        }
+        for (int k = start; k < cols; ++k) {
+            float sum = 0.0f;
+            for (int r = 0; r < rows; ++r) {
+                sum += src[(size_t)r * cols + k];
+            }
+            dst[k] = sum;
+        }
+    }
+}
+
+static bool _acquire(Backend* backend, std::shared_ptr<Tensor>& tensor, const std::vector<int>& shape) {
+    tensor.reset(Tensor::createDevice<float>(shape));
+    return backend->onAcquireBuffer(tensor.get(), Backend::DYNAMIC);
+}
+
+CPURecurrentSequence::CPURecurrentSequence(Backend* b, bool lstm) : Execution(b), mLSTM(lstm) {
+    // Do nothing
+}
+
+ErrorCode CPURecurrentSequence::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    const int T   = inputs[0]->length(0);
+    const int N   = inputs[0]->length(1);
+    const int I   = inputs[0]->length(2);
+    const int H   = inputs[2]->length(0);
+    const int GH  = (mLSTM ? 4 : 3) * H;
+    mThreadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    mInputGemm.setup(backend(), T * N, I, GH, false, mThreadNumber);
+    mHiddenGemm.setup(backend(), N, H, GH, false, mThreadNumber);
+    const int tempSize = (int)ALIMAX(mInputGemm.tempSize(), mHiddenGemm.tempSize());
+    bool res           = _acquire(backend(), mPackedWx, {(int)mInputGemm.packedSize()});
+    res = res && _acquire(backend(), mPackedWh, {(int)mHiddenGemm.packedSize()});
+    res = res && _acquire(backend(), mInputGates, {T * N, GH});
+    res = res && _acquire(backend(), mHiddenGates, {N, GH});
+    res = res && _acquire(backend(), mTemp, {mThreadNumber, tempSize});
+    if (!res) {
+        return OUT_OF_MEMORY;
+    }
+    for (auto t : {mPackedWx, mPackedWh, mInputGates, mHiddenGates, mTemp}) {
+        backend()->onReleaseBuffer(t.get(), Backend::DYNAMIC);
+    }
+    return NO_ERROR;
+}
+
+ErrorCode CPURecurrentSequence::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    const int T      = inputs[0]->length(0);
+    const int N      = inputs[0]->length(1);
+    const int H      = inputs[2]->length(0);
+    const int GH     = (mLSTM ? 4 : 3) * H;
+    const bool lstm  = mLSTM;
+    auto x           = inputs[0]->host<float>();
+    auto bias        = inputs[3]->host<float>();
+    auto h0          = inputs[4]->host<float>();
+    auto c0          = lstm ? inputs[5]->host<float>() : nullptr;
+    auto y           = outputs[0]->host<float>();
+    auto cell        = lstm ? outputs[1]->host<float>() : nullptr;
+    auto reserve     = outputs[outputs.size() - 1]->host<float>();
+    auto packedWx    = mPackedWx->host<float>();
+    auto packedWh    = mPackedWh->host<float>();
+    auto inputGates  = mInputGates->host<float>();
+    auto hiddenGates = mHiddenGates->host<float>();
+    auto temp        = mTemp->host<float>();
+    // The bias of h is only separated for GRU
+    auto bh = lstm ? nullptr : bias + GH;
+
+    mInputGemm.packB(packedWx, inputs[1]->host<float>(), false);
+    mHiddenGemm.packB(packedWh, inputs[2]->host<float>(), false);
+    mInputGemm.run(inputGates, x, packedWx, false, temp, mThreadNumber);
+    const int threadNumber = ALIMIN(mThreadNumber, N);
+    for (int t = 0; t < T; ++t) {
+        auto hPrev = 0 == t ? h0 : y + (size_t)(t - 1) * N * H;
+        auto cPrev = (0 == t || !lstm) ? c0 : cell + (size_t)(t - 1) * N * H;
+        mHiddenGemm.run(hiddenGates, hPrev, packedWh, false, temp, mThreadNumber);
+        MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+            for (int n = (int)tId; n < N; n += threadNumber) {
+                const size_t row = (size_t)t * N + n;
+                if (lstm) {
+                    _lstmCell(y + row * H, cell + row * H, reserve + row * 4 * H, inputGates + row * GH,
+                              hiddenGates + n * GH, bias, cPrev + n * H, H);
+                } else {
+                    _gruCell(y + row * H, reserve + row * 4 * H, inputGates + row * GH, hiddenGates + n * GH, bias,
+                             bh, hPrev + n * H, H);
+                }
+            }
+        }
+        MNN_CONCURRENCY_END();
+    }
+    return NO_ERROR;
+}
+
+CPURecurrentSequenceGrad::CPURecurrentSequenceGrad(Backend* b, bool lstm) : Execution(b), mLSTM(lstm) {
+    // Do nothing
+}
+
+ErrorCode CPURecurrentSequenceGrad::onResize(const std::vector<Tensor*>& inputs,
+                                             const std::vector<Tensor*>& outputs) {
+    const int T   = inputs[0]->length(0);
+    const int N   = inputs[0]->length(1);
+    const int I   = inputs[0]->length(2);
+    const int H   = inputs[2]->length(0);
+    const int GH  = (mLSTM ? 4 : 3) * H;
+    mThreadNumber = static_cast<CPUBackend*>(backend())->threadNumber();
+    mHiddenGemm.setup(backend(), N, GH, H, false, mThreadNumber);
+    mInputGemm.setup(backend(), T * N, GH, I, false, mThreadNumber);
+    mInputWeightGemm.setup(backend(), I, T * N, GH, true, mThreadNumber);
+    mHiddenWeightGemm.setup(backend(), H, T * N, GH, true, mThreadNumber);
+    size_t tempSize = H;
+    for (auto gemm : {&mHiddenGemm, &mInputGemm, &mInputWeightGemm, &mHiddenWeightGemm}) {
+        tempSize = ALIMAX(tempSize, gemm->tempSize());
+    }
+    const int packedSize = (int)ALIMAX(mInputWeightGemm.packedSize(), mHiddenWeightGemm.packedSize());
+    bool res             = _acquire(backend(), mPackedWhT, {(int)mHiddenGemm.packedSize()});
+    res = res && _acquire(backend(), mPackedWxT, {(int)mInputGemm.packedSize()});
+    res = res && _acquire(backend(), mPackedGrad, {packedSize});
+    res = res && _acquire(backend(), mInputGatesGrad, {T * N, GH});
+    res = res && _acquire(backend(), mHiddenPrev, {T * N, H});
+    res = res && _acquire(backend(), mTemp, {mThreadNumber, (int)tempSize});
+    if (mLSTM) {
+        mHiddenGatesGrad = mInputGatesGrad;
+    } else {
+        res = res && _acquire(backend(), mHiddenGatesGrad, {T * N, GH});
+    }
+    if (!res) {
+        return OUT_OF_MEMORY;
+    }
+    for (auto t : {mPackedWhT, mPackedWxT, mPackedGrad, mInputGatesGrad, mHiddenPrev, mTemp}) {
+        backend()->onReleaseBuffer(t.get(), Backend::DYNAMIC);
+    }
+    if (!mLSTM) {
+        backend()->onReleaseBuffer(mHiddenGatesGrad.get(), Backend::DYNAMIC);
+    }
+    return NO_ERROR;
+}
+
+ErrorCode CPURecurrentSequenceGrad::onExecute(const std::vector<Tensor*>& inputs,
+                                              const std::vector<Tensor*>& outputs) {
+    const int T         = inputs[0]->length(0);
+    const int N         = inputs[0]->length(1);
+    const int H         = inputs[2]->length(0);
+    const int GH        = (mLSTM ? 4 : 3) * H;
+    const bool lstm     = mLSTM;
+    auto x              = inputs[0]->host<float>();
+    auto h0             = inputs[4]->host<float>();
+    auto c0             = lstm ? inputs[5]->host<float>() : nullptr;
+    auto y              = inputs[lstm ? 6 : 5]->host<float>();
+    auto cell           = lstm ? inputs[7]->host<float>() : nullptr;
+    auto reserve        = inputs[lstm ? 8 : 6]->host<float>();
+    auto yGrad          = inputs[lstm ? 9 : 7]->host<float>();
+    auto cellGrad       = lstm ? inputs[10]->host<float>() : nullptr;
+    auto hGrad          = outputs[4]->host<float>();
+    auto cGrad          = lstm ? outputs[5]->host<float>() : nullptr;
+    auto packedWhT      = mPackedWhT->host<float>();
+    auto packedWxT      = mPackedWxT->host<float>();
+    auto packedGrad     = mPackedGrad->host<float>();
+    auto inputGateGrad  = mInputGatesGrad->host<float>();
+    auto hiddenGateGrad = mHiddenGatesGrad->host<float>();
+    auto hiddenPrev     = mHiddenPrev->host<float>();
+    auto temp           = mTemp->host<float>();
+    const size_t tempSize = mTemp->length(1);
+
+    // Grads of h0 and c0 carry the hidden and cell grads from the next step
+    ::memset(hGrad, 0, N * H * sizeof(float));
+    if (lstm) {
+        ::memset(cGrad, 0, N * H * sizeof(float));
+    }
+    mHiddenGemm.packB(packedWhT, inputs[2]->host<float>(), true);
+    int threadNumber = ALIMIN(mThreadNumber, N);
+    for (int t = T - 1; t >= 0; --t) {
+        auto hPrev = 0 == t ? h0 : y + (size_t)(t - 1) * N * H;
+        auto cPrev = (0 == t || !lstm) ? c0 : cell + (size_t)(t - 1) * N * H;
+        MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+            for (int n = (int)tId; n < N; n += threadNumber) {
+                const size_t row = (size_t)t * N + n;
+                if (lstm) {
+                    _lstmCellGrad(inputGateGrad + row * GH, hGrad + n * H, cGrad + n * H, yGrad + row * H,
+                                  cellGrad + row * H, reserve + row * 4 * H, cell + row * H, cPrev + n * H,
+                                  temp + tId * tempSize, H);
+                } else {
+                    _gruCellGrad(inputGateGrad + row * GH, hiddenGateGrad + row * GH, hGrad + n * H, yGrad + row * H,
+                                 reserve + row * 4 * H, hPrev + n * H, H);
+                }
+            }
+        }
+        MNN_CONCURRENCY_END();
+        // LSTM carries no hidden grad by element, GRU accumulates to dh * z
+        mHiddenGemm.run(hGrad, hiddenGateGrad + (size_t)t * N * GH, packedWhT, !lstm, temp, mThreadNumber);
+    }
+
+    // Bias grads, the bias of h is only separated for GRU
+    auto biasGrad = outputs[3]->host<float>();
+    threadNumber  = ALIMIN(mThreadNumber, UP_DIV(GH, 4));
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        _columnSum(biasGrad, inputGateGrad, T * N, GH, (int)tId, threadNumber);
+        if (!lstm) {
+            _columnSum(biasGrad + GH, hiddenGateGrad, T * N, GH, (int)tId, threadNumber);
+        }
+    }
+    MNN_CONCURRENCY_END();
+
+    // wx grad = x^T * input gate grads, wh grad = [h0, y[0 : T - 1]]^T * hidden gate grads
+    mInputWeightGemm.packB(packedGrad, inputGateGrad, false);
+    mInputWeightGemm.run(outputs[1]->host<float>(), x, packedGrad, false, temp, mThreadNumber);
+    ::memcpy(hiddenPrev, h0, N * H * sizeof(float));
+    ::memcpy(hiddenPrev + N * H, y, (size_t)(T - 1) * N * H * sizeof(float));
+    mHiddenWeightGemm.packB(packedGrad, hiddenGateGrad, false);
+    mHiddenWeightGemm.run(outputs[2]->host<float>(), hiddenPrev, packedGrad, false, temp, mThreadNumber);
+    // x grad = input gate grads * wx^T
+    mInputGemm.packB(packedWxT, inputs[1]->host<float>(), true);
+    mInputGemm.run(outputs[0]->host<float>(), inputGateGrad, packedWxT, false, temp, mThreadNumber);
+    return NO_ERROR;
+}
+
+class CPURecurrentSequenceCreator : public CPUBackend::Creator {
+public:
+    virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
+                                const MNN::Op* op, Backend* backend) const override {
+        const bool lstm = op->type() == OpType_LSTMSequence || op->type() == OpType_LSTMSequenceGrad;
+        if (op->type() == OpType_GRUSequenceGrad || op->type() == OpType_LSTMSequenceGrad) {
+            return new CPURecurrentSequenceGrad(backend, lstm);
+        }
+        return new CPURecurrentSequence(backend, lstm);
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPURecurrentSequenceCreator, OpType_GRUSequence);
+REGISTER_CPU_OP_CREATOR(CPURecurrentSequenceCreator, OpType_GRUSequenceGrad);
+REGISTER_CPU_OP_CREATOR(CPURecurrentSequenceCreator, OpType_LSTMSequence);
+REGISTER_CPU_OP_CREATOR(CPURecurrentSequenceCreator, OpType_LSTMSequenceGrad);
+} // namespace MNN
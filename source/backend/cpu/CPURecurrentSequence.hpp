@@ -0,0 +1,107 @@
+//
+//  CPURecurrentSequence.hpp
+//  MNN
+//
+//  Created by MNN on 2021/01/04.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPURecurrentSequence_hpp
+#define CPURecurrentSequence_hpp
+
+#include "core/Execution.hpp"
+
+namespace MNN {
+
+/**
+ C [e, h] (+)= A [e, l] x B [l, h] on the packed matmul kernel, A is [l, e] if transposed. B is packed once by packB and
+ reused for every call, e.g. the recurrent weight by all time steps. Work is split into units of (e tile, h block).
+ */
+class RecurrentGemm {
+public:
+    void setup(Backend* backend, int e, int l, int h, bool transposeA, int threadNumber);
+    // Size of packed B in float
+    size_t packedSize() const;
+    // Temp memory of each thread in float
+    size_t tempSize() const {
+        return mTempSize;
+    }
+    // B is [l, h], or [h, l] if transposeB
+    void packB(float* dst, const float* B, bool transposeB) const;
+    void run(float* C, const float* A, const float* packedB, bool accumulate, float* temp, int threadNumber) const;
+
+private:
+    Backend* backend() const {
+        return mBackend;
+    }
+    void onUnit(float* C, const float* A, const float* packedB, bool accumulate, float* temp, int unit) const;
+    Backend* mBackend = nullptr;
+    int mE = 0;
+    int mL = 0;
+    int mH = 0;
+    bool mTransposeA = false;
+    int mHBlocks = 1;
+    int mHBlockSize = 0;
+    int mUnits = 0;
+    size_t mTempSize = 0;
+};
+
+/**
+ GRU / LSTM over a whole time major sequence. Input gates of all steps are computed by one GEMM, each step then computes
+ the recurrent gates of the whole batch by one GEMM with the packed hidden weight and applies the cell. The activated
+ gates are saved to reserve for backward.
+ */
+class CPURecurrentSequence : public Execution {
+public:
+    CPURecurrentSequence(Backend *b, bool lstm);
+    virtual ~CPURecurrentSequence() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    bool mLSTM;
+    int mThreadNumber = 1;
+    RecurrentGemm mInputGemm;
+    RecurrentGemm mHiddenGemm;
+    std::shared_ptr<Tensor> mPackedWx;
+    std::shared_ptr<Tensor> mPackedWh;
+    // Input gates [T * N, G * H] and recurrent gates of one step [N, G * H]
+    std::shared_ptr<Tensor> mInputGates;
+    std::shared_ptr<Tensor> mHiddenGates;
+    std::shared_ptr<Tensor> mTemp;
+};
+
+/**
+ Backward of CPURecurrentSequence in reverse time. Each step computes the gate grads of the whole batch and propagates
+ the hidden grad by one GEMM with the transposed hidden weight. The weight grads and the input grad are computed by one
+ GEMM each over all steps at the end.
+ */
+class CPURecurrentSequenceGrad : public Execution {
+public:
+    CPURecurrentSequenceGrad(Backend *b, bool lstm);
+    virtual ~CPURecurrentSequenceGrad() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    bool mLSTM;
+    int mThreadNumber = 1;
+    RecurrentGemm mHiddenGemm;
+    RecurrentGemm mInputGemm;
+    RecurrentGemm mInputWeightGemm;
+    RecurrentGemm mHiddenWeightGemm;
+    std::shared_ptr<Tensor> mPackedWhT;
+    std::shared_ptr<Tensor> mPackedWxT;
+    // Packed gate grads as B of weight grads
+    std::shared_ptr<Tensor> mPackedGrad;
+    // Grads of input gates and recurrent gates [T * N, G * H], they are the same for LSTM
+    std::shared_ptr<Tensor> mInputGatesGrad;
+    std::shared_ptr<Tensor> mHiddenGatesGrad;
+    // h0 and y of the first T - 1 steps, [T * N, H]
+    std::shared_ptr<Tensor> mHiddenPrev;
+    std::shared_ptr<Tensor> mTemp;
+};
+
+} // namespace MNN
+
+#endif /* CPURecurrentSequence_hpp */
@@ -13,90 +13,274 @@
 #include "core/Macro.h"
 #include <cmath>
 #include <algorithm>
+#include <limits>
 #include "core/OpCommonUtils.hpp"
-#define UNIT 4
-#define UNIT_DUP(value) \
-    { (value), (value), (value), (value) }
+#include "math/Vec.hpp"
+// Floats of inside reduced together by one unit
+#define REDUCE_TILE 32
+// Rows of axis accumulated before combined with the total
+#define REDUCE_AXIS_BLOCK 128
+// Continuous rows longer than this are split in half
+#define REDUCE_ROW_BLOCK 256
+// Min length of axis for one thread when axis is split
+#define REDUCE_MIN_AXIS_CHUNK 256
 
 namespace MNN {
+using Vec4 = Math::Vec<float, 4>;
+
+struct ReduceSumOp {
+    static float identity() {
+        return 0.0f;
+    }
+    static float reduce(float a, float b) {
+        return a + b;
+    }
+    static Vec4 reduce(Vec4 a, Vec4 b) {
+        return a + b;
+    }
+};
+
+struct ReduceMaxOp {
+    static float identity() {
+        return std::numeric_limits<float>::lowest();
+    }
+    static float reduce(float a, float b) {
+        return std::max(a, b);
+    }
+    static Vec4 reduce(Vec4 a, Vec4 b) {
+        return Vec4::max(a, b);
+    }
+};
+
+struct ReduceMinOp {
+    static float identity() {
+        return std::numeric_limits<float>::max();
+    }
+    static float reduce(float a, float b) {
+        return std::min(a, b);
+    }
+    static Vec4 reduce(Vec4 a, Vec4 b) {
+        return Vec4::min(a, b);
+    }
+};
+
+// Pairwise reduce of a continuous row, so the rounding error of sum grows with log(count) instead of count
+template <typename Op>
+static float _reduceRow(const float* src, int count) {
+    if (count > REDUCE_ROW_BLOCK) {
+        int half = count / 2 / 16 * 16;
+        return Op::reduce(_reduceRow<Op>(src, half), _reduceRow<Op>(src + half, count - half));
+    }
+    Vec4 acc0(Op::identity()), acc1(Op::identity()), acc2(Op::identity()), acc3(Op::identity());
+    int i = 0;
+    for (; i + 15 < count; i += 16) {
+        acc0 = Op::reduce(acc0, Vec4::load(src + i));
+        acc1 = Op::reduce(acc1, Vec4::load(src + i + 4));
+        acc2 = Op::reduce(acc2, Vec4::load(src + i + 8));
+        acc3 = Op::reduce(acc3, Vec4::load(src + i + 12));
+    }
+    for (; i + 3 < count; i += 4) {
+        acc0 = Op::reduce(acc0, Vec4::load(src + i));
+    }
+    acc0         = Op::reduce(Op::reduce(acc0, acc1), Op::reduce(acc2, acc3));
+    float result = Op::reduce(Op::reduce(acc0[0], acc0[1]), Op::reduce(acc0[2], acc0[3]));
+    for (; i < count; ++i) {
+        result = Op::reduce(result, src[i]);
+    }
+    return result;
+}
+
+// Reduce axisCount rows of a tile of count (<= REDUCE_TILE) floats, vectorized across inside. Rows are accumulated in
+// blocks of REDUCE_AXIS_BLOCK before added to the total, as a two level pairwise sum
+template <typename Op>
+static void _reduceTile(const float* src, float* dst, int axisCount, int inside, int count, float scale) {
+    const int countC4 = count / 4;
+    const int remain  = count % 4;
+    Vec4 total[REDUCE_TILE / 4];
+    float totalRemain[3];
+    for (int j = 0; j < countC4; ++j) {
+        total[j] = Vec4(Op::identity());
+    }
+    for (int j = 0; j < remain; ++j) {
+        totalRemain[j] = Op::identity();
+    }
+    for (int aStart = 0; aStart < axisCount; aStart += REDUCE_AXIS_BLOCK) {
+        const int aEnd = ALIMIN(aStart + REDUCE_AXIS_BLOCK, axisCount);
+        Vec4 block[REDUCE_TILE / 4];
+        float blockRemain[3];
+        for (int j = 0; j < countC4; ++j) {
+            block[j] = Vec4(Op::identity());
+        }
+        for (int j = 0; j < remain; ++j) {
+            blockRemain[j] = Op::identity();
+        }
+        for (int a = aStart; a < aEnd; ++a) {
+            auto srcA = src + a * inside;
+            for (int j = 0; j < countC4; ++j) {
+                block[j] = Op::reduce(block[j], Vec4::load(srcA + 4 * j));
+            }
+            for (int j = 0; j < remain; ++j) {
+                blockRemain[j] = Op::reduce(blockRemain[j], srcA[countC4 * 4 + j]);
+            }
+        }
+        for (int j = 0; j < countC4; ++j) {
+            total[j] = Op::reduce(total[j], block[j]);
+        }
+        for (int j = 0; j < remain; ++j) {
+            totalRemain[j] = Op::reduce(totalRemain[j], blockRemain[j]);
+        }
+    }
+    for (int j = 0; j < countC4; ++j) {
+        Vec4::save(dst + 4 * j, total[j] * scale);
+    }
+    for (int j = 0; j < remain; ++j) {
+        dst[countC4 * 4 + j] = totalRemain[j] * scale;
+    }
+}
+
 // outside, axis, inside
 
 class Reduction : public Execution {
 public:
-    Reduction(Backend* backend, const Op* op) : Execution(backend) {
+    Reduction(Backend* backend, const Op* op, bool vectorize = false) : Execution(backend), mVectorize(vectorize) {
         // Do nothing
         mAxis = op->main_as_ReductionParam()->dim()->data()[0];
     }
     virtual ~Reduction() = default;
 
+    virtual ErrorCode onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) override {
+        auto input = inputs[0];
+        mOutside   = 1;
+        for (int i = 0; i < mAxis; ++i) {
+            mOutside *= input->length(i);
+        }
+        mInside = 1;
+        for (int i = mAxis + 1; i < input->dimensions(); ++i) {
+            mInside *= input->length(i);
+        }
+        mAxisSize = input->length(mAxis);
+        if (!mVectorize || halide_type_float != input->getType().code) {
+            return NO_ERROR;
+        }
+        // Units are (outside, inside tile, axis chunk), axis is split only when the others can't feed all threads
+        auto numberThread = ((CPUBackend*)backend())->threadNumber();
+        mInsideTiles      = mInside == 1 ? 1 : UP_DIV(mInside, REDUCE_TILE);
+        const int units   = mOutside * mInsideTiles;
+        int axisSplit     = 1;
+        if (units < numberThread) {
+            axisSplit = ALIMAX(1, ALIMIN(UP_DIV(numberThread, units), mAxisSize / REDUCE_MIN_AXIS_CHUNK));
+        }
+        mAxisChunk = ALIMAX(1, UP_DIV(mAxisSize, axisSplit));
+        mAxisSplit = UP_DIV(mAxisSize, mAxisChunk);
+        if (mAxisSplit > 1) {
+            mPartial.reset(Tensor::createDevice<float>({mAxisSplit, mOutside * mInside}));
+            auto res = backend()->onAcquireBuffer(mPartial.get(), Backend::DYNAMIC);
+            if (!res) {
+                return OUT_OF_MEMORY;
+            }
+            backend()->onReleaseBuffer(mPartial.get(), Backend::DYNAMIC);
+        }
+        return NO_ERROR;
+    }
+
     virtual ErrorCode onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) override {
         auto input  = inputs[0];
         auto output = outputs[0];
         auto typeCode = input->getType().code;
         auto src = inputs[0];
-        int outside = 1;
-        for(int i=0; i<mAxis; ++i) {
-            outside *= input->length(i);
-        }
-        int inside = 1;
-        for(int i=mAxis+1; i<input->dimensions(); ++i) {
-            inside *= input->length(i);
-        }
-        auto axis = input->length(mAxis);
         auto dst = output;
         //MNN_ASSERT(output->elementSize() == inside * outside);
         if (halide_type_float == typeCode) {
-            this->onReduce(src->host<float>(), dst->host<float>(), inside, outside, axis);
+            this->onReduce(src->host<float>(), dst->host<float>(), mInside, mOutside, mAxisSize);
         } else if (halide_type_int == typeCode) {
-            this->onReduce(src->host<int32_t>(), dst->host<int32_t>(), inside, outside, axis);
+            this->onReduce(src->host<int32_t>(), dst->host<int32_t>(), mInside, mOutside, mAxisSize);
         }
         return NO_ERROR;
     }
 protected:
     virtual void onReduce(const float* src, float* dst, int inside, int outside, int axis) const     = 0;
     virtual void onReduce(const int32_t* src, int32_t* dst, int inside, int outsize, int axis) const = 0;
+
+    // Vectorized reduce for float, only valid if created with vectorize
+    template <typename Op>
+    void reduceFloat(const float* src, float* dst, int inside, int outside, int axisSize, float scale) const {
+        auto numberThread    = ((CPUBackend*)backend())->threadNumber();
+        const int insideTiles = mInsideTiles;
+        const int axisSplit  = mAxisSplit;
+        const int axisChunk  = mAxisChunk;
+        const int total      = outside * inside;
+        float* partial       = axisSplit > 1 ? mPartial->host<float>() : nullptr;
+        const int unitNumber = outside * insideTiles * axisSplit;
+        MNN_CONCURRENCY_BEGIN(tId, numberThread) {
+            for (int u = (int)tId; u < unitNumber; u += numberThread) {
+                int chunk   = u % axisSplit;
+                int tile    = (u / axisSplit) % insideTiles;
+                int oi      = u / axisSplit / insideTiles;
+                int aStart  = chunk * axisChunk;
+                int aCount  = ALIMIN(axisChunk, axisSize - aStart);
+                auto srcO   = src + oi * axisSize * inside + aStart * inside;
+                auto target = nullptr == partial ? dst + oi * inside : partial + chunk * total + oi * inside;
+                auto s      = nullptr == partial ? scale : 1.0f;
+                if (1 == inside) {
+                    target[0] = _reduceRow<Op>(srcO, aCount) * s;
+                } else {
+                    int iStart = tile * REDUCE_TILE;
+                    _reduceTile<Op>(srcO + iStart, target + iStart, aCount, inside,
+                                    ALIMIN(REDUCE_TILE, inside - iStart), s);
+                }
+            }
+        }
+        MNN_CONCURRENCY_END();
+        if (nullptr == partial) {
+            return;
+        }
+        // Combine the partial results of the axis chunks as a binary tree, each thread owns a range of outputs
+        const int step = ALIGN_UP4(UP_DIV(total, numberThread));
+        MNN_CONCURRENCY_BEGIN(tId, numberThread) {
+            const int start = (int)tId * step;
+            const int end   = ALIMIN(start + step, total);
+            for (int stride = 1; stride < axisSplit; stride *= 2) {
+                for (int c = 0; c + stride < axisSplit; c += 2 * stride) {
+                    auto left  = partial + c * total;
+                    auto right = partial + (c + stride) * total;
+                    int i      = start;
+                    for (; i + 3 < end; i += 4) {
+                        Vec4::save(left + i, Op::reduce(Vec4::load(left + i), Vec4::load(right + i)));
+                    }
+                    for (; i < end; ++i) {
+                        left[i] = Op::reduce(left[i], right[i]);
+                    }
+                }
+            }
+            for (int i = start; i < end; ++i) {
+                dst[i] = partial[i] * scale;
+            }
+        }
+        MNN_CONCURRENCY_END();
+    }
+
 private:
     int mAxis = -1;
+    bool mVectorize;
+    int mOutside     = 1;
+    int mInside      = 1;
+    int mAxisSize    = 1;
+    int mInsideTiles = 1;
+    int mAxisSplit   = 1;
+    int mAxisChunk   = 1;
+    std::shared_ptr<Tensor> mPartial;
 };
 
 class MeanReduce : public Reduction {
 public:
-    MeanReduce(Backend* backend, const Op* op) : Reduction(backend, op) {
+    MeanReduce(Backend* backend, const Op* op) : Reduction(backend, op, true) {
         // nothing to do
     }
     virtual ~MeanReduce() = default;
 
 protected:
     virtual void onReduce(const float* src, float* dst, int inside, int outside, int axisSize) const override {
-        auto numberThread = ((CPUBackend*)backend())->threadNumber();
-        MNN_CONCURRENCY_BEGIN(tId, numberThread) {
-            for (int oi = tId; oi < outside; oi+=numberThread) {
-                auto srcOutSide = src + oi * axisSize * inside;
-                auto dstOutSide = dst + oi * inside;
-                if (inside % 4 == 0) {
-                    ::memcpy(dstOutSide, srcOutSide, inside * sizeof(float));
-                    for (int a = 1; a < axisSize; ++a) {
-                        auto srcAxis = srcOutSide + a * inside;
-                        MNNMatrixAddCommon(dstOutSide, dstOutSide, srcAxis, inside, 0, 0, 0, 1);
-                    }
-                    float divide = 1.0f / (float)axisSize;
-                    for (int i=0; i<inside; ++i) {
-                        dstOutSide[i] = dstOutSide[i] * divide;
-                    }
-                } else {
-                    for (int ii = 0; ii < inside; ++ii) {
-                        auto srcInside = srcOutSide + ii;
-                        auto dstInside = dstOutSide + ii;
-                        float summer   = 0.0f;
-                        for (int a = 0; a < axisSize; ++a) {
-                            summer += srcInside[a * inside];
-                        }
-                        *dstInside = summer / (float)axisSize;
-                    }
-                }
-            }
-        }
-        MNN_CONCURRENCY_END();
+        reduceFloat<ReduceSumOp>(src, dst, inside, outside, axisSize, 1.0f / (float)axisSize);
     }
 
     virtual void onReduce(const int32_t* src, int32_t* dst, int inside, int outside, int axisSize) const override {
@@ -118,38 +302,14 @@ protected:
 
 class SumReduce : public Reduction {
 public:
-    SumReduce(Backend* backend, const Op* op) : Reduction(backend, op) {
+    SumReduce(Backend* backend, const Op* op) : Reduction(backend, op, true) {
         // nothing to do
     }
     virtual ~SumReduce() = default;
 
 protected:
     virtual void onReduce(const float* src, float* dst, int inside, int outside, int axisSize) const override {
-        auto numberThread = ((CPUBackend*)backend())->threadNumber();
-        MNN_CONCURRENCY_BEGIN(tId, numberThread) {
-            for (int oi = tId; oi < outside; oi+=numberThread) {
-                auto srcOutSide = src + oi * axisSize * inside;
-                auto dstOutSide = dst + oi * inside;
-                if (inside % 4 == 0) {
-                    ::memcpy(dstOutSide, srcOutSide, inside * sizeof(float));
-                    for (int a = 1; a < axisSize; ++a) {
-                        auto srcAxis = srcOutSide + a * inside;
-                        MNNMatrixAddCommon(dstOutSide, dstOutSide, srcAxis, inside, 0, 0, 0, 1);
-                    }
-                } else {
-                    for (int ii = 0; ii < inside; ++ii) {
-                        auto srcInside = srcOutSide + ii;
-                        auto dstInside = dstOutSide + ii;
-                        float summer   = 0.0f;
-                        for (int a = 0; a < axisSize; ++a) {
-                            summer += srcInside[a * inside];
-                        }
-                        *dstInside = summer;
-                    }
-                }
-            }
-        }
-        MNN_CONCURRENCY_END();
+        reduceFloat<ReduceSumOp>(src, dst, inside, outside, axisSize, 1.0f);
     }
 
     virtual void onReduce(const int32_t* src, int32_t* dst, int inside, int outside, int axisSize) const override {
@@ -171,44 +331,14 @@ protected:
 
 class MinReduce : public Reduction {
 public:
-    MinReduce(Backend* backend, const Op* op) : Reduction(backend, op) {
+    MinReduce(Backend* backend, const Op* op) : Reduction(backend, op, true) {
         // nothing to do
     }
     virtual ~MinReduce() = default;
 
 protected:
     virtual void onReduce(const float* src, float* dst, int inside, int outside, int axisSize) const override {
-        for (int oi = 0; oi < outside; ++oi) {
-            auto srcOutSide = src + oi * axisSize * inside;
-            auto dstOutSide = dst + oi * inside;
-            for (int ii = 0; ii < inside; ++ii) {
-                auto srcInside = srcOutSide + ii;
-                auto dstInside = dstOutSide + ii;
-                float Min      = srcInside[0];
-                if (1 == inside) {
-                    int32_t inputCountUnit = axisSize / (UNIT * 2);
-                    int32_t remain         = axisSize - (inputCountUnit * UNIT * 2);
-                    float minArray[UNIT]   = UNIT_DUP(Min);
-                    MNNMinFloat((float*)srcInside, minArray, inputCountUnit);
-
-                    for (int i = 0; i < UNIT; i++) {
-                        Min = std::min(Min, minArray[i]);
-                    }
-                    if (remain > 0) {
-                        int currentIndex = inputCountUnit * UNIT * 2;
-                        for (int i = 0; i < remain; i++) {
-                            float currentInputData = srcInside[currentIndex + i];
-                            Min                    = std::min(Min, currentInputData);
-                        }
-                    }
-                } else {
-                    for (int a = 0; a < axisSize; ++a) {
-                        Min = std::min(Min, srcInside[a * inside]);
-                    }
-                }
-                *dstInside = Min;
-            }
-        }
+        reduceFloat<ReduceMinOp>(src, dst, inside, outside, axisSize, 1.0f);
     }
 
     virtual void onReduce(const int32_t* src, int32_t* dst, int inside, int outside, int axisSize) const override {
@@ -230,45 +360,14 @@ protected:
 
 class MaxReduce : public Reduction {
 public:
-    MaxReduce(Backend* backend, const Op* op) : Reduction(backend, op) {
+    MaxReduce(Backend* backend, const Op* op) : Reduction(backend, op, true) {
         // nothing to do
     }
     virtual ~MaxReduce() = default;
 
 protected:
     virtual void onReduce(const float* src, float* dst, int inside, int outside, int axisSize) const override {
-        for (int oi = 0; oi < outside; ++oi) {
-            auto srcOutSide = src + oi * axisSize * inside;
-            auto dstOutSide = dst + oi * inside;
-            for (int ii = 0; ii < inside; ++ii) {
-                auto srcInside = srcOutSide + ii;
-                auto dstInside = dstOutSide + ii;
-                float Max      = srcInside[0];
-                if (1 == inside) {
-                    int32_t inputCountUnit = axisSize / (UNIT * 2);
-                    int32_t remain         = axisSize - (inputCountUnit * UNIT * 2);
-                    float maxArray[UNIT]   = UNIT_DUP(Max);
-
-                    MNNMaxFloat((float*)srcInside, maxArray, inputCountUnit);
-
-                    for (int i = 0; i < UNIT; i++) {
-                        Max = std::max(Max, maxArray[i]);
-                    }
-                    if (remain > 0) {
-                        int currentIndex = inputCountUnit * UNIT * 2;
-                        for (int i = 0; i < remain; i++) {
-                            float currentInputData = srcInside[currentIndex + i];
-                            Max                    = std::max(Max, currentInputData);
-                        }
-                    }
-                } else {
-                    for (int a = 0; a < axisSize; ++a) {
-                        Max = std::max(Max, srcInside[a * inside]);
-                    }
-                }
-                *dstInside = Max;
-            }
-        }
+        reduceFloat<ReduceMaxOp>(src, dst, inside, outside, axisSize, 1.0f);
     }
 
     virtual void onReduce(const int32_t* src, int32_t* dst, int inside, int outside, int axisSize) const override {
@@ -0,0 +1,341 @@
+//
+//  CPUSoftmaxCrossEntropy.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/07.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/CPUSoftmaxCrossEntropy.hpp"
+#include <math.h>
+#include "backend/cpu/CPUBackend.hpp"
+#include "backend/cpu/compute/CommonOptFunction.h"
+#include "core/Concurrency.h"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+#include "math/Vec.hpp"
+
+namespace MNN {
+using Vec4 = Math::Vec<float, 4>;
+
+static float _rowMax(const float* src, int size) {
+    float maxValue = src[0];
+    int c          = 0;
+    if (size >= 4) {
+        auto maxV = Vec4::load(src);
+        for (c = 4; c + 3 < size; c += 4) {
+            maxV = Vec4::max(maxV, Vec4::load(src + c));
+        }
+        maxValue = std::max(std::max(maxV[0], maxV[1]), std::max(maxV[2], maxV[3]));
+    }
+    for (; c < size; ++c) {
+        maxValue = std::max(maxValue, src[c]);
+    }
+    return maxValue;
+}
+
+static float _rowSum(const float* src, int size) {
+    Vec4 sumV(0.0f);
+    int c = 0;
+    for (; c + 3 < size; c += 4) {
+        sumV = sumV + Vec4::load(src + c);
+    }
+    float sumValue = (sumV[0] + sumV[1]) + (sumV[2] + sumV[3]);
+    for (; c < size; ++c) {
+        sumValue += src[c];
+    }
+    return sumValue;
+}
+
+static float _rowDot(const float* a, const float* b, int size) {
+    Vec4 sumV(0.0f);
+    int c = 0;
+    for (; c + 3 < size; c += 4) {
+        sumV = sumV + Vec4::load(a + c) * Vec4::load(b + c);
+    }
+    float sumValue = (sumV[0] + sumV[1]) + (sumV[2] + sumV[3]);
+    for (; c < size; ++c) {
+        sumValue += a[c] * b[c];
+    }
+    return sumValue;
+}
+
+// cache = exp(x - max), return max. cache must be aligned for MNNExp
+static float _rowExp(const float* src, float* cache, int size) {
+    auto maxValue = _rowMax(src, size);
+    Vec4 maxV(maxValue);
+    int c = 0;
+    for (; c + 3 < size; c += 4) {
+        Vec4::save(cache + c, maxV - Vec4::load(src + c));
+    }
+    for (; c < size; ++c) {
+        cache[c] = maxValue - src[c];
+    }
+    // MNNExp compute exp(-x)
+    MNNExp(cache, cache, size);
+    return maxValue;
+}
+
+static void _logSoftmaxRow(const float* src, float* dst, float* cache, int size) {
+    auto maxValue = _rowExp(src, cache, size);
+    auto offset   = maxValue + logf(_rowSum(cache, size));
+    Vec4 offsetV(offset);
+    int c = 0;
+    for (; c + 3 < size; c += 4) {
+        Vec4::save(dst + c, Vec4::load(src + c) - offsetV);
+    }
+    for (; c < size; ++c) {
+        dst[c] = src[c] - offset;
+    }
+}
+
+// Reduce along channel for each inside position, cache has 3 * ALIGN_UP4(inside) floats
+static void _logSoftmaxInside(const float* src, float* dst, float* cache, int channel, int inside) {
+    // MNNExp needs aligned dst, so exp is computed in cache instead of the rows of dst
+    auto maxValue = cache;
+    auto sumValue = cache + ALIGN_UP4(inside);
+    auto expValue = sumValue + ALIGN_UP4(inside);
+    ::memcpy(maxValue, src, inside * sizeof(float));
+    for (int c = 1; c < channel; ++c) {
+        auto srcC = src + c * inside;
+        int x     = 0;
+        for (; x + 3 < inside; x += 4) {
+            Vec4::save(maxValue + x, Vec4::max(Vec4::load(maxValue + x), Vec4::load(srcC + x)));
+        }
+        for (; x < inside; ++x) {
+            maxValue[x] = std::max(maxValue[x], srcC[x]);
+        }
+    }
+    ::memset(sumValue, 0, inside * sizeof(float));
+    for (int c = 0; c < channel; ++c) {
+        auto srcC = src + c * inside;
+        int x     = 0;
+        for (; x + 3 < inside; x += 4) {
+            Vec4::save(expValue + x, Vec4::load(maxValue + x) - Vec4::load(srcC + x));
+        }
+        for (; x < inside; ++x) {
+            expValue[x] = maxValue[x] - srcC[x];
+        }
+        MNNExp(expValue, expValue, inside);
+        for (x = 0; x + 3 < inside; x += 4) {
+            Vec4::save(sumValue + x, Vec4::load(sumValue + x) + Vec4::load(expValue + x));
+        }
+        for (; x < inside; ++x) {
+            sumValue[x] += expValue[x];
+        }
+    }
+    for (int x = 0; x < inside; ++x) {
+        maxValue[x] += logf(sumValue[x]);
+    }
+    for (int c = 0; c < channel; ++c) {
+        auto srcC = src + c * inside;
+        auto dstC = dst + c * inside;
+        int x     = 0;
+        for (; x + 3 < inside; x += 4) {
+            Vec4::save(dstC + x, Vec4::load(srcC + x) - Vec4::load(maxValue + x));
+        }
+        for (; x < inside; ++x) {
+            dstC[x] = srcC[x] - maxValue[x];
+        }
+    }
+}
+
+CPULogSoftmax::CPULogSoftmax(Backend* b, int axis) : Execution(b), mAxis(axis), mStorage(2), mCache(2) {
+    // Do nothing
+}
+
+ErrorCode CPULogSoftmax::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto input     = inputs[0];
+    int dimensions = input->dimensions();
+    int axis       = mAxis;
+    if (axis < 0) {
+        axis += dimensions;
+    }
+    mOutside = 1;
+    mInside  = 1;
+    for (int i = 0; i < axis; ++i) {
+        mOutside *= input->length(i);
+    }
+    mChannel = input->length(axis);
+    for (int i = axis + 1; i < dimensions; ++i) {
+        mInside *= input->length(i);
+    }
+    mNeedUnpackC4 = TensorUtils::getDescribe(input)->dimensionFormat == MNN_DATA_FORMAT_NC4HW4;
+    if (mNeedUnpackC4) {
+        mStorage.buffer().dim[0].extent = input->length(0);
+        // elementSize of NC4HW4 counts the aligned channel, use the real one
+        mStorage.buffer().dim[1].extent = mChannel * mInside * mOutside / input->length(0);
+        TensorUtils::getDescribe(&mStorage)->dimensionFormat = MNN_DATA_FORMAT_NHWC;
+        mStorage.buffer().type = input->getType();
+        backend()->onAcquireBuffer(&mStorage, Backend::DYNAMIC);
+    }
+    int threadNum                 = ((CPUBackend*)backend())->threadNumber();
+    mCache.buffer().dim[0].extent = threadNum;
+    mCache.buffer().dim[1].extent = mInside == 1 ? ALIGN_UP4(mChannel) : 3 * ALIGN_UP4(mInside);
+    mCache.buffer().type          = halide_type_of<float>();
+    TensorUtils::getDescribe(&mCache)->dimensionFormat = MNN_DATA_FORMAT_NHWC;
+    backend()->onAcquireBuffer(&mCache, Backend::DYNAMIC);
+    backend()->onReleaseBuffer(&mCache, Backend::DYNAMIC);
+    if (mNeedUnpackC4) {
+        backend()->onReleaseBuffer(&mStorage, Backend::DYNAMIC);
+    }
+    return NO_ERROR;
+}
+
+ErrorCode CPULogSoftmax::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto input    = inputs[0];
+    auto output   = outputs[0];
+    auto srcData  = input->host<float>();
+    auto dstData  = output->host<float>();
+    int threadNum = ((CPUBackend*)backend())->threadNumber();
+    if (mNeedUnpackC4) {
+        // Unpack input into output, compute into storage and pack back
+        int batch     = input->length(0);
+        int area      = 1;
+        for (int i = 2; i < input->dimensions(); ++i) {
+            area *= input->length(i);
+        }
+        int batchSize = mStorage.length(1);
+        int batchC4   = ROUND_UP(input->channel(), 4) * area;
+        for (int b = 0; b < batch; ++b) {
+            MNNUnpackC4(dstData + b * batchSize, srcData + b * batchC4, area, input->channel());
+        }
+        srcData = dstData;
+        dstData = mStorage.host<float>();
+    }
+    const int outside = mOutside;
+    const int channel = mChannel;
+    const int inside  = mInside;
+    const int stepY   = channel * inside;
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        auto cache = mCache.host<float>() + tId * mCache.length(1);
+        for (int y = (int)tId; y < outside; y += threadNum) {
+            if (1 == inside) {
+                _logSoftmaxRow(srcData + y * stepY, dstData + y * stepY, cache, channel);
+            } else {
+                _logSoftmaxInside(srcData + y * stepY, dstData + y * stepY, cache, channel, inside);
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    if (mNeedUnpackC4) {
+        int batch     = output->length(0);
+        int area      = 1;
+        for (int i = 2; i < output->dimensions(); ++i) {
+            area *= output->length(i);
+        }
+        int batchSize = mStorage.length(1);
+        int batchC4   = ROUND_UP(output->channel(), 4) * area;
+        for (int b = 0; b < batch; ++b) {
+            MNNPackC4(output->host<float>() + b * batchC4, dstData + b * batchSize, area, output->channel());
+        }
+    }
+    return NO_ERROR;
+}
+
+// One row of exp for each thread, rows are aligned for MNNExp
+static void _acquireRowCache(Backend* backend, Tensor* cache, int channel) {
+    int threadNum = ((CPUBackend*)backend)->threadNumber();
+    cache->buffer().dimensions    = 2;
+    cache->buffer().dim[0].extent = threadNum;
+    cache->buffer().dim[1].extent = ALIGN_UP4(channel);
+    cache->buffer().type          = halide_type_of<float>();
+    TensorUtils::getDescribe(cache)->dimensionFormat = MNN_DATA_FORMAT_NHWC;
+    backend->onAcquireBuffer(cache, Backend::DYNAMIC);
+    backend->onReleaseBuffer(cache, Backend::DYNAMIC);
+}
+
+ErrorCode CPUSoftmaxCrossEntropy::onResize(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto logits = inputs[0];
+    _acquireRowCache(backend(), &mCache, logits->length(logits->dimensions() - 1));
+    return NO_ERROR;
+}
+
+ErrorCode CPUSoftmaxCrossEntropyGrad::onResize(const std::vector<Tensor*>& inputs,
+                                               const std::vector<Tensor*>& outputs) {
+    auto logits = inputs[0];
+    _acquireRowCache(backend(), &mCache, logits->length(logits->dimensions() - 1));
+    return NO_ERROR;
+}
+
+ErrorCode CPUSoftmaxCrossEntropy::onExecute(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs) {
+    auto logits   = inputs[0]->host<float>();
+    auto labels   = inputs[1]->host<float>();
+    auto loss     = outputs[0]->host<float>();
+    int channel   = inputs[0]->length(inputs[0]->dimensions() - 1);
+    int outside   = inputs[0]->elementSize() / channel;
+    int threadNum = ((CPUBackend*)backend())->threadNumber();
+    // loss = -sum(y * (x - max - log(sum(exp(x - max))))), softmax and log are never materialized
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        auto cache = mCache.host<float>() + tId * mCache.length(1);
+        for (int y = (int)tId; y < outside; y += threadNum) {
+            auto x        = logits + y * channel;
+            auto label    = labels + y * channel;
+            auto maxValue = _rowExp(x, cache, channel);
+            auto logSum   = maxValue + logf(_rowSum(cache, channel));
+            loss[y]       = logSum * _rowSum(label, channel) - _rowDot(label, x, channel);
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+ErrorCode CPUSoftmaxCrossEntropyGrad::onExecute(const std::vector<Tensor*>& inputs,
+                                                const std::vector<Tensor*>& outputs) {
+    auto logits   = inputs[0]->host<float>();
+    auto labels   = inputs[1]->host<float>();
+    auto lossGrad = inputs[2]->host<float>();
+    auto grad     = outputs[0]->host<float>();
+    int channel   = inputs[0]->length(inputs[0]->dimensions() - 1);
+    int outside   = inputs[0]->elementSize() / channel;
+    int threadNum = ((CPUBackend*)backend())->threadNumber();
+    MNN_CONCURRENCY_BEGIN(tId, threadNum) {
+        auto cache = mCache.host<float>() + tId * mCache.length(1);
+        for (int y = (int)tId; y < outside; y += threadNum) {
+            auto label = labels + y * channel;
+            auto dst   = grad + y * channel;
+            _rowExp(logits + y * channel, cache, channel);
+            auto g     = lossGrad[y];
+            auto scale = _rowSum(label, channel) * g / _rowSum(cache, channel);
+            Vec4 scaleV(scale);
+            Vec4 gV(g);
+            int c = 0;
+            for (; c + 3 < channel; c += 4) {
+                Vec4::save(dst + c, Vec4::load(cache + c) * scaleV - Vec4::load(label + c) * gV);
+            }
+            for (; c < channel; ++c) {
+                dst[c] = cache[c] * scale - label[c] * g;
+            }
+        }
+    }
+    MNN_CONCURRENCY_END();
+    return NO_ERROR;
+}
+
+class CPULogSoftmaxCreator : public CPUBackend::Creator {
+public:
+    virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
+                                const MNN::Op* op, Backend* backend) const override {
+        int axis = -1;
+        if (nullptr != op->main_as_Axis()) {
+            axis = op->main_as_Axis()->axis();
+        }
+        return new CPULogSoftmax(backend, axis);
+    }
+};
+
+class CPUSoftmaxCrossEntropyCreator : public CPUBackend::Creator {
+public:
+    virtual Execution* onCreate(const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
+                                const MNN::Op* op, Backend* backend) const override {
+        if (op->type() == OpType_SoftmaxCrossEntropyGrad) {
+            return new CPUSoftmaxCrossEntropyGrad(backend);
+        }
+        return new CPUSoftmaxCrossEntropy(backend);
+    }
+};
+
+REGISTER_CPU_OP_CREATOR(CPULogSoftmaxCreator, OpType_LogSoftmax);
+REGISTER_CPU_OP_CREATOR(CPUSoftmaxCrossEntropyCreator, OpType_SoftmaxCrossEntropy);
+REGISTER_CPU_OP_CREATOR(CPUSoftmaxCrossEntropyCreator, OpType_SoftmaxCrossEntropyGrad);
+} // namespace MNN
@@ -0,0 +1,59 @@
+//
+//  CPUSoftmaxCrossEntropy.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/07.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef CPUSoftmaxCrossEntropy_hpp
+#define CPUSoftmaxCrossEntropy_hpp
+
+#include "core/Execution.hpp"
+
+namespace MNN {
+class CPULogSoftmax : public Execution {
+public:
+    CPULogSoftmax(Backend *b, int axis);
+    virtual ~CPULogSoftmax() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    int mAxis;
+    int mOutside = 1;
+    int mChannel = 1;
+    int mInside  = 1;
+    bool mNeedUnpackC4 = false;
+    Tensor mStorage;
+    Tensor mCache;
+};
+
+// inputs: logits [outside, channel], labels [outside, channel]; output: loss [outside]
+class CPUSoftmaxCrossEntropy : public Execution {
+public:
+    CPUSoftmaxCrossEntropy(Backend *b) : Execution(b) {
+    }
+    virtual ~CPUSoftmaxCrossEntropy() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    Tensor mCache;
+};
+
+// inputs: logits, labels, loss grad [outside]; output: logits grad = (softmax * sum(labels) - labels) * lossGrad
+class CPUSoftmaxCrossEntropyGrad : public Execution {
+public:
+    CPUSoftmaxCrossEntropyGrad(Backend *b) : Execution(b) {
+    }
+    virtual ~CPUSoftmaxCrossEntropyGrad() = default;
+    virtual ErrorCode onResize(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+    virtual ErrorCode onExecute(const std::vector<Tensor *> &inputs, const std::vector<Tensor *> &outputs) override;
+
+private:
+    Tensor mCache;
+};
+} // namespace MNN
+
+#endif /* CPUSoftmaxCrossEntropy_hpp */
@@ -0,0 +1,107 @@
+//
+//  NMSComputer.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/28.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "backend/cpu/compute/NMSComputer.hpp"
+#include <algorithm>
+#include "core/Macro.h"
+#include "math/Vec.hpp"
+
+namespace MNN {
+using Vec4 = Math::Vec<float, 4>;
+
+void NMSBoxes::resize(int size) {
+    xmin.resize(size);
+    ymin.resize(size);
+    xmax.resize(size);
+    ymax.resize(size);
+    area.resize(size);
+}
+
+void NMSBoxes::set(int index, float x0, float y0, float x1, float y1) {
+    xmin[index] = std::min(x0, x1);
+    ymin[index] = std::min(y0, y1);
+    xmax[index] = std::max(x0, x1);
+    ymax[index] = std::max(y0, y1);
+    area[index] = (xmax[index] - xmin[index]) * (ymax[index] - ymin[index]);
+}
+
+// Candidates above the threshold from the highest score, only the top preTopK are sorted
+static void _sortCandidates(const float* scores, int size, float scoreThreshold, int preTopK,
+                            std::vector<int>& order) {
+    order.clear();
+    for (int i = 0; i < size; ++i) {
+        if (scores[i] > scoreThreshold) {
+            order.emplace_back(i);
+        }
+    }
+    auto compare = [scores](int i, int j) { return scores[i] > scores[j] || (scores[i] == scores[j] && i < j); };
+    if (preTopK > 0 && preTopK < (int)order.size()) {
+        std::partial_sort(order.begin(), order.begin() + preTopK, order.end(), compare);
+        order.resize(preTopK);
+    } else {
+        std::sort(order.begin(), order.end(), compare);
+    }
+}
+
+void NMSSelect(const NMSBoxes& boxes, const float* scores, float iouThreshold, float scoreThreshold, int preTopK,
+               int maxOutput, std::vector<int>& selected) {
+    selected.clear();
+    std::vector<int> order;
+    _sortCandidates(scores, boxes.size(), scoreThreshold, preTopK, order);
+    const int outputNumber = std::min(maxOutput, (int)order.size());
+    if (outputNumber <= 0) {
+        return;
+    }
+    selected.reserve(outputNumber);
+    // Selected boxes in SoA, padded by empty boxes that never intersect to a multiple of 4
+    const int capacity = ALIGN_UP4(outputNumber);
+    std::vector<float> selectedBoxes(5 * capacity, 0.0f);
+    auto selXMin = selectedBoxes.data();
+    auto selYMin = selXMin + capacity;
+    auto selXMax = selYMin + capacity;
+    auto selYMax = selXMax + capacity;
+    auto selArea = selYMax + capacity;
+    const float thresholdPlusOne = 1.0f + iouThreshold;
+    Vec4 zero(0.0f);
+    int count = 0;
+    for (auto index : order) {
+        if (count >= outputNumber) {
+            break;
+        }
+        const float area = boxes.area[index];
+        bool keep        = true;
+        // An empty box has zero IoU with any box
+        if (area > 0.0f) {
+            Vec4 xMin(boxes.xmin[index]);
+            Vec4 yMin(boxes.ymin[index]);
+            Vec4 xMax(boxes.xmax[index]);
+            Vec4 yMax(boxes.ymax[index]);
+            Vec4 areaV(area);
+            float diff[4];
+            for (int j = 0; j < count && keep; j += 4) {
+                auto w = Vec4::min(xMax, Vec4::load(selXMax + j)) - Vec4::max(xMin, Vec4::load(selXMin + j));
+                auto h = Vec4::min(yMax, Vec4::load(selYMax + j)) - Vec4::max(yMin, Vec4::load(selYMin + j));
+                auto inter = Vec4::max(w, zero) * Vec4::max(h, zero);
+                // iou > threshold <=> inter > threshold * (areaA + areaB - inter), no division needed
+                Vec4::save(diff, inter * thresholdPlusOne - (areaV + Vec4::load(selArea + j)) * iouThreshold);
+                keep = !(diff[0] > 0.0f || diff[1] > 0.0f || diff[2] > 0.0f || diff[3] > 0.0f);
+            }
+        }
+        if (keep) {
+            selXMin[count] = boxes.xmin[index];
+            selYMin[count] = boxes.ymin[index];
+            selXMax[count] = boxes.xmax[index];
+            selYMax[count] = boxes.ymax[index];
+            selArea[count] = area;
+            selected.emplace_back(index);
+            count++;
+        }
+    }
+}
+
+} // namespace MNN
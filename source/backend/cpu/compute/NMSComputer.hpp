@@ -0,0 +1,50 @@
+//
+//  NMSComputer.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/28.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef NMSComputer_hpp
+#define NMSComputer_hpp
+
+#include <vector>
+
+namespace MNN {
+
+/**
+ Boxes of non max suppression in SoA layout, so that the IoU of a candidate against the selected boxes is computed
+ four at a time. Corners are reordered on set so that min <= max.
+ */
+struct NMSBoxes {
+    std::vector<float> xmin;
+    std::vector<float> ymin;
+    std::vector<float> xmax;
+    std::vector<float> ymax;
+    std::vector<float> area;
+
+    void resize(int size);
+    int size() const {
+        return (int)area.size();
+    }
+    void set(int index, float x0, float y0, float x1, float y1);
+};
+
+/**
+ * @brief greedy non max suppression, visit the candidates from the highest score and keep one if its IoU with every
+ * selected box is not larger than iouThreshold.
+ * @param boxes          boxes to select from.
+ * @param scores         score of each box, only the boxes with score > scoreThreshold are candidates.
+ * @param iouThreshold   IoU threshold.
+ * @param scoreThreshold score threshold.
+ * @param preTopK        only the preTopK highest candidates are visited, <= 0 means all of them.
+ * @param maxOutput      max number of selected boxes.
+ * @param selected       index of the selected boxes, from the highest score.
+ */
+void NMSSelect(const NMSBoxes& boxes, const float* scores, float iouThreshold, float scoreThreshold, int preTopK,
+               int maxOutput, std::vector<int>& selected);
+
+} // namespace MNN
+
+#endif /* NMSComputer_hpp */
@@ -0,0 +1,304 @@
+//
+//  BatchScheduler.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/21.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/BatchScheduler.hpp>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "core/Macro.h"
+
+namespace MNN {
+
+struct BatchRequest {
+    BatchScheduler::TensorMap inputs;
+    std::promise<BatchScheduler::Result> promise;
+    std::chrono::steady_clock::time_point enqueueTime;
+};
+
+// One prepared session of a batch size, with host tensors for staging the batch
+struct BatchBucket {
+    int batch;
+    Session* session = nullptr;
+    std::vector<Tensor*> inputs;
+    std::vector<Tensor*> outputs;
+    std::vector<std::shared_ptr<Tensor>> hostInputs;
+    std::vector<std::shared_ptr<Tensor>> hostOutputs;
+};
+
+struct BatchContent {
+    std::shared_ptr<Interpreter> net;
+    BatchScheduler::Config config;
+    std::vector<std::string> inputNames;
+    std::vector<std::string> outputNames;
+    // Bytes of one sample for each input / output
+    std::vector<size_t> inputBytes;
+    std::vector<size_t> outputBytes;
+    std::vector<BatchBucket> buckets;
+
+    std::mutex lock;
+    std::condition_variable condition;
+    std::deque<std::unique_ptr<BatchRequest>> queue;
+    bool stop = false;
+    std::thread worker;
+};
+
+static std::vector<int> _sampleShape(const Tensor* tensor) {
+    auto shape = tensor->shape();
+    if (!shape.empty()) {
+        shape[0] = 1;
+    }
+    return shape;
+}
+
+static bool _prepareBuckets(BatchContent* content) {
+    auto& config = content->config;
+    auto net     = content->net.get();
+    auto runtime = Interpreter::createRuntime({config.schedule});
+    std::sort(config.batchBuckets.begin(), config.batchBuckets.end());
+    config.batchBuckets.erase(std::unique(config.batchBuckets.begin(), config.batchBuckets.end()),
+                              config.batchBuckets.end());
+    for (auto batch : config.batchBuckets) {
+        if (batch <= 0) {
+            continue;
+        }
+        BatchBucket bucket;
+        bucket.batch   = batch;
+        bucket.session = net->createSession(config.schedule, runtime);
+        if (nullptr == bucket.session) {
+            return false;
+        }
+        auto& inputMap = net->getSessionInputAll(bucket.session);
+        if (content->inputNames.empty()) {
+            for (auto& iter : inputMap) {
+                content->inputNames.emplace_back(iter.first);
+            }
+        }
+        for (auto& name : content->inputNames) {
+            auto input = inputMap.find(name)->second;
+            auto shape = input->shape();
+            if (shape.empty()) {
+                MNN_ERROR("BatchScheduler: input %s has no batch dimension\n", name.c_str());
+                return false;
+            }
+            for (int i = 1; i < shape.size(); ++i) {
+                if (shape[i] <= 0) {
+                    MNN_ERROR("BatchScheduler: input %s has unknown dimension %d\n", name.c_str(), i);
+                    return false;
+                }
+            }
+            shape[0] = batch;
+            net->resizeTensor(input, shape);
+            bucket.inputs.emplace_back(input);
+        }
+        net->resizeSession(bucket.session);
+        auto& outputMap = net->getSessionOutputAll(bucket.session);
+        if (content->outputNames.empty()) {
+            for (auto& iter : outputMap) {
+                content->outputNames.emplace_back(iter.first);
+            }
+        }
+        for (auto& name : content->outputNames) {
+            auto output = outputMap.find(name)->second;
+            if (output->dimensions() <= 0 || output->length(0) != batch) {
+                MNN_ERROR("BatchScheduler: the first dimension of output %s is not batch\n", name.c_str());
+                return false;
+            }
+            bucket.outputs.emplace_back(output);
+        }
+        for (auto input : bucket.inputs) {
+            bucket.hostInputs.emplace_back(new Tensor(input, input->getDimensionType()));
+            ::memset(bucket.hostInputs.back()->host<void>(), 0, bucket.hostInputs.back()->size());
+        }
+        for (auto output : bucket.outputs) {
+            bucket.hostOutputs.emplace_back(new Tensor(output, output->getDimensionType()));
+        }
+        if (content->inputBytes.empty()) {
+            for (auto& host : bucket.hostInputs) {
+                content->inputBytes.emplace_back(host->size() / batch);
+            }
+            for (auto& host : bucket.hostOutputs) {
+                content->outputBytes.emplace_back(host->size() / batch);
+            }
+        }
+        content->buckets.emplace_back(std::move(bucket));
+    }
+    if (content->buckets.empty()) {
+        MNN_ERROR("BatchScheduler: no valid batch bucket\n");
+        return false;
+    }
+    // All sessions are resized, the model buffer is not needed
+    net->releaseModel();
+    return true;
+}
+
+static BatchContent* _createContent(Interpreter* net, const BatchScheduler::Config& config) {
+    if (nullptr == net) {
+        return nullptr;
+    }
+    auto content = new BatchContent;
+    content->net.reset(net);
+    content->config = config;
+    if (!_prepareBuckets(content)) {
+        delete content;
+        return nullptr;
+    }
+    return content;
+}
+
+BatchScheduler* BatchScheduler::createFromFile(const char* file, const Config& config) {
+    auto content = _createContent(Interpreter::createFromFile(file), config);
+    if (nullptr == content) {
+        return nullptr;
+    }
+    return new BatchScheduler(content);
+}
+
+BatchScheduler* BatchScheduler::createFromBuffer(const void* buffer, size_t size, const Config& config) {
+    auto content = _createContent(Interpreter::createFromBuffer(buffer, size), config);
+    if (nullptr == content) {
+        return nullptr;
+    }
+    return new BatchScheduler(content);
+}
+
+BatchScheduler::BatchScheduler(BatchContent* content) {
+    mContent         = content;
+    mContent->worker = std::thread([this]() { _run(); });
+}
+
+BatchScheduler::~BatchScheduler() {
+    {
+        std::unique_lock<std::mutex> _l(mContent->lock);
+        mContent->stop = true;
+    }
+    mContent->condition.notify_all();
+    mContent->worker.join();
+    for (auto& bucket : mContent->buckets) {
+        mContent->net->releaseSession(bucket.session);
+    }
+    delete mContent;
+}
+
+const std::vector<std::string>& BatchScheduler::inputNames() const {
+    return mContent->inputNames;
+}
+
+const std::vector<std::string>& BatchScheduler::outputNames() const {
+    return mContent->outputNames;
+}
+
+std::shared_ptr<Tensor> BatchScheduler::createInput(const std::string& name) const {
+    auto& bucket = mContent->buckets[0];
+    for (int i = 0; i < mContent->inputNames.size(); ++i) {
+        if (mContent->inputNames[i] == name) {
+            auto host = bucket.hostInputs[i].get();
+            return std::shared_ptr<Tensor>(
+                Tensor::create(_sampleShape(host), host->getType(), nullptr, host->getDimensionType()));
+        }
+    }
+    return nullptr;
+}
+
+std::future<BatchScheduler::Result> BatchScheduler::submit(const TensorMap& inputs) {
+    std::unique_ptr<BatchRequest> request(new BatchRequest);
+    auto future = request->promise.get_future();
+    for (int i = 0; i < mContent->inputNames.size(); ++i) {
+        auto iter = inputs.find(mContent->inputNames[i]);
+        if (iter == inputs.end() || nullptr == iter->second || nullptr == iter->second->host<void>() ||
+            iter->second->size() != mContent->inputBytes[i]) {
+            MNN_ERROR("BatchScheduler: invalid input %s\n", mContent->inputNames[i].c_str());
+            Result result;
+            result.code = INPUT_DATA_ERROR;
+            request->promise.set_value(std::move(result));
+            return future;
+        }
+    }
+    request->inputs      = inputs;
+    request->enqueueTime = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> _l(mContent->lock);
+        mContent->queue.emplace_back(std::move(request));
+    }
+    mContent->condition.notify_one();
+    return future;
+}
+
+static void _runBatch(BatchContent* content, std::vector<std::unique_ptr<BatchRequest>>& requests) {
+    const int number = (int)requests.size();
+    auto bucketIter  = std::find_if(content->buckets.begin(), content->buckets.end(),
+                                   [number](const BatchBucket& bucket) { return bucket.batch >= number; });
+    MNN_ASSERT(bucketIter != content->buckets.end());
+    auto& bucket = *bucketIter;
+    auto net     = content->net.get();
+    // Gather: batch is the outermost dimension, so each sample is a continuous slice
+    for (int i = 0; i < bucket.inputs.size(); ++i) {
+        auto bytes = content->inputBytes[i];
+        auto dst   = bucket.hostInputs[i]->host<uint8_t>();
+        for (int b = 0; b < number; ++b) {
+            auto& input = requests[b]->inputs[content->inputNames[i]];
+            ::memcpy(dst + b * bytes, input->host<uint8_t>(), bytes);
+        }
+        bucket.inputs[i]->copyFromHostTensor(bucket.hostInputs[i].get());
+    }
+    auto code = net->runSession(bucket.session);
+    if (NO_ERROR == code) {
+        for (int i = 0; i < bucket.outputs.size(); ++i) {
+            bucket.outputs[i]->copyToHostTensor(bucket.hostOutputs[i].get());
+        }
+    }
+    // Scatter
+    for (int b = 0; b < number; ++b) {
+        BatchScheduler::Result result;
+        result.code = code;
+        if (NO_ERROR == code) {
+            for (int i = 0; i < bucket.outputs.size(); ++i) {
+                auto host  = bucket.hostOutputs[i].get();
+                auto bytes = content->outputBytes[i];
+                std::shared_ptr<Tensor> output(
+                    Tensor::create(_sampleShape(host), host->getType(), nullptr, host->getDimensionType()));
+                ::memcpy(output->host<void>(), host->host<uint8_t>() + b * bytes, bytes);
+                result.outputs.insert(std::make_pair(content->outputNames[i], output));
+            }
+        }
+        requests[b]->promise.set_value(std::move(result));
+    }
+}
+
+void BatchScheduler::_run() {
+    auto content        = mContent;
+    const int maxBatch = content->buckets.back().batch;
+    const auto maxWait = std::chrono::microseconds(std::max(0, content->config.maxWaitUs));
+    while (true) {
+        std::vector<std::unique_ptr<BatchRequest>> requests;
+        {
+            std::unique_lock<std::mutex> _l(content->lock);
+            content->condition.wait(_l, [content]() { return content->stop || !content->queue.empty(); });
+            if (content->queue.empty()) {
+                // Stopped and all requests are done
+                break;
+            }
+            // Wait for a full batch, until the oldest request times out
+            auto deadline = content->queue.front()->enqueueTime + maxWait;
+            content->condition.wait_until(_l, deadline, [content, maxBatch]() {
+                return content->stop || content->queue.size() >= maxBatch;
+            });
+            auto number = std::min((int)content->queue.size(), maxBatch);
+            for (int i = 0; i < number; ++i) {
+                requests.emplace_back(std::move(content->queue.front()));
+                content->queue.pop_front();
+            }
+        }
+        _runBatch(content, requests);
+    }
+}
+
+} // namespace MNN
@@ -85,7 +85,7 @@ void Pipeline::UnitInfo::setUp(const Command& command, int index) {
 Pipeline::Pipeline(std::vector<Schedule::PipelineInfo>&& infos, std::shared_ptr<Backend> backend,
                    std::shared_ptr<Backend> cpuBackend, bool allocInput, bool geometry)
 #ifndef MNN_BUILD_MINI
-    : mContext(cpuBackend, true), mUseGeometry(geometry) {
+    : mContext(cpuBackend, true, backend->type()), mUseGeometry(geometry) {
 #else
 {
 #endif
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <map>
+#include <mutex>
 #include "core/AutoStorage.h"
 #include "core/Macro.h"
 #include "core/TensorUtils.hpp"
@@ -16,7 +17,9 @@
 #include "cv/ImageBlitter.hpp"
 #include "cv/ImageFloatBlitter.hpp"
 #include "cv/ImageSampler.hpp"
+#include "backend/cpu/CPUBackend.hpp"
 #include "backend/cpu/CPUTensorConvert.hpp"
+#include "core/Concurrency.h"
 #include <MNN/MNNForwardType.h>
 #include "core/Backend.hpp"
 #define CACHE_SIZE 256
@@ -24,8 +27,6 @@ namespace MNN {
 namespace CV {
 struct ImageProcess::Inside {
     Config config;
-    AutoStorage<uint8_t> cacheBuffer;
-    AutoStorage<uint8_t> cacheBufferRGBA;
 };
 
 ImageProcess::~ImageProcess() {
@@ -35,8 +36,6 @@ ImageProcess::~ImageProcess() {
 ImageProcess::ImageProcess(const Config& config) {
     mInside         = new Inside;
     mInside->config = config;
-    mInside->cacheBuffer.reset(4 * CACHE_SIZE);
-    mInside->cacheBufferRGBA.reset(4 * CACHE_SIZE);
     for (int i = 0; i < 4; ++i) {
         mInside->config.mean[i]   = config.mean[i];
         mInside->config.normal[i] = config.normal[i];
@@ -193,99 +192,76 @@ static ImageFormat _correctImageFormat(int outputBpp, halide_type_t type, ImageF
     return format;
 }
 
-ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int stride, Tensor* destOrigin) {
-    auto dest = destOrigin;
-    if (nullptr == dest || nullptr == source) {
-        MNN_ERROR("null dest or source for image process\n");
-        return INPUT_DATA_ERROR;
-    }
-    if (destOrigin->buffer().device == 0 && destOrigin->buffer().host == nullptr) {
-        MNN_ERROR("Invalid Tensor, the session may not be ready\n");
-        return INPUT_DATA_ERROR;
-    }
-    std::shared_ptr<Tensor> tempTensor;
-    auto ow              = dest->width();
-    auto oh              = dest->height();
-    auto bpp             = dest->channel();
-    auto dimensionFormat = TensorUtils::getDescribe(dest)->dimensionFormat;
-    auto tensorBn = TensorUtils::getDescribe(dest)->backend;
-    auto bnType = MNN_FORWARD_CPU;
-    if(tensorBn){
-        bnType = tensorBn->type();
-    }
-    if (bnType != MNN_FORWARD_CPU) {
-        tempTensor.reset(Tensor::create({1, bpp, oh, ow}, dest->getType(), nullptr, Tensor::CAFFE_C4),[destOrigin] (void* p) {
-            auto hostTensor = (Tensor*)p;
-            destOrigin->copyFromHostTensor(hostTensor);
-            delete hostTensor;
-        });
-        dest = tempTensor.get();
-    }
-    else if (MNN_DATA_FORMAT_NCHW == dimensionFormat) {
-        tempTensor.reset(Tensor::create(dest->shape(), dest->getType(), nullptr, Tensor::CAFFE_C4), [destOrigin](void* p) {
-            auto hostTensor = (Tensor*)p;
-            CPUTensorConverter::convert(hostTensor, destOrigin);
-            delete hostTensor;
-        });
-        dest = tempTensor.get();
-    }
-    dimensionFormat = TensorUtils::getDescribe(dest)->dimensionFormat;
-    if (dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
-        bpp = 4;
-    }
-    return convert(source, iw, ih, stride, dest->host<void>(), ow, oh, bpp, ow * bpp, dest->getType());
-}
+namespace {
+// Read-only state of one convert call, shared by all the row workers
+struct RowConvertInfo {
+    const ImageProcess::Config* config;
+    const Matrix* transform;
+    const Matrix* transformInvert;
+    ImageSampler::PROC sampler;
+    ImageBlitter::BLITTER blitter;
+    ImageFloatBlitter::BLIT_FLOAT blitFloat;
+    const uint8_t* source;
+    int iw;
+    int ih;
+    int stride;
+    int sourceBpp;
+    uint8_t* dest;
+    int ow;
+    int oh;
+    int bpp;
+    int destBytes;
+    bool needBlit;
+    bool isFloat;
+    // > 0: write planar (NCHW) output of planeChannel channels, the rows are produced with bpp = 4 and scattered
+    int planeChannel;
+};
+} // namespace
 
-ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int stride, void* dest, int ow, int oh,
-                                int outputBpp, int outputStride, halide_type_t type) {
-    auto sourceBpp = _getBpp(mInside->config.sourceFormat);
-    if (0 == stride) {
-        stride = iw * sourceBpp;
-    }
+// sample: 4 * CACHE_SIZE bytes, rgba: 4 * CACHE_SIZE bytes, plane: 4 * CACHE_SIZE elements of dest type
+#define CACHE_UNIT_BYTES (4 * CACHE_SIZE * (1 + 1 + 4))
 
-    // AUTOTIME;
-    auto& config      = mInside->config;
-    auto sourceFormat = config.sourceFormat;
-    auto destFormat   = config.destFormat;
-    destFormat        = _correctImageFormat(outputBpp, type, destFormat);
-    auto blitter      = ImageBlitter::choose(sourceFormat, destFormat);
-    if (nullptr == blitter) {
-        return INPUT_DATA_ERROR;
-    }
-    bool identity = mTransform.isIdentity() && iw >= ow && ih >= oh; // TODO, no need for iw, ih limit
-    auto sampler  = ImageSampler::choose(sourceFormat, config.filterType, identity);
-    if (nullptr == sampler) {
-        return INPUT_DATA_ERROR;
-    }
-    if (0 == outputBpp) {
-        outputBpp = _getBpp(destFormat);
+template <typename T>
+static void _scatterPlanes(const T* src, T* dst, int count, int srcBpp, int channel, size_t planeStride) {
+    for (int c = 0; c < channel; ++c) {
+        auto dstC = dst + c * planeStride;
+        auto srcC = src + c;
+        for (int x = 0; x < count; ++x) {
+            dstC[x] = srcC[x * srcBpp];
+        }
     }
+}
 
-    int tileCount = UP_DIV(ow, CACHE_SIZE);
+static void _convertRows(const RowConvertInfo& info, int yStart, int yEnd, uint8_t* cache) {
+    auto& config       = *info.config;
+    auto& transform    = *info.transform;
+    auto sampleBuffer  = cache;
+    auto rgbaBuffer    = cache + 4 * CACHE_SIZE;
+    auto planeBuffer   = cache + 8 * CACHE_SIZE;
+    auto destBytes     = info.destBytes;
+    auto bpp           = info.bpp;
+    auto ow            = info.ow;
+    auto iw            = info.iw;
+    auto ih            = info.ih;
+    auto sourceBpp     = info.sourceBpp;
+    bool planar        = info.planeChannel > 0;
+    size_t planeStride = (size_t)info.ow * info.oh;
+    int tileCount      = UP_DIV(ow, CACHE_SIZE);
     Point points[2];
-    auto sampleBuffer = (uint8_t*)mInside->cacheBuffer.get();
-    auto srcData      = source;
-    auto destBytes    = type.bytes();
-    auto bpp          = outputBpp;
-    auto needBlit     = sourceFormat != destFormat;
-    bool isFloat      = type.code == halide_type_float;
-    //            MNN_PRINT("bpp:%d, destBytes:%d, destFormat:%d, %d, %d\n",bpp, destBytes, ow, oh, dimensionFormat);
-
-    auto blitFloat = ImageFloatBlitter::choose(destFormat, bpp);
-    for (int dy = 0; dy < oh; ++dy) {
-        auto dstY = (uint8_t*)dest + dy * destBytes * ow * bpp;
+    for (int dy = yStart; dy < yEnd; ++dy) {
+        auto dstY = info.dest + (size_t)dy * destBytes * ow * (planar ? 1 : bpp);
         for (int tIndex = 0; tIndex < tileCount; ++tIndex) {
             int xStart    = tIndex * CACHE_SIZE;
             int count     = std::min(CACHE_SIZE, ow - xStart);
-            auto dstStart = dstY + destBytes * bpp * xStart;
+            auto dstStart = planar ? planeBuffer : dstY + destBytes * bpp * xStart;
 
             auto samplerDest = sampleBuffer;
-            auto blitDest    = mInside->cacheBufferRGBA.get();
+            auto blitDest    = rgbaBuffer;
 
-            if (!isFloat) {
+            if (!info.isFloat) {
                 blitDest = dstStart;
             }
-            if (!needBlit) {
+            if (!info.needBlit) {
                 samplerDest = blitDest;
             }
 
@@ -298,23 +274,22 @@ ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int strid
                 points[1].fX = xStart + count;
                 points[1].fY = dy;
 
-                mTransform.mapPoints(points, 2);
+                transform.mapPoints(points, 2);
                 float deltaY = points[1].fY - points[0].fY;
                 float deltaX = points[1].fX - points[0].fX;
 
                 int sta = 0;
                 int end = count;
 
-                // FUNC_PRINT(sta);
                 if (config.wrap == ZERO) {
                     // Clip: Cohen-Sutherland
-                    auto clip    = _computeClip(points, iw, ih, mTransformInvert, xStart, count);
+                    auto clip    = _computeClip(points, iw, ih, *info.transformInvert, xStart, count);
                     sta          = clip.first;
                     end          = clip.second;
                     points[0].fX = sta + xStart;
                     points[0].fY = dy;
 
-                    mTransform.mapPoints(points, 1);
+                    transform.mapPoints(points, 1);
                     if (sta != 0 || end < count) {
                         if (sourceBpp > 0) {
                             if (sta > 0) {
@@ -333,23 +308,172 @@ ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int strid
                 points[1].fX = (deltaX) / (float)(count);
                 points[1].fY = (deltaY) / (float)(count);
 
-                sampler(srcData, samplerDest, points, sta, end - sta, count, iw, ih, stride);
+                info.sampler(info.source, samplerDest, points, sta, end - sta, count, iw, ih, info.stride);
             }
             // Convert format
-            if (needBlit) {
-                blitter(samplerDest, blitDest, count);
+            if (info.needBlit) {
+                info.blitter(samplerDest, blitDest, count);
             }
             // Turn float
-            if (isFloat) {
-                auto normal = mInside->config.normal;
-                auto mean   = mInside->config.mean;
-                blitFloat(blitDest, (float*)dstStart, mean, normal, count);
+            if (info.isFloat) {
+                info.blitFloat(blitDest, (float*)dstStart, config.mean, config.normal, count);
+            }
+            // Write the tile to the planes directly, instead of converting the whole image after
+            if (planar) {
+                auto dstPlane = dstY + destBytes * xStart;
+                if (info.isFloat) {
+                    _scatterPlanes((const float*)dstStart, (float*)dstPlane, count, bpp, info.planeChannel,
+                                   planeStride);
+                } else {
+                    _scatterPlanes((const uint8_t*)dstStart, (uint8_t*)dstPlane, count, bpp, info.planeChannel,
+                                   planeStride);
+                }
             }
         }
     }
+}
 
+static ErrorCode _convertImage(const ImageProcess::Config& config, const Matrix& transform,
+                               const Matrix& transformInvert, const uint8_t* source, int iw, int ih, int stride,
+                               void* dest, int ow, int oh, int outputBpp, halide_type_t type, int planeChannel,
+                               const CPUBackend* cpuBackend) {
+    auto sourceBpp = _getBpp(config.sourceFormat);
+    if (0 == stride) {
+        stride = iw * sourceBpp;
+    }
+
+    // AUTOTIME;
+    auto sourceFormat = config.sourceFormat;
+    auto destFormat   = _correctImageFormat(outputBpp, type, config.destFormat);
+    auto blitter      = ImageBlitter::choose(sourceFormat, destFormat);
+    if (nullptr == blitter) {
+        return INPUT_DATA_ERROR;
+    }
+    bool identity = transform.isIdentity() && iw >= ow && ih >= oh; // TODO, no need for iw, ih limit
+    auto sampler  = ImageSampler::choose(sourceFormat, config.filterType, identity);
+    if (nullptr == sampler) {
+        return INPUT_DATA_ERROR;
+    }
+    if (0 == outputBpp) {
+        outputBpp = _getBpp(destFormat);
+    }
+    RowConvertInfo info;
+    info.config          = &config;
+    info.transform       = &transform;
+    info.transformInvert = &transformInvert;
+    info.sampler         = sampler;
+    info.blitter         = blitter;
+    info.blitFloat       = ImageFloatBlitter::choose(destFormat, outputBpp);
+    info.source          = source;
+    info.iw              = iw;
+    info.ih              = ih;
+    info.stride          = stride;
+    info.sourceBpp       = sourceBpp;
+    info.dest            = (uint8_t*)dest;
+    info.ow              = ow;
+    info.oh              = oh;
+    info.bpp             = outputBpp;
+    info.destBytes       = type.bytes();
+    info.needBlit        = sourceFormat != destFormat;
+    info.isFloat         = type.code == halide_type_float;
+    info.planeChannel    = planeChannel;
+
+    int threadNumber = 1;
+    if (nullptr != cpuBackend) {
+        threadNumber = std::max(1, std::min(cpuBackend->threadNumber(), oh));
+    }
+    // Each worker owns its cache, so that the convert don't share state between calls
+    AutoStorage<uint8_t> cache(CACHE_UNIT_BYTES * threadNumber);
+    if (nullptr == cache.get()) {
+        return OUT_OF_MEMORY;
+    }
+    if (1 == threadNumber) {
+        _convertRows(info, 0, oh, cache.get());
+        return NO_ERROR;
+    }
+#ifdef MNN_USE_THREAD_POOL
+    // The split runs on the task index of the backend, which is not reentrant. A convert in another thread that
+    // finds it in use converts in its own thread. Like the session, the backend mustn't run while converting.
+    static std::mutex gSplitMutex;
+    std::unique_lock<std::mutex> splitLock(gSplitMutex, std::try_to_lock);
+    if (!splitLock.owns_lock()) {
+        _convertRows(info, 0, oh, cache.get());
+        return NO_ERROR;
+    }
+#endif
+    // The rows are independent, split them on the threads of the backend
+    auto backend = [cpuBackend]() { return cpuBackend; };
+    cpuBackend->onExecuteBegin();
+    MNN_CONCURRENCY_BEGIN(tId, threadNumber) {
+        int yStart = (int)((int64_t)oh * tId / threadNumber);
+        int yEnd   = (int)((int64_t)oh * (tId + 1) / threadNumber);
+        _convertRows(info, yStart, yEnd, cache.get() + CACHE_UNIT_BYTES * tId);
+    }
+    MNN_CONCURRENCY_END();
+    cpuBackend->onExecuteEnd();
     return NO_ERROR;
 }
 
+ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int stride, Tensor* destOrigin) {
+    auto dest = destOrigin;
+    if (nullptr == dest || nullptr == source) {
+        MNN_ERROR("null dest or source for image process\n");
+        return INPUT_DATA_ERROR;
+    }
+    if (destOrigin->buffer().device == 0 && destOrigin->buffer().host == nullptr) {
+        MNN_ERROR("Invalid Tensor, the session may not be ready\n");
+        return INPUT_DATA_ERROR;
+    }
+    std::shared_ptr<Tensor> tempTensor;
+    auto ow              = dest->width();
+    auto oh              = dest->height();
+    auto bpp             = dest->channel();
+    auto dimensionFormat = TensorUtils::getDescribe(dest)->dimensionFormat;
+    auto tensorBn = TensorUtils::getDescribe(dest)->backend;
+    auto bnType = MNN_FORWARD_CPU;
+    if(tensorBn){
+        bnType = tensorBn->type();
+    }
+    const CPUBackend* cpuBackend = nullptr;
+    if (bnType != MNN_FORWARD_CPU) {
+        tempTensor.reset(Tensor::create({1, bpp, oh, ow}, dest->getType(), nullptr, Tensor::CAFFE_C4),[destOrigin] (void* p) {
+            auto hostTensor = (Tensor*)p;
+            destOrigin->copyFromHostTensor(hostTensor);
+            delete hostTensor;
+        });
+        dest = tempTensor.get();
+    } else {
+        // Use the threads of the session which owns the tensor
+        cpuBackend = static_cast<const CPUBackend*>(tensorBn);
+        if (MNN_DATA_FORMAT_NCHW == dimensionFormat) {
+            auto type        = dest->getType();
+            bool fuseToPlane = bpp <= 4 && (type.code == halide_type_float || type.bytes() == 1);
+            if (fuseToPlane) {
+                // Normalize and write the planes in one pass, no NC4HW4 temp tensor and layout convert
+                return _convertImage(mInside->config, mTransform, mTransformInvert, source, iw, ih, stride,
+                                     dest->host<void>(), ow, oh, 4, type, bpp, cpuBackend);
+            }
+            tempTensor.reset(Tensor::create(dest->shape(), dest->getType(), nullptr, Tensor::CAFFE_C4), [destOrigin](void* p) {
+                auto hostTensor = (Tensor*)p;
+                CPUTensorConverter::convert(hostTensor, destOrigin);
+                delete hostTensor;
+            });
+            dest = tempTensor.get();
+        }
+    }
+    dimensionFormat = TensorUtils::getDescribe(dest)->dimensionFormat;
+    if (dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
+        bpp = 4;
+    }
+    return _convertImage(mInside->config, mTransform, mTransformInvert, source, iw, ih, stride, dest->host<void>(),
+                         ow, oh, bpp, dest->getType(), 0, cpuBackend);
+}
+
+ErrorCode ImageProcess::convert(const uint8_t* source, int iw, int ih, int stride, void* dest, int ow, int oh,
+                                int outputBpp, int outputStride, halide_type_t type) {
+    return _convertImage(mInside->config, mTransform, mTransformInvert, source, iw, ih, stride, dest, ow, oh,
+                         outputBpp, type, 0, nullptr);
+}
+
 } // namespace CV
 } // namespace MNN
@@ -23,8 +23,10 @@ GeometryComputer::Context::~Context() {
     }
 }
 
-GeometryComputer::Context::Context(std::shared_ptr<Backend> allocBackend, bool permitVirtual) {
+GeometryComputer::Context::Context(std::shared_ptr<Backend> allocBackend, bool permitVirtual,
+                                   MNNForwardType forwardType) {
     mPermitVirtual = permitVirtual;
+    mForwardType   = forwardType;
     mBackend       = allocBackend;
     flatbuffers::FlatBufferBuilder builder;
     OpBuilder opBuilder(builder);
@@ -149,7 +151,7 @@ Tensor* GeometryComputer::Context::getRasterCacheCreate(Tensor* src, CommandBuff
 bool GeometryComputer::compute(const Op* op, const std::vector<Tensor*>& inputs,
                                const std::vector<Tensor*>& originOutputs, GeometryComputer::Context& context,
                                CommandBuffer& cmdBuffer) const {
-    auto outputRes = this->onGetOutputVirtual(op, inputs, originOutputs);
+    auto outputRes = this->onGetOutputVirtual(op, inputs, originOutputs, context);
     std::map<std::shared_ptr<Tensor>, Tensor*> rasterMap;
     auto outputs = originOutputs;
     for (int i = 0; i < outputs.size(); ++i) {
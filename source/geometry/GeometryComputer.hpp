@@ -10,6 +10,7 @@
 #define GeometryComputer_hpp
 #include <map>
 #include <vector>
+#include <MNN/MNNForwardType.h>
 #include "MNN_generated.h"
 #include "core/Command.hpp"
 #include "core/TensorUtils.hpp"
@@ -22,7 +23,9 @@ public:
     }
     class MNN_PUBLIC Context {
     public:
-        Context(std::shared_ptr<Backend> allocBackend, bool permitVirtual = true);
+        // forwardType is the type of the backend which executes the commands
+        Context(std::shared_ptr<Backend> allocBackend, bool permitVirtual = true,
+                MNNForwardType forwardType = MNN_FORWARD_CPU);
         ~Context();
 
         void clear();
@@ -30,6 +33,9 @@ public:
         bool supportVirtual() const {
             return mPermitVirtual;
         }
+        MNNForwardType forwardType() const {
+            return mForwardType;
+        }
         Tensor* getRasterCacheCreateRecurrse(Tensor* src, CommandBuffer& cmd);
         const std::vector<std::shared_ptr<Tensor>>& searchConst(const Op* op) const;
         std::shared_ptr<Tensor> allocConst(const Op* key, const std::vector<int>& shape, halide_type_t type,
@@ -42,6 +48,7 @@ public:
         std::map<const Op*, std::vector<std::shared_ptr<Tensor>>> mConstTensors;
         std::vector<std::shared_ptr<Tensor>> mEmpty;
         bool mPermitVirtual;
+        MNNForwardType mForwardType;
         std::shared_ptr<Backend> mBackend;
         std::vector<uint8_t> mRasterOp;
     };
@@ -58,6 +65,11 @@ protected:
     // Return the outputs tensor is virtual or not
     virtual std::vector<bool> onGetOutputVirtual(const Op* op, const std::vector<Tensor*>& inputs,
                                                  const std::vector<Tensor*>& outputs) const;
+    // For the computers whose decomposition depends on the context, call the one above by default
+    virtual std::vector<bool> onGetOutputVirtual(const Op* op, const std::vector<Tensor*>& inputs,
+                                                 const std::vector<Tensor*>& outputs, const Context& context) const {
+        return onGetOutputVirtual(op, inputs, outputs);
+    }
 };
 
 class DefaultGeometryComputer : public GeometryComputer {
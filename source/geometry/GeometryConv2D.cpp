@@ -311,8 +311,31 @@ public:
             // Origin convolution with format converter
             return GeometryConvUtils::computeSingle(op, inputs, outputs, context, res);
         }
+        if (_computeDirectly(op, inputs, context)) {
+            // Weight as input in NC4HW4 (such as the input grad of convolution), computed by backend directly
+            return GeometryConvUtils::computeSingle(op, inputs, outputs, context, res);
+        }
         return computeGEMM_Col2Im(op, inputs, outputs, context, res);
     }
+    virtual std::vector<bool> onGetOutputVirtual(const Op* op, const std::vector<Tensor*>& inputs,
+                                                 const std::vector<Tensor*>& outputs,
+                                                 const Context& context) const override {
+        std::vector<bool> res(outputs.size(), true);
+        auto outputDes = TensorUtils::getDescribe(outputs[0]);
+        if (MNN_DATA_FORMAT_NC4HW4 == outputDes->dimensionFormat) {
+            if (1 == inputs.size() || _computeDirectly(op, inputs, context)) {
+                res[0] = false;
+            }
+        }
+        return res;
+    }
+
+private:
+    // Only the CPU backend computes the deconvolution with weight as input
+    static bool _computeDirectly(const Op* op, const std::vector<Tensor*>& inputs, const Context& context) {
+        return MNN_FORWARD_CPU == context.forwardType() && 1 == op->main_as_Convolution2D()->common()->group() &&
+               MNN_DATA_FORMAT_NC4HW4 == TensorUtils::getDescribe(inputs[0])->dimensionFormat;
+    }
 };
 static void _create() {
     std::shared_ptr<GeometryComputer> comp(new GeometryConv2D);
@@ -167,6 +167,11 @@ public:
         }
         return true;
     }
+    virtual std::vector<bool> onGetOutputVirtual(const Op* op, const std::vector<Tensor*>& inputs,
+                                                 const std::vector<Tensor*>& outputs,
+                                                 const Context& context) const override {
+        return {!_computeDirectly(op, inputs, context)};
+    }
     virtual bool onCompute(const Op* op, const std::vector<Tensor*>& inputs, const std::vector<Tensor*>& outputs,
                            Context& context, CommandBuffer& res) const override {
         auto common     = op->main_as_Convolution2D()->common();
@@ -175,6 +180,17 @@ public:
         bool depthWise  = false;
         if (inputs[0]->channel() == inputs[1]->channel() && inputs[1]->channel() == common->group()) {
             depthWise = true;
+        }
+        if (_computeDirectly(op, inputs, context)) {
+            // Computed by backend directly, without im2col
+            Command cmd;
+            cmd.op      = op;
+            cmd.inputs  = inputs;
+            cmd.outputs = outputs;
+            res.command.emplace_back(std::move(cmd));
+            return true;
+        }
+        if (depthWise) {
             return computeForDepthWise(common, input, outputDiff, outputs[0], context, res);
         }
         auto kw    = common->kernelX();
@@ -275,6 +291,16 @@ public:
         }
         return true;
     }
+
+private:
+    // Dense or depthwise with input and output diff in NC4HW4, only the CPU backend computes this form
+    static bool _computeDirectly(const Op* op, const std::vector<Tensor*>& inputs, const Context& context) {
+        auto group     = op->main_as_Convolution2D()->common()->group();
+        bool depthWise = inputs[0]->channel() == inputs[1]->channel() && inputs[1]->channel() == group;
+        return MNN_FORWARD_CPU == context.forwardType() && (depthWise || 1 == group) &&
+               MNN_DATA_FORMAT_NC4HW4 == TensorUtils::getDescribe(inputs[0])->dimensionFormat &&
+               MNN_DATA_FORMAT_NC4HW4 == TensorUtils::getDescribe(inputs[1])->dimensionFormat;
+    }
 };
 
 static void _create() {
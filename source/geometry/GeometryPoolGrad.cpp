@@ -452,6 +452,11 @@ public:
 
         return true;
     }
+    virtual std::vector<bool> onGetOutputVirtual(const Op* op, const std::vector<Tensor*>& inputs,
+                                                 const std::vector<Tensor*>& outputs) const override {
+        // The max pool grad writes the output by eltwise, only the one of average pool is virtual
+        return {PoolType_MAXPOOL != op->main_as_Pool()->type()};
+    }
 };
 
 static void _create() {
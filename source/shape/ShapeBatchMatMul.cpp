@@ -22,30 +22,38 @@ public:
         auto param = op->main_as_BatchMatMulParam();
         auto input0 = inputs[0];
         auto input1 = inputs[1];
-        MNN_ASSERT(input0->dimensions() == input1->dimensions());
-
-        const int dimensions = input0->dimensions();
-        MNN_ASSERT(dimensions >= 2);
-        for (int i = 0; i < dimensions - 2; ++i) {
-            MNN_ASSERT(input0->length(i) == input1->length(i));
+        const int i0Dim = input0->dimensions();
+        const int i1Dim = input1->dimensions();
+        if (i0Dim < 2 || i1Dim < 2) {
+            return false;
         }
-
+        // The batch dimensions are broadcast, align them from the last
+        const int dimensions = ALIMAX(i0Dim, i1Dim);
         auto output = outputs[0];
         output->buffer().type = input0->buffer().type;
-        TensorUtils::copyShape(input0, output, true);
-        auto k0 = input0->length(dimensions - 1);
-        auto k1 = input1->length(dimensions - 2);
+        TensorUtils::copyShape(i0Dim >= i1Dim ? input0 : input1, output, true);
+        for (int i = 0; i < dimensions - 2; ++i) {
+            int l0 = i - (dimensions - i0Dim) >= 0 ? input0->length(i - (dimensions - i0Dim)) : 1;
+            int l1 = i - (dimensions - i1Dim) >= 0 ? input1->length(i - (dimensions - i1Dim)) : 1;
+            if (l0 != l1 && l0 != 1 && l1 != 1) {
+                MNN_ERROR("Don't support broadcast for BatchMatMul, i0=%d, i1=%d\n", l0, l1);
+                return false;
+            }
+            output->setLength(i, ALIMAX(l0, l1));
+        }
+        auto k0 = input0->length(i0Dim - 1);
+        auto k1 = input1->length(i1Dim - 2);
         if (param->adjX()) {
-            k0 = input0->length(dimensions - 2);
-            output->setLength(dimensions - 2, input0->length(dimensions - 1));
+            k0 = input0->length(i0Dim - 2);
+            output->setLength(dimensions - 2, input0->length(i0Dim - 1));
         } else {
-            output->setLength(dimensions - 2, input0->length(dimensions - 2));
+            output->setLength(dimensions - 2, input0->length(i0Dim - 2));
         }
         if (param->adjY()) {
-            k1 = input1->length(dimensions - 1);
-            output->setLength(dimensions - 1, input1->length(dimensions - 2));
+            k1 = input1->length(i1Dim - 1);
+            output->setLength(dimensions - 1, input1->length(i1Dim - 2));
         } else {
-            output->setLength(dimensions - 1, input1->length(dimensions - 1));
+            output->setLength(dimensions - 1, input1->length(i1Dim - 1));
         }
         if (k0 != k1) {
             return false;
@@ -0,0 +1,37 @@
+//
+//  ShapeBatchNormTrain.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "shape/SizeComputer.hpp"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+
+// Output 0 has the shape of x, others have the shape of the per-channel parameter
+class BatchNormTrainComputer : public SizeComputer {
+    virtual bool onComputeSize(const MNN::Op* op, const std::vector<Tensor*>& inputs,
+                               const std::vector<Tensor*>& outputs) const override {
+        MNN_ASSERT(5 == inputs.size());
+        auto x       = inputs[0];
+        auto channel = op->type() == OpType_BatchNormTrain ? inputs[1] : inputs[2];
+        if (x->dimensions() < 2 || channel->elementSize() != x->length(1)) {
+            return false;
+        }
+        TensorUtils::copyShape(x, outputs[0], true);
+        outputs[0]->buffer().type = x->buffer().type;
+        for (int i = 1; i < outputs.size(); ++i) {
+            TensorUtils::copyShape(channel, outputs[i], true);
+            outputs[i]->buffer().type = channel->buffer().type;
+        }
+        return true;
+    }
+};
+
+REGISTER_SHAPE(BatchNormTrainComputer, OpType_BatchNormTrain);
+REGISTER_SHAPE(BatchNormTrainComputer, OpType_BatchNormTrainGrad);
+} // namespace MNN
@@ -0,0 +1,40 @@
+//
+//  ShapeDropout.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/09.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "shape/SizeComputer.hpp"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+
+// Output 0 is the same as input, output 1 is the bit-packed mask of the input buffer (including C4 padding)
+class DropoutComputer : public SizeComputer {
+    virtual bool onComputeSize(const MNN::Op* op, const std::vector<Tensor*>& inputs,
+                               const std::vector<Tensor*>& outputs) const override {
+        MNN_ASSERT(1 == inputs.size());
+        auto input = inputs[0];
+        if (input->getType() != halide_type_of<float>()) {
+            return false;
+        }
+        TensorUtils::copyShape(input, outputs[0], true);
+        outputs[0]->buffer().type = input->buffer().type;
+        if (outputs.size() < 2) {
+            return true;
+        }
+        auto count                          = input->size() / input->getType().bytes();
+        auto& mask                          = outputs[1]->buffer();
+        mask.dimensions                     = 1;
+        mask.dim[0].extent                  = (count + 7) / 8;
+        mask.type                           = halide_type_of<uint8_t>();
+        TensorUtils::getDescribe(outputs[1])->dimensionFormat = MNN_DATA_FORMAT_NCHW;
+        return true;
+    }
+};
+
+REGISTER_SHAPE(DropoutComputer, OpType_Dropout);
+} // namespace MNN
@@ -0,0 +1,48 @@
+//
+//  ShapeEmbeddingBag.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/29.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "shape/SizeComputer.hpp"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+
+// weight: [num, d1, ...], offsets: [bags] -> output: [bags, d1, ...]
+class EmbeddingBagComputer : public SizeComputer {
+    virtual bool onComputeSize(const MNN::Op* op, const std::vector<Tensor*>& inputs,
+                               const std::vector<Tensor*>& outputs) const override {
+        MNN_ASSERT(3 == inputs.size() || 4 == inputs.size());
+        auto weight  = inputs[0];
+        auto indices = inputs[1];
+        auto offsets = inputs[2];
+        if (weight->getType().code != halide_type_float || weight->dimensions() < 1) {
+            return false;
+        }
+        if (indices->getType().code != halide_type_int || offsets->getType().code != halide_type_int) {
+            return false;
+        }
+        if (offsets->dimensions() != 1) {
+            return false;
+        }
+        if (inputs.size() == 4 && inputs[3]->elementSize() != indices->elementSize()) {
+            return false;
+        }
+        auto& ob      = outputs[0]->buffer();
+        ob.dimensions = weight->dimensions();
+        ob.type       = weight->getType();
+        ob.dim[0].extent = offsets->length(0);
+        for (int i = 1; i < weight->dimensions(); ++i) {
+            ob.dim[i].extent = weight->length(i);
+        }
+        TensorUtils::getDescribe(outputs[0])->dimensionFormat = TensorUtils::getDescribe(weight)->dimensionFormat;
+        return true;
+    }
+};
+
+REGISTER_SHAPE(EmbeddingBagComputer, OpType_EmbeddingBag);
+} // namespace MNN
@@ -0,0 +1,52 @@
+//
+//  ShapeGAE.cpp
+//  MNN
+//
+//  Created by MNN on 2021/01/07.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "shape/SizeComputer.hpp"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+
+// inputs: reward, value, done [T, N], bootstrap [N]; outputs: advantage, return [T, N]
+class GAEComputer : public SizeComputer {
+    virtual bool onComputeSize(const MNN::Op* op, const std::vector<Tensor*>& inputs,
+                               const std::vector<Tensor*>& outputs) const override {
+        if (4 != inputs.size() || 2 != outputs.size()) {
+            return false;
+        }
+        auto reward = inputs[0];
+        if (2 != reward->dimensions()) {
+            MNN_ERROR("GAE need [T, N] reward\n");
+            return false;
+        }
+        for (int i = 0; i < 4; ++i) {
+            if (inputs[i]->getType() != halide_type_of<float>() ||
+                TensorUtils::getDescribe(inputs[i])->dimensionFormat == MNN_DATA_FORMAT_NC4HW4) {
+                return false;
+            }
+        }
+        for (int i = 1; i < 3; ++i) {
+            if (inputs[i]->elementSize() != reward->elementSize()) {
+                MNN_ERROR("GAE need value and done of the same size as reward\n");
+                return false;
+            }
+        }
+        if (inputs[3]->elementSize() != reward->length(1)) {
+            MNN_ERROR("GAE need one bootstrap value for each trajectory\n");
+            return false;
+        }
+        for (auto output : outputs) {
+            TensorUtils::copyShape(reward, output, true);
+            output->buffer().type = reward->buffer().type;
+        }
+        return true;
+    }
+};
+
+REGISTER_SHAPE(GAEComputer, OpType_GAE);
+} // namespace MNN
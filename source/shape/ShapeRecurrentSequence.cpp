@@ -0,0 +1,62 @@
+//
+//  ShapeRecurrentSequence.cpp
+//  MNN
+//
+//  Created by MNN on 2021/01/04.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "shape/SizeComputer.hpp"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+
+// Time major x [T, N, I], the hidden size H comes from wh [H, G * H]
+class RecurrentSequenceComputer : public SizeComputer {
+    virtual bool onComputeSize(const MNN::Op* op, const std::vector<Tensor*>& inputs,
+                               const std::vector<Tensor*>& outputs) const override {
+        const bool lstm = op->type() == OpType_LSTMSequence || op->type() == OpType_LSTMSequenceGrad;
+        if (inputs.size() < (lstm ? 6 : 5)) {
+            return false;
+        }
+        auto x  = inputs[0];
+        auto wx = inputs[1];
+        auto wh = inputs[2];
+        if (x->dimensions() != 3 || wx->dimensions() != 2 || wh->dimensions() != 2) {
+            return false;
+        }
+        const int H  = wh->length(0);
+        const int GH = (lstm ? 4 : 3) * H;
+        if (wh->length(1) != GH || wx->length(0) != x->length(2) || wx->length(1) != GH ||
+            inputs[3]->elementSize() != (lstm ? GH : 2 * GH) || inputs[4]->elementSize() != x->length(1) * H) {
+            return false;
+        }
+        if (op->type() == OpType_GRUSequenceGrad || op->type() == OpType_LSTMSequenceGrad) {
+            // Grads of x, wx, wh, bias, h0 (, c0)
+            for (int i = 0; i < outputs.size(); ++i) {
+                TensorUtils::copyShape(inputs[i], outputs[i], true);
+                outputs[i]->buffer().type = inputs[i]->buffer().type;
+            }
+            return true;
+        }
+        // y (, cell), reserve
+        for (int i = 0; i < outputs.size(); ++i) {
+            auto& output         = outputs[i]->buffer();
+            output.type          = x->buffer().type;
+            output.dimensions    = 3;
+            output.dim[0].extent = x->length(0);
+            output.dim[1].extent = x->length(1);
+            output.dim[2].extent = H;
+            TensorUtils::getDescribe(outputs[i])->dimensionFormat = TensorUtils::getDescribe(x)->dimensionFormat;
+        }
+        outputs[outputs.size() - 1]->buffer().dim[2].extent = 4 * H;
+        return true;
+    }
+};
+
+REGISTER_SHAPE(RecurrentSequenceComputer, OpType_GRUSequence);
+REGISTER_SHAPE(RecurrentSequenceComputer, OpType_GRUSequenceGrad);
+REGISTER_SHAPE(RecurrentSequenceComputer, OpType_LSTMSequence);
+REGISTER_SHAPE(RecurrentSequenceComputer, OpType_LSTMSequenceGrad);
+} // namespace MNN
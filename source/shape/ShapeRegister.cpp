@@ -86,6 +86,16 @@ extern void ___SpaceToBatchNDSizeComputer__OpType_SpaceToBatchND__();
 extern void ___PackComputer__OpType_Pack__();
 extern void ___DeconvolutionSizeComputer__OpType_Deconvolution__();
 extern void ___DeconvolutionSizeComputer__OpType_DeconvolutionDepthwise__();
+extern void ___SoftmaxCrossEntropyComputer__OpType_SoftmaxCrossEntropy__();
+extern void ___DropoutComputer__OpType_Dropout__();
+extern void ___BatchNormTrainComputer__OpType_BatchNormTrain__();
+extern void ___BatchNormTrainComputer__OpType_BatchNormTrainGrad__();
+extern void ___EmbeddingBagComputer__OpType_EmbeddingBag__();
+extern void ___RecurrentSequenceComputer__OpType_GRUSequence__();
+extern void ___RecurrentSequenceComputer__OpType_GRUSequenceGrad__();
+extern void ___RecurrentSequenceComputer__OpType_LSTMSequence__();
+extern void ___RecurrentSequenceComputer__OpType_LSTMSequenceGrad__();
+extern void ___GAEComputer__OpType_GAE__();
 
 void registerShapeOps() {
 ___ShapeSizeComputer__OpType_Shape__();
@@ -174,5 +184,15 @@ ___SpaceToBatchNDSizeComputer__OpType_SpaceToBatchND__();
 ___PackComputer__OpType_Pack__();
 ___DeconvolutionSizeComputer__OpType_Deconvolution__();
 ___DeconvolutionSizeComputer__OpType_DeconvolutionDepthwise__();
+___SoftmaxCrossEntropyComputer__OpType_SoftmaxCrossEntropy__();
+___DropoutComputer__OpType_Dropout__();
+___BatchNormTrainComputer__OpType_BatchNormTrain__();
+___BatchNormTrainComputer__OpType_BatchNormTrainGrad__();
+___EmbeddingBagComputer__OpType_EmbeddingBag__();
+___RecurrentSequenceComputer__OpType_GRUSequence__();
+___RecurrentSequenceComputer__OpType_GRUSequenceGrad__();
+___RecurrentSequenceComputer__OpType_LSTMSequence__();
+___RecurrentSequenceComputer__OpType_LSTMSequenceGrad__();
+___GAEComputer__OpType_GAE__();
 }
 }
@@ -0,0 +1,39 @@
+//
+//  ShapeSoftmaxCrossEntropy.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/07.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "shape/SizeComputer.hpp"
+#include "core/Macro.h"
+#include "core/TensorUtils.hpp"
+
+namespace MNN {
+
+// Reduce the last axis of logits to per-sample loss
+class SoftmaxCrossEntropyComputer : public SizeComputer {
+    virtual bool onComputeSize(const MNN::Op* op, const std::vector<Tensor*>& inputs,
+                               const std::vector<Tensor*>& outputs) const override {
+        MNN_ASSERT(2 == inputs.size());
+        MNN_ASSERT(1 == outputs.size());
+        auto logits = inputs[0];
+        auto labels = inputs[1];
+        if (TensorUtils::getDescribe(logits)->dimensionFormat == MNN_DATA_FORMAT_NC4HW4 ||
+            logits->dimensions() < 1 || logits->elementSize() != labels->elementSize()) {
+            return false;
+        }
+        auto& ob      = outputs[0]->buffer();
+        ob.dimensions = logits->dimensions() - 1;
+        for (int i = 0; i < ob.dimensions; ++i) {
+            ob.dim[i].extent = logits->length(i);
+        }
+        ob.type = logits->buffer().type;
+        TensorUtils::getDescribe(outputs[0])->dimensionFormat = TensorUtils::getDescribe(logits)->dimensionFormat;
+        return true;
+    }
+};
+
+REGISTER_SHAPE(SoftmaxCrossEntropyComputer, OpType_SoftmaxCrossEntropy);
+} // namespace MNN
@@ -0,0 +1,110 @@
+//
+//  BatchSchedulerTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2020/12/21.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/BatchScheduler.hpp>
+#include <thread>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+using namespace MNN;
+
+class BatchSchedulerTest : public MNNTestCase {
+public:
+    virtual ~BatchSchedulerTest() = default;
+    virtual bool run() {
+        // build net: y = tanh(x), x: [batch, 16]
+        const int length = 16;
+        std::unique_ptr<NetT> net(new NetT);
+        std::unique_ptr<OpT> input(new OpT);
+        input->type = OpType_Input;
+        auto param(new InputT);
+        param->dims    = {1, length};
+        param->dformat = MNN_DATA_FORMAT_NHWC;
+        input->main.type  = OpParameter_Input;
+        input->main.value = param;
+        input->outputIndexes.push_back(0);
+        net->oplists.emplace_back(std::move(input));
+        std::unique_ptr<OpT> op(new OpT);
+        op->type = OpType_TanH;
+        op->inputIndexes.push_back(0);
+        op->outputIndexes.push_back(1);
+        net->oplists.emplace_back(std::move(op));
+        net->tensorName.push_back("x");
+        net->tensorName.push_back("y");
+        net->tensorNumber = 2;
+        net->usage        = Usage_INFERENCE;
+        flatbuffers::FlatBufferBuilder builder(1024);
+        auto offset = MNN::Net::Pack(builder, net.get());
+        builder.Finish(offset);
+
+        BatchScheduler::Config config;
+        config.batchBuckets       = {1, 2, 4};
+        config.maxWaitUs          = 1000;
+        config.schedule.numThread = 1;
+        std::shared_ptr<BatchScheduler> scheduler(
+            BatchScheduler::createFromBuffer(builder.GetBufferPointer(), builder.GetSize(), config));
+        if (nullptr == scheduler) {
+            MNN_ERROR("Create BatchScheduler failed\n");
+            return false;
+        }
+        // Submit from several threads, each request must get its own result
+        const int threadNumber = 3, requestNumber = 7;
+        // Not vector<bool>, whose elements share words and can't be written from several threads
+        std::vector<int> correct(threadNumber, 1);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadNumber; ++t) {
+            threads.emplace_back([&, t]() {
+                std::vector<std::future<BatchScheduler::Result>> futures;
+                std::vector<std::shared_ptr<Tensor>> inputs;
+                for (int r = 0; r < requestNumber; ++r) {
+                    auto x   = scheduler->createInput("x");
+                    auto ptr = x->host<float>();
+                    for (int i = 0; i < length; ++i) {
+                        ptr[i] = (float)(t * 100 + r * 10 + i) / 200.0f - 1.0f;
+                    }
+                    inputs.emplace_back(x);
+                    futures.emplace_back(scheduler->submit({{"x", x}}));
+                }
+                for (int r = 0; r < requestNumber; ++r) {
+                    auto result = futures[r].get();
+                    if (result.code != NO_ERROR || result.outputs.find("y") == result.outputs.end()) {
+                        correct[t] = 0;
+                        continue;
+                    }
+                    auto y = result.outputs["y"];
+                    if (y->length(0) != 1 || y->elementSize() != length) {
+                        correct[t] = 0;
+                        continue;
+                    }
+                    for (int i = 0; i < length; ++i) {
+                        if (fabsf(y->host<float>()[i] - tanhf(inputs[r]->host<float>()[i])) > 1e-4f) {
+                            correct[t] = 0;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (auto c : correct) {
+            if (!c) {
+                MNN_ERROR("BatchScheduler result error\n");
+                return false;
+            }
+        }
+        // Mismatched input is rejected
+        std::shared_ptr<Tensor> wrong(Tensor::create<float>({1, length + 1}));
+        if (scheduler->submit({{"x", wrong}}).get().code != INPUT_DATA_ERROR) {
+            MNN_ERROR("BatchScheduler should reject invalid input\n");
+            return false;
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(BatchSchedulerTest, "core/batch_scheduler");
@@ -7,10 +7,15 @@
 //
 
 #include <MNN/ImageProcess.hpp>
+#include <MNN/Interpreter.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <map>
+#include <thread>
 #include "MNNTestSuite.h"
+#include "MNN_generated.h"
 
 using namespace MNN;
 using namespace MNN::CV;
@@ -580,6 +585,118 @@ public:
 };
 MNNTestSuiteRegister(ImageProcessBGRToBGRFloatBlitterTest, "cv/image_process/bgr_to_bgr_blitter");
 
+// rgba -> bgr float, normalized and written to NCHW planes, the width is larger than one cache tile
+class ImageProcessRGBAToBGRPlanarTest : public MNNTestCase {
+public:
+    virtual ~ImageProcessRGBAToBGRPlanarTest() = default;
+    virtual bool run() {
+        int w = 300, h = 7, size = w * h;
+        auto integers = genSourceData(h, w, 4);
+        std::vector<float> floats(size * 3);
+        std::shared_ptr<MNN::Tensor> tensor(
+            MNN::Tensor::create<float>(std::vector<int>{1, 3, h, w}, floats.data(), Tensor::CAFFE));
+        ImageProcess::Config config;
+        config.sourceFormat = RGBA;
+        config.destFormat   = BGR;
+
+        const float means[3]   = {103.94f, 116.78f, 123.68f};
+        const float normals[3] = {0.017f, 0.018f, 0.019f};
+        memcpy(config.mean, means, sizeof(means));
+        memcpy(config.normal, normals, sizeof(normals));
+
+        std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+        process->convert(integers.data(), w, h, 0, tensor.get());
+        for (int c = 0; c < 3; ++c) {
+            for (int i = 0; i < size; ++i) {
+                float result = floats[c * size + i];
+                float right  = (integers[4 * i + 2 - c] - means[c]) * normals[c];
+                if (fabs(result - right) > 1e-5f) {
+                    MNN_ERROR("Error for rgba to bgr planar, channel %d, index %d: %f, right: %f\n", c, i, result,
+                              right);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageProcessRGBAToBGRPlanarTest, "cv/image_process/rgba_to_bgr_planar");
+
+// Two threads convert into the inputs of one multi-thread session at once, the rows are split on the threads
+// of the session, compare with the serial convert into host tensors
+class ImageProcessSessionInputTest : public MNNTestCase {
+public:
+    virtual ~ImageProcessSessionInputTest() = default;
+    virtual bool run() {
+        const int w = 97, h = 61, iw = 128, ih = 80;
+        std::shared_ptr<Interpreter> net;
+        {
+            auto x0 = Express::_Input({1, 3, h, w}, Express::NCHW);
+            auto x1 = Express::_Input({1, 3, h, w}, Express::NCHW);
+            x0->setName("x0");
+            x1->setName("x1");
+            auto y = Express::_Add(x0, x1);
+            y->setName("y");
+            std::unique_ptr<NetT> netT(new NetT);
+            Express::Variable::save({y}, netT.get());
+            flatbuffers::FlatBufferBuilder builder(1024);
+            builder.Finish(Net::Pack(builder, netT.get()));
+            net.reset(Interpreter::createFromBuffer(builder.GetBufferPointer(), builder.GetSize()));
+        }
+        ScheduleConfig scheduleConfig;
+        scheduleConfig.numThread = 4;
+        auto session             = net->createSession(scheduleConfig);
+        Tensor* inputs[2]        = {net->getSessionInput(session, "x0"), net->getSessionInput(session, "x1")};
+        std::vector<uint8_t> sources[2] = {genSourceData(ih, iw, 4), genSourceData(ih, iw, 4)};
+        std::reverse(sources[1].begin(), sources[1].end());
+
+        ImageProcess::Config config;
+        config.sourceFormat = RGBA;
+        config.destFormat   = BGR;
+        config.filterType   = BILINEAR;
+        const float means[3]   = {103.94f, 116.78f, 123.68f};
+        const float normals[3] = {0.017f, 0.018f, 0.019f};
+        memcpy(config.mean, means, sizeof(means));
+        memcpy(config.normal, normals, sizeof(normals));
+        Matrix transform;
+        transform.setScale((float)iw / w, (float)ih / h);
+        transform.postRotate(7.0f, iw / 2.0f, ih / 2.0f);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&, t]() {
+                std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+                process->setMatrix(transform);
+                for (int i = 0; i < 20; ++i) {
+                    process->convert(sources[t].data(), iw, ih, 0, inputs[t]);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (int t = 0; t < 2; ++t) {
+            std::shared_ptr<Tensor> expect(Tensor::createHostTensorFromDevice(inputs[t], false));
+            std::shared_ptr<Tensor> result(Tensor::createHostTensorFromDevice(inputs[t], false));
+            std::shared_ptr<ImageProcess> process(ImageProcess::create(config));
+            process->setMatrix(transform);
+            process->convert(sources[t].data(), iw, ih, 0, expect.get());
+            inputs[t]->copyToHostTensor(result.get());
+            for (int i = 0; i < expect->elementSize(); ++i) {
+                auto right = expect->host<float>()[i];
+                auto value = result->host<float>()[i];
+                if (fabsf(value - right) > 1e-6f) {
+                    MNN_ERROR("Error for convert into session input %d, index %d: %f, right: %f\n", t, i, value,
+                              right);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ImageProcessSessionInputTest, "cv/image_process/session_input");
+
 // Test for _blitC1ToFloatC1
 class ImageProcessGrayToGrayFloatBlitterTest : public MNNTestCase {
 public:
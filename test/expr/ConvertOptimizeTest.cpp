@@ -0,0 +1,111 @@
+//
+//  ConvertOptimizeTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/01/05.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/ExprCreator.hpp>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN::Express;
+
+static bool _checkValue(VARP y, const std::vector<float>& expect, const char* name) {
+    auto ptr = y->readMap<float>();
+    if (nullptr == ptr || y->getInfo()->size != expect.size()) {
+        MNN_ERROR("ConvertOptimizeTest %s can't compute\n", name);
+        return false;
+    }
+    for (int i = 0; i < expect.size(); ++i) {
+        if (fabsf(ptr[i] - expect[i]) > 1e-6f) {
+            MNN_ERROR("ConvertOptimizeTest %s: %d, %f - %f\n", name, i, ptr[i], expect[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static EXPRP _inputExpr(VARP y, int index = 0) {
+    return y->expr().first->inputs()[index]->expr().first;
+}
+
+// Redundant ConvertTensor are cancelled or sunk when the graph is computed
+class ConvertOptimizeTest : public MNNTestCase {
+public:
+    virtual ~ConvertOptimizeTest() = default;
+    virtual bool run() {
+        // Channel not aligned to 4, so NC4HW4 has padding
+        const int c = 5, h = 3, w = 2;
+        std::vector<float> data(c * h * w), square(data.size()), relu(data.size());
+        for (int i = 0; i < data.size(); ++i) {
+            data[i]   = (float)(i % 7) - 3.0f;
+            square[i] = data[i] * data[i];
+            relu[i]   = fmaxf(data[i], 0.0f);
+        }
+        {
+            // Convert(Convert(x)) -> x
+            auto x = _Const(data.data(), {1, c, h, w}, NCHW);
+            auto b = _Convert(_Convert(x, NC4HW4), NCHW);
+            auto y = _Square(b);
+            if (!_checkValue(y, square, "inverse pair")) {
+                return false;
+            }
+            if (_inputExpr(y) != x->expr().first) {
+                MNN_ERROR("ConvertOptimizeTest inverse pair is not cancelled\n");
+                return false;
+            }
+            // The intermediate is still valid
+            if (!_checkValue(b, data, "inverse pair intermediate")) {
+                return false;
+            }
+        }
+        {
+            // Convert(Convert(x, NCHW), NC4HW4) -> Convert(x, NC4HW4)
+            std::vector<float> nhwc(data.size());
+            for (int i = 0; i < c; ++i) {
+                for (int j = 0; j < h * w; ++j) {
+                    nhwc[j * c + i] = data[i * h * w + j];
+                }
+            }
+            auto x = _Const(nhwc.data(), {1, h, w, c}, NHWC);
+            auto y = _Convert(_Relu(_Convert(_Convert(x, NCHW), NC4HW4)), NCHW);
+            if (!_checkValue(y, relu, "convert chain")) {
+                return false;
+            }
+            auto convert = _inputExpr(y->expr().first->inputs()[0]);
+            if (MNN::OpType_ConvertTensor != convert->get()->type() ||
+                convert->inputs()[0]->expr().first != x->expr().first) {
+                MNN_ERROR("ConvertOptimizeTest convert chain is not folded\n");
+                return false;
+            }
+        }
+        {
+            // Convert(Relu(Convert(x, NCHW)), NC4HW4) -> Relu(x), x is the NC4HW4 output of a 1x1 conv computing x - 1
+            auto x = _Const(data.data(), {1, c, h, w}, NCHW);
+            std::vector<float> weight(c * c, 0.0f), bias(c, -1.0f);
+            for (int i = 0; i < c; ++i) {
+                weight[i * c + i] = 1.0f;
+            }
+            auto p = _Conv(std::move(weight), std::move(bias), _Convert(x, NC4HW4), {c, c}, {1, 1});
+            auto q = _Convert(_Relu(_Convert(p, NCHW)), NC4HW4);
+            auto y = _Convert(_Relu(q), NCHW);
+            std::vector<float> expect(data.size());
+            for (int i = 0; i < data.size(); ++i) {
+                expect[i] = fmaxf(data[i] - 1.0f, 0.0f);
+            }
+            if (!_checkValue(y, expect, "sink")) {
+                return false;
+            }
+            auto sunk = _inputExpr(y->expr().first->inputs()[0]);
+            if (MNN::OpType_ReLU != sunk->get()->type() || sunk->inputs()[0]->expr().first != p->expr().first) {
+                MNN_ERROR("ConvertOptimizeTest convert is not sunk\n");
+                return false;
+            }
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(ConvertOptimizeTest, "expr/ConvertOptimize");
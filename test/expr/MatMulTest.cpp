@@ -230,6 +230,42 @@ public:
             }
         }
 
+        {
+            // Broadcast B over the batch dimensions of A, sizes not aligned to the pack unit
+            std::unique_ptr<MNN::OpT> op(new MNN::OpT);
+            op->type       = MNN::OpType_BatchMatMul;
+            op->main.type  = MNN::OpParameter_BatchMatMulParam;
+            op->main.value = new MNN::BatchMatMulParamT;
+            auto param     = op->main.AsBatchMatMulParam();
+            param->adjX    = false;
+            param->adjY    = true;
+
+            const int batch = 6, bh = 17, bl = 13, be = 29;
+            auto x0         = _Input({2, 3, bh, bl}, NHWC, halide_type_of<float>());
+            auto x1         = _Input({1, bl, be}, NHWC, halide_type_of<float>());
+            auto x0Ptr      = x0->writeMap<float>();
+            auto x1Ptr      = x1->writeMap<float>();
+            for (int b = 0; b < batch; ++b) {
+                fillFloat(x0Ptr + b * bh * bl, bh, bl, (float)b);
+            }
+            fillFloat(x1Ptr, bl, be);
+            auto tranposeB = _Transpose(x1, {0, 2, 1});
+            auto y         = Variable::create(Expr::create(op.get(), {x0, tranposeB}));
+            auto info      = y->getInfo();
+            if (nullptr == info || info->dim != std::vector<int>({2, 3, bh, be})) {
+                FUNC_PRINT(1);
+                return false;
+            }
+            auto yPtr = y->readMap<float>();
+            for (int b = 0; b < batch; ++b) {
+                auto res = checkMatMul(yPtr + b * be * bh, x0Ptr + b * bh * bl, x1Ptr, be, bl, bh);
+                if (!res) {
+                    FUNC_PRINT(1);
+                    return false;
+                }
+            }
+        }
+
         return true;
     }
 };
@@ -0,0 +1,231 @@
+//
+//  WhileModuleTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/01/08.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/Module.hpp>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+
+using namespace MNN;
+using namespace MNN::Express;
+
+static int _tensorIndex(const std::vector<std::string>& names, const std::string& name) {
+    for (int i = 0; i < names.size(); ++i) {
+        if (names[i] == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static std::unique_ptr<SubGraphProtoT> _makeSubGraph(const std::string& name, const std::vector<VARP>& inputs,
+                                                     const std::vector<VARP>& outputs) {
+    std::unique_ptr<NetT> net(new NetT);
+    Variable::save(outputs, net.get());
+    std::unique_ptr<SubGraphProtoT> graph(new SubGraphProtoT);
+    graph->name    = name;
+    graph->nodes   = std::move(net->oplists);
+    graph->tensors = std::move(net->tensorName);
+    for (auto& v : inputs) {
+        graph->inputs.emplace_back(_tensorIndex(graph->tensors, v->name()));
+    }
+    for (auto& v : outputs) {
+        graph->outputs.emplace_back(_tensorIndex(graph->tensors, v->name()));
+    }
+    return graph;
+}
+
+static std::unique_ptr<OpT> _makeInput(int index, std::vector<int> dims, DataType type) {
+    std::unique_ptr<OpT> op(new OpT);
+    op->type          = OpType_Input;
+    op->outputIndexes = {index};
+    op->main.type     = OpParameter_Input;
+    auto input        = new InputT;
+    input->dims       = dims;
+    input->dtype      = type;
+    input->dformat    = MNN_DATA_FORMAT_NHWC;
+    op->main.value    = input;
+    return op;
+}
+
+/**
+ i, acc = i0, acc0
+ while i < n:
+     i, acc = i + 1, acc * 0.5 + x      (grow = false)
+     i, acc = i + 1, concat(acc, x)     (grow = true)
+ */
+static std::shared_ptr<Module> _createLoop(int size, bool grow, bool dynamic) {
+    std::unique_ptr<NetT> net(new NetT);
+    {
+        auto i    = _Input({1}, NHWC, halide_type_of<int>());
+        auto n    = _Input({1}, NHWC, halide_type_of<int>());
+        auto cond = _Less(i, n);
+        i->setName("i");
+        n->setName("n");
+        cond->setName("cond");
+        net->subgraphs.emplace_back(_makeSubGraph("cond", {i, n}, {cond}));
+    }
+    {
+        auto i     = _Input({1}, NHWC, halide_type_of<int>());
+        auto acc   = _Input({size}, NHWC);
+        auto x     = _Input({size}, NHWC);
+        auto iNext = _Add(i, _Scalar<int>(1));
+        VARP accNext;
+        if (grow) {
+            accNext = _Concat({acc, x}, 0);
+        } else {
+            accNext = acc * _Scalar<float>(0.5f) + x;
+        }
+        i->setName("i");
+        acc->setName("acc");
+        x->setName("x");
+        iNext->setName("i_next");
+        accNext->setName("acc_next");
+        net->subgraphs.emplace_back(_makeSubGraph("body", {i, acc, x}, {iNext, accNext}));
+    }
+    net->tensorName = {"i0", "n", "acc0", "x", "i_out", "acc_out"};
+    net->oplists.emplace_back(_makeInput(0, {1}, DataType_DT_INT32));
+    net->oplists.emplace_back(_makeInput(1, {1}, DataType_DT_INT32));
+    net->oplists.emplace_back(_makeInput(2, {size}, DataType_DT_FLOAT));
+    net->oplists.emplace_back(_makeInput(3, {size}, DataType_DT_FLOAT));
+    std::unique_ptr<OpT> loop(new OpT);
+    loop->type          = OpType_While;
+    loop->name          = "loop";
+    loop->inputIndexes  = {0, 1, 2, 3};
+    loop->outputIndexes = {4, 5};
+    loop->main.type     = OpParameter_WhileParam;
+    auto param          = new WhileParamT;
+    param->cond_graph   = "cond";
+    param->body_graph   = "body";
+    for (auto name : {"i", "n", "acc", "x"}) {
+        std::unique_ptr<StringVecT> alias(new StringVecT);
+        alias->data = {name};
+        param->aliases_inputs.emplace_back(std::move(alias));
+    }
+    param->aliases_outputs = {"i_next", "acc_next"};
+    for (auto& update : std::vector<std::vector<std::string>>{{"i_next", "i"}, {"acc_next", "acc"}}) {
+        std::unique_ptr<StringVecT> alias(new StringVecT);
+        alias->data = update;
+        param->aliases_updates.emplace_back(std::move(alias));
+    }
+    loop->main.value = param;
+    net->oplists.emplace_back(std::move(loop));
+
+    flatbuffers::FlatBufferBuilder builder(1024);
+    builder.Finish(Net::Pack(builder, net.get()));
+    return std::shared_ptr<Module>(
+        Module::load({"i0", "n", "acc0", "x"}, {"i_out", "acc_out"}, builder.GetBufferPointer(), builder.GetSize(),
+                     dynamic));
+}
+
+static std::vector<VARP> _makeInputs(int i0, int n, const std::vector<float>& acc0, const std::vector<float>& x) {
+    auto iVar   = _Input({1}, NHWC, halide_type_of<int>());
+    auto nVar   = _Input({1}, NHWC, halide_type_of<int>());
+    auto accVar = _Input({(int)acc0.size()}, NHWC);
+    auto xVar   = _Input({(int)x.size()}, NHWC);
+    iVar->writeMap<int>()[0] = i0;
+    nVar->writeMap<int>()[0] = n;
+    ::memcpy(accVar->writeMap<float>(), acc0.data(), acc0.size() * sizeof(float));
+    ::memcpy(xVar->writeMap<float>(), x.data(), x.size() * sizeof(float));
+    return {iVar, nVar, accVar, xVar};
+}
+
+static bool _check(const std::vector<VARP>& outputs, int i, const std::vector<float>& acc, const char* mode,
+                   const char* name) {
+    if (outputs.size() != 2 || nullptr == outputs[0] || nullptr == outputs[1]) {
+        MNN_ERROR("WhileModuleTest %s %s: no output\n", mode, name);
+        return false;
+    }
+    auto iPtr   = outputs[0]->readMap<int>();
+    auto accPtr = outputs[1]->readMap<float>();
+    if (nullptr == iPtr || nullptr == accPtr || outputs[1]->getInfo()->size != acc.size()) {
+        MNN_ERROR("WhileModuleTest %s %s: can't compute output\n", mode, name);
+        return false;
+    }
+    if (iPtr[0] != i) {
+        MNN_ERROR("WhileModuleTest %s %s: i = %d, expect %d\n", mode, name, iPtr[0], i);
+        return false;
+    }
+    for (int k = 0; k < acc.size(); ++k) {
+        if (fabsf(accPtr[k] - acc[k]) > 1e-5f) {
+            MNN_ERROR("WhileModuleTest %s %s: acc[%d] = %f, expect %f\n", mode, name, k, accPtr[k], acc[k]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Compare the loop with a plain loop of the same computation. Only the expressions of dynamic load use the
+// compiled plan, the submodules of static load compute at once.
+static bool _testLoop(bool dynamic) {
+    const char* mode = dynamic ? "dynamic" : "static";
+    const int size   = 5;
+    std::vector<float> acc0(size), x(size);
+    for (int k = 0; k < size; ++k) {
+        acc0[k] = (float)k - 2.0f;
+        x[k]    = 0.25f * k + 1.0f;
+    }
+    {
+        // Both phases of the plan are used, the plan is reused by later forwards
+        std::shared_ptr<Module> loop(_createLoop(size, false, dynamic));
+        for (int n : {1, 2, 3, 6, 4}) {
+            std::vector<float> scaledX(size), acc = acc0;
+            for (int k = 0; k < size; ++k) {
+                scaledX[k] = x[k] * n;
+            }
+            for (int i = 0; i < n; ++i) {
+                for (int k = 0; k < size; ++k) {
+                    acc[k] = acc[k] * 0.5f + scaledX[k];
+                }
+            }
+            auto outputs = loop->onForward(_makeInputs(0, n, acc0, scaledX));
+            if (!_check(outputs, n, acc, mode, "loop-carried state")) {
+                return false;
+            }
+        }
+        // No iteration, the outputs are the initial state
+        auto outputs = loop->onForward(_makeInputs(3, 0, acc0, x));
+        if (!_check(outputs, 3, acc0, mode, "zero iteration")) {
+            return false;
+        }
+        // The plan still works after a loop without iteration
+        std::vector<float> acc(size);
+        for (int k = 0; k < size; ++k) {
+            acc[k] = acc0[k] * 0.5f + x[k];
+        }
+        outputs = loop->onForward(_makeInputs(2, 3, acc0, x));
+        if (!_check(outputs, 3, acc, mode, "after zero iteration")) {
+            return false;
+        }
+    }
+    {
+        // The loop-carried shape changes, continue without the plan
+        std::shared_ptr<Module> loop(_createLoop(size, true, dynamic));
+        for (int n : {0, 1, 3}) {
+            std::vector<float> acc = acc0;
+            for (int i = 0; i < n; ++i) {
+                acc.insert(acc.end(), x.begin(), x.end());
+            }
+            auto outputs = loop->onForward(_makeInputs(0, n, acc0, x));
+            if (!_check(outputs, n, acc, mode, "shape change")) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+class WhileModuleTest : public MNNTestCase {
+public:
+    virtual ~WhileModuleTest() = default;
+    virtual bool run() {
+        return _testLoop(false) && _testLoop(true);
+    }
+};
+MNNTestSuiteRegister(WhileModuleTest, "expr/WhileModule");
@@ -0,0 +1,128 @@
+//
+//  BatchNormTrainTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2020/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <vector>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+#include "TestUtils.h"
+
+using namespace MNN::Express;
+
+class BatchNormTrainTest : public MNNTestCase {
+public:
+    virtual ~BatchNormTrainTest() = default;
+    virtual bool run() {
+        using namespace MNN;
+        const int batch = 3, channel = 6, area = 10;
+        const float eps = 1e-5f, momentum = 0.9f;
+        std::vector<float> xData(batch * channel * area), dyData(batch * channel * area);
+        for (int i = 0; i < xData.size(); ++i) {
+            xData[i]  = (float)((i * 37) % 23) * 0.3f + 100.0f;
+            dyData[i] = (float)((i * 11) % 7) - 3.0f;
+        }
+        std::vector<float> scaleData(channel), biasData(channel), meanData(channel), varData(channel);
+        for (int c = 0; c < channel; ++c) {
+            scaleData[c] = 0.5f + 0.1f * c;
+            biasData[c]  = 0.2f * c - 0.3f;
+            meanData[c]  = 0.1f * c;
+            varData[c]   = 1.0f + 0.5f * c;
+        }
+        // Reference
+        const int count = batch * area;
+        std::vector<float> expectY(xData.size()), expectDx(xData.size());
+        std::vector<float> expectRunningMean(channel), expectRunningVar(channel), expectDScale(channel),
+            expectDBias(channel);
+        for (int c = 0; c < channel; ++c) {
+            double mean = 0.0, var = 0.0;
+            for (int b = 0; b < batch; ++b) {
+                for (int i = 0; i < area; ++i) {
+                    mean += xData[(b * channel + c) * area + i];
+                }
+            }
+            mean /= count;
+            for (int b = 0; b < batch; ++b) {
+                for (int i = 0; i < area; ++i) {
+                    auto diff = xData[(b * channel + c) * area + i] - mean;
+                    var += diff * diff;
+                }
+            }
+            var /= count;
+            double invStd = 1.0 / sqrt(var + eps);
+            double dBias = 0.0, dScale = 0.0;
+            for (int b = 0; b < batch; ++b) {
+                for (int i = 0; i < area; ++i) {
+                    auto index     = (b * channel + c) * area + i;
+                    auto xhat      = (xData[index] - mean) * invStd;
+                    expectY[index] = xhat * scaleData[c] + biasData[c];
+                    dBias += dyData[index];
+                    dScale += dyData[index] * xhat;
+                }
+            }
+            for (int b = 0; b < batch; ++b) {
+                for (int i = 0; i < area; ++i) {
+                    auto index      = (b * channel + c) * area + i;
+                    auto xhat       = (xData[index] - mean) * invStd;
+                    expectDx[index] = scaleData[c] * invStd / count * (count * dyData[index] - dBias - xhat * dScale);
+                }
+            }
+            expectDBias[c]       = dBias;
+            expectDScale[c]      = dScale;
+            expectRunningMean[c] = momentum * meanData[c] + (1.0f - momentum) * mean;
+            expectRunningVar[c]  = momentum * varData[c] + (1.0f - momentum) * var;
+        }
+
+        auto x     = _Const(xData.data(), {batch, channel, 2, 5}, NCHW);
+        auto dy    = _Const(dyData.data(), {batch, channel, 2, 5}, NCHW);
+        auto scale = _Const(scaleData.data(), {1, channel, 1, 1}, NCHW);
+        auto bias  = _Const(biasData.data(), {1, channel, 1, 1}, NCHW);
+        auto rMean = _Const(meanData.data(), {1, channel, 1, 1}, NCHW);
+        auto rVar  = _Const(varData.data(), {1, channel, 1, 1}, NCHW);
+        std::unique_ptr<OpT> bn(new OpT);
+        bn->type                      = OpType_BatchNormTrain;
+        bn->main.type                 = OpParameter_BatchNorm;
+        bn->main.value                = new BatchNormT;
+        bn->main.AsBatchNorm()->epsilon  = eps;
+        bn->main.AsBatchNorm()->momentum = momentum;
+        auto bnExpr = Expr::create(bn.get(), {_Convert(x, NC4HW4), scale, bias, rMean, rVar}, 5);
+        auto y      = _Convert(Variable::create(bnExpr, 0), NCHW);
+        std::unique_ptr<OpT> grad(new OpT);
+        grad->type    = OpType_BatchNormTrainGrad;
+        auto gradExpr = Expr::create(grad.get(), {_Convert(x, NC4HW4), _Convert(dy, NC4HW4), scale,
+                                                   Variable::create(bnExpr, 1), Variable::create(bnExpr, 2)}, 3);
+        auto dx       = _Convert(Variable::create(gradExpr, 0), NCHW);
+
+        if (!checkVector<float>(y->readMap<float>(), expectY.data(), expectY.size(), 0.001f)) {
+            MNN_ERROR("BatchNormTrain output test failed!\n");
+            return false;
+        }
+        if (!checkVector<float>(Variable::create(bnExpr, 3)->readMap<float>(), expectRunningMean.data(), channel,
+                                0.001f) ||
+            !checkVector<float>(Variable::create(bnExpr, 4)->readMap<float>(), expectRunningVar.data(), channel,
+                                0.001f)) {
+            MNN_ERROR("BatchNormTrain running statistics test failed!\n");
+            return false;
+        }
+        if (!checkVector<float>(dx->readMap<float>(), expectDx.data(), expectDx.size(), 0.001f)) {
+            MNN_ERROR("BatchNormTrainGrad input grad test failed!\n");
+            return false;
+        }
+        if (!checkVector<float>(Variable::create(gradExpr, 1)->readMap<float>(), expectDScale.data(), channel,
+                                0.001f) ||
+            !checkVector<float>(Variable::create(gradExpr, 2)->readMap<float>(), expectDBias.data(), channel,
+                                0.001f)) {
+            MNN_ERROR("BatchNormTrainGrad parameter grad test failed!\n");
+            return false;
+        }
+        return true;
+    }
+};
+
+MNNTestSuiteRegister(BatchNormTrainTest, "op/BatchNormTrain");
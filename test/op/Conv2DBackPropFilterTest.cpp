@@ -11,6 +11,7 @@
 
 #include <MNN/MNNForwardType.h>
 #include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
 #include <MNN/expr/ExprCreator.hpp>
 #include <MNN/expr/Optimizer.hpp>
 #include "MNNTestSuite.h"
@@ -156,3 +157,76 @@ public:
 };
 
 MNNTestSuiteRegister(Conv2DDWBackPropFilterTest, "op/Conv2DBackPropFilterDW");
+
+// Larger shapes run on several threads: channels not aligned to 4, more output pixels than a chunk, stride and dilation
+class Conv2DBackPropFilterImplicitTest : public MNNTestCase {
+public:
+    virtual ~Conv2DBackPropFilterImplicitTest() = default;
+    virtual bool run() {
+        MNN::BackendConfig config;
+        auto executor = Executor::newExecutor(MNN_FORWARD_CPU, config, 4);
+        ExecutorScope scope(executor);
+        // Dense
+        if (!_test(2, 5, 7, 23, 37, 3, 2, 2, 1, 1, 2, 1, 0, 1)) {
+            return false;
+        }
+        // Depthwise
+        return _test(2, 6, 6, 19, 17, 3, 3, 2, 2, 1, 1, 1, 1, 6);
+    }
+
+private:
+    static bool _test(int batch, int ic, int oc, int ih, int iw, int kw, int kh, int sw, int sh, int dw, int dh,
+                      int padX, int padY, int group) {
+        const int oh = (ih + 2 * padY - (kh - 1) * dh - 1) / sh + 1;
+        const int ow = (iw + 2 * padX - (kw - 1) * dw - 1) / sw + 1;
+        std::vector<float> inputData(batch * ic * ih * iw), gradData(batch * oc * oh * ow);
+        for (int i = 0; i < inputData.size(); ++i) {
+            inputData[i] = (float)((i * 7 + 3) % 19) / 19.0f - 0.5f;
+        }
+        for (int i = 0; i < gradData.size(); ++i) {
+            gradData[i] = (float)((i * 5 + 1) % 23) / 23.0f - 0.5f;
+        }
+        const int icGroup = ic / group, ocGroup = oc / group;
+        std::vector<float> expect(oc * icGroup * kh * kw, 0.0f);
+        for (int o = 0; o < oc; ++o) {
+            for (int c = 0; c < icGroup; ++c) {
+                const int inputC = (o / ocGroup) * icGroup + c;
+                for (int ky = 0; ky < kh; ++ky) {
+                    for (int kx = 0; kx < kw; ++kx) {
+                        float sum = 0.0f;
+                        for (int n = 0; n < batch; ++n) {
+                            for (int oy = 0; oy < oh; ++oy) {
+                                const int iy = oy * sh - padY + ky * dh;
+                                for (int ox = 0; ox < ow; ++ox) {
+                                    const int ix = ox * sw - padX + kx * dw;
+                                    if (iy < 0 || iy >= ih || ix < 0 || ix >= iw) {
+                                        continue;
+                                    }
+                                    sum += gradData[((n * oc + o) * oh + oy) * ow + ox] *
+                                           inputData[((n * ic + inputC) * ih + iy) * iw + ix];
+                                }
+                            }
+                        }
+                        expect[((o * icGroup + c) * kh + ky) * kw + kx] = sum;
+                    }
+                }
+            }
+        }
+        auto input  = _Const(inputData.data(), {batch, ic, ih, iw}, NCHW);
+        auto grad   = _Const(gradData.data(), {batch, oc, oh, ow}, NCHW);
+        auto output = _Conv2DBackPropFilter(_Convert(input, NC4HW4), _Convert(grad, NC4HW4), {kw, kh}, CAFFE,
+                                            {sw, sh}, {dw, dh}, group, {padX, padY});
+        const std::vector<int> outDim = {oc, icGroup, kh, kw};
+        if (!checkVector<int>(output->getInfo()->dim.data(), outDim.data(), 4, 0)) {
+            MNN_ERROR("Conv2DBackPropFilterImplicitTest shape test failed!\n");
+            return false;
+        }
+        if (!checkVectorByRelativeError<float>(output->readMap<float>(), expect.data(), expect.size(), 0.001)) {
+            MNN_ERROR("Conv2DBackPropFilterImplicitTest test failed, group = %d!\n", group);
+            return false;
+        }
+        return true;
+    }
+};
+
+MNNTestSuiteRegister(Conv2DBackPropFilterImplicitTest, "op/Conv2DBackPropFilterImplicit");
@@ -9,6 +9,7 @@
 #include <MNN/MNNForwardType.h>
 #include <MNN/AutoTime.hpp>
 #include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
 #include <MNN/expr/ExprCreator.hpp>
 #include <MNN/expr/Optimizer.hpp>
 #include <cmath>
@@ -133,3 +134,75 @@ class ConvBiasGradTestOnOpencl : public ConvBiasGradTest {
 };
 
 MNNTestSuiteRegister(ConvBiasGradTestOnCPU, "op/bias_grad");
+
+// Deconvolution with weight and bias as inputs, as the input grad of convolution, on several threads
+class DeconvMultiInputTest : public MNNTestCase {
+public:
+    virtual ~DeconvMultiInputTest() = default;
+    virtual bool run() {
+        MNN::BackendConfig config;
+        auto executor = Executor::newExecutor(MNN_FORWARD_CPU, config, 4);
+        ExecutorScope scope(executor);
+        const int batch = 2, ic = 7, oc = 6, ih = 9, iw = 11, kh = 3, kw = 2;
+        const int sh = 2, sw = 3, dh = 2, dw = 1, padY = 1, padX = 0;
+        std::vector<float> inputData(batch * ic * ih * iw), weightData(ic * oc * kh * kw), biasData(oc);
+        for (int i = 0; i < inputData.size(); ++i) {
+            inputData[i] = (float)((i * 7 + 3) % 19) / 19.0f - 0.5f;
+        }
+        for (int i = 0; i < weightData.size(); ++i) {
+            weightData[i] = (float)((i * 5 + 1) % 23) / 23.0f - 0.5f;
+        }
+        for (int i = 0; i < oc; ++i) {
+            biasData[i] = 0.1f * i;
+        }
+        auto input  = _Const(inputData.data(), {batch, ic, ih, iw}, NCHW);
+        auto weight = _Const(weightData.data(), {ic, oc, kh, kw}, NCHW);
+        auto bias   = _Const(biasData.data(), {oc}, NCHW);
+        auto output = _Convert(_Deconv(weight, bias, _Convert(input, NC4HW4), CAFFE, {sw, sh}, {dw, dh}, 1,
+                                       {padX, padY}),
+                               NCHW);
+        auto info = output->getInfo();
+        if (nullptr == info || info->dim.size() != 4 || info->dim[1] != oc) {
+            MNN_ERROR("DeconvMultiInputTest shape test failed!\n");
+            return false;
+        }
+        const int oh = info->dim[2], ow = info->dim[3];
+        std::vector<float> expect(batch * oc * oh * ow);
+        for (int n = 0; n < batch; ++n) {
+            for (int o = 0; o < oc; ++o) {
+                for (int i = 0; i < oh * ow; ++i) {
+                    expect[(n * oc + o) * oh * ow + i] = biasData[o];
+                }
+            }
+        }
+        for (int n = 0; n < batch; ++n) {
+            for (int c = 0; c < ic; ++c) {
+                for (int iy = 0; iy < ih; ++iy) {
+                    for (int ix = 0; ix < iw; ++ix) {
+                        const float x = inputData[((n * ic + c) * ih + iy) * iw + ix];
+                        for (int o = 0; o < oc; ++o) {
+                            for (int ky = 0; ky < kh; ++ky) {
+                                const int y = iy * sh - padY + ky * dh;
+                                for (int kx = 0; kx < kw; ++kx) {
+                                    const int xx = ix * sw - padX + kx * dw;
+                                    if (y < 0 || y >= oh || xx < 0 || xx >= ow) {
+                                        continue;
+                                    }
+                                    expect[((n * oc + o) * oh + y) * ow + xx] +=
+                                        x * weightData[((c * oc + o) * kh + ky) * kw + kx];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        if (!checkVector<float>(output->readMap<float>(), expect.data(), (int)expect.size(), 0.001)) {
+            MNN_ERROR("DeconvMultiInputTest test failed!\n");
+            return false;
+        }
+        return true;
+    }
+};
+
+MNNTestSuiteRegister(DeconvMultiInputTest, "op/DeconvMultiInput");
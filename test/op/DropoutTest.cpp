@@ -0,0 +1,91 @@
+//
+//  DropoutTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2020/12/09.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+#include "TestUtils.h"
+
+using namespace MNN::Express;
+
+static EXPRP _DropoutExpr(VARP x, float ratio, int seed) {
+    using namespace MNN;
+    std::unique_ptr<OpT> op(new OpT);
+    op->type       = OpType_Dropout;
+    op->main.type  = OpParameter_DropoutParam;
+    op->main.value = new DropoutParamT;
+    op->main.AsDropoutParam()->ratio = ratio;
+    op->main.AsDropoutParam()->seed  = seed;
+    op->main.AsDropoutParam()->seed2 = seed + 1;
+    return Expr::create(op.get(), {x}, 2);
+}
+
+static VARP _DropoutGrad(VARP grad, VARP mask, float ratio) {
+    using namespace MNN;
+    std::unique_ptr<OpT> op(new OpT);
+    op->type       = OpType_DropoutGrad;
+    op->main.type  = OpParameter_DropoutParam;
+    op->main.value = new DropoutParamT;
+    op->main.AsDropoutParam()->ratio = ratio;
+    return Variable::create(Expr::create(op.get(), {grad, mask}));
+}
+
+class DropoutTest : public MNNTestCase {
+public:
+    virtual ~DropoutTest() = default;
+    virtual bool run() {
+        const int size    = 4099;
+        const float ratio = 0.3f;
+        const float scale = 1.0f / (1.0f - ratio);
+        auto x            = _Input({size}, NCHW);
+        auto grad         = _Input({size}, NCHW);
+        auto xPtr         = x->writeMap<float>();
+        auto gradPtr      = grad->writeMap<float>();
+        for (int i = 0; i < size; ++i) {
+            xPtr[i]    = (float)(i % 17) + 1.0f;
+            gradPtr[i] = (float)(i % 5) - 2.0f;
+        }
+        auto expr  = _DropoutExpr(x, ratio, 7);
+        auto y     = Variable::create(expr, 0);
+        auto mask  = Variable::create(expr, 1);
+        auto dx    = _DropoutGrad(grad, mask, ratio);
+        auto yPtr  = y->readMap<float>();
+        auto mPtr  = mask->readMap<uint8_t>();
+        auto dxPtr = dx->readMap<float>();
+        if (mask->getInfo()->size != (size + 7) / 8) {
+            MNN_ERROR("Dropout mask size error\n");
+            return false;
+        }
+        int dropped = 0;
+        for (int i = 0; i < size; ++i) {
+            bool keep     = (mPtr[i / 8] >> (i % 8)) & 1;
+            float expectY = keep ? xPtr[i] * scale : 0.0f;
+            float expectG = keep ? gradPtr[i] * scale : 0.0f;
+            if (fabsf(yPtr[i] - expectY) > 1e-5f || fabsf(dxPtr[i] - expectG) > 1e-5f) {
+                MNN_ERROR("Dropout result not match mask at %d\n", i);
+                return false;
+            }
+            dropped += keep ? 0 : 1;
+        }
+        if (fabsf((float)dropped / size - ratio) > 0.05f) {
+            MNN_ERROR("Dropout ratio %f is far from %f\n", (float)dropped / size, ratio);
+            return false;
+        }
+        // The same seed gives the same mask
+        auto y2 = Variable::create(_DropoutExpr(x, ratio, 7), 0);
+        if (!checkVector<float>(y2->readMap<float>(), yPtr, size, 0.0f)) {
+            MNN_ERROR("Dropout is not deterministic\n");
+            return false;
+        }
+        return true;
+    }
+};
+
+MNNTestSuiteRegister(DropoutTest, "op/Dropout");
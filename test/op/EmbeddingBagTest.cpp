@@ -0,0 +1,102 @@
+//
+//  EmbeddingBagTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2020/12/29.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <algorithm>
+#include "MNNTestSuite.h"
+#include "TestUtils.h"
+using namespace MNN::Express;
+
+static std::vector<float> _refEmbeddingBag(const std::vector<float>& weight, int dim, const std::vector<int>& indices,
+                                           const std::vector<int>& offsets, const std::vector<float>& scale,
+                                           EmbeddingBagMode mode) {
+    const int bags = (int)offsets.size();
+    std::vector<float> result(bags * dim, 0.0f);
+    for (int b = 0; b < bags; ++b) {
+        const int start = offsets[b];
+        const int end   = b + 1 < bags ? offsets[b + 1] : (int)indices.size();
+        for (int d = 0; d < dim; ++d) {
+            float value = 0.0f;
+            for (int i = start; i < end; ++i) {
+                auto v = weight[indices[i] * dim + d] * (scale.empty() ? 1.0f : scale[i]);
+                if (BAG_MAX == mode) {
+                    value = i == start ? v : std::max(value, v);
+                } else {
+                    value += v;
+                }
+            }
+            if (BAG_MEAN == mode && end > start) {
+                value /= (float)(end - start);
+            }
+            result[b * dim + d] = value;
+        }
+    }
+    return result;
+}
+
+class EmbeddingBagTest : public MNNTestCase {
+public:
+    virtual ~EmbeddingBagTest() = default;
+    bool _run(int num, int dim, int bags, bool weighted) {
+        uint32_t seed = 11;
+        auto random   = [&seed]() {
+            seed = seed * 1103515245 + 12345;
+            return (int)((seed >> 8) % 10000);
+        };
+        std::vector<float> weightData(num * dim);
+        for (auto& v : weightData) {
+            v = (float)random() / 5000.0f - 1.0f;
+        }
+        // Bags of 0 to 9 rows, the second bag is always empty
+        std::vector<int> offsetsData(bags), indicesData;
+        for (int b = 0; b < bags; ++b) {
+            offsetsData[b] = (int)indicesData.size();
+            const int size = 1 == b ? 0 : random() % 10;
+            for (int i = 0; i < size; ++i) {
+                indicesData.emplace_back(random() % num);
+            }
+        }
+        std::vector<float> scaleData;
+        if (weighted) {
+            for (int i = 0; i < indicesData.size(); ++i) {
+                scaleData.emplace_back((float)random() / 10000.0f + 0.5f);
+            }
+        }
+        auto weight  = _Const(weightData.data(), {num, dim}, NHWC);
+        auto indices = _Const(indicesData.data(), {(int)indicesData.size()}, NHWC, halide_type_of<int>());
+        auto offsets = _Const(offsetsData.data(), {bags}, NHWC, halide_type_of<int>());
+        VARP scale   = nullptr;
+        if (weighted) {
+            scale = _Const(scaleData.data(), {(int)scaleData.size()}, NHWC);
+        }
+        for (auto mode : {BAG_SUM, BAG_MEAN, BAG_MAX}) {
+            auto expect = _refEmbeddingBag(weightData, dim, indicesData, offsetsData, scaleData, mode);
+            auto output = _EmbeddingBag(weight, indices, offsets, scale, mode);
+            auto info   = output->getInfo();
+            if (nullptr == info || info->dim != std::vector<int>({bags, dim})) {
+                MNN_ERROR("EmbeddingBagTest shape test failed, mode: %d\n", mode);
+                return false;
+            }
+            if (!checkVector<float>(output->readMap<float>(), expect.data(), bags * dim, 1e-4)) {
+                MNN_ERROR("EmbeddingBagTest test failed, mode: %d, dim: %d, weighted: %d\n", mode, dim, weighted);
+                return false;
+            }
+        }
+        return true;
+    }
+    virtual bool run() {
+        MNN::BackendConfig config;
+        auto executor = Executor::newExecutor(MNN_FORWARD_CPU, config, 4);
+        ExecutorScope scope(executor);
+        // Many bags, and fewer bags than threads so that rows are split
+        return _run(100, 17, 33, false) && _run(100, 17, 33, true) && _run(50, 130, 3, true);
+    }
+};
+MNNTestSuiteRegister(EmbeddingBagTest, "op/embedding_bag");
@@ -0,0 +1,73 @@
+//
+//  GAETest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/01/07.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/ExecutorScope.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <vector>
+#include "MNNTestSuite.h"
+#include "TestUtils.h"
+
+using namespace MNN::Express;
+
+static bool _testGAE(int T, int N, float gamma, float lambda) {
+    std::vector<float> reward(T * N), value(T * N), done(T * N), bootstrap(N);
+    uint32_t seed = 7;
+    auto random   = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (float)((seed >> 8) % 10000) / 10000.0f;
+    };
+    for (int i = 0; i < T * N; ++i) {
+        reward[i] = random() * 2.0f - 1.0f;
+        value[i]  = random() * 4.0f - 2.0f;
+        done[i]   = random() < 0.2f ? 1.0f : 0.0f;
+    }
+    for (auto& v : bootstrap) {
+        v = random() * 4.0f - 2.0f;
+    }
+    std::vector<float> expectAdvantage(T * N), expectReturn(T * N);
+    for (int n = 0; n < N; ++n) {
+        double nextValue = bootstrap[n], nextAdvantage = 0.0;
+        for (int t = T - 1; t >= 0; --t) {
+            const int index = t * N + n;
+            double notDone  = 1.0 - done[index];
+            double delta    = reward[index] + gamma * notDone * nextValue - value[index];
+            nextAdvantage   = delta + gamma * lambda * notDone * nextAdvantage;
+            nextValue       = value[index];
+            expectAdvantage[index] = (float)nextAdvantage;
+            expectReturn[index]    = (float)(nextAdvantage + value[index]);
+        }
+    }
+    auto outputs = _GAE(_Const(reward.data(), {T, N}, NHWC), _Const(value.data(), {T, N}, NHWC),
+                        _Const(done.data(), {T, N}, NHWC), _Const(bootstrap.data(), {N}, NHWC), gamma, lambda);
+    if (!checkVector<float>(outputs[0]->readMap<float>(), expectAdvantage.data(), T * N, 0.0001f)) {
+        MNN_ERROR("GAE advantage test failed, T = %d, N = %d!\n", T, N);
+        return false;
+    }
+    if (!checkVector<float>(outputs[1]->readMap<float>(), expectReturn.data(), T * N, 0.0001f)) {
+        MNN_ERROR("GAE return test failed, T = %d, N = %d!\n", T, N);
+        return false;
+    }
+    return true;
+}
+
+class GAETest : public MNNTestCase {
+public:
+    virtual ~GAETest() = default;
+    virtual bool run() {
+        // Single trajectory, and lambda = 1 for the discounted return
+        if (!_testGAE(9, 1, 0.99f, 1.0f)) {
+            return false;
+        }
+        // Environments not aligned to 4, on several threads
+        MNN::BackendConfig config;
+        auto executor = Executor::newExecutor(MNN_FORWARD_CPU, config, 4);
+        ExecutorScope scope(executor);
+        return _testGAE(13, 37, 0.95f, 0.9f);
+    }
+};
+MNNTestSuiteRegister(GAETest, "op/GAE");
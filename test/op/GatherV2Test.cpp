@@ -8,6 +8,7 @@
 
 #include <MNN/expr/Expr.hpp>
 #include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
 #include "MNNTestSuite.h"
 #include "TestUtils.h"
 using namespace MNN::Express;
@@ -37,3 +38,38 @@ public:
     }
 };
 MNNTestSuiteRegister(GatherV2Test, "op/gatherv2");
+
+class GatherV2ParallelTest : public MNNTestCase {
+public:
+    virtual ~GatherV2ParallelTest() = default;
+    virtual bool run() {
+        MNN::BackendConfig config;
+        auto executor = Executor::newExecutor(MNN_FORWARD_CPU, config, 4);
+        ExecutorScope scope(executor);
+        const int outside = 3, limit = 211, inside = 37, N = 500;
+        std::vector<float> paramsData(outside * limit * inside);
+        for (int i = 0; i < paramsData.size(); ++i) {
+            paramsData[i] = (float)(i % 1013);
+        }
+        std::vector<int> indicesData(N);
+        for (int i = 0; i < N; ++i) {
+            indicesData[i] = (i * 97 + 13) % limit;
+        }
+        std::vector<float> expect(outside * N * inside);
+        for (int o = 0; o < outside; ++o) {
+            for (int i = 0; i < N; ++i) {
+                ::memcpy(expect.data() + (o * N + i) * inside,
+                         paramsData.data() + (o * limit + indicesData[i]) * inside, inside * sizeof(float));
+            }
+        }
+        auto params  = _Const(paramsData.data(), {outside, limit, inside}, NHWC);
+        auto indices = _Const(indicesData.data(), {N}, NHWC, halide_type_of<int>());
+        auto output  = _GatherV2(params, indices, _Scalar<int>(1));
+        if (!checkVector<float>(output->readMap<float>(), expect.data(), (int)expect.size(), 0)) {
+            MNN_ERROR("GatherV2ParallelTest test failed!\n");
+            return false;
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(GatherV2ParallelTest, "op/gatherv2_parallel");
@@ -0,0 +1,105 @@
+//
+//  NonMaxSuppressionTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2020/12/28.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <algorithm>
+#include <numeric>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+#include "TestUtils.h"
+using namespace MNN::Express;
+
+static float _refIOU(const float* a, const float* b) {
+    const float yMinA = std::min(a[0], a[2]), xMinA = std::min(a[1], a[3]);
+    const float yMaxA = std::max(a[0], a[2]), xMaxA = std::max(a[1], a[3]);
+    const float yMinB = std::min(b[0], b[2]), xMinB = std::min(b[1], b[3]);
+    const float yMaxB = std::max(b[0], b[2]), xMaxB = std::max(b[1], b[3]);
+    const float areaA = (yMaxA - yMinA) * (xMaxA - xMinA);
+    const float areaB = (yMaxB - yMinB) * (xMaxB - xMinB);
+    if (areaA <= 0 || areaB <= 0) {
+        return 0.0f;
+    }
+    const float inter = std::max(std::min(yMaxA, yMaxB) - std::max(yMinA, yMinB), 0.0f) *
+                        std::max(std::min(xMaxA, xMaxB) - std::max(xMinA, xMinB), 0.0f);
+    return inter / (areaA + areaB - inter);
+}
+
+static std::vector<int> _refNMS(const std::vector<float>& boxes, const std::vector<float>& scores, int maxOutput,
+                                float iouThreshold) {
+    std::vector<int> order(scores.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&scores](int i, int j) { return scores[i] > scores[j]; });
+    std::vector<int> selected;
+    for (auto index : order) {
+        if (selected.size() >= maxOutput) {
+            break;
+        }
+        bool keep = true;
+        for (auto s : selected) {
+            if (_refIOU(boxes.data() + 4 * index, boxes.data() + 4 * s) > iouThreshold) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) {
+            selected.emplace_back(index);
+        }
+    }
+    return selected;
+}
+
+class NonMaxSuppressionTest : public MNNTestCase {
+public:
+    virtual ~NonMaxSuppressionTest() = default;
+    virtual bool run() {
+        const int numBoxes = 301, maxOutput = 23;
+        const float iouThreshold = 0.4f;
+        std::vector<float> boxesData(numBoxes * 4), scoresData(numBoxes);
+        uint32_t seed = 7;
+        auto random   = [&seed]() {
+            seed = seed * 1103515245 + 12345;
+            return (float)((seed >> 8) % 10000) / 10000.0f;
+        };
+        for (int i = 0; i < numBoxes; ++i) {
+            float y = random() * 100.0f, x = random() * 100.0f;
+            float h = 5.0f + random() * 30.0f, w = 5.0f + random() * 30.0f;
+            // Some boxes have flipped corners, and one is empty
+            if (i % 5 == 0) {
+                boxesData[4 * i + 0] = y + h;
+                boxesData[4 * i + 2] = y;
+            } else {
+                boxesData[4 * i + 0] = y;
+                boxesData[4 * i + 2] = y + h;
+            }
+            boxesData[4 * i + 1] = x;
+            boxesData[4 * i + 3] = i == 17 ? x : x + w;
+            scoresData[i]        = random() + (float)i * 1e-6f;
+        }
+        auto expect = _refNMS(boxesData, scoresData, maxOutput, iouThreshold);
+
+        auto boxes  = _Const(boxesData.data(), {numBoxes, 4}, NHWC);
+        auto scores = _Const(scoresData.data(), {numBoxes}, NHWC);
+        auto maxOutputVar = _Scalar<int>(maxOutput);
+        auto iouVar       = _Scalar<float>(iouThreshold);
+        std::unique_ptr<MNN::OpT> op(new MNN::OpT);
+        op->type    = MNN::OpType_NonMaxSuppressionV2;
+        auto output = Variable::create(Expr::create(op.get(), {boxes, scores, maxOutputVar, iouVar}));
+        auto info   = output->getInfo();
+        if (nullptr == info || info->size != maxOutput) {
+            MNN_ERROR("NonMaxSuppressionTest shape test failed!\n");
+            return false;
+        }
+        if (!checkVector<int>(output->readMap<int>(), expect.data(), (int)expect.size(), 0)) {
+            MNN_ERROR("NonMaxSuppressionTest test failed!\n");
+            return false;
+        }
+        return true;
+    }
+};
+MNNTestSuiteRegister(NonMaxSuppressionTest, "op/non_max_suppression");
@@ -81,6 +81,21 @@ protected:
             MNN_ERROR("AvepoolGrad(%s) test failed!\n", deviceName.c_str());
             return false;
         }
+        // The grads computed as outputs, not as intermediate tensors of the convert
+        auto maxPoolGrad = _PoolGrad(poolInputConvert, maxPoolOut, poolInputGradConvert, {3, 3}, {2, 2}, MAXPOOL);
+        auto avePoolGrad = _PoolGrad(poolInputConvert, avePoolOut, poolInputGradConvert, {3, 3}, {2, 2}, AVEPOOL);
+        maxPoolGrad->readMap<float>();
+        avePoolGrad->readMap<float>();
+        if (!checkVectorByRelativeError<float>(_Convert(maxPoolGrad, NCHW)->readMap<float>(), maxExpectedGrad, size,
+                                               0.001)) {
+            MNN_ERROR("MaxpoolGrad(%s) output test failed!\n", deviceName.c_str());
+            return false;
+        }
+        if (!checkVectorByRelativeError<float>(_Convert(avePoolGrad, NCHW)->readMap<float>(), aveExpectedGrad, size,
+                                               0.001)) {
+            MNN_ERROR("AvepoolGrad(%s) output test failed!\n", deviceName.c_str());
+            return false;
+        }
 
         return true;
     }
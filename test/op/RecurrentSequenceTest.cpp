@@ -0,0 +1,191 @@
+//
+//  RecurrentSequenceTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2021/01/04.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <vector>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+#include "TestUtils.h"
+
+using namespace MNN::Express;
+
+static double _sigmoid(double x) {
+    return 1.0 / (1.0 + exp(-x));
+}
+
+// Inputs are x, wx, wh, bias, h0 (, c0), returns sum(y * dy) (+ sum(c * dc))
+static double _reference(const std::vector<std::vector<double>>& p, bool lstm, int T, int N, int I, int H,
+                         const std::vector<double>& dy, const std::vector<double>& dc, std::vector<double>* y,
+                         std::vector<double>* c) {
+    const int GH = (lstm ? 4 : 3) * H;
+    auto& x      = p[0];
+    auto& wx     = p[1];
+    auto& wh     = p[2];
+    auto& bias   = p[3];
+    std::vector<double> h = p[4], cell = lstm ? p[5] : std::vector<double>();
+    std::vector<double> gx(GH), gh(GH), hNext(N * H);
+    double loss = 0.0;
+    for (int t = 0; t < T; ++t) {
+        for (int n = 0; n < N; ++n) {
+            for (int k = 0; k < GH; ++k) {
+                gx[k] = bias[k];
+                gh[k] = lstm ? 0.0 : bias[GH + k];
+                for (int i = 0; i < I; ++i) {
+                    gx[k] += x[(t * N + n) * I + i] * wx[i * GH + k];
+                }
+                for (int j = 0; j < H; ++j) {
+                    gh[k] += h[n * H + j] * wh[j * GH + k];
+                }
+            }
+            for (int j = 0; j < H; ++j) {
+                const int index = (t * N + n) * H + j;
+                double hValue;
+                if (lstm) {
+                    auto gate = [&](int g) { return gx[g * H + j] + gh[g * H + j]; };
+                    double cValue = _sigmoid(gate(1)) * cell[n * H + j] + _sigmoid(gate(0)) * tanh(gate(2));
+                    hValue        = _sigmoid(gate(3)) * tanh(cValue);
+                    cell[n * H + j] = cValue;
+                    loss += cValue * dc[index];
+                    if (nullptr != c) {
+                        (*c)[index] = cValue;
+                    }
+                } else {
+                    double r     = _sigmoid(gx[j] + gh[j]);
+                    double z     = _sigmoid(gx[H + j] + gh[H + j]);
+                    double nGate = tanh(gx[2 * H + j] + r * gh[2 * H + j]);
+                    hValue       = (1.0 - z) * nGate + z * h[n * H + j];
+                }
+                hNext[n * H + j] = hValue;
+                loss += hValue * dy[index];
+                if (nullptr != y) {
+                    (*y)[index] = hValue;
+                }
+            }
+        }
+        h = hNext;
+    }
+    return loss;
+}
+
+static bool _testRecurrent(bool lstm, int T, int N, int I, int H) {
+    using namespace MNN;
+    const int GH = (lstm ? 4 : 3) * H;
+    std::vector<std::vector<int>> shapes{{T, N, I}, {I, GH}, {H, GH}, {lstm ? 1 : 2, GH}, {N, H}};
+    if (lstm) {
+        shapes.push_back({N, H});
+    }
+    uint32_t seed = 11;
+    auto random   = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (double)((seed >> 8) % 10000) / 10000.0 - 0.5;
+    };
+    std::vector<std::vector<double>> params(shapes.size());
+    for (int k = 0; k < shapes.size(); ++k) {
+        int size = 1;
+        for (auto d : shapes[k]) {
+            size *= d;
+        }
+        params[k].resize(size);
+        for (auto& v : params[k]) {
+            v = random() * (k == 0 ? 2.0 : 1.0);
+        }
+    }
+    std::vector<double> dy(T * N * H), dc(lstm ? T * N * H : 0);
+    for (auto& v : dy) {
+        v = random() * 2.0;
+    }
+    for (auto& v : dc) {
+        v = random() * 2.0;
+    }
+    std::vector<double> expectY(T * N * H), expectC(T * N * H);
+    _reference(params, lstm, T, N, I, H, dy, dc, &expectY, &expectC);
+    // Numerical grads
+    const double eps = 1e-4;
+    std::vector<std::vector<float>> expectGrads(params.size());
+    for (int k = 0; k < params.size(); ++k) {
+        for (int i = 0; i < params[k].size(); ++i) {
+            auto origin  = params[k][i];
+            params[k][i] = origin + eps;
+            auto plus    = _reference(params, lstm, T, N, I, H, dy, dc, nullptr, nullptr);
+            params[k][i] = origin - eps;
+            auto minus   = _reference(params, lstm, T, N, I, H, dy, dc, nullptr, nullptr);
+            params[k][i] = origin;
+            expectGrads[k].emplace_back((float)((plus - minus) / (2.0 * eps)));
+        }
+    }
+
+    auto toConst = [](const std::vector<double>& data, const std::vector<int>& shape) {
+        std::vector<float> floatData(data.begin(), data.end());
+        return _Const(floatData.data(), shape, NCHW);
+    };
+    std::vector<VARP> inputs;
+    for (int k = 0; k < params.size(); ++k) {
+        inputs.emplace_back(toConst(params[k], shapes[k]));
+    }
+    std::unique_ptr<OpT> op(new OpT);
+    op->type  = lstm ? OpType_LSTMSequence : OpType_GRUSequence;
+    auto expr = Expr::create(op.get(), inputs, lstm ? 3 : 2);
+    std::vector<float> floatY(expectY.begin(), expectY.end()), floatC(expectC.begin(), expectC.end());
+    if (!checkVector<float>(Variable::create(expr, 0)->readMap<float>(), floatY.data(), T * N * H, 0.001f)) {
+        MNN_ERROR("%s output test failed!\n", lstm ? "LSTMSequence" : "GRUSequence");
+        return false;
+    }
+    if (lstm && !checkVector<float>(Variable::create(expr, 1)->readMap<float>(), floatC.data(), T * N * H, 0.001f)) {
+        MNN_ERROR("LSTMSequence cell test failed!\n");
+        return false;
+    }
+    // x, wx, wh, bias, h0 (, c0), y (, cell), reserve, y grad (, cell grad)
+    std::vector<VARP> gradInputs = inputs;
+    for (int i = 0; i < expr->outputSize(); ++i) {
+        gradInputs.emplace_back(Variable::create(expr, i));
+    }
+    gradInputs.emplace_back(toConst(dy, {T, N, H}));
+    if (lstm) {
+        gradInputs.emplace_back(toConst(dc, {T, N, H}));
+    }
+    std::unique_ptr<OpT> gradOp(new OpT);
+    gradOp->type  = lstm ? OpType_LSTMSequenceGrad : OpType_GRUSequenceGrad;
+    auto gradExpr = Expr::create(gradOp.get(), gradInputs, (int)inputs.size());
+    const char* names[] = {"x", "wx", "wh", "bias", "h0", "c0"};
+    for (int k = 0; k < inputs.size(); ++k) {
+        auto grad = Variable::create(gradExpr, k);
+        if (!checkVectorByRelativeError<float>(grad->readMap<float>(), expectGrads[k].data(),
+                                               (int)expectGrads[k].size(), 0.005f)) {
+            MNN_ERROR("%s grad of %s test failed!\n", lstm ? "LSTMSequence" : "GRUSequence", names[k]);
+            return false;
+        }
+    }
+    return true;
+}
+
+class RecurrentSequenceTest : public MNNTestCase {
+public:
+    virtual ~RecurrentSequenceTest() = default;
+    virtual bool run() {
+        for (auto lstm : {false, true}) {
+            if (!_testRecurrent(lstm, 1, 2, 3, 4)) {
+                return false;
+            }
+        }
+        // Batch across more than one tile, hidden size not aligned to 4, on several threads
+        MNN::BackendConfig config;
+        auto executor = Executor::newExecutor(MNN_FORWARD_CPU, config, 4);
+        ExecutorScope scope(executor);
+        for (auto lstm : {false, true}) {
+            if (!_testRecurrent(lstm, 5, 19, 7, 6)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+MNNTestSuiteRegister(RecurrentSequenceTest, "op/RecurrentSequence");
@@ -8,6 +8,8 @@
 
 #include <MNN/expr/Expr.hpp>
 #include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/ExecutorScope.hpp>
+#include <algorithm>
 #include "MNNTestSuite.h"
 #include "TestUtils.h"
 using namespace MNN::Express;
@@ -169,9 +171,89 @@ public:
         return true;
     }
 };
+// Long axis and unaligned inside with several threads, cover the axis split and the accuracy of the pairwise sum
+class ReduceLargeTest : public MNNTestCase {
+public:
+    virtual ~ReduceLargeTest() = default;
+    virtual bool run() {
+        MNN::BackendConfig config;
+        auto executor = Executor::newExecutor(MNN_FORWARD_CPU, config, 4);
+        ExecutorScope scope(executor);
+        {
+            const int size = 1 << 20;
+            auto input     = _Input({size}, NCHW);
+            auto inputPtr  = input->writeMap<float>();
+            double sumValue = 0.0;
+            float maxValue = -1000.0f, minValue = 1000.0f;
+            for (int i = 0; i < size; ++i) {
+                inputPtr[i] = 0.1f * (float)(i % 7 + 1);
+                if (i == size / 3) {
+                    inputPtr[i] = 7.5f;
+                }
+                if (i == size - 5) {
+                    inputPtr[i] = -3.0f;
+                }
+                sumValue += inputPtr[i];
+                maxValue = std::max(maxValue, inputPtr[i]);
+                minValue = std::min(minValue, inputPtr[i]);
+            }
+            input->unMap();
+            const float expectSum = (float)sumValue;
+            if (!checkVectorByRelativeError<float>(_ReduceSum(input)->readMap<float>(), &expectSum, 1, 1e-5)) {
+                MNN_ERROR("ReduceLargeTest sum test failed!\n");
+                return false;
+            }
+            const float expectMean = (float)(sumValue / size);
+            if (!checkVectorByRelativeError<float>(_ReduceMean(input)->readMap<float>(), &expectMean, 1, 1e-5)) {
+                MNN_ERROR("ReduceLargeTest mean test failed!\n");
+                return false;
+            }
+            if (!checkVector<float>(_ReduceMax(input)->readMap<float>(), &maxValue, 1, 0.0f) ||
+                !checkVector<float>(_ReduceMin(input)->readMap<float>(), &minValue, 1, 0.0f)) {
+                MNN_ERROR("ReduceLargeTest max / min test failed!\n");
+                return false;
+            }
+        }
+        {
+            const int outside = 2, axis = 1500, inside = 37;
+            auto input    = _Input({outside, axis, inside}, NCHW);
+            auto inputPtr = input->writeMap<float>();
+            for (int i = 0; i < outside * axis * inside; ++i) {
+                inputPtr[i] = (float)((i * 37) % 101) * 0.01f - 0.5f;
+            }
+            std::vector<float> expectMean(outside * inside), expectMax(outside * inside);
+            for (int o = 0; o < outside; ++o) {
+                for (int x = 0; x < inside; ++x) {
+                    double sumValue = 0.0;
+                    float maxValue  = inputPtr[o * axis * inside + x];
+                    for (int a = 0; a < axis; ++a) {
+                        auto value = inputPtr[(o * axis + a) * inside + x];
+                        sumValue += value;
+                        maxValue = std::max(maxValue, value);
+                    }
+                    expectMean[o * inside + x] = (float)(sumValue / axis);
+                    expectMax[o * inside + x]  = maxValue;
+                }
+            }
+            input->unMap();
+            auto mean = _ReduceMean(input, {1});
+            if (!checkVector<float>(mean->readMap<float>(), expectMean.data(), outside * inside, 1e-4)) {
+                MNN_ERROR("ReduceLargeTest inside mean test failed!\n");
+                return false;
+            }
+            auto maxOutput = _ReduceMax(input, {1});
+            if (!checkVector<float>(maxOutput->readMap<float>(), expectMax.data(), outside * inside, 0.0f)) {
+                MNN_ERROR("ReduceLargeTest inside max test failed!\n");
+                return false;
+            }
+        }
+        return true;
+    }
+};
 MNNTestSuiteRegister(ReduceSumTest, "op/reduction/reduce_sum");
 MNNTestSuiteRegister(ReduceSumMultiTest, "op/reduction/reduce_sum_multi");
 MNNTestSuiteRegister(ReduceMeanTest, "op/reduction/reduce_mean");
 MNNTestSuiteRegister(ReduceMaxTest, "op/reduction/reduce_max");
 MNNTestSuiteRegister(ReduceMinTest, "op/reduction/reduce_min");
 MNNTestSuiteRegister(ReduceProdTest, "op/reduction/reduce_prod");
+MNNTestSuiteRegister(ReduceLargeTest, "op/reduction/reduce_large");
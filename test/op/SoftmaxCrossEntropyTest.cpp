@@ -0,0 +1,155 @@
+//
+//  SoftmaxCrossEntropyTest.cpp
+//  MNNTests
+//
+//  Created by MNN on 2020/12/07.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <vector>
+#include "MNNTestSuite.h"
+#include "MNN_generated.h"
+#include "TestUtils.h"
+
+using namespace MNN::Express;
+
+static VARP _SoftmaxCrossEntropy(VARP logits, VARP labels) {
+    using namespace MNN;
+    std::unique_ptr<OpT> op(new OpT);
+    op->type = OpType_SoftmaxCrossEntropy;
+    return Variable::create(Expr::create(std::move(op), {logits, labels}));
+}
+
+static VARP _SoftmaxCrossEntropyGrad(VARP logits, VARP labels, VARP lossGrad) {
+    using namespace MNN;
+    std::unique_ptr<OpT> op(new OpT);
+    op->type = OpType_SoftmaxCrossEntropyGrad;
+    return Variable::create(Expr::create(std::move(op), {logits, labels, lossGrad}));
+}
+
+// Reference log softmax of [outside, channel, inside] along channel
+static std::vector<float> _refLogSoftmax(const std::vector<float>& x, int outside, int channel, int inside) {
+    std::vector<float> y(x.size());
+    for (int o = 0; o < outside; ++o) {
+        for (int i = 0; i < inside; ++i) {
+            auto src = x.data() + o * channel * inside + i;
+            auto dst = y.data() + o * channel * inside + i;
+            double maxValue = src[0];
+            for (int c = 1; c < channel; ++c) {
+                maxValue = fmax(maxValue, src[c * inside]);
+            }
+            double sum = 0.0;
+            for (int c = 0; c < channel; ++c) {
+                sum += exp(src[c * inside] - maxValue);
+            }
+            for (int c = 0; c < channel; ++c) {
+                dst[c * inside] = (float)(src[c * inside] - maxValue - log(sum));
+            }
+        }
+    }
+    return y;
+}
+
+static std::vector<float> _makeData(int size, float scale) {
+    std::vector<float> data(size);
+    for (int i = 0; i < size; ++i) {
+        data[i] = scale * (float)((i * 7) % 13 - 6);
+    }
+    return data;
+}
+
+class LogSoftmaxTest : public MNNTestCase {
+public:
+    virtual ~LogSoftmaxTest() = default;
+    virtual bool run() {
+        // Last axis, channel is not multiple of 4
+        {
+            const int outside = 3, channel = 11;
+            auto data  = _makeData(outside * channel, 1.5f);
+            auto input = _Input({outside, channel}, NCHW);
+            ::memcpy(input->writeMap<float>(), data.data(), data.size() * sizeof(float));
+            auto output = _LogSoftmax(input);
+            auto expect = _refLogSoftmax(data, outside, channel, 1);
+            if (!checkVector<float>(output->readMap<float>(), expect.data(), expect.size(), 0.001)) {
+                MNN_ERROR("LogSoftmax last axis test failed!\n");
+                return false;
+            }
+        }
+        // Channel axis of NC4HW4 input
+        {
+            const int batch = 2, channel = 5, area = 9;
+            auto data  = _makeData(batch * channel * area, 0.7f);
+            auto input = _Input({batch, channel, 3, 3}, NCHW);
+            ::memcpy(input->writeMap<float>(), data.data(), data.size() * sizeof(float));
+            auto output = _Convert(_LogSoftmax(_Convert(input, NC4HW4), 1), NCHW);
+            auto expect = _refLogSoftmax(data, batch, channel, area);
+            if (!checkVector<float>(output->readMap<float>(), expect.data(), expect.size(), 0.001)) {
+                MNN_ERROR("LogSoftmax NC4HW4 test failed!\n");
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+class SoftmaxCrossEntropyTest : public MNNTestCase {
+public:
+    virtual ~SoftmaxCrossEntropyTest() = default;
+    virtual bool run() {
+        const int batch = 3, channel = 10;
+        // Large logits would overflow a naive log(softmax)
+        auto logitsData = _makeData(batch * channel, 20.0f);
+        std::vector<float> labelsData(batch * channel, 0.0f);
+        for (int b = 0; b < batch; ++b) {
+            labelsData[b * channel + (b * 3) % channel] = 1.0f;
+        }
+        // The last sample has soft labels
+        for (int c = 0; c < channel; ++c) {
+            labelsData[(batch - 1) * channel + c] = 1.0f / channel;
+        }
+        const float lossGradData[batch] = {1.0f, 0.5f, -2.0f};
+        auto logSoftmax = _refLogSoftmax(logitsData, batch, channel, 1);
+        std::vector<float> expectLoss(batch), expectGrad(batch * channel);
+        for (int b = 0; b < batch; ++b) {
+            float loss = 0.0f, labelSum = 0.0f;
+            for (int c = 0; c < channel; ++c) {
+                loss -= labelsData[b * channel + c] * logSoftmax[b * channel + c];
+                labelSum += labelsData[b * channel + c];
+            }
+            expectLoss[b] = loss;
+            for (int c = 0; c < channel; ++c) {
+                expectGrad[b * channel + c] =
+                    (expf(logSoftmax[b * channel + c]) * labelSum - labelsData[b * channel + c]) * lossGradData[b];
+            }
+        }
+
+        auto logits   = _Input({batch, channel}, NCHW);
+        auto labels   = _Input({batch, channel}, NCHW);
+        auto lossGrad = _Input({batch}, NCHW);
+        ::memcpy(logits->writeMap<float>(), logitsData.data(), logitsData.size() * sizeof(float));
+        ::memcpy(labels->writeMap<float>(), labelsData.data(), labelsData.size() * sizeof(float));
+        ::memcpy(lossGrad->writeMap<float>(), lossGradData, batch * sizeof(float));
+        auto loss = _SoftmaxCrossEntropy(logits, labels);
+        auto grad = _SoftmaxCrossEntropyGrad(logits, labels, lossGrad);
+        auto lossInfo = loss->getInfo();
+        if (nullptr == lossInfo || lossInfo->dim.size() != 1 || lossInfo->dim[0] != batch) {
+            MNN_ERROR("SoftmaxCrossEntropy shape test failed!\n");
+            return false;
+        }
+        if (!checkVectorByRelativeError<float>(loss->readMap<float>(), expectLoss.data(), batch, 0.001)) {
+            MNN_ERROR("SoftmaxCrossEntropy test failed!\n");
+            return false;
+        }
+        if (!checkVector<float>(grad->readMap<float>(), expectGrad.data(), batch * channel, 0.001)) {
+            MNN_ERROR("SoftmaxCrossEntropyGrad test failed!\n");
+            return false;
+        }
+        return true;
+    }
+};
+
+MNNTestSuiteRegister(LogSoftmaxTest, "op/LogSoftmax");
+MNNTestSuiteRegister(SoftmaxCrossEntropyTest, "op/SoftmaxCrossEntropy");
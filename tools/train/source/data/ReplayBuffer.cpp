@@ -0,0 +1,171 @@
+//
+//  ReplayBuffer.cpp
+//  MNN
+//
+//  Created by MNN on 2021/01/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "ReplayBuffer.hpp"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <MNN/expr/ExprCreator.hpp>
+#include "RandomGenerator.hpp"
+#include "core/Macro.h"
+#include "math/Vec.hpp"
+using namespace MNN::Express;
+
+namespace MNN {
+namespace Train {
+using Vec4 = Math::Vec<float, 4>;
+
+static float _sum(Vec4 v) {
+    return v[0] + v[1] + v[2] + v[3];
+}
+
+ReplayBuffer::ReplayBuffer(size_t capacity, int observationSize, float alpha) {
+    MNN_ASSERT(capacity > 0 && observationSize > 0);
+    mCapacity        = capacity;
+    mObservationSize = observationSize;
+    mAlpha           = alpha;
+    mObservations.resize(capacity * observationSize);
+    mActions.resize(capacity);
+    mRewards.resize(capacity);
+    mDones.resize(capacity);
+    // Every level is aligned to 4, the top level holds the children of the root
+    size_t levelSize = ALIGN_UP4(capacity);
+    while (true) {
+        mTree.emplace_back(levelSize, 0.0f);
+        if (levelSize <= 4) {
+            break;
+        }
+        levelSize = ALIGN_UP4(UP_DIV(levelSize, 4));
+    }
+}
+
+void ReplayBuffer::clear() {
+    mSize        = 0;
+    mHead        = 0;
+    mMaxPriority = 1.0f;
+    for (auto& level : mTree) {
+        std::fill(level.begin(), level.end(), 0.0f);
+    }
+}
+
+float ReplayBuffer::_total() const {
+    return _sum(Vec4::load(mTree.back().data()));
+}
+
+void ReplayBuffer::_setPriority(size_t slot, float priority) {
+    mTree[0][slot] = priority;
+    for (int k = 1; k < mTree.size(); ++k) {
+        slot /= 4;
+        mTree[k][slot] = _sum(Vec4::load(mTree[k - 1].data() + 4 * slot));
+    }
+}
+
+size_t ReplayBuffer::_find(float value) const {
+    size_t node = 0;
+    for (int k = (int)mTree.size() - 1; k >= 0; --k) {
+        auto children = Vec4::load(mTree[k].data() + 4 * node);
+        float p0      = children[0];
+        float p1      = p0 + children[1];
+        float p2      = p1 + children[2];
+        int index     = (value >= p0) + (value >= p1) + (value >= p2);
+        // Rounding may point to an empty child at the end
+        while (index > 0 && children[index] <= 0.0f) {
+            --index;
+        }
+        float before[] = {0.0f, p0, p1, p2};
+        value          = value - before[index];
+        node           = 4 * node + index;
+    }
+    return node;
+}
+
+size_t ReplayBuffer::add(const float* observation, int action, float reward, bool done) {
+    auto slot = mHead;
+    ::memcpy(mObservations.data() + slot * mObservationSize, observation, mObservationSize * sizeof(float));
+    mActions[slot] = action;
+    mRewards[slot] = reward;
+    mDones[slot]   = done ? 1.0f : 0.0f;
+    _setPriority(slot, powf(mMaxPriority, mAlpha));
+    mHead = (mHead + 1) % mCapacity;
+    mSize = std::min(mSize + 1, mCapacity);
+    return slot;
+}
+
+std::vector<size_t> ReplayBuffer::sample(size_t batchSize) {
+    if (0 == mSize) {
+        return {};
+    }
+    std::vector<size_t> slots(batchSize);
+    auto segment = _total() / (float)batchSize;
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    auto& generator = RandomGenerator::generator();
+    for (size_t i = 0; i < batchSize; ++i) {
+        auto value = ((float)i + distribution(generator)) * segment;
+        slots[i]   = std::min(_find(value), mSize - 1);
+    }
+    return slots;
+}
+
+std::vector<size_t> ReplayBuffer::latest(size_t count) const {
+    count = std::min(count, mSize);
+    std::vector<size_t> slots(count);
+    for (size_t i = 0; i < count; ++i) {
+        slots[i] = (mHead + mCapacity - count + i) % mCapacity;
+    }
+    return slots;
+}
+
+void ReplayBuffer::updatePriorities(const std::vector<size_t>& slots, const float* priorities) {
+    for (size_t i = 0; i < slots.size(); ++i) {
+        // Keep a positive priority so that every transition can be sampled again
+        auto priority = fabsf(priorities[i]) + 1e-6f;
+        mMaxPriority  = std::max(mMaxPriority, priority);
+        _setPriority(slots[i], powf(priority, mAlpha));
+    }
+}
+
+ReplayBuffer::Batch ReplayBuffer::gather(const std::vector<size_t>& slots, float beta) const {
+    const int n = (int)slots.size();
+    Batch batch;
+    batch.observation = _Input({n, mObservationSize}, NHWC, halide_type_of<float>());
+    batch.action      = _Input({n, 1}, NHWC, halide_type_of<int32_t>());
+    batch.reward      = _Input({n, 1}, NHWC, halide_type_of<float>());
+    batch.done        = _Input({n, 1}, NHWC, halide_type_of<float>());
+    batch.weight      = _Input({n, 1}, NHWC, halide_type_of<float>());
+    auto observation  = batch.observation->writeMap<float>();
+    auto action       = batch.action->writeMap<int32_t>();
+    auto reward       = batch.reward->writeMap<float>();
+    auto done         = batch.done->writeMap<float>();
+    auto weight       = batch.weight->writeMap<float>();
+    const auto rowSize = mObservationSize * sizeof(float);
+    for (int i = 0; i < n; ++i) {
+        auto slot = slots[i];
+        MNN_ASSERT(slot < mSize);
+        ::memcpy(observation + i * mObservationSize, mObservations.data() + slot * mObservationSize, rowSize);
+        action[i] = mActions[slot];
+        reward[i] = mRewards[slot];
+        done[i]   = mDones[slot];
+    }
+    if (0.0f == beta || 0 == n) {
+        std::fill(weight, weight + n, 1.0f);
+        return batch;
+    }
+    // (size * p / total) ^ -beta normalized by the max of the batch, which comes from the min priority
+    float minPriority = mTree[0][slots[0]];
+    for (int i = 0; i < n; ++i) {
+        minPriority = std::min(minPriority, mTree[0][slots[i]]);
+    }
+    for (int i = 0; i < n; ++i) {
+        weight[i] = powf(mTree[0][slots[i]] / minPriority, -beta);
+    }
+    return batch;
+}
+
+} // namespace Train
+} // namespace MNN
@@ -0,0 +1,90 @@
+//
+//  ReplayBuffer.hpp
+//  MNN
+//
+//  Created by MNN on 2021/01/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef ReplayBuffer_hpp
+#define ReplayBuffer_hpp
+
+#include <MNN/MNNDefine.h>
+#include <MNN/expr/Expr.hpp>
+#include <vector>
+
+namespace MNN {
+namespace Train {
+
+/**
+ Transitions of reinforcement learning in a preallocated ring, the oldest ones are overwritten when it's full. Each
+ field is kept in its own array (observation, action, reward, done), so a batch is gathered by row copies straight into
+ the memory of the input variables.
+ Slots are sampled in proportion to priority ^ alpha by a 4-ary sum tree, whose children of a node are one vector. With
+ alpha = 0 the sampling is uniform.
+ */
+class MNN_PUBLIC ReplayBuffer {
+public:
+    struct Batch {
+        // [n, observationSize], float
+        Express::VARP observation;
+        // [n, 1], int32
+        Express::VARP action;
+        // [n, 1], float
+        Express::VARP reward;
+        // [n, 1], float, 1 for the last step of an episode
+        Express::VARP done;
+        // [n, 1], float, importance sampling weight (size * P(i)) ^ -beta normalized by the max of the batch
+        Express::VARP weight;
+    };
+
+    ReplayBuffer(size_t capacity, int observationSize, float alpha = 0.0f);
+
+    // Add a transition with the max priority seen so far, return its slot
+    size_t add(const float* observation, int action, float reward, bool done);
+
+    void clear();
+
+    size_t size() const {
+        return mSize;
+    }
+
+    size_t capacity() const {
+        return mCapacity;
+    }
+
+    // Sample batchSize slots, one from each of batchSize equal segments of the total priority
+    std::vector<size_t> sample(size_t batchSize);
+
+    // Slots of the latest count transitions in the order they were added, for on-policy rollouts
+    std::vector<size_t> latest(size_t count) const;
+
+    // Set the priority of slots, usually |td error|
+    void updatePriorities(const std::vector<size_t>& slots, const float* priorities);
+
+    Batch gather(const std::vector<size_t>& slots, float beta = 0.0f) const;
+
+private:
+    void _setPriority(size_t slot, float priority);
+    size_t _find(float value) const;
+    float _total() const;
+
+    size_t mCapacity;
+    int mObservationSize;
+    float mAlpha;
+    float mMaxPriority = 1.0f;
+    size_t mSize = 0;
+    size_t mHead = 0;
+
+    std::vector<float> mObservations;
+    std::vector<int32_t> mActions;
+    std::vector<float> mRewards;
+    std::vector<float> mDones;
+    // mTree[0] are the priorities of slots, mTree[k + 1][i] is the sum of mTree[k][4i, 4i + 4)
+    std::vector<std::vector<float>> mTree;
+};
+
+} // namespace Train
+} // namespace MNN
+
+#endif // ReplayBuffer_hpp
@@ -2,6 +2,7 @@
 #include <memory>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <MNN/expr/NN.hpp>
 #include "ADAM.hpp"
@@ -14,14 +15,17 @@ using namespace MNN::Express;
 using namespace MNN::Train;
 
 #define GAMMA 0.99
+// lambda = 1 keeps the advantage as the discounted return minus value, lower it to reduce the variance
+#define LAMBDA 1.0
 
 MNN::Express::VARP A2C::Policy_Loss(Express::VARP pi, Express::VARP oneHotActions, Express::VARP adv) {
     MNN_ASSERT(pi->getInfo()->dim == oneHotActions->getInfo()->dim);
-    MNN_ASSERT(oneHotActions->getInfo()->dim == reward->getInfo()->dim);
+    MNN_ASSERT(pi->getInfo()->dim[0] == adv->getInfo()->dim[0]);
+    // keep dims so that the log prob [batch, 1] matches adv [batch, 1]
     auto pi_loss = _Negative(
         _ReduceMean(
             _ReduceSum(
-                _Log(pi) * oneHotActions, {1}
+                _Log(pi) * oneHotActions, {1}, true
                 ) * adv, {}
             )
         );
@@ -89,58 +93,50 @@ std::vector<float> A2C::Predict(std::vector<float>& obs)
     return pi_ret;
 }
 
-void A2C::Train(std::vector<std::vector<float>>& s_batch,
-                std::vector<int32_t>& a_batch, 
-                std::vector<float>& r_batch) {
-    // from vector to VARP
-    auto batch_size = s_batch.size();
-    // generate tmp state
-    std::vector<float> s_tmp;
-    for (auto &t: s_batch){
-        for (auto &l: t){
-            s_tmp.push_back(l);
+int A2C::Act(std::vector<float>& obs, std::mt19937& gen) {
+    std::uniform_real_distribution<> dis(0., 1.);
+    auto prob = this->Predict(obs);
+    double best = -std::numeric_limits<double>::infinity();
+    int action  = 0;
+    for (int n = 0; n < this->a_dim; ++n) {
+        auto gumble = -std::log(-std::log(dis(gen))) + std::log(prob[n]);
+        if (gumble > best) {
+            action = n;
+            best   = gumble;
         }
     }
-    // compute real reward
-    auto R_batch = this->ComputeR(r_batch);
-
-    auto states = _Input({int(batch_size), this->s_info}, NHWC, halide_type_of<float>());
-    auto actions = _Input({int(batch_size), 1}, NHWC, halide_type_of<int32_t>());
-    auto rewards = _Input({int(batch_size), 1}, NHWC, halide_type_of<float>());
-    auto advs = _Input({int(batch_size), 1}, NHWC, halide_type_of<float>());
+    return action;
+}
 
-    ::memcpy(states->writeMap<float>(), s_tmp.data(), s_tmp.size() * sizeof(float));
-    ::memcpy(actions->writeMap<int32_t>(), a_batch.data(), a_batch.size() * sizeof(int32_t));
-    ::memcpy(rewards->writeMap<float>(), R_batch.data(), R_batch.size() * sizeof(float));
+std::pair<VARP, VARP> A2C::Loss(const ReplayBuffer::Batch& batch, std::vector<float>& next_obs) {
+    // states and actions are gathered by the replay buffer, a trajectory of [T, 1]
+    auto states = batch.observation;
+    auto actions = batch.action;
+    auto next_states = _Input({1, this->s_info}, NHWC, halide_type_of<float>());
+    ::memcpy(next_states->writeMap<float>(), next_obs.data(), next_obs.size() * sizeof(float));
 
-    auto actionOneHot = _OneHot(_Cast<int32_t>(actions), _Scalar<int>(this->a_dim), _Scalar<float>(1.0f),
-                                _Scalar<float>(0.0f));
+    // actions [T, 1] -> one hot [T, a_dim]
+    auto actionOneHot = _OneHot(_Reshape(_Cast<int32_t>(actions), {-1}), _Scalar<int>(this->a_dim),
+                                _Scalar<float>(1.0f), _Scalar<float>(0.0f));
     
     auto pi = this->policy_->forward(states);
-    auto val = this->val_->forward(states);
-    auto val_mem = val->readMap<float>();
-    std::vector<float> adv(batch_size);
-    for (auto i = 0; i < batch_size; ++i) {
-        adv[i] = R_batch[i] - val_mem[i];
-    }
-    ::memcpy(advs->writeMap<float>(), adv.data(), adv.size() * sizeof(float));
-
-    auto p_loss = this->Policy_Loss(pi, actionOneHot, advs);
-    this->policy_adam_->step(p_loss);
-
-    auto v_loss = this->Val_Loss(val, rewards);
-    this->val_adam_->step(v_loss);
+    // The last step bootstraps from the value of the next state unless the episode is done. The module rebinds its
+    // input on each forward, so the values of all T + 1 states come from one forward
+    auto batch_size = batch.reward->getInfo()->dim[0];
+    auto values = _Split(this->val_->forward(_Concat({states, next_states}, 0)), {batch_size, 1}, 0);
+    auto val = values[0];
+    auto bootstrap = values[1];
+    // advantages and returns are computed in the graph, they have no grad so they act as constants in the losses
+    auto gae = _GAE(batch.reward, val, batch.done, bootstrap, GAMMA, LAMBDA);
+
+    auto p_loss = this->Policy_Loss(pi, actionOneHot, gae[0]);
+    auto v_loss = this->Val_Loss(val, gae[1]);
+    return std::make_pair(p_loss, v_loss);
 }
 
-std::vector<float> A2C::ComputeR(std::vector<float>& r_batch)
-{
-    auto batch_size = r_batch.size();
-    std::vector<float> R_batch(batch_size);
-    for(auto i = 0; i < batch_size - 1; ++i)
-    {
-        auto t = batch_size - 1 - i;
-        R_batch[t] = r_batch[t] + GAMMA * R_batch[t + 1];
-    }
-    return R_batch;
+void A2C::Train(const ReplayBuffer::Batch& batch, std::vector<float>& next_obs) {
+    auto loss = this->Loss(batch, next_obs);
+    this->policy_adam_->step(loss.first);
+    this->val_adam_->step(loss.second);
 }
 
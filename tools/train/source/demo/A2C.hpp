@@ -2,7 +2,9 @@
 #define A2C_hpp
 #include <vector>
 #include <memory>
+#include <random>
 #include <string>
+#include <utility>
 
 #include <MNN/expr/Module.hpp>
 #include <MNN/expr/Executor.hpp>
@@ -10,14 +12,48 @@
 #include "Policy.hpp"
 #include "Val.hpp"
 #include "ADAM.hpp"
+#include "ReplayBuffer.hpp"
 
 class A2C {
 public:
     A2C(int s_info, int a_dim, double learning_rate);
-    void Train(std::vector<std::vector<float>>& s_batch,
-                std::vector<int32_t>& a_batch, 
-                std::vector<float>& r_batch);
+    // batch is a trajectory in order, next_obs is the observation after its last step
+    void Train(const MNN::Train::ReplayBuffer::Batch& batch, std::vector<float>& next_obs);
+    // The policy and value losses of Train, without the optimizer steps
+    std::pair<MNN::Express::VARP, MNN::Express::VARP> Loss(const MNN::Train::ReplayBuffer::Batch& batch,
+                                                           std::vector<float>& next_obs);
     std::vector<float> Predict(std::vector<float>& obs);
+    // Sample an action from the policy by the gumbel max trick
+    int Act(std::vector<float>& obs, std::mt19937& gen);
+    // Play one episode of at most max_step steps from env->reset, the transitions are added to buffer. obs is the
+    // observation after the last step, return the number of steps
+    template <typename Env>
+    int Rollout(Env& env, MNN::Train::ReplayBuffer& buffer, int max_step, std::vector<float>& obs, float& cum,
+                std::mt19937& gen) {
+        int steps = 0;
+        cum       = 0.0f;
+        env.reset(obs);
+        for (auto step = 0; step < max_step; ++step) {
+            std::vector<float> state = obs;
+            auto action              = this->Act(obs, gen);
+            float reward;
+            bool done;
+            env.step(action, obs, reward, done);
+            buffer.add(state.data(), action, reward, done);
+            cum += reward;
+            steps++;
+            if (done) {
+                break;
+            }
+        }
+        return steps;
+    }
+    std::shared_ptr<MNN::Train::ADAM> PolicyOptimizer() const {
+        return policy_adam_;
+    }
+    std::shared_ptr<MNN::Train::ADAM> ValOptimizer() const {
+        return val_adam_;
+    }
     // void Load(std::string& filename);
     // void Save(std::string& filename);
     
@@ -33,7 +69,6 @@ private:
     std::shared_ptr<MNN::Express::Executor> exe;
     MNN::Express::VARP Policy_Loss(MNN::Express::VARP pi, MNN::Express::VARP oneHotActions, MNN::Express::VARP reward);
     MNN::Express::VARP Val_Loss(MNN::Express::VARP val, MNN::Express::VARP reward);
-    std::vector<float> ComputeR(std::vector<float>& r_batch);
 protected:
 
 };
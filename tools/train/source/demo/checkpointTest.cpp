@@ -0,0 +1,184 @@
+//
+//  checkpointTest.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/08.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <MNN/expr/ExprCreator.hpp>
+#include <MNN/expr/NN.hpp>
+#include "Checkpoint.hpp"
+#include "DemoUnit.hpp"
+#if defined(_MSC_VER)
+#include <direct.h>
+#define MNN_MKDIR(name) _mkdir(name)
+#else
+#include <sys/stat.h>
+#define MNN_MKDIR(name) mkdir(name, 0755)
+#endif
+using namespace MNN::Express;
+using namespace MNN::Train;
+
+static bool _compare(const std::vector<VARP>& a, const std::vector<VARP>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (int i = 0; i < a.size(); ++i) {
+        auto infoA = a[i]->getInfo();
+        auto infoB = b[i]->getInfo();
+        if (infoA->dim != infoB->dim || infoA->type != infoB->type) {
+            return false;
+        }
+        if (0 != ::memcmp(a[i]->readMap<void>(), b[i]->readMap<void>(), infoA->size * infoA->type.bytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class CheckpointTest : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        MNN_PRINT("Test checkpoint save, delta save and mapped load\n");
+        std::shared_ptr<Module> model(NN::Linear(64, 32));
+        std::shared_ptr<Module> other(NN::Linear(64, 32));
+        Checkpoint writer;
+        if (!writer.save(model->parameters(), "checkpoint.base.ckpt")) {
+            return 1;
+        }
+        // Change the bias only, the delta checkpoint should contain one variable
+        auto parameters = model->parameters();
+        auto bias       = parameters[1];
+        auto biasPtr    = bias->writeMap<float>();
+        for (int i = 0; i < bias->getInfo()->size; ++i) {
+            biasPtr[i] = (float)i;
+        }
+        writer.saveAsync(parameters, "checkpoint.delta.ckpt", true);
+        // Modify after snapshot, should not affect the async checkpoint
+        auto expect = model->parameters();
+        std::vector<VARP> expectCopy;
+        for (auto& v : expect) {
+            auto info = v->getInfo();
+            auto copy = _Const(v->readMap<void>(), info->dim, info->order, info->type);
+            expectCopy.emplace_back(copy);
+        }
+        bias->writeMap<float>()[0] = -1.0f;
+        if (!writer.wait()) {
+            return 1;
+        }
+        Checkpoint reader;
+        auto loaded = reader.load("checkpoint.delta.ckpt");
+        if (!_compare(loaded, expectCopy)) {
+            MNN_ERROR("Checkpoint load result not match\n");
+            return 1;
+        }
+        other->loadParameters(loaded);
+        if (!_compare(other->parameters(), expectCopy)) {
+            MNN_ERROR("Checkpoint loadParameters result not match\n");
+            return 1;
+        }
+        FILE* f = fopen("checkpoint.delta.ckpt", "rb");
+        fseek(f, 0, SEEK_END);
+        auto deltaSize = ftell(f);
+        fclose(f);
+        MNN_PRINT("Delta checkpoint size: %ld bytes\n", deltaSize);
+
+        MNN_PRINT("Test delta save to the file of its base\n");
+        Checkpoint sameName;
+        if (!sameName.save(expectCopy, "checkpoint.same.ckpt")) {
+            return 1;
+        }
+        bias->writeMap<float>()[1] = -2.0f;
+        if (sameName.save(model->parameters(), "checkpoint.same.ckpt", true)) {
+            MNN_ERROR("Checkpoint delta save overwrites its base\n");
+            return 1;
+        }
+        // The base is kept, and a delta to another file still works
+        Checkpoint baseReader;
+        if (!_compare(baseReader.load("checkpoint.same.ckpt"), expectCopy)) {
+            MNN_ERROR("Checkpoint base is broken by the rejected delta save\n");
+            return 1;
+        }
+        if (!sameName.save(model->parameters(), "checkpoint.same.delta.ckpt", true)) {
+            return 1;
+        }
+        Checkpoint deltaReader;
+        if (!_compare(deltaReader.load("checkpoint.same.delta.ckpt"), model->parameters())) {
+            MNN_ERROR("Checkpoint delta load result not match\n");
+            return 1;
+        }
+
+        MNN_PRINT("Test delta save to an ancestor of its base\n");
+        {
+            Checkpoint chain;
+            if (!chain.save(expectCopy, "checkpoint.chain.a.ckpt") ||
+                !chain.save(model->parameters(), "checkpoint.chain.b.ckpt", true)) {
+                return 1;
+            }
+            bias->writeMap<float>()[2] = -3.0f;
+            // a -> b -> a is a cycle, also when a is spelled in another way
+            if (chain.save(model->parameters(), "./checkpoint.chain.a.ckpt", true)) {
+                MNN_ERROR("Checkpoint delta save overwrites an ancestor of its base\n");
+                return 1;
+            }
+            Checkpoint chainReader;
+            if (!_compare(chainReader.load("checkpoint.chain.a.ckpt"), expectCopy)) {
+                MNN_ERROR("Checkpoint ancestor is broken by the rejected delta save\n");
+                return 1;
+            }
+        }
+
+        MNN_PRINT("Test moving a directory of delta checkpoints\n");
+        {
+            MNN_MKDIR("checkpoint.dir");
+            ::remove("checkpoint.moved/base.ckpt");
+            ::remove("checkpoint.moved/delta.ckpt");
+            ::remove("checkpoint.moved");
+            Checkpoint dirWriter;
+            if (!dirWriter.save(expectCopy, "checkpoint.dir/base.ckpt") ||
+                !dirWriter.save(model->parameters(), "checkpoint.dir/delta.ckpt", true)) {
+                return 1;
+            }
+            // The base is found relative to the delta file, not the working directory
+            if (0 != ::rename("checkpoint.dir", "checkpoint.moved")) {
+                MNN_ERROR("Can't move checkpoint.dir\n");
+                return 1;
+            }
+            Checkpoint movedReader;
+            if (!_compare(movedReader.load("checkpoint.moved/delta.ckpt"), model->parameters())) {
+                MNN_ERROR("Checkpoint delta load after move not match\n");
+                return 1;
+            }
+        }
+
+        MNN_PRINT("Test NC4HW4 variable\n");
+        {
+            const int channel = 5, area = 3 * 3;
+            std::vector<float> values(channel * area);
+            for (int i = 0; i < values.size(); ++i) {
+                values[i] = (float)i * 0.5f - 3.0f;
+            }
+            auto plain  = _Const(values.data(), {1, channel, 3, 3}, NCHW);
+            auto packed = _Convert(plain, NC4HW4);
+            packed.fix(VARP::TRAINABLE);
+            Checkpoint packedWriter;
+            if (!packedWriter.save({packed}, "checkpoint.nc4hw4.ckpt")) {
+                return 1;
+            }
+            Checkpoint packedReader;
+            auto packedLoaded = packedReader.load("checkpoint.nc4hw4.ckpt");
+            if (packedLoaded.size() != 1 || packedLoaded[0]->getInfo()->order != NC4HW4 ||
+                !_compare({_Convert(packedLoaded[0], NCHW)}, {plain})) {
+                MNN_ERROR("Checkpoint NC4HW4 load result not match\n");
+                return 1;
+            }
+        }
+        MNN_PRINT("Checkpoint test success\n");
+        return 0;
+    }
+};
+
+DemoUnitSetRegister(CheckpointTest, "CheckpointTest");
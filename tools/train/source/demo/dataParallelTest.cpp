@@ -0,0 +1,129 @@
+//
+//  dataParallelTest.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/03.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/ExprCreator.hpp>
+#include <cmath>
+#include <random>
+#include <string.h>
+#include <vector>
+#include "DataParallel.hpp"
+#include "DemoUnit.hpp"
+#include "Lenet.hpp"
+#include "Loss.hpp"
+#include "SGD.hpp"
+
+using namespace MNN::Express;
+using namespace MNN::Train;
+using namespace MNN::Train::Model;
+
+static VARP _lenetLoss(std::shared_ptr<Module> m, const Example& example) {
+    return _CrossEntropy(m->forward(example.first[0]), example.second[0]);
+}
+
+static SGD* _createSGD(std::shared_ptr<Module> m) {
+    auto sgd = new SGD(m);
+    sgd->setLearningRate(0.01f);
+    return sgd;
+}
+
+static bool _compare(const std::vector<VARP>& result, const std::vector<VARP>& expect, const char* name) {
+    if (result.size() != expect.size()) {
+        MNN_ERROR("%s: size %d, expect %d\n", name, (int)result.size(), (int)expect.size());
+        return false;
+    }
+    for (int i = 0; i < result.size(); ++i) {
+        auto size = result[i]->getInfo()->size;
+        auto x    = result[i]->readMap<float>();
+        auto y    = expect[i]->readMap<float>();
+        for (int k = 0; k < size; ++k) {
+            if (fabsf(x[k] - y[k]) > 1e-4f * (1.0f + fabsf(y[k]))) {
+                MNN_ERROR("%s: %d's value %d is %f, expect %f\n", name, i, k, x[k], y[k]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+class DataParallelTest : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        const int number = 3, batch = 4;
+        std::shared_ptr<Module> master(new Lenet);
+        // Dropout is random per replica, turn it off to compare the results
+        static_cast<Lenet*>(master.get())->dropout->setIsTraining(false);
+
+        MNN_PRINT("Test clone of replicas\n");
+        auto replicas = DataParallel::createReplicas(master, number);
+        if (replicas.size() != number) {
+            MNN_ERROR("Can't clone %d replicas\n", number);
+            return 1;
+        }
+        std::mt19937 gen(0);
+        std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+        auto makeExample = [&]() {
+            auto input  = _Input({batch, 1, 28, 28}, NCHW);
+            auto target = _Input({batch, 10}, NCHW);
+            auto inputPtr  = input->writeMap<float>();
+            auto targetPtr = target->writeMap<float>();
+            for (int i = 0; i < batch * 28 * 28; ++i) {
+                inputPtr[i] = dis(gen);
+            }
+            ::memset(targetPtr, 0, batch * 10 * sizeof(float));
+            for (int i = 0; i < batch; ++i) {
+                targetPtr[i * 10 + gen() % 10] = 1.0f;
+            }
+            return Example{{input}, {target}};
+        };
+        auto example = makeExample();
+        auto expect  = master->forward(example.first[0]);
+        for (int r = 1; r < number; ++r) {
+            auto masterParameters = master->parameters();
+            auto parameters       = replicas[r]->parameters();
+            for (int k = 0; k < parameters.size(); ++k) {
+                if (parameters[k]->readMap<float>() == masterParameters[k]->readMap<float>()) {
+                    MNN_ERROR("Replica %d shares the parameter %d\n", r, k);
+                    return 1;
+                }
+            }
+            if (!_compare({replicas[r]->forward(example.first[0])}, {expect}, "Forward of replica")) {
+                return 1;
+            }
+        }
+
+        MNN_PRINT("Test step with the same shard on all replicas\n");
+        // The mean of the same gradients is the gradient of one replica, compare with a plain SGD step
+        std::shared_ptr<Module> reference(Module::clone(master.get()));
+        std::shared_ptr<SGD> sgd(_createSGD(reference));
+        std::shared_ptr<DataParallel> parallel(DataParallel::create(replicas, _createSGD, _lenetLoss));
+        if (nullptr == parallel) {
+            MNN_ERROR("Can't create DataParallel\n");
+            return 1;
+        }
+        // The workers are reused by each step
+        for (int step = 0; step < 3; ++step) {
+            auto shard = makeExample();
+            std::vector<Example> shards(number, shard);
+            float loss = 0.0f;
+            if (!parallel->step(shards, &loss)) {
+                MNN_ERROR("Step %d failed\n", step);
+                return 1;
+            }
+            sgd->step(_lenetLoss(reference, shard));
+            for (int r = 0; r < number; ++r) {
+                if (!_compare(replicas[r]->parameters(), reference->parameters(), "Parameters after step")) {
+                    return 1;
+                }
+            }
+        }
+        MNN_PRINT("Test DataParallel success\n");
+        return 0;
+    }
+};
+
+DemoUnitSetRegister(DataParallelTest, "DataParallelTest");
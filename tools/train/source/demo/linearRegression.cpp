@@ -10,6 +10,7 @@
 #include <random>
 #include "DemoUnit.hpp"
 #include "SGD.hpp"
+#include "TrainStep.hpp"
 using namespace MNN::Express;
 using namespace MNN::Train;
 std::random_device gRandom;
@@ -55,3 +56,47 @@ public:
 };
 
 DemoUnitSetRegister(LinearRegress, "LinearRegress");
+
+class LinearRegressStep : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        VARP w = _TrainableParam(0.3f, {}, NHWC);
+        VARP b = _TrainableParam(0.1f, {}, NHWC);
+        std::shared_ptr<Module> _m(Module::createEmpty({w, b}));
+        std::shared_ptr<SGD> opt(new SGD(_m));
+        opt->setLearningRate(0.1f);
+
+        const int number = 10;
+        const int limit  = 300;
+        Variable::Info info;
+        info.order = NHWC;
+        info.dim   = {number};
+        info.type  = halide_type_of<float>();
+        std::shared_ptr<TrainStep> trainStep(TrainStep::create(_m, opt, {info, info}, [w, b](const std::vector<VARP>& inputs) {
+            VARP diff = inputs[0] * w + b - inputs[1];
+            return (diff * diff).mean({});
+        }));
+        if (nullptr == trainStep) {
+            return 1;
+        }
+        VARP x     = _Input({number}, NHWC);
+        VARP label = _Input({number}, NHWC);
+        float loss = 0.0f;
+        for (int i = 0; i < limit; ++i) {
+            auto xPtr = x->writeMap<float>();
+            auto ptr  = label->writeMap<float>();
+            for (int v = 0; v < number; ++v) {
+                xPtr[v] = (gRandom() % 10000) / 10000.0f;
+                ptr[v]  = xPtr[v] * 0.8f + 0.7f;
+            }
+            if (!trainStep->step({x, label}, &loss)) {
+                return 1;
+            }
+        }
+        MNN_PRINT("loss = %f, w = %f, b = %f, Target w = 0.8f, Target b = 0.7f\n", loss, w->readMap<float>()[0],
+                  b->readMap<float>()[0]);
+        return 0;
+    }
+};
+
+DemoUnitSetRegister(LinearRegressStep, "LinearRegressStep");
@@ -11,8 +11,14 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include "ADAM.hpp"
+#include "Checkpoint.hpp"
+#include "DataLoader.hpp"
+#include "DataParallel.hpp"
 #include "DemoUnit.hpp"
 #include "Lenet.hpp"
+#include "Loss.hpp"
+#include "MnistDataset.hpp"
 #include "MnistUtils.hpp"
 #include <MNN/expr/NN.hpp>
 #define MNN_OPEN_TIME_TRACE
@@ -195,6 +201,68 @@ public:
         return 0;
     }
 };
+class MnistTrainParallel : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        if (argc < 2) {
+            std::cout << "usage: ./runTrainDemo.out MnistTrainParallel /path/to/unzipped/mnist/data/ [replicas]" << std::endl;
+            return 0;
+        }
+        RandomGenerator::generator(17);
+        std::string root = argv[1];
+        int number       = 4;
+        if (argc >= 3) {
+            std::istringstream is(argv[2]);
+            is >> number;
+        }
+        // The replicas are clones of the first one
+        auto replicas = DataParallel::createReplicas(std::shared_ptr<Module>(new Lenet), number);
+        if (replicas.empty()) {
+            return 1;
+        }
+        std::shared_ptr<DataParallel> parallel(DataParallel::create(
+            replicas,
+            [](std::shared_ptr<Module> m) {
+                auto adam = new ADAM(m);
+                adam->setLearningRate(1e-4);
+                return adam;
+            },
+            [](std::shared_ptr<Module> m, const Example& example) {
+                auto input  = _Cast<float>(example.first[0]) * _Const(1.0f / 255.0f);
+                auto target = _OneHot(_Cast<int32_t>(example.second[0]), _Scalar<int>(10), _Scalar<float>(1.0f),
+                                      _Scalar<float>(0.0f));
+                return _CrossEntropy(m->forward(input), target);
+            }));
+        if (nullptr == parallel) {
+            return 1;
+        }
+        auto dataset    = MnistDataset::create(root, MnistDataset::Mode::TRAIN);
+        auto dataLoader = std::shared_ptr<DataLoader>(dataset.createLoader(64, true, true, 0));
+        auto iterations = dataLoader->iterNumber() / number;
+        Checkpoint checkpoint;
+        for (int epoch = 0; epoch < 10; ++epoch) {
+            AUTOTIME;
+            dataLoader->reset();
+            for (int i = 0; i < iterations; ++i) {
+                std::vector<Example> shards;
+                for (int r = 0; r < number; ++r) {
+                    shards.emplace_back(dataLoader->next()[0]);
+                }
+                float loss = 0.0f;
+                parallel->step(shards, &loss);
+                if (i % 100 == 0) {
+                    std::cout << "epoch: " << epoch << " " << i << " / " << iterations << " loss: " << loss << std::endl;
+                }
+            }
+            // Written in background while next epoch is training
+            checkpoint.saveAsync(parallel->module()->parameters(), "mnist.parallel.ckpt");
+        }
+        checkpoint.wait();
+        return 0;
+    }
+};
+
 DemoUnitSetRegister(MnistTrain, "MnistTrain");
+DemoUnitSetRegister(MnistTrainParallel, "MnistTrainParallel");
 DemoUnitSetRegister(MnistTrainSnapshot, "MnistTrainSnapshot");
 DemoUnitSetRegister(MnistInt8Train, "MnistInt8Train");
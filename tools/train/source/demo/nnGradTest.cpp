@@ -6,11 +6,24 @@
 //  Copyright © 2018, Alibaba Group Holding Limited
 //
 
+#include <math.h>
+#include <stdio.h>
 #include <string.h>
+#include <fstream>
+#include <functional>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <MNN/expr/Executor.hpp>
 #include "ADAM.hpp"
 #include "DemoUnit.hpp"
+#include "Initializer.hpp"
+#include "Lenet.hpp"
+#include "Loss.hpp"
 #include <MNN/expr/NN.hpp>
+#include "OpGrad.hpp"
 #include "SGD.hpp"
+#include "core/Backend.hpp"
 using namespace MNN::Express;
 using namespace MNN::Train;
 #include <random>
@@ -309,7 +322,287 @@ public:
     }
 };
 
+class GatherGradTest : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        MNN_PRINT("Test sparse grad for Gather, GatherND with lazy SGD, ADAM\n");
+        const int num = 1000, dim = 8, batch = 16;
+        std::vector<float> targetVecs(num * dim);
+        for (int i = 0; i < targetVecs.size(); ++i) {
+            targetVecs[i] = ((float)(gDevice() % 2000) - 1000.0f) / 1000.0f;
+        }
+        auto tableTarget = _Const(targetVecs.data(), {num, dim}, NCHW);
+        for (int useAdam = 0; useAdam < 2; ++useAdam) {
+            auto table = _TrainableParam(0.1f, {num, dim}, NCHW);
+            std::shared_ptr<Module> _m(Module::createEmpty({table}));
+            std::shared_ptr<SGD> sgd;
+            if (useAdam) {
+                sgd.reset(new ADAM(_m));
+                sgd->setLearningRate(0.05f);
+            } else {
+                sgd.reset(new SGD(_m));
+                sgd->setLearningRate(0.5f);
+                sgd->setMomentum(0.9f);
+            }
+            // A dense update would decay the untouched rows
+            sgd->setWeightDecay(0.001f);
+            float firstLoss = 0.0f, lastLoss = 0.0f;
+            for (int i = 0; i < 2000; ++i) {
+                // Only the first half of the table is looked up, the rest must stay untouched
+                auto indices    = _Input({batch}, NCHW, halide_type_of<int>());
+                auto indicesPtr = indices->writeMap<int>();
+                for (int b = 0; b < batch; ++b) {
+                    indicesPtr[b] = gDevice() % (num / 2);
+                }
+                VARP predictValue, targetValue;
+                if (i % 2 == 0) {
+                    predictValue = _GatherV2(table, indices);
+                    targetValue  = _GatherV2(tableTarget, indices);
+                } else {
+                    auto ndIndices = _Unsqueeze(indices, {1});
+                    predictValue   = _GatherND(table, ndIndices);
+                    targetValue    = _GatherND(tableTarget, ndIndices);
+                }
+                auto loss = _ReduceMean(_Square(_Subtract(targetValue, predictValue)), {});
+                lastLoss  = loss->readMap<float>()[0];
+                if (0 == i) {
+                    firstLoss = lastLoss;
+                }
+                if (i % 500 == 0) {
+                    MNN_PRINT("Loss = %f\n", lastLoss);
+                }
+                // Only sparse grads, the step still succeeds
+                if (!sgd->step(loss)) {
+                    MNN_ERROR("Sparse step failed\n");
+                    return 1;
+                }
+            }
+            auto tablePtr = _m->parameters()[0]->readMap<float>();
+            for (int i = num / 2 * dim; i < num * dim; ++i) {
+                if (tablePtr[i] != 0.1f) {
+                    MNN_ERROR("Untouched row %d is updated\n", i / dim);
+                    return 1;
+                }
+            }
+            if (!(lastLoss < firstLoss * 0.1f)) {
+                MNN_ERROR("Loss not converge: %f -> %f\n", firstLoss, lastLoss);
+                return 1;
+            }
+        }
+        return 0;
+    }
+};
+
+class RecurrentGradTest : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        MNN_PRINT("Test grad for GRU, LSTM sequence\n");
+        const int step = 8, batch = 16, inputSize = 4, hiddenSize = 8;
+        for (int lstm = 0; lstm < 2; ++lstm) {
+            std::shared_ptr<Initializer> teacherInit(Initializer::uniform(-1.0f, 1.0f));
+            std::shared_ptr<Module> teacher(lstm ? NN::LSTM(inputSize, hiddenSize, teacherInit)
+                                                 : NN::GRU(inputSize, hiddenSize, teacherInit));
+            std::shared_ptr<Module> student(lstm ? NN::LSTM(inputSize, hiddenSize) : NN::GRU(inputSize, hiddenSize));
+            std::shared_ptr<ADAM> sgd(new ADAM(student));
+            sgd->setLearningRate(0.01f);
+            float firstLoss = 0.0f, lastLoss = 0.0f;
+            for (int i = 0; i < 500; ++i) {
+                auto input    = _Input({step, batch, inputSize}, NCHW);
+                auto inputPtr = input->writeMap<float>();
+                for (int j = 0; j < step * batch * inputSize; ++j) {
+                    inputPtr[j] = ((float)(gDevice() % 2000) - 1000.0f) / 1000.0f;
+                }
+                auto targetValue  = teacher->forward(input);
+                auto predictValue = student->forward(input);
+                auto loss         = _ReduceMean(_Square(_Subtract(targetValue, predictValue)), {});
+                lastLoss          = loss->readMap<float>()[0];
+                if (0 == i) {
+                    firstLoss = lastLoss;
+                }
+                if (i % 100 == 0) {
+                    MNN_PRINT("%s Loss = %f\n", lstm ? "LSTM" : "GRU", lastLoss);
+                }
+                sgd->step(loss);
+            }
+            if (!(lastLoss < firstLoss * 0.5f)) {
+                MNN_ERROR("Loss not converge: %f -> %f\n", firstLoss, lastLoss);
+                return 1;
+            }
+        }
+        return 0;
+    }
+};
+
+// Reset the peak rss and return it after the function, only supported by linux
+static float _peakRSSInMB(const std::function<void()>& function) {
+#if defined(__linux__)
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (nullptr != f) {
+        fputs("5", f);
+        fclose(f);
+    }
+#endif
+    function();
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (0 == line.compare(0, 6, "VmHWM:")) {
+            return ::atol(line.c_str() + 6) / 1024.0f;
+        }
+    }
+#endif
+    return -1.0f;
+}
+
+// Linear layers with relu, the activations of all layers are needed by the backward
+class DeepMLP : public Module {
+public:
+    DeepMLP(int width, int depth) {
+        for (int i = 0; i < depth; ++i) {
+            mLayers.emplace_back(NN::Linear(width, width));
+        }
+        registerModel(mLayers);
+    }
+    virtual std::vector<VARP> onForward(const std::vector<VARP>& inputs) override {
+        auto x = inputs[0];
+        for (auto& layer : mLayers) {
+            x = _Relu(layer->forward(x));
+        }
+        return {x};
+    }
+
+private:
+    std::vector<std::shared_ptr<Module>> mLayers;
+};
+
+class CheckpointGradTest : public DemoUnit {
+public:
+    // The memory of the CPU allocator, it only grows until gc, so it is the peak since the last gc
+    static float allocatorMemoryInMB() {
+        auto runtime = Executor::getRuntime();
+        float memory = 0.0f;
+        for (auto& iter : runtime.first) {
+            memory += iter.second->onGetMemoryInMB();
+        }
+        return memory;
+    }
+    // Compute the grads of all parameters from a new forward, return the peak memory of the allocator
+    static float computeGrad(std::shared_ptr<Module> model, const std::function<VARP()>& lossFunction, int segments,
+                             std::vector<std::vector<float>>& result) {
+        auto loss       = lossFunction();
+        auto parameters = model->parameters();
+        std::set<VARP> parameterSet(parameters.begin(), parameters.end());
+        std::map<VARP, VARP> grad;
+        if (segments > 0) {
+            grad = MNN::OpGrad::grad(loss, parameterSet, MNN::OpGrad::autoCheckpoints(loss, segments));
+        } else {
+            grad = MNN::OpGrad::grad(loss, parameterSet);
+        }
+        std::vector<VARP> gradVars;
+        for (auto& p : parameters) {
+            gradVars.emplace_back(grad[p]);
+        }
+        Variable::prepareCompute(gradVars);
+        result.clear();
+        for (auto& g : gradVars) {
+            auto ptr = g->readMap<float>();
+            result.emplace_back(ptr, ptr + g->getInfo()->size);
+        }
+        return allocatorMemoryInMB();
+    }
+    // The memory of the previous run is released before the peak rss is reset
+    static float measure(std::shared_ptr<Module> model, const std::function<VARP()>& lossFunction, int segments,
+                         std::vector<std::vector<float>>& result, const char* name) {
+        Executor::getGlobalExecutor()->gc(Executor::FULL);
+        float memory = 0.0f;
+        auto rss     = _peakRSSInMB([&]() { memory = computeGrad(model, lossFunction, segments, result); });
+        MNN_PRINT("%s, %d segments: allocator %f MB, peak rss %f MB\n", name, segments, memory, rss);
+        return memory;
+    }
+    static bool compare(const std::vector<std::vector<float>>& result, const std::vector<std::vector<float>>& expect) {
+        for (int i = 0; i < expect.size(); ++i) {
+            float maxValue = 0.0f;
+            for (auto v : expect[i]) {
+                maxValue = fmaxf(maxValue, fabsf(v));
+            }
+            for (int j = 0; j < expect[i].size(); ++j) {
+                if (fabsf(result[i][j] - expect[i][j]) > 1e-4f * maxValue + 1e-6f) {
+                    MNN_ERROR("Grad of parameter %d not match at %d: %f - %f\n", i, j, result[i][j], expect[i][j]);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    virtual int run(int argc, const char* argv[]) override {
+        MNN_PRINT("Test grad with activation checkpointing for Lenet\n");
+        std::vector<std::vector<float>> expect, result;
+        {
+            const int batch = 32, classes = 10;
+            std::shared_ptr<Model::Lenet> lenet(new Model::Lenet);
+            std::shared_ptr<Module> model = lenet;
+            model->setIsTraining(true);
+            // No dropout, so that the forwards are the same
+            lenet->dropout->setIsTraining(false);
+            auto input     = _Input({batch, 1, 28, 28}, NCHW);
+            auto target    = _Input({batch, classes}, NCHW);
+            auto inputPtr  = input->writeMap<float>();
+            auto targetPtr = target->writeMap<float>();
+            for (int i = 0; i < batch * 28 * 28; ++i) {
+                inputPtr[i] = (float)(gDevice() % 1000) / 1000.0f;
+            }
+            ::memset(targetPtr, 0, batch * classes * sizeof(float));
+            for (int i = 0; i < batch; ++i) {
+                targetPtr[i * classes + gDevice() % classes] = 1.0f;
+            }
+            auto lossFunction = [&]() { return _CrossEntropy(model->forward(_Convert(input, NC4HW4)), target); };
+            // The workspace of the first convolution is the largest buffer of lenet, so the memory is only reported
+            measure(model, lossFunction, 0, expect, "Lenet");
+            for (int segments : {2, 3}) {
+                measure(model, lossFunction, segments, result, "Lenet");
+                if (!compare(result, expect)) {
+                    return 1;
+                }
+            }
+        }
+        MNN_PRINT("Test peak memory with activation checkpointing for deep MLP\n");
+        {
+            const int width = 256, depth = 16, batch = 512;
+            std::shared_ptr<Module> model(new DeepMLP(width, depth));
+            auto input    = _Input({batch, width}, NCHW);
+            auto inputPtr = input->writeMap<float>();
+            for (int i = 0; i < batch * width; ++i) {
+                inputPtr[i] = (float)(gDevice() % 1000) / 1000.0f;
+            }
+            auto lossFunction = [&]() {
+                auto output = model->forward(input);
+                return _ReduceMean(output * output, {});
+            };
+            auto plainMemory = measure(model, lossFunction, 0, expect, "MLP");
+            for (int segments : {2, 4}) {
+                auto memory = measure(model, lossFunction, segments, result, "MLP");
+                if (!compare(result, expect)) {
+                    return 1;
+                }
+                if (!(memory < plainMemory)) {
+                    MNN_ERROR("Peak memory with %d segments is %f MB, not less than %f MB without checkpoint\n",
+                              segments, memory, plainMemory);
+                    return 1;
+                }
+            }
+        }
+        return 0;
+    }
+};
+
 DemoUnitSetRegister(NNGrad, "NNGrad");
 DemoUnitSetRegister(NNGradV2, "NNGradV2");
 DemoUnitSetRegister(NNGradV3, "NNGradV3");
 DemoUnitSetRegister(MatMulGradTest, "MatMulGradTest");
+DemoUnitSetRegister(GatherGradTest, "GatherGradTest");
+DemoUnitSetRegister(RecurrentGradTest, "RecurrentGradTest");
+DemoUnitSetRegister(CheckpointGradTest, "CheckpointGradTest");
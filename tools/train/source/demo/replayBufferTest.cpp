@@ -0,0 +1,96 @@
+//
+//  replayBufferTest.cpp
+//  MNN
+//
+//  Created by MNN on 2021/01/06.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <MNN/expr/ExprCreator.hpp>
+#include <cmath>
+#include <vector>
+#include "DemoUnit.hpp"
+#include "ReplayBuffer.hpp"
+
+using namespace MNN::Express;
+using namespace MNN::Train;
+
+class ReplayBufferTest : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        MNN_PRINT("Test ring storage and gather\n");
+        {
+            const int obsSize = 3;
+            ReplayBuffer buffer(10, obsSize);
+            for (int i = 0; i < 13; ++i) {
+                float obs[] = {(float)i, i + 0.5f, i + 0.25f};
+                buffer.add(obs, i, i * 0.1f, i % 5 == 4);
+            }
+            if (buffer.size() != 10) {
+                MNN_ERROR("Size %d is not the capacity\n", (int)buffer.size());
+                return 1;
+            }
+            // The latest four are 9, 10, 11, 12
+            auto batch       = buffer.gather(buffer.latest(4));
+            auto observation = batch.observation->readMap<float>();
+            auto action      = batch.action->readMap<int32_t>();
+            auto reward      = batch.reward->readMap<float>();
+            auto done        = batch.done->readMap<float>();
+            auto weight      = batch.weight->readMap<float>();
+            for (int i = 0; i < 4; ++i) {
+                int index = 9 + i;
+                if (observation[i * obsSize] != index || observation[i * obsSize + 1] != index + 0.5f ||
+                    observation[i * obsSize + 2] != index + 0.25f || action[i] != index ||
+                    fabsf(reward[i] - index * 0.1f) > 1e-6f || done[i] != (index % 5 == 4 ? 1.0f : 0.0f) ||
+                    weight[i] != 1.0f) {
+                    MNN_ERROR("Gather error for transition %d\n", index);
+                    return 1;
+                }
+            }
+        }
+        MNN_PRINT("Test prioritized sampling\n");
+        {
+            // More than one level of the sum tree
+            const int capacity = 37;
+            ReplayBuffer buffer(capacity, 1, 1.0f);
+            std::vector<size_t> slots;
+            std::vector<float> priorities;
+            float total = 0.0f;
+            for (int i = 0; i < capacity; ++i) {
+                float obs = (float)i;
+                slots.emplace_back(buffer.add(&obs, i, 0.0f, false));
+                priorities.emplace_back((float)(i + 1));
+                total += i + 1;
+            }
+            buffer.updatePriorities(slots, priorities.data());
+            const int batchSize = 64, iteration = 2000;
+            std::vector<int> count(capacity, 0);
+            for (int k = 0; k < iteration; ++k) {
+                for (auto slot : buffer.sample(batchSize)) {
+                    count[slot]++;
+                }
+            }
+            for (int i = 0; i < capacity; ++i) {
+                float expect = (float)batchSize * iteration * priorities[i] / total;
+                if (fabsf(count[i] - expect) > 5.0f * sqrtf(expect) + 1.0f) {
+                    MNN_ERROR("Slot %d is sampled %d times, expect %f\n", i, count[i], expect);
+                    return 1;
+                }
+            }
+            // Weights are (p / minP) ^ -beta in the batch
+            auto batch  = buffer.gather({0, 3, 36}, 1.0f);
+            auto weight = batch.weight->readMap<float>();
+            float expectWeight[] = {1.0f, 1.0f / 4.0f, 1.0f / 37.0f};
+            for (int i = 0; i < 3; ++i) {
+                if (fabsf(weight[i] - expectWeight[i]) > 1e-5f) {
+                    MNN_ERROR("Weight %d: %f - %f\n", i, weight[i], expectWeight[i]);
+                    return 1;
+                }
+            }
+        }
+        MNN_PRINT("ReplayBufferTest passed\n");
+        return 0;
+    }
+};
+
+DemoUnitSetRegister(ReplayBufferTest, "ReplayBufferTest");
@@ -0,0 +1,229 @@
+//
+//  trainBenchmark.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/15.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <MNN/AutoTime.hpp>
+#include <MNN/expr/Executor.hpp>
+#include <MNN/expr/ExprCreator.hpp>
+#include <algorithm>
+#include <random>
+#include <string>
+#include "A2C.hpp"
+#include "CartPole.hpp"
+#include "DemoUnit.hpp"
+#include "Lenet.hpp"
+#include "Loss.hpp"
+#include "MobilenetV1.hpp"
+#include "MobilenetV2.hpp"
+#include "SGD.hpp"
+#include "core/Backend.hpp"
+using namespace MNN;
+using namespace MNN::Express;
+using namespace MNN::Train;
+using namespace MNN::Train::Model;
+
+/**
+ Fixed-step training on synthetic data, the time of each step is split into:
+ data: prepare the batch (for A2C: the CartPole rollout of the A2C demo, include the policy inference)
+ forward: compute the loss
+ backward: compute the gradients, the forward result is reused
+ optimizer: compute and assign the next parameters
+ The first step is not counted because it includes resize and memory allocation.
+ The peak memory is the max of the memory sampled after each phase, include the first step.
+ */
+struct TrainCost {
+    double data      = 0.0;
+    double forward   = 0.0;
+    double backward  = 0.0;
+    double optimizer = 0.0;
+    int64_t samples  = 0;
+    float peakMemory = 0.0f;
+};
+
+static float _currentMemoryInMB() {
+    auto runtime = Executor::getRuntime();
+    float memory = 0.0f;
+    for (auto& iter : runtime.first) {
+        memory += iter.second->onGetMemoryInMB();
+    }
+    if (nullptr != runtime.second) {
+        memory += runtime.second->onGetMemoryInMB();
+    }
+    return memory;
+}
+
+static void _report(const char* name, int batch, int steps, const TrainCost& cost) {
+    auto total = cost.data + cost.forward + cost.backward + cost.optimizer;
+    auto perStep = [steps](double us) {
+        return steps > 0 ? us / 1000.0 / steps : 0.0;
+    };
+    MNN_PRINT("{\"model\": \"%s\", \"batch\": %d, \"steps\": %d, \"samples_per_sec\": %.3f, \"step_ms\": {\"data\": %.3f, "
+              "\"forward\": %.3f, \"backward\": %.3f, \"optimizer\": %.3f, \"total\": %.3f}, \"peak_memory_mb\": %.3f}\n",
+              name, batch, steps, total > 0.0 ? cost.samples * 1000000.0 / total : 0.0, perStep(cost.data),
+              perStep(cost.forward), perStep(cost.backward), perStep(cost.optimizer), perStep(total),
+              cost.peakMemory);
+}
+
+static TrainCost _benchClassifier(std::shared_ptr<Module> model, int channel, int size, int classes, int batch,
+                                  int steps) {
+    auto exe = Executor::getGlobalExecutor();
+    exe->gc(Executor::FULL);
+    std::shared_ptr<SGD> sgd(new SGD(model));
+    sgd->setMomentum(0.9f);
+    sgd->setLearningRate(0.01f);
+    sgd->setWeightDecay(0.0001f);
+    model->setIsTraining(true);
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    TrainCost cost;
+    Timer timer;
+    for (int step = 0; step <= steps; ++step) {
+        timer.reset();
+        auto input  = _Input({batch, channel, size, size}, NCHW);
+        auto target = _Input({batch, classes}, NCHW);
+        auto inputPtr  = input->writeMap<float>();
+        auto targetPtr = target->writeMap<float>();
+        for (int i = 0; i < batch * channel * size * size; ++i) {
+            inputPtr[i] = dis(gen);
+        }
+        ::memset(targetPtr, 0, batch * classes * sizeof(float));
+        for (int i = 0; i < batch; ++i) {
+            targetPtr[i * classes + gen() % classes] = 1.0f;
+        }
+        auto dataTime = timer.durationInUs();
+
+        timer.reset();
+        auto predict = model->forward(_Convert(input, NC4HW4));
+        auto loss    = _CrossEntropy(predict, target);
+        loss->readMap<float>();
+        auto forwardTime = timer.durationInUs();
+        cost.peakMemory  = std::max(cost.peakMemory, _currentMemoryInMB());
+
+        timer.reset();
+        auto grad         = sgd->computeGradients(loss);
+        auto backwardTime = timer.durationInUs();
+        cost.peakMemory   = std::max(cost.peakMemory, _currentMemoryInMB());
+
+        timer.reset();
+        sgd->stepGradients(grad);
+        auto optimizerTime = timer.durationInUs();
+        cost.peakMemory    = std::max(cost.peakMemory, _currentMemoryInMB());
+        if (0 == step) {
+            continue;
+        }
+        cost.data += dataTime;
+        cost.forward += forwardTime;
+        cost.backward += backwardTime;
+        cost.optimizer += optimizerTime;
+        cost.samples += batch;
+    }
+    return cost;
+}
+
+// Trains the A2C demo on CartPole, the rollout and the losses are the ones of A2C
+static TrainCost _benchA2C(int maxLength, int steps, int thread) {
+    auto exe = Executor::getGlobalExecutor();
+    exe->gc(Executor::FULL);
+    const int stateDim = 4, actionDim = 2;
+    std::shared_ptr<A2C> a2c(new A2C(stateDim, actionDim, 1e-4));
+    // A2C sets its own executor config, use the one of the benchmark
+    BackendConfig config;
+    exe->setGlobalExecutorConfig(MNN_FORWARD_CPU, config, thread);
+    CartPole env;
+    ReplayBuffer buffer(maxLength, stateDim);
+    std::mt19937 gen(0);
+    std::vector<float> obs;
+    TrainCost cost;
+    Timer timer;
+    for (int step = 0; step <= steps; ++step) {
+        timer.reset();
+        float cum     = 0.0f;
+        auto length   = a2c->Rollout(env, buffer, maxLength, obs, cum, gen);
+        auto batch    = buffer.gather(buffer.latest(length));
+        auto dataTime = timer.durationInUs();
+
+        timer.reset();
+        auto loss = a2c->Loss(batch, obs);
+        loss.first->readMap<float>();
+        loss.second->readMap<float>();
+        auto forwardTime = timer.durationInUs();
+        cost.peakMemory  = std::max(cost.peakMemory, _currentMemoryInMB());
+
+        timer.reset();
+        auto policyGrad   = a2c->PolicyOptimizer()->computeGradients(loss.first);
+        auto valGrad      = a2c->ValOptimizer()->computeGradients(loss.second);
+        auto backwardTime = timer.durationInUs();
+        cost.peakMemory   = std::max(cost.peakMemory, _currentMemoryInMB());
+
+        timer.reset();
+        a2c->PolicyOptimizer()->stepGradients(policyGrad);
+        a2c->ValOptimizer()->stepGradients(valGrad);
+        auto optimizerTime = timer.durationInUs();
+        cost.peakMemory    = std::max(cost.peakMemory, _currentMemoryInMB());
+        if (0 == step) {
+            continue;
+        }
+        cost.data += dataTime;
+        cost.forward += forwardTime;
+        cost.backward += backwardTime;
+        cost.optimizer += optimizerTime;
+        cost.samples += length;
+    }
+    return cost;
+}
+
+class TrainBenchmark : public DemoUnit {
+public:
+    virtual int run(int argc, const char* argv[]) override {
+        // Without a model name all of them are run
+        MNN_PRINT("usage: ./runTrainDemo.out TrainBenchmark [lenet|mobilenetv1|mobilenetv2|a2c|all] [steps=20] "
+                  "[batch=16] [thread=4] [imageSize=224]\n");
+        std::string name = "all";
+        int steps = 20, batch = 16, thread = 4, imageSize = 224;
+        if (argc >= 2) {
+            name = argv[1];
+        }
+        if (argc >= 3) {
+            steps = ::atoi(argv[2]);
+        }
+        if (argc >= 4) {
+            batch = ::atoi(argv[3]);
+        }
+        if (argc >= 5) {
+            thread = ::atoi(argv[4]);
+        }
+        if (argc >= 6) {
+            imageSize = ::atoi(argv[5]);
+        }
+        auto exe = Executor::getGlobalExecutor();
+        BackendConfig config;
+        exe->setGlobalExecutorConfig(MNN_FORWARD_CPU, config, thread);
+        if (name == "lenet" || name == "all") {
+            std::shared_ptr<Module> model(new Lenet);
+            _report("lenet", batch, steps, _benchClassifier(model, 1, 28, 10, batch, steps));
+        }
+        if (name == "mobilenetv1" || name == "all") {
+            std::shared_ptr<Module> model(new MobilenetV1);
+            _report("mobilenetv1", batch, steps, _benchClassifier(model, 3, imageSize, 1001, batch, steps));
+        }
+        if (name == "mobilenetv2" || name == "all") {
+            std::shared_ptr<Module> model(new MobilenetV2);
+            _report("mobilenetv2", batch, steps, _benchClassifier(model, 3, imageSize, 1001, batch, steps));
+        }
+        if (name == "a2c" || name == "all") {
+            // The batch of A2C is a rollout of at most 500 steps, samples are the real rollout length
+            _report("a2c_cartpole", 500, steps, _benchA2C(500, steps, thread));
+        }
+        return 0;
+    }
+};
+
+DemoUnitSetRegister(TrainBenchmark, "TrainBenchmark");
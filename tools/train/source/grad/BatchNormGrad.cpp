@@ -0,0 +1,44 @@
+//
+//  BatchNormGrad.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/10.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "BatchNormGrad.hpp"
+#include "core/Macro.h"
+#include <MNN/expr/ExprCreator.hpp>
+using namespace std;
+using namespace MNN;
+using namespace MNN::Express;
+
+class BatchNormTrainGrad : public OpGrad {
+public:
+    BatchNormTrainGrad() {
+        mType = NO_LINEAR;
+    }
+    virtual std::vector<Express::VARP> onGrad(Express::EXPRP expr,
+                                              const std::vector<Express::VARP>& backwardOutput) override {
+        MNN_ASSERT(expr->inputs().size() == 5 && expr->outputSize() == 5);
+        auto outputGrad = backwardOutput[0];
+        if (nullptr == outputGrad) {
+            return {};
+        }
+        if (outputGrad->getInfo()->order != NC4HW4) {
+            outputGrad = _Convert(outputGrad, NC4HW4);
+        }
+        auto inputs = expr->inputs();
+        // Use the batch mean and inv std saved by forward
+        std::unique_ptr<OpT> gradOp(new OpT);
+        gradOp->type = OpType_BatchNormTrainGrad;
+        auto gradExpr = Expr::create(gradOp.get(), {inputs[0], outputGrad, inputs[1], Variable::create(expr, 1), Variable::create(expr, 2)}, 3);
+        return {Variable::create(gradExpr, 0), Variable::create(gradExpr, 1), Variable::create(gradExpr, 2)};
+    }
+};
+
+static const auto gRegister = []() {
+    static BatchNormTrainGrad _c;
+    OpGrad::insert(OpType_BatchNormTrain, &_c);
+    return true;
+}();
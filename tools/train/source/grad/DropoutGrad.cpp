@@ -0,0 +1,38 @@
+//
+//  DropoutGrad.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/09.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "OpGrad.hpp"
+#include "core/Macro.h"
+using namespace std;
+using namespace MNN;
+using namespace MNN::Express;
+
+class DropoutGrad : public OpGrad {
+public:
+    virtual std::vector<Express::VARP> onGrad(Express::EXPRP expr,
+                                              const std::vector<Express::VARP>& backwardOutput) override {
+        MNN_ASSERT(expr->outputSize() == 2);
+        if (nullptr == backwardOutput[0]) {
+            return {};
+        }
+        // Reuse the bit-packed mask from forward instead of the random seed
+        std::unique_ptr<OpT> gradOp(new OpT);
+        gradOp->type       = OpType_DropoutGrad;
+        gradOp->main.type  = OpParameter_DropoutParam;
+        gradOp->main.value = new DropoutParamT;
+        gradOp->main.AsDropoutParam()->ratio = expr->get()->main_as_DropoutParam()->ratio();
+        auto mask = Variable::create(expr, 1);
+        return {Variable::create(Expr::create(gradOp.get(), {backwardOutput[0], mask}))};
+    }
+};
+
+static const auto gRegister = []() {
+    static DropoutGrad _c;
+    OpGrad::insert(OpType_Dropout, &_c);
+    return true;
+}();
@@ -0,0 +1,92 @@
+//
+//  GatherGrad.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/30.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "OpGrad.hpp"
+#include "core/Macro.h"
+using namespace std;
+using namespace MNN;
+using namespace MNN::Express;
+
+/**
+ The grad of params is ScatterNd(indices, rows of output diff, shape of params). The indices and rows are kept as the
+ inputs of ScatterNd, so that an optimizer can update the touched rows only instead of the dense grad, see SGD.
+ */
+class GatherGrad : public OpGrad {
+public:
+    virtual std::vector<Express::VARP> onGrad(Express::EXPRP expr,
+                                              const std::vector<Express::VARP>& backwardOutput) override {
+        auto inputs = expr->inputs();
+        std::vector<VARP> res(inputs.size(), nullptr);
+        auto params     = inputs[0];
+        auto indices    = inputs[1];
+        auto paramsInfo = params->getInfo();
+        auto indexInfo  = indices->getInfo();
+        if (nullptr == backwardOutput[0] || nullptr == paramsInfo || nullptr == indexInfo) {
+            return res;
+        }
+        if (paramsInfo->order == NC4HW4) {
+            MNN_ERROR("Gather grad don't support NC4HW4 params\n");
+            return res;
+        }
+        auto op    = expr->get();
+        auto shape = _Const(paramsInfo->dim.data(), {(int)paramsInfo->dim.size()}, NCHW, halide_type_of<int>());
+        if (op->type() == OpType_GatherND) {
+            const int indexDim = indexInfo->dim.empty() ? 1 : indexInfo->dim[indexInfo->dim.size() - 1];
+            std::vector<int> updateShape{indexInfo->size / indexDim};
+            for (int i = indexDim; i < paramsInfo->dim.size(); ++i) {
+                updateShape.emplace_back(paramsInfo->dim[i]);
+            }
+            res[0] = _ScatterNd(_Reshape(indices, {-1, indexDim}), _Reshape(backwardOutput[0], updateShape), shape);
+            return res;
+        }
+        int axis = 0;
+        if (inputs.size() == 3) {
+            auto axisPtr = inputs[2]->readMap<int>();
+            if (nullptr == axisPtr) {
+                return res;
+            }
+            axis = axisPtr[0];
+        }
+        if (op->main_type() == OpParameter_Axis) {
+            axis = op->main_as_Axis()->axis();
+        }
+        const int dimensions = (int)paramsInfo->dim.size();
+        if (axis < 0) {
+            axis = dimensions + axis;
+        }
+        if (0 == axis) {
+            std::vector<int> updateShape = paramsInfo->dim;
+            updateShape[0]               = indexInfo->size;
+            res[0] = _ScatterNd(_Reshape(indices, {-1, 1}), _Reshape(backwardOutput[0], updateShape), shape);
+            return res;
+        }
+        // Move the gathered axis to front, scatter the rows and move it back
+        int outside = 1, inside = 1;
+        for (int i = 0; i < axis; ++i) {
+            outside *= paramsInfo->dim[i];
+        }
+        for (int i = axis + 1; i < dimensions; ++i) {
+            inside *= paramsInfo->dim[i];
+        }
+        const int limit = paramsInfo->dim[axis];
+        auto diff       = _Transpose(_Reshape(backwardOutput[0], {outside, indexInfo->size, inside}), {1, 0, 2});
+        std::vector<int> scatterShapeData{limit, outside, inside};
+        auto scatterShape = _Const(scatterShapeData.data(), {3}, NCHW, halide_type_of<int>());
+        auto scatter      = _ScatterNd(_Reshape(indices, {-1, 1}), diff, scatterShape);
+        res[0]            = _Reshape(_Transpose(scatter, {1, 0, 2}), paramsInfo->dim);
+        return res;
+    }
+};
+
+static const auto gRegister = []() {
+    static GatherGrad _c;
+    OpGrad::insert(OpType_GatherV2, &_c);
+    OpGrad::insert(OpType_Gather, &_c);
+    OpGrad::insert(OpType_GatherND, &_c);
+    return true;
+}();
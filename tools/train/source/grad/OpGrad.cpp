@@ -7,6 +7,7 @@
 //
 
 #include "OpGrad.hpp"
+#include <cmath>
 using namespace std;
 using namespace MNN::Express;
 namespace MNN {
@@ -53,6 +54,10 @@ std::vector<Express::VARP> OpGrad::gradLinear(Express::VARP loss, const std::vec
 }
 
 std::map<Express::VARP, Express::VARP> OpGrad::grad(VARP loss, const std::set<Express::VARP>& parameters, const std::string& blockName) {
+    return grad(loss, parameters, {}, blockName);
+}
+
+std::map<Express::VARP, Express::VARP> OpGrad::grad(VARP loss, const std::set<Express::VARP>& parameters, const std::vector<Express::VARP>& checkpoints, const std::string& blockName) {
     std::map<EXPRP, std::vector<VARP>> backwardMap;
     {
         auto shape = loss->getInfo();
@@ -60,13 +65,111 @@ std::map<Express::VARP, Express::VARP> OpGrad::grad(VARP loss, const std::set<Ex
         auto init                       = _Const(1.0f, shape->dim, shape->order);
         backwardMap[loss->expr().first] = std::vector<VARP>{init};
     }
-    return gradCommon(loss, parameters, backwardMap, blockName);
+    return gradCommon(loss, parameters, backwardMap, blockName, checkpoints);
+}
+
+std::vector<Express::VARP> OpGrad::autoCheckpoints(Express::VARP loss, int segmentNumber) {
+    auto executeOrder = Variable::getExecuteOrder({loss});
+    std::vector<std::pair<EXPRP, int>> candidates;
+    size_t totalSize = 0;
+    for (auto expr : executeOrder) {
+        if (nullptr == expr->get() || expr == loss->expr().first || expr->outputSize() != 1) {
+            continue;
+        }
+        auto info = expr->outputInfo(0);
+        if (expr->requireInfo() == false || info->size <= 0) {
+            continue;
+        }
+        candidates.emplace_back(std::make_pair(expr, info->size));
+        totalSize += info->size;
+    }
+    if (segmentNumber <= 0) {
+        segmentNumber = (int)::sqrtf((float)candidates.size());
+    }
+    std::vector<VARP> checkpoints;
+    if (segmentNumber <= 1 || candidates.empty()) {
+        return checkpoints;
+    }
+    auto segmentSize = totalSize / segmentNumber;
+    size_t currentSize = 0;
+    for (auto& iter : candidates) {
+        currentSize += iter.second;
+        if (currentSize >= segmentSize) {
+            checkpoints.emplace_back(Variable::create(iter.first, 0));
+            currentSize = 0;
+        }
+    }
+    return checkpoints;
+}
+
+// Compute the grads still needed by the backward of the exprs before a checkpoint and keep them as const, so that the
+// cache of the segment, include the recomputed activations, is released. The grads of the finished exprs and of the
+// inputs which are not parameters are not needed any more.
+static bool _computeSegmentGrad(std::map<EXPRP, std::vector<VARP>>& backwardMap, const std::set<Expr*>& finished,
+                                const std::map<Expr*, VARP>& parametersExpr) {
+    std::vector<VARP*> pending;
+    for (auto iter = backwardMap.begin(); iter != backwardMap.end();) {
+        auto expr     = iter->first.get();
+        auto needless = nullptr == expr->get() ? parametersExpr.find(expr) == parametersExpr.end()
+                                               : finished.find(expr) != finished.end();
+        if (needless) {
+            iter = backwardMap.erase(iter);
+            continue;
+        }
+        for (auto& var : iter->second) {
+            if (nullptr != var && nullptr != var->expr().first->get()) {
+                pending.emplace_back(&var);
+            }
+        }
+        iter++;
+    }
+    std::vector<VARP> prepareCompute;
+    for (auto var : pending) {
+        prepareCompute.emplace_back(*var);
+    }
+    Variable::prepareCompute(prepareCompute);
+    prepareCompute.clear();
+    for (auto var : pending) {
+        auto info = (*var)->getInfo();
+        auto ptr  = (*var)->readMap<void>();
+        if (nullptr == info || nullptr == ptr) {
+            MNN_ERROR("Compute grad of segment error\n");
+            return false;
+        }
+        *var = _Const(ptr, info->dim, info->order, info->type);
+    }
+    return true;
 }
-std::map<Express::VARP, Express::VARP> OpGrad::gradCommon(Express::VARP loss, const std::set<Express::VARP>& parameters, std::map<EXPRP, std::vector<VARP>>& backwardMap, const std::string& blockName) {
+
+std::map<Express::VARP, Express::VARP> OpGrad::gradCommon(Express::VARP loss, const std::set<Express::VARP>& parameters, std::map<EXPRP, std::vector<VARP>>& backwardMap, const std::string& blockName, const std::vector<Express::VARP>& checkpoints) {
     auto executeOrder = Variable::getExecuteOrder({loss});
+    std::map<Expr*, VARP> parametersExpr;
+    for (auto p : parameters) {
+        parametersExpr.insert(std::make_pair(p->expr().first.get(), p));
+    }
+    // Only the checkpoints are computed and kept, the executor recomputes the other activations of a segment from
+    // them in the cache of the segment's grads
+    std::set<Expr*> checkpointExprs;
+    std::set<Expr*> finished;
+    if (!checkpoints.empty()) {
+        Variable::prepareCompute(checkpoints);
+        for (auto c : checkpoints) {
+            if (nullptr == c->readMap<void>()) {
+                MNN_ERROR("Compute checkpoint error\n");
+                return {};
+            }
+            checkpointExprs.insert(c->expr().first.get());
+        }
+    }
     for (auto iter = executeOrder.rbegin(); iter != executeOrder.rend(); iter++) {
         auto expr    = *iter;
         auto& inputs = expr->inputs();
+        if (checkpointExprs.find(expr.get()) != checkpointExprs.end()) {
+            if (!_computeSegmentGrad(backwardMap, finished, parametersExpr)) {
+                return {};
+            }
+        }
+        finished.insert(expr.get());
         if (backwardMap.find(expr) == backwardMap.end()) {
             continue;
         }
@@ -127,10 +230,6 @@ std::map<Express::VARP, Express::VARP> OpGrad::gradCommon(Express::VARP loss, co
         }
     }
     std::map<Express::VARP, Express::VARP> grads;
-    std::map<Expr*, VARP> parametersExpr;
-    for (auto p : parameters) {
-        parametersExpr.insert(std::make_pair(p->expr().first.get(), p));
-    }
     for (auto iter : backwardMap) {
         auto expr = iter.first.get();
         if (parametersExpr.find(expr) != parametersExpr.end()) {
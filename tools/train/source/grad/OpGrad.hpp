@@ -33,9 +33,18 @@ public:
     static OpGrad* get(int type);
     static void insert(int type, OpGrad* creator);
     static std::vector<Express::VARP> gradLinear(Express::VARP loss, const std::vector<Express::VARP>& parameters, const std::vector<Express::VARP>& outputDiff, const std::string& blockExpr = "");
-    static std::map<Express::VARP, Express::VARP> gradCommon(Express::VARP loss, const std::set<Express::VARP>& parameters, std::map<Express::EXPRP, std::vector<Express::VARP>>& backwardMap, const std::string& blockExpr = "");
+    static std::map<Express::VARP, Express::VARP> gradCommon(Express::VARP loss, const std::set<Express::VARP>& parameters, std::map<Express::EXPRP, std::vector<Express::VARP>>& backwardMap, const std::string& blockExpr = "", const std::vector<Express::VARP>& checkpoints = {});
     static std::map<Express::VARP, Express::VARP> grad(Express::VARP loss, const std::set<Express::VARP>& parameters, const std::string& blockExpr = "");
 
+    /**
+     Activation checkpointing: the checkpoints are computed and kept, the backward is computed segment by segment from
+     the last one. At each checkpoint the grads still needed are computed and stored as const, so the activations
+     recomputed for a segment are released before the next one. The grads of the first segment are returned uncomputed.
+     */
+    static std::map<Express::VARP, Express::VARP> grad(Express::VARP loss, const std::set<Express::VARP>& parameters, const std::vector<Express::VARP>& checkpoints, const std::string& blockExpr = "");
+    // Split the forward of loss into segmentNumber segments with nearly the same activation memory, return the boundaries. Use sqrt(n) segments if segmentNumber <= 0
+    static std::vector<Express::VARP> autoCheckpoints(Express::VARP loss, int segmentNumber = 0);
+
 protected:
     Type mType = LINEAR;
 };
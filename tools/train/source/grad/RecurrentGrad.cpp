@@ -0,0 +1,65 @@
+//
+//  RecurrentGrad.cpp
+//  MNN
+//
+//  Created by MNN on 2021/01/04.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "OpGrad.hpp"
+#include "core/Macro.h"
+using namespace std;
+using namespace MNN;
+using namespace MNN::Express;
+
+/**
+ The grad op runs backward through time with the outputs and the gates saved by forward. The grad of the cell output
+ of LSTM is zero if it is not used.
+ */
+class RecurrentSequenceGrad : public OpGrad {
+public:
+    RecurrentSequenceGrad() {
+        mType = NO_LINEAR;
+    }
+    virtual std::vector<Express::VARP> onGrad(Express::EXPRP expr,
+                                              const std::vector<Express::VARP>& backwardOutput) override {
+        auto inputs     = expr->inputs();
+        const bool lstm = expr->get()->type() == OpType_LSTMSequence;
+        MNN_ASSERT(inputs.size() == (lstm ? 6 : 5) && expr->outputSize() == (lstm ? 3 : 2));
+        std::vector<VARP> res(inputs.size(), nullptr);
+        auto yGrad    = backwardOutput[0];
+        auto cellGrad = lstm ? backwardOutput[1] : nullptr;
+        if (nullptr == yGrad && nullptr == cellGrad) {
+            return res;
+        }
+        // y (, cell), reserve
+        std::vector<VARP> gradInputs = inputs;
+        for (int i = 0; i < expr->outputSize(); ++i) {
+            gradInputs.emplace_back(Variable::create(expr, i));
+        }
+        if (nullptr == yGrad) {
+            yGrad = _ZerosLike(gradInputs[inputs.size()]);
+        }
+        gradInputs.emplace_back(yGrad);
+        if (lstm) {
+            if (nullptr == cellGrad) {
+                cellGrad = _ZerosLike(gradInputs[inputs.size() + 1]);
+            }
+            gradInputs.emplace_back(cellGrad);
+        }
+        std::unique_ptr<OpT> gradOp(new OpT);
+        gradOp->type  = lstm ? OpType_LSTMSequenceGrad : OpType_GRUSequenceGrad;
+        auto gradExpr = Expr::create(gradOp.get(), gradInputs, (int)inputs.size());
+        for (int i = 0; i < inputs.size(); ++i) {
+            res[i] = Variable::create(gradExpr, i);
+        }
+        return res;
+    }
+};
+
+static const auto gRegister = []() {
+    static RecurrentSequenceGrad _c;
+    OpGrad::insert(OpType_GRUSequence, &_c);
+    OpGrad::insert(OpType_LSTMSequence, &_c);
+    return true;
+}();
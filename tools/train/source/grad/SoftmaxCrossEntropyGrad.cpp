@@ -0,0 +1,71 @@
+//
+//  SoftmaxCrossEntropyGrad.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/07.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "OpGrad.hpp"
+#include "core/Macro.h"
+#include <MNN/expr/ExprCreator.hpp>
+using namespace std;
+using namespace MNN;
+using namespace MNN::Express;
+
+class SoftmaxCrossEntropyGrad : public OpGrad {
+public:
+    SoftmaxCrossEntropyGrad() {
+        mType = NO_LINEAR;
+    }
+    virtual std::vector<Express::VARP> onGrad(Express::EXPRP expr,
+                                              const std::vector<Express::VARP>& backwardOutput) override {
+        MNN_ASSERT(expr->inputs().size() == 2 && backwardOutput.size() == 1);
+        auto inputs = expr->inputs();
+        // The softmax is recomputed inside the grad op so the forward needn't keep it
+        std::unique_ptr<OpT> gradOp(new OpT);
+        gradOp->type = OpType_SoftmaxCrossEntropyGrad;
+        auto logitsGrad = Variable::create(Expr::create(gradOp.get(), {inputs[0], inputs[1], backwardOutput[0]}));
+        return {logitsGrad, nullptr};
+    }
+};
+
+class LogSoftmaxGrad : public OpGrad {
+public:
+    LogSoftmaxGrad() {
+        mType = NO_LINEAR;
+    }
+    virtual std::vector<Express::VARP> onGrad(Express::EXPRP expr,
+                                              const std::vector<Express::VARP>& backwardOutput) override {
+        MNN_ASSERT(expr->inputs().size() == 1 && backwardOutput.size() == 1);
+        auto info = expr->inputs()[0]->getInfo();
+        if (nullptr == info) {
+            return {};
+        }
+        auto axis = expr->get()->main_as_Axis()->axis();
+        if (axis < 0) {
+            axis = axis + info->dim.size();
+        }
+        auto gradOutput = backwardOutput[0];
+        auto output     = Variable::create(expr, 0);
+        auto originOrder = info->order;
+        if (originOrder == NC4HW4) {
+            gradOutput = _Convert(gradOutput, NCHW);
+            output     = _Convert(output, NCHW);
+        }
+        // d(x - log(sum(exp(x)))) = g - softmax * sum(g)
+        auto inputGrad = gradOutput - _Exp(output) * _ReduceSum(gradOutput, {axis}, true);
+        if (originOrder == NC4HW4) {
+            inputGrad = _Convert(inputGrad, NC4HW4);
+        }
+        return {inputGrad};
+    }
+};
+
+static const auto gRegister = []() {
+    static SoftmaxCrossEntropyGrad _c;
+    OpGrad::insert(OpType_SoftmaxCrossEntropy, &_c);
+    static LogSoftmaxGrad _d;
+    OpGrad::insert(OpType_LogSoftmax, &_d);
+    return true;
+}();
@@ -29,6 +29,27 @@ Lenet::Lenet() {
     registerModel({conv1, conv2, ip1, ip2, dropout});
 }
 
+Lenet::Lenet(const std::vector<std::shared_ptr<Express::Module>>& layers) {
+    conv1   = layers[0];
+    conv2   = layers[1];
+    ip1     = layers[2];
+    ip2     = layers[3];
+    dropout = layers[4];
+    registerModel({conv1, conv2, ip1, ip2, dropout});
+}
+
+Express::Module* Lenet::clone(CloneContext* ctx) const {
+    std::vector<std::shared_ptr<Express::Module>> layers;
+    for (auto layer : {conv1, conv2, ip1, ip2, dropout}) {
+        std::shared_ptr<Express::Module> replica(layer->clone(ctx));
+        if (nullptr == replica) {
+            return nullptr;
+        }
+        layers.emplace_back(replica);
+    }
+    return this->cloneBaseTo(ctx, new Lenet(layers));
+}
+
 std::vector<Express::VARP> Lenet::onForward(const std::vector<Express::VARP>& inputs) {
     using namespace Express;
     VARP x = inputs[0];
@@ -21,11 +21,17 @@ public:
 
     virtual std::vector<Express::VARP> onForward(const std::vector<Express::VARP>& inputs) override;
 
+    virtual Express::Module* clone(CloneContext* ctx) const override;
+
     std::shared_ptr<Express::Module> conv1;
     std::shared_ptr<Express::Module> conv2;
     std::shared_ptr<Express::Module> ip1;
     std::shared_ptr<Express::Module> ip2;
     std::shared_ptr<Express::Module> dropout;
+
+private:
+    // For clone, the layers are given
+    Lenet(const std::vector<std::shared_ptr<Express::Module>>& layers);
 };
 
 } // namespace Model
@@ -8,6 +8,7 @@
 
 #include "ADAM.hpp"
 #include "OpGrad.hpp"
+#include <cmath>
 
 using namespace MNN::Express;
 
@@ -59,5 +60,72 @@ Express::VARP ADAM::onComputeUpdateValue(Express::VARP param, Express::VARP grad
     return updateValue;
 }
 
+void ADAM::onSparseUpdate(Express::VARP param, SparseGrad& grad) {
+    auto paramPtr = param->writeMap<float>();
+    regularizeSparse(paramPtr, grad);
+    auto& history  = mHistory[param];
+    auto& history2 = mHistory2[param];
+    if (nullptr != history->expr().first->get()) {
+        history.fix(Express::VARP::CONSTANT);
+    }
+    if (nullptr != history2->expr().first->get()) {
+        history2.fix(Express::VARP::CONSTANT);
+    }
+    auto mPtr         = history->writeMap<float>();
+    auto vPtr         = history2->writeMap<float>();
+    const float step  = (float)currentStep();
+    const float beta1 = mMomentum;
+    const float beta2 = mMomentum2;
+    const float lr    = mLearningRate * ::sqrtf(1.0f - ::powf(beta2, step)) / (1.0f - ::powf(beta1, step));
+    const int sliceSize = grad.sliceSize;
+    for (int i = 0; i < grad.offsets.size(); ++i) {
+        auto p = paramPtr + grad.offsets[i];
+        auto m = mPtr + grad.offsets[i];
+        auto v = vPtr + grad.offsets[i];
+        auto g = grad.values.data() + i * sliceSize;
+        for (int k = 0; k < sliceSize; ++k) {
+            m[k] = beta1 * m[k] + (1.0f - beta1) * g[k];
+            v[k] = beta2 * v[k] + (1.0f - beta2) * g[k] * g[k];
+            p[k] -= lr * m[k] / (::sqrtf(v[k]) + mEps);
+        }
+    }
+}
+
+Express::VARP ADAM::onBuildUpdate(Express::VARP parameter, Express::VARP grad,
+                                  std::vector<std::pair<Express::VARP, Express::VARP>>& states) {
+    auto iter  = mHistory.find(parameter);
+    auto iter2 = mHistory2.find(parameter);
+    if (iter == mHistory.end() || iter2 == mHistory2.end()) {
+        return nullptr;
+    }
+    auto history  = iter->second;
+    auto history2 = iter2->second;
+    if (nullptr != history->expr().first->get()) {
+        history.fix(Express::VARP::CONSTANT);
+    }
+    if (nullptr != history2->expr().first->get()) {
+        history2.fix(Express::VARP::CONSTANT);
+    }
+    auto beta1 = _Const(mMomentum, {}, NCHW);
+    auto beta2 = _Const(mMomentum2, {}, NCHW);
+    auto eps   = _Const(mEps, {}, NCHW);
+    auto addWeightDecayGrad = regularizeParameters(parameter, grad);
+
+    auto nextHistory  = beta1 * history + (_Const(1.0f, {}, NCHW) - beta1) * addWeightDecayGrad;
+    auto nextHistory2 = beta2 * history2 + (_Const(1.0f, {}, NCHW) - beta2) * _Square(addWeightDecayGrad);
+    states.emplace_back(std::make_pair(history, nextHistory));
+    states.emplace_back(std::make_pair(history2, nextHistory2));
+
+    // The bias correction depends on step, it's folded into the learning rate input by onPrepareStep
+    auto updateValue = _staticLearningRate() * (nextHistory / (_Sqrt(nextHistory2) + eps));
+    return parameter - updateValue;
+}
+
+void ADAM::onPrepareStep() {
+    float step       = (float)currentStep();
+    float correction = ::sqrtf(1.0f - ::powf(mMomentum2, step)) / (1.0f - ::powf(mMomentum, step));
+    _staticLearningRate()->writeMap<float>()[0] = mLearningRate * correction;
+}
+
 } // namespace Train
 } // namespace MNN
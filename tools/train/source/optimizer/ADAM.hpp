@@ -25,6 +25,14 @@ public:
 
     virtual Express::VARP onComputeUpdateValue(Express::VARP param, Express::VARP grad) override;
 
+    virtual Express::VARP onBuildUpdate(Express::VARP parameter, Express::VARP grad,
+                                        std::vector<std::pair<Express::VARP, Express::VARP>>& states) override;
+
+    virtual void onPrepareStep() override;
+
+    // Lazy Adam: only the moments of touched slices are updated, the bias correction uses the global step
+    virtual void onSparseUpdate(Express::VARP param, SparseGrad& grad) override;
+
     float getMomentum2();
 
     void setMomentum2(float momentum2);
@@ -0,0 +1,581 @@
+//
+//  Checkpoint.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/08.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "Checkpoint.hpp"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <MNN/expr/ExprCreator.hpp>
+#include "core/MNNMemoryUtils.h"
+#include "core/Macro.h"
+#if defined(_MSC_VER)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace MNN::Express;
+
+namespace MNN {
+namespace Train {
+
+static const uint32_t gCheckpointMagic   = 0x4B434E4D; // "MNCK"
+static const uint32_t gCheckpointVersion = 1;
+static const size_t gCheckpointAlign     = 64;
+static const int gMaxDeltaDepth          = 64;
+
+// Data is stored in host byte order
+struct CheckpointHeader {
+    uint32_t magic;
+    uint32_t version;
+    // Variable number of the whole checkpoint and entry number in this file
+    uint32_t number;
+    uint32_t entryNumber;
+    uint64_t indexOffset;
+    uint64_t indexSize;
+};
+
+struct Checkpoint::Entry {
+    uint32_t index;
+    int32_t inputType;
+    halide_type_t type;
+    int32_t order;
+    std::vector<int> dim;
+    std::string name;
+    uint64_t offset;
+    uint64_t bytes;
+    uint64_t hash;
+    const uint8_t* ptr;
+};
+
+struct Checkpoint::Snapshot {
+    uint32_t number;
+    bool delta;
+    std::vector<Entry> entries;
+    // Own the copied content for async save
+    std::vector<uint8_t> storage;
+    // The NCHW copies of NC4HW4 variables that entries point to
+    std::vector<VARP> converted;
+};
+
+class Checkpoint::MappedFile {
+public:
+    MappedFile(const char* fileName) {
+#if defined(_MSC_VER)
+        FILE* f = fopen(fileName, "rb");
+        if (nullptr == f) {
+            return;
+        }
+        fseek(f, 0, SEEK_END);
+        auto size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        if (size > 0) {
+            mData = (uint8_t*)MNNMemoryAllocAlign(size, MNN_MEMORY_ALIGN_DEFAULT);
+            if (nullptr != mData && fread(mData, 1, size, f) == size) {
+                mSize = size;
+            }
+        }
+        fclose(f);
+#else
+        int fd = open(fileName, O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (0 == fstat(fd, &st) && st.st_size > 0) {
+            // Private mapping: pages are loaded lazily and writing a parameter in place only copies its pages
+            auto ptr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED != ptr) {
+                mData = (uint8_t*)ptr;
+                mSize = st.st_size;
+            }
+        }
+        close(fd);
+#endif
+    }
+    ~MappedFile() {
+        if (nullptr == mData) {
+            return;
+        }
+#if defined(_MSC_VER)
+        MNNMemoryFreeAlign(mData);
+#else
+        munmap(mData, mSize);
+#endif
+    }
+    uint8_t* data() const {
+        return mSize > 0 ? mData : nullptr;
+    }
+    size_t size() const {
+        return mSize;
+    }
+
+private:
+    uint8_t* mData = nullptr;
+    size_t mSize   = 0;
+};
+
+class IndexReader {
+public:
+    IndexReader(const uint8_t* data, size_t size) : mData(data), mSize(size) {
+    }
+    template <typename T>
+    bool read(T& value) {
+        if (mPos + sizeof(T) > mSize) {
+            return false;
+        }
+        ::memcpy(&value, mData + mPos, sizeof(T));
+        mPos += sizeof(T);
+        return true;
+    }
+    bool read(std::string& value) {
+        uint32_t length = 0;
+        if (!read(length) || mPos + length > mSize) {
+            return false;
+        }
+        value.assign((const char*)mData + mPos, length);
+        mPos += length;
+        return true;
+    }
+
+private:
+    const uint8_t* mData;
+    size_t mSize;
+    size_t mPos = 0;
+};
+
+template <typename T>
+static void _append(std::vector<uint8_t>& buffer, const T& value) {
+    auto pos = buffer.size();
+    buffer.resize(pos + sizeof(T));
+    ::memcpy(buffer.data() + pos, &value, sizeof(T));
+}
+
+static void _append(std::vector<uint8_t>& buffer, const std::string& value) {
+    _append(buffer, (uint32_t)value.size());
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+static uint64_t _hash(const uint8_t* data, size_t size) {
+    // FNV-1a over 64 bit words
+    uint64_t hash        = 14695981039346656037ULL;
+    const uint64_t prime = 1099511628211ULL;
+    size_t i             = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        ::memcpy(&word, data + i, sizeof(uint64_t));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ data[i]) * prime;
+    }
+    return hash ^ size;
+}
+
+#if defined(_MSC_VER)
+static const char* gPathSeparators = "/\\";
+#else
+static const char* gPathSeparators = "/";
+#endif
+
+static bool _isAbsolute(const std::string& path) {
+#if defined(_MSC_VER)
+    if (path.size() >= 2 && path[1] == ':') {
+        return true;
+    }
+#endif
+    return !path.empty() && nullptr != strchr(gPathSeparators, path[0]);
+}
+
+// The directory of path with the trailing separator, empty for a file in the working directory
+static std::string _directory(const std::string& path) {
+    auto pos = path.find_last_of(gPathSeparators);
+    return std::string::npos == pos ? std::string() : path.substr(0, pos + 1);
+}
+
+// Absolute path with symbolic links resolved, the file itself may not exist yet
+static std::string _canonicalPath(const std::string& path) {
+    auto dir  = _directory(path);
+    auto name = path.substr(dir.size());
+    if (dir.empty()) {
+        dir = ".";
+    }
+#if defined(_MSC_VER)
+    char buffer[_MAX_PATH];
+    if (nullptr != _fullpath(buffer, path.c_str(), _MAX_PATH)) {
+        return buffer;
+    }
+    if (nullptr == _fullpath(buffer, dir.c_str(), _MAX_PATH)) {
+        return std::string();
+    }
+#else
+    char buffer[PATH_MAX];
+    if (nullptr != realpath(path.c_str(), buffer)) {
+        return buffer;
+    }
+    if (nullptr == realpath(dir.c_str(), buffer)) {
+        return std::string();
+    }
+#endif
+    std::string result = buffer;
+    if (result.empty() || nullptr == strchr(gPathSeparators, result.back())) {
+        result += "/";
+    }
+    return result + name;
+}
+
+static std::vector<std::string> _splitPath(const std::string& path) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start <= path.size()) {
+        auto end = path.find_first_of(gPathSeparators, start);
+        if (std::string::npos == end) {
+            end = path.size();
+        }
+        if (end > start) {
+            parts.emplace_back(path.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return parts;
+}
+
+// Path of the canonical file relative to the canonical directory
+static std::string _relativePath(const std::string& directory, const std::string& file) {
+    auto from = _splitPath(directory);
+    auto to   = _splitPath(file);
+#if defined(_MSC_VER)
+    if (from.empty() || to.empty() || from[0] != to[0]) {
+        // Another drive
+        return file;
+    }
+#endif
+    size_t common = 0;
+    while (common < from.size() && common + 1 < to.size() && from[common] == to[common]) {
+        common++;
+    }
+    std::string result;
+    for (size_t i = common; i < from.size(); ++i) {
+        result += "../";
+    }
+    for (size_t i = common; i < to.size(); ++i) {
+        result += to[i];
+        if (i + 1 < to.size()) {
+            result += "/";
+        }
+    }
+    return result;
+}
+
+// The base of a delta checkpoint is stored relative to the directory of the delta
+static std::string _resolveBase(const std::string& fileName, const std::string& base) {
+    if (base.empty() || _isAbsolute(base)) {
+        return base;
+    }
+    return _directory(fileName) + base;
+}
+
+// Read the base name of a checkpoint without mapping it
+static bool _readBase(const std::string& fileName, std::string& base) {
+    FILE* f = fopen(fileName.c_str(), "rb");
+    if (nullptr == f) {
+        return false;
+    }
+    CheckpointHeader header;
+    uint32_t length = 0;
+    bool success    = fread(&header, 1, sizeof(CheckpointHeader), f) == sizeof(CheckpointHeader) &&
+                   header.magic == gCheckpointMagic && header.version == gCheckpointVersion &&
+                   header.indexSize >= sizeof(uint32_t) && 0 == fseek(f, (long)header.indexOffset, SEEK_SET) &&
+                   fread(&length, 1, sizeof(uint32_t), f) == sizeof(uint32_t) &&
+                   length <= header.indexSize - sizeof(uint32_t);
+    if (success) {
+        base.resize(length);
+        success = length == 0 || fread(&base[0], 1, length, f) == length;
+    }
+    fclose(f);
+    return success;
+}
+
+Checkpoint::~Checkpoint() {
+    wait();
+}
+
+bool Checkpoint::wait() {
+    if (mWriter.joinable()) {
+        mWriter.join();
+    }
+    return mWriteSuccess;
+}
+
+bool Checkpoint::_prepare(const std::vector<VARP>& vars, bool copy, Snapshot& snapshot) {
+    snapshot.number = (uint32_t)vars.size();
+    snapshot.entries.resize(vars.size());
+    size_t totalBytes = 0;
+    for (int i = 0; i < vars.size(); ++i) {
+        auto& entry = snapshot.entries[i];
+        auto var    = vars[i];
+        auto info   = var->getInfo();
+        if (nullptr != info && NC4HW4 == info->order) {
+            // The NC4HW4 buffer is padded on channel, the file keeps the NCHW content and the order for load
+            var = _Convert(var, NCHW);
+            snapshot.converted.emplace_back(var);
+        }
+        info     = var->getInfo();
+        auto ptr = var->readMap<uint8_t>();
+        if (nullptr == info || (nullptr == ptr && info->size > 0)) {
+            MNN_ERROR("Checkpoint: can't compute variable %d\n", i);
+            return false;
+        }
+        auto expr       = vars[i]->expr().first;
+        entry.index     = i;
+        entry.inputType = nullptr == expr->get() ? (int32_t)expr->inputType() : (int32_t)VARP::CONSTANT;
+        entry.type      = info->type;
+        entry.order     = var.get() != vars[i].get() ? (int32_t)NC4HW4 : (int32_t)info->order;
+        entry.dim       = info->dim;
+        entry.name      = vars[i]->name();
+        entry.bytes     = info->size * info->type.bytes();
+        entry.ptr       = ptr;
+        totalBytes += entry.bytes;
+    }
+    if (copy) {
+        snapshot.storage.resize(totalBytes);
+        size_t offset = 0;
+        for (auto& entry : snapshot.entries) {
+            ::memcpy(snapshot.storage.data() + offset, entry.ptr, entry.bytes);
+            entry.ptr = snapshot.storage.data() + offset;
+            offset += entry.bytes;
+        }
+        snapshot.converted.clear();
+    }
+    return true;
+}
+
+bool Checkpoint::_write(Snapshot& snapshot, const char* fileName) {
+    bool delta = snapshot.delta;
+    if (delta && (mHashes.size() != snapshot.number || mLastFile.empty())) {
+        MNN_ERROR("Checkpoint: delta save need a previous checkpoint with the same variables\n");
+        return false;
+    }
+    auto target = _canonicalPath(fileName);
+    if (target.empty()) {
+        MNN_ERROR("Checkpoint: invalid path %s\n", fileName);
+        return false;
+    }
+    std::string base;
+    if (delta) {
+        // The file mustn't replace any checkpoint of its base chain
+        auto current = mLastFile;
+        for (int depth = 0; !current.empty(); ++depth) {
+            if (current == target) {
+                MNN_ERROR("Checkpoint: delta save can't overwrite %s of its base chain\n", fileName);
+                return false;
+            }
+            std::string next;
+            if (depth > gMaxDeltaDepth || !_readBase(current, next)) {
+                MNN_ERROR("Checkpoint: can't read the base chain of %s\n", mLastFile.c_str());
+                return false;
+            }
+            current = next.empty() ? next : _canonicalPath(_resolveBase(current, next));
+        }
+        base = _relativePath(_directory(target), mLastFile);
+    }
+    std::vector<uint64_t> hashes(snapshot.number);
+    for (auto& entry : snapshot.entries) {
+        entry.hash           = _hash(entry.ptr, entry.bytes);
+        hashes[entry.index] = entry.hash;
+    }
+    // Write to a temp file and rename, so that a crash never leaves a broken checkpoint
+    std::string tempName = std::string(fileName) + ".tmp";
+    FILE* f              = fopen(tempName.c_str(), "wb");
+    if (nullptr == f) {
+        MNN_ERROR("Checkpoint: can't open %s\n", tempName.c_str());
+        return false;
+    }
+    CheckpointHeader header;
+    ::memset(&header, 0, sizeof(CheckpointHeader));
+    bool success = fwrite(&header, 1, sizeof(CheckpointHeader), f) == sizeof(CheckpointHeader);
+    uint64_t offset = sizeof(CheckpointHeader);
+    const uint8_t zeros[gCheckpointAlign] = {0};
+    std::vector<uint8_t> index;
+    _append(index, base);
+    uint32_t entryNumber = 0;
+    for (auto& entry : snapshot.entries) {
+        if (!success) {
+            break;
+        }
+        if (delta && mHashes[entry.index] == entry.hash) {
+            continue;
+        }
+        auto pad = (gCheckpointAlign - offset % gCheckpointAlign) % gCheckpointAlign;
+        success  = success && fwrite(zeros, 1, pad, f) == pad;
+        offset += pad;
+        entry.offset = offset;
+        success      = success && fwrite(entry.ptr, 1, entry.bytes, f) == entry.bytes;
+        offset += entry.bytes;
+
+        _append(index, entry.index);
+        _append(index, entry.inputType);
+        _append(index, entry.type);
+        _append(index, entry.order);
+        _append(index, (uint32_t)entry.dim.size());
+        for (auto d : entry.dim) {
+            _append(index, (int32_t)d);
+        }
+        _append(index, entry.name);
+        _append(index, entry.offset);
+        _append(index, entry.bytes);
+        _append(index, entry.hash);
+        entryNumber++;
+    }
+    header.magic       = gCheckpointMagic;
+    header.version     = gCheckpointVersion;
+    header.number      = snapshot.number;
+    header.entryNumber = entryNumber;
+    header.indexOffset = offset;
+    header.indexSize   = index.size();
+    success = success && fwrite(index.data(), 1, index.size(), f) == index.size();
+    success = success && 0 == fseek(f, 0, SEEK_SET);
+    success = success && fwrite(&header, 1, sizeof(CheckpointHeader), f) == sizeof(CheckpointHeader);
+    success = (0 == fclose(f)) && success;
+    if (success) {
+        ::remove(fileName);
+        success = 0 == ::rename(tempName.c_str(), fileName);
+    }
+    if (!success) {
+        MNN_ERROR("Checkpoint: write %s failed\n", fileName);
+        ::remove(tempName.c_str());
+        return false;
+    }
+    mHashes   = std::move(hashes);
+    mLastFile = target;
+    return true;
+}
+
+bool Checkpoint::save(const std::vector<VARP>& vars, const char* fileName, bool delta) {
+    if (!wait()) {
+        MNN_ERROR("Checkpoint: previous async save failed\n");
+    }
+    Snapshot snapshot;
+    snapshot.delta = delta;
+    if (!_prepare(vars, false, snapshot)) {
+        return false;
+    }
+    return _write(snapshot, fileName);
+}
+
+bool Checkpoint::saveAsync(const std::vector<VARP>& vars, const char* fileName, bool delta) {
+    if (!wait()) {
+        MNN_ERROR("Checkpoint: previous async save failed\n");
+    }
+    std::shared_ptr<Snapshot> snapshot(new Snapshot);
+    snapshot->delta = delta;
+    if (!_prepare(vars, true, *snapshot)) {
+        return false;
+    }
+    std::string name = fileName;
+    mWriter = std::thread([this, snapshot, name]() { mWriteSuccess = _write(*snapshot, name.c_str()); });
+    return true;
+}
+
+bool Checkpoint::_load(const char* fileName, std::vector<VARP>& result, std::vector<uint64_t>& hashes, int depth) {
+    if (depth > gMaxDeltaDepth) {
+        MNN_ERROR("Checkpoint: delta chain of %s is too long\n", fileName);
+        return false;
+    }
+    std::shared_ptr<MappedFile> file(new MappedFile(fileName));
+    auto data = file->data();
+    if (nullptr == data || file->size() < sizeof(CheckpointHeader)) {
+        MNN_ERROR("Checkpoint: can't open %s\n", fileName);
+        return false;
+    }
+    CheckpointHeader header;
+    ::memcpy(&header, data, sizeof(CheckpointHeader));
+    if (header.magic != gCheckpointMagic || header.version != gCheckpointVersion ||
+        header.indexOffset > file->size() || header.indexSize > file->size() - header.indexOffset) {
+        MNN_ERROR("Checkpoint: %s is not a valid checkpoint\n", fileName);
+        return false;
+    }
+    IndexReader reader(data + header.indexOffset, header.indexSize);
+    std::string base;
+    if (!reader.read(base)) {
+        return false;
+    }
+    if (base.empty()) {
+        result.clear();
+        result.resize(header.number);
+        hashes.resize(header.number);
+    } else {
+        base = _resolveBase(fileName, base);
+        if (!_load(base.c_str(), result, hashes, depth + 1)) {
+            return false;
+        }
+        if (result.size() != header.number) {
+            MNN_ERROR("Checkpoint: variable number of %s not match its base %s\n", fileName, base.c_str());
+            return false;
+        }
+    }
+    for (int i = 0; i < header.entryNumber; ++i) {
+        Entry entry;
+        uint32_t dimNumber = 0;
+        bool valid = reader.read(entry.index) && reader.read(entry.inputType) && reader.read(entry.type) &&
+                     reader.read(entry.order) && reader.read(dimNumber);
+        for (int d = 0; valid && d < dimNumber; ++d) {
+            int32_t length = 0;
+            valid          = reader.read(length);
+            entry.dim.emplace_back(length);
+        }
+        valid = valid && reader.read(entry.name) && reader.read(entry.offset) && reader.read(entry.bytes) &&
+                reader.read(entry.hash);
+        valid = valid && entry.index < header.number && entry.offset <= header.indexOffset &&
+                entry.bytes <= header.indexOffset - entry.offset;
+        if (!valid) {
+            MNN_ERROR("Checkpoint: broken index in %s\n", fileName);
+            return false;
+        }
+        Variable::Info info;
+        info.order = NC4HW4 == entry.order ? NCHW : (Dimensionformat)entry.order;
+        info.dim   = entry.dim;
+        info.type  = entry.type;
+        info.syncSize();
+        if (info.size * info.type.bytes() != entry.bytes) {
+            MNN_ERROR("Checkpoint: size of variable %d in %s not match\n", (int)entry.index, fileName);
+            return false;
+        }
+        auto var = Variable::create(
+            Expr::create(std::move(info), data + entry.offset, (VARP::InputType)entry.inputType, false));
+        if (NC4HW4 == entry.order) {
+            var = _Convert(var, NC4HW4);
+            var.fix((VARP::InputType)entry.inputType);
+        }
+        if (!entry.name.empty()) {
+            var->setName(entry.name);
+        }
+        result[entry.index] = var;
+        hashes[entry.index] = entry.hash;
+    }
+    mFiles.emplace_back(file);
+    return true;
+}
+
+std::vector<VARP> Checkpoint::load(const char* fileName) {
+    wait();
+    std::vector<VARP> result;
+    std::vector<uint64_t> hashes;
+    if (!_load(fileName, result, hashes, 0)) {
+        return {};
+    }
+    mHashes   = std::move(hashes);
+    mLastFile = _canonicalPath(fileName);
+    return result;
+}
+
+} // namespace Train
+} // namespace MNN
@@ -0,0 +1,77 @@
+//
+//  Checkpoint.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/08.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef Checkpoint_hpp
+#define Checkpoint_hpp
+
+#include <MNN/expr/Expr.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MNN {
+namespace Train {
+
+/**
+ Checkpoint for training parameters, unlike Variable::save it doesn't build a NetT:
+ file layout is [header][tensor data, 64 bytes aligned]...[index], the tensor data is streamed from host memory
+ and the index records name / type / shape / offset / content hash of each variable.
+
+ A delta checkpoint only stores the variables changed since the last save of the same Checkpoint object and
+ references the previous file as its base, by the path relative to the directory of the delta file, so a directory
+ of checkpoints can be moved. Loading maps the file and let the variables alias the mapped memory, so the
+ Checkpoint object must outlive the loaded variables. NC4HW4 variables are stored as NCHW and converted back on load.
+ */
+class MNN_PUBLIC Checkpoint {
+public:
+    Checkpoint() = default;
+    ~Checkpoint();
+
+    /**
+     Write vars to fileName.
+     @param delta only write the variables whose content changed since last save / load, need a previous one,
+                  fileName can't be any checkpoint of its base chain.
+     */
+    bool save(const std::vector<Express::VARP>& vars, const char* fileName, bool delta = false);
+
+    /**
+     Copy the content of vars into a snapshot and write it in a background thread, so training can continue and
+     modify the variables. Previous async save is waited at first.
+     */
+    bool saveAsync(const std::vector<Express::VARP>& vars, const char* fileName, bool delta = false);
+
+    // Wait the async save, return false if it failed
+    bool wait();
+
+    /**
+     Load variables in saved order, the base checkpoints of delta checkpoint are loaded recursively.
+     The result aliases mapped file memory, use Module::loadParameters to put them into module.
+     */
+    std::vector<Express::VARP> load(const char* fileName);
+
+private:
+    struct Entry;
+    class MappedFile;
+    struct Snapshot;
+    bool _prepare(const std::vector<Express::VARP>& vars, bool copy, Snapshot& snapshot);
+    bool _write(Snapshot& snapshot, const char* fileName);
+    bool _load(const char* fileName, std::vector<Express::VARP>& result, std::vector<uint64_t>& hashes, int depth);
+
+    // Content hash of each variable in the last saved / loaded checkpoint, used for delta save
+    std::vector<uint64_t> mHashes;
+    std::string mLastFile;
+    std::vector<std::shared_ptr<MappedFile>> mFiles;
+    std::thread mWriter;
+    bool mWriteSuccess = true;
+};
+
+} // namespace Train
+} // namespace MNN
+
+#endif // Checkpoint_hpp
@@ -0,0 +1,271 @@
+//
+//  DataParallel.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/03.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "DataParallel.hpp"
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <MNN/expr/ExecutorScope.hpp>
+using namespace MNN::Express;
+
+namespace MNN {
+namespace Train {
+
+class ReplicaBarrier {
+public:
+    ReplicaBarrier(int number) : mNumber(number) {
+    }
+    void wait() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto generation = mGeneration;
+        mCount++;
+        if (mCount == mNumber) {
+            mCount = 0;
+            mGeneration++;
+            mCondition.notify_all();
+            return;
+        }
+        mCondition.wait(lock, [this, generation]() { return generation != mGeneration; });
+    }
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    int mNumber;
+    int mCount      = 0;
+    int mGeneration = 0;
+};
+
+std::vector<std::shared_ptr<Module>> DataParallel::createReplicas(std::shared_ptr<Module> module, int number) {
+    std::vector<std::shared_ptr<Module>> replicas{module};
+    for (int i = 1; i < number; ++i) {
+        std::shared_ptr<Module> replica(Module::clone(module.get(), false));
+        if (nullptr == replica) {
+            MNN_ERROR("DataParallel: module %s can't be cloned\n", module->name().c_str());
+            return {};
+        }
+        replicas.emplace_back(replica);
+    }
+    return replicas;
+}
+
+DataParallel* DataParallel::create(const std::vector<std::shared_ptr<Module>>& replicas, OptimizerCreator creator,
+                                   LossFunction lossFunc, int numberThread) {
+    if (replicas.empty()) {
+        return nullptr;
+    }
+    std::unique_ptr<DataParallel> parallel(new DataParallel);
+    auto masterParameters = replicas[0]->parameters();
+    for (int i = 0; i < replicas.size(); ++i) {
+        auto parameters = replicas[i]->parameters();
+        if (parameters.size() != masterParameters.size()) {
+            MNN_ERROR("DataParallel: replica %d's parameter number not match\n", i);
+            return nullptr;
+        }
+        // Broadcast the parameters of first replica
+        for (int k = 0; k < parameters.size() && i > 0; ++k) {
+            if (nullptr == parameters[k].get() || nullptr != parameters[k]->expr().first->get()) {
+                continue;
+            }
+            auto srcInfo = masterParameters[k]->getInfo();
+            auto dstInfo = parameters[k]->getInfo();
+            if (nullptr == srcInfo || srcInfo->size != dstInfo->size || srcInfo->type != dstInfo->type) {
+                MNN_ERROR("DataParallel: replica %d's parameter %d not match\n", i, k);
+                return nullptr;
+            }
+            ::memcpy(parameters[k]->writeMap<void>(), masterParameters[k]->readMap<void>(),
+                     srcInfo->size * srcInfo->type.bytes());
+        }
+        BackendConfig config;
+        parallel->mExecutors.emplace_back(Executor::newExecutor(MNN_FORWARD_CPU, config, numberThread));
+        std::shared_ptr<SGD> optimizer(creator(replicas[i]));
+        if (nullptr == optimizer) {
+            return nullptr;
+        }
+        // The all-reduce works on dense gradients
+        optimizer->setSparseUpdate(false);
+        parallel->mOptimizers.emplace_back(optimizer);
+    }
+    parallel->mReplicas = replicas;
+    parallel->mLossFunc = lossFunc;
+    parallel->mGradients.resize(replicas.size());
+    parallel->mGradientSizes.resize(replicas.size());
+    parallel->mGradientMaps.resize(replicas.size());
+    for (int i = 1; i < replicas.size(); ++i) {
+        parallel->mWorkers.emplace_back(std::thread(&DataParallel::_workerLoop, parallel.get(), i));
+    }
+    return parallel.release();
+}
+
+DataParallel::~DataParallel() {
+    {
+        std::lock_guard<std::mutex> lock(mWorkerMutex);
+        mStop = true;
+    }
+    mTaskCondition.notify_all();
+    for (auto& t : mWorkers) {
+        t.join();
+    }
+}
+
+void DataParallel::_workerLoop(int index) {
+    int generation = 0;
+    while (true) {
+        std::function<void(int)> task;
+        {
+            std::unique_lock<std::mutex> lock(mWorkerMutex);
+            mTaskCondition.wait(lock, [this, generation]() { return mStop || generation != mGeneration; });
+            if (mStop) {
+                return;
+            }
+            generation = mGeneration;
+            task       = mTask;
+        }
+        task(index);
+        std::lock_guard<std::mutex> lock(mWorkerMutex);
+        mPending--;
+        if (0 == mPending) {
+            mDoneCondition.notify_all();
+        }
+    }
+}
+
+bool DataParallel::_runReplica(int index, const Example& example, float* loss) {
+    auto lossVar = mLossFunc(mReplicas[index], example);
+    if (nullptr == lossVar.get()) {
+        return false;
+    }
+    auto lossPtr = lossVar->readMap<float>();
+    if (nullptr == lossPtr) {
+        return false;
+    }
+    *loss = lossPtr[0];
+    auto grads = mOptimizers[index]->computeGradients(lossVar);
+    if (grads.empty()) {
+        return false;
+    }
+    // Order the gradients by module's parameters so that all replicas match
+    auto parameters = mReplicas[index]->parameters();
+    auto& gradients = mGradients[index];
+    auto& sizes     = mGradientSizes[index];
+    gradients.clear();
+    sizes.clear();
+    for (auto& p : parameters) {
+        auto iter = grads.find(p);
+        if (iter == grads.end() || iter->second->getInfo()->type != halide_type_of<float>()) {
+            continue;
+        }
+        gradients.emplace_back(iter->second->writeMap<float>());
+        sizes.emplace_back(iter->second->getInfo()->size);
+    }
+    mGradientMaps[index] = std::move(grads);
+    return true;
+}
+
+void DataParallel::_allReduce(int index) {
+    // Reduce-scatter and all-gather fused: each replica averages its own chunk of the flatten gradients
+    const int number  = (int)mReplicas.size();
+    const float scale = 1.0f / (float)number;
+    auto& sizes       = mGradientSizes[0];
+    size_t totalSize  = 0;
+    for (auto s : sizes) {
+        totalSize += s;
+    }
+    size_t begin  = totalSize * index / number;
+    size_t end    = totalSize * (index + 1) / number;
+    size_t offset = 0;
+    const int blockSize = 1024;
+    float cache[blockSize];
+    for (int k = 0; k < sizes.size(); ++k) {
+        size_t kBegin = std::max(begin, offset);
+        size_t kEnd   = std::min(end, offset + sizes[k]);
+        for (size_t pos = kBegin; pos < kEnd; pos += blockSize) {
+            auto start = pos - offset;
+            auto len   = std::min((size_t)blockSize, kEnd - pos);
+            ::memcpy(cache, mGradients[0][k] + start, len * sizeof(float));
+            for (int r = 1; r < number; ++r) {
+                auto src = mGradients[r][k] + start;
+                for (int v = 0; v < len; ++v) {
+                    cache[v] += src[v];
+                }
+            }
+            for (int v = 0; v < len; ++v) {
+                cache[v] *= scale;
+            }
+            for (int r = 0; r < number; ++r) {
+                ::memcpy(mGradients[r][k] + start, cache, len * sizeof(float));
+            }
+        }
+        offset += sizes[k];
+    }
+}
+
+bool DataParallel::step(const std::vector<Example>& shards, float* loss) {
+    const int number = (int)mReplicas.size();
+    if (shards.size() != number) {
+        MNN_ERROR("DataParallel: need %d shards, but receive %d\n", number, (int)shards.size());
+        return false;
+    }
+    ReplicaBarrier barrier(number);
+    std::vector<float> losses(number, 0.0f);
+    std::atomic<bool> success(true);
+    std::atomic<bool> matched(true);
+    auto worker = [&](int index) {
+        ExecutorScope scope(mExecutors[index]);
+        if (!_runReplica(index, shards[index], losses.data() + index)) {
+            success = false;
+        }
+        barrier.wait();
+        if (!success) {
+            return;
+        }
+        for (int r = 1; r < number; ++r) {
+            if (mGradientSizes[r] != mGradientSizes[0]) {
+                if (0 == index) {
+                    MNN_ERROR("DataParallel: gradients of replica %d not match\n", r);
+                    matched = false;
+                }
+                return;
+            }
+        }
+        _allReduce(index);
+        barrier.wait();
+        mOptimizers[index]->stepGradients(std::move(mGradientMaps[index]));
+    };
+    {
+        std::lock_guard<std::mutex> lock(mWorkerMutex);
+        mTask    = worker;
+        mPending = number - 1;
+        mGeneration++;
+    }
+    mTaskCondition.notify_all();
+    worker(0);
+    {
+        std::unique_lock<std::mutex> lock(mWorkerMutex);
+        mDoneCondition.wait(lock, [this]() { return 0 == mPending; });
+        mTask = nullptr;
+    }
+    for (int i = 0; i < number; ++i) {
+        mGradientMaps[i].clear();
+    }
+    if (!success) {
+        MNN_ERROR("DataParallel: compute error\n");
+        return false;
+    }
+    if (nullptr != loss) {
+        float sum = 0.0f;
+        for (auto l : losses) {
+            sum += l;
+        }
+        *loss = sum / (float)number;
+    }
+    return matched;
+}
+
+} // namespace Train
+} // namespace MNN
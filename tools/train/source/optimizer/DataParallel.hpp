@@ -0,0 +1,94 @@
+//
+//  DataParallel.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/03.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef DataParallel_hpp
+#define DataParallel_hpp
+
+#include <MNN/expr/Executor.hpp>
+#include <MNN/expr/Module.hpp>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Example.hpp"
+#include "SGD.hpp"
+
+namespace MNN {
+namespace Train {
+
+/**
+ Data parallel training on CPU: every replica runs on its own thread and executor with its own batch shard,
+ gradients are averaged by a chunked all-reduce in shared memory before each replica updates its parameters.
+ The threads of replicas live as long as the DataParallel, replica 0 runs on the thread calling step.
+ */
+class MNN_PUBLIC DataParallel {
+public:
+    typedef std::function<Express::VARP(std::shared_ptr<Express::Module>, const Example&)> LossFunction;
+    typedef std::function<SGD*(std::shared_ptr<Express::Module>)> OptimizerCreator;
+
+    /**
+     @param replicas modules with the same structure, parameters of replicas[0] are broadcasted to others.
+     @param creator create the optimizer for each replica.
+     @param numberThread thread number of each replica's executor.
+     */
+    static DataParallel* create(const std::vector<std::shared_ptr<Express::Module>>& replicas, OptimizerCreator creator,
+                                LossFunction lossFunc, int numberThread = 1);
+
+    // Make replicas by Module::clone without sharing parameters, the first one is module itself
+    static std::vector<std::shared_ptr<Express::Module>> createReplicas(std::shared_ptr<Express::Module> module,
+                                                                        int number);
+    ~DataParallel();
+
+    /**
+     Run one step, shards.size() must be the same as replica number.
+     @param loss if not nullptr, the mean loss of all replicas.
+     */
+    bool step(const std::vector<Example>& shards, float* loss = nullptr);
+
+    int replicaNumber() const {
+        return (int)mReplicas.size();
+    }
+    std::shared_ptr<Express::Module> module() const {
+        return mReplicas[0];
+    }
+    std::shared_ptr<SGD> optimizer(int index) const {
+        return mOptimizers[index];
+    }
+
+private:
+    DataParallel() = default;
+    bool _runReplica(int index, const Example& example, float* loss);
+    void _allReduce(int index);
+    void _workerLoop(int index);
+
+    std::vector<std::shared_ptr<Express::Module>> mReplicas;
+    std::vector<std::shared_ptr<SGD>> mOptimizers;
+    std::vector<std::shared_ptr<Express::Executor>> mExecutors;
+    LossFunction mLossFunc;
+
+    // For all-reduce, mGradients[replica][parameter]
+    std::vector<std::vector<float*>> mGradients;
+    std::vector<std::vector<size_t>> mGradientSizes;
+    std::vector<std::map<Express::VARP, Express::VARP>> mGradientMaps;
+
+    // Workers of replica [1, n), each step publishes mTask with a new generation and waits mPending to be zero
+    std::vector<std::thread> mWorkers;
+    std::mutex mWorkerMutex;
+    std::condition_variable mTaskCondition;
+    std::condition_variable mDoneCondition;
+    std::function<void(int)> mTask;
+    int mGeneration = 0;
+    int mPending    = 0;
+    bool mStop      = false;
+};
+
+} // namespace Train
+} // namespace MNN
+
+#endif // DataParallel_hpp
@@ -7,6 +7,7 @@
 //
 
 #include "Loss.hpp"
+#include "MNN_generated.h"
 
 using namespace MNN::Express;
 
@@ -48,6 +49,18 @@ Express::VARP _Hinge(Express::VARP predicts, Express::VARP oneHotTargets) {
     return loss;
 }
 
+Express::VARP _SoftmaxCrossEntropyWithLogits(Express::VARP logits, Express::VARP oneHotTargets) {
+    if (logits->getInfo()->order == NC4HW4) {
+        logits = _Convert(logits, NCHW);
+    }
+    MNN_ASSERT(logits->getInfo()->dim.size() == 2);
+    MNN_ASSERT(logits->getInfo()->dim == oneHotTargets->getInfo()->dim);
+    std::unique_ptr<OpT> op(new OpT);
+    op->type  = OpType_SoftmaxCrossEntropy;
+    auto loss = Variable::create(Expr::create(op.get(), {logits, oneHotTargets}));
+    return _ReduceMean(loss, {});
+}
+
 Express::VARP _DistillLoss(Express::VARP studentLogits, Express::VARP teacherLogits, Express::VARP oneHotTargets, const float temperature, const float alpha) {
     auto info = teacherLogits->getInfo();
     if (info->order == NC4HW4) {
@@ -61,7 +74,7 @@ Express::VARP _DistillLoss(Express::VARP studentLogits, Express::VARP teacherLog
     auto softTargets = _Softmax(teacherLogits * _Scalar(1 / temperature));
     auto studentPredict = _Softmax(studentLogits * _Scalar(1 / temperature));
     auto loss1 = _Scalar(temperature * temperature) * _KLDivergence(studentPredict, softTargets);
-    auto loss2 = _CrossEntropy(_Softmax(studentLogits), oneHotTargets);
+    auto loss2 = _SoftmaxCrossEntropyWithLogits(studentLogits, oneHotTargets);
     auto loss = _Scalar(alpha) * loss1 + _Scalar(1 - alpha) * loss2;
     return loss;
 }
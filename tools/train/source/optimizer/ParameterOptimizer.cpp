@@ -51,13 +51,19 @@ ParameterOptimizer* ParameterOptimizer::createADAM(std::shared_ptr<Module> modul
 bool ParameterOptimizer::step(Express::VARP loss) {
     mStep++;
     auto res = this->onGetNextParameter(loss);
+    return updateParameters(res);
+}
+
+bool ParameterOptimizer::updateParameters(std::map<Express::VARP, Express::VARP>& res) {
     for (auto iter : res) {
         iter.second.fix(Express::VARP::TRAINABLE);
     }
     for (auto iter : res) {
         iter.first->input(iter.second);
     }
-    return !res.empty();
+    bool updated    = !res.empty() || mUpdatedInPlace > 0;
+    mUpdatedInPlace = 0;
+    return updated;
 }
 
 int ParameterOptimizer::currentStep() {
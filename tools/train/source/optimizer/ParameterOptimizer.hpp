@@ -29,6 +29,19 @@ public:
 
     virtual std::map<Express::VARP, Express::VARP> onGetNextParameter(Express::VARP loss) = 0;
 
+    /**
+     Build the update expression of one parameter for TrainStep. The states must be kept across steps are appended
+     to states as (buffer, nextValue), buffer must be an input variable. Return nullptr if not supported.
+     */
+    virtual Express::VARP onBuildUpdate(Express::VARP parameter, Express::VARP grad,
+                                        std::vector<std::pair<Express::VARP, Express::VARP>>& states) {
+        return nullptr;
+    }
+    // Refresh hyper-parameter inputs used by onBuildUpdate, called before each TrainStep
+    virtual void onPrepareStep() {
+        // Do nothing
+    }
+
     static ParameterOptimizer* createSGD(std::shared_ptr<Express::Module> module, float lr, float momentum, float weightDecay, RegularizationMethod method);
     static ParameterOptimizer* createADAM(std::shared_ptr<Express::Module> module, float lr, float momentum, float momentum2, float weightDecay, float eps, RegularizationMethod method);
 protected:
@@ -38,7 +51,12 @@ protected:
     std::shared_ptr<Express::Module> module() const {
         return mModule;
     }
+    // Replace parameters by their next value
+    bool updateParameters(std::map<Express::VARP, Express::VARP>& next);
+    // Parameters updated in place while computing the next values, they count as updated but are not in the map
+    int mUpdatedInPlace = 0;
 private:
+    friend class TrainStep;
     int mStep = 0;
     std::shared_ptr<Express::Module> mModule;
     std::set<Express::VARP> mTrainable;
@@ -7,6 +7,8 @@
 //
 
 #include "SGD.hpp"
+#include <algorithm>
+#include <cmath>
 #include "OpGrad.hpp"
 using namespace MNN::Express;
 
@@ -68,6 +70,116 @@ Express::VARP SGD::regularizeParameters(Express::VARP param, Express::VARP grad)
     return addWeightDecayGrad;
 }
 
+bool SGD::isSparseGrad(Express::VARP param, Express::VARP grad) {
+    auto op = grad->expr().first->get();
+    if (nullptr == op || OpType_ScatterNd != op->type() || grad->expr().first->inputs().size() != 3) {
+        return false;
+    }
+    auto info = param->getInfo();
+    return nullptr != info && info->order != NC4HW4 && info->type == halide_type_of<float>();
+}
+
+bool SGD::getSparseGrad(Express::VARP grad, SparseGrad& sparse) {
+    auto inputs      = grad->expr().first->inputs();
+    auto indexInfo   = inputs[0]->getInfo();
+    auto updateInfo  = inputs[1]->getInfo();
+    auto gradInfo    = grad->getInfo();
+    auto indicesPtr  = inputs[0]->readMap<int>();
+    auto updatesPtr  = inputs[1]->readMap<float>();
+    if (nullptr == indicesPtr || nullptr == updatesPtr || nullptr == gradInfo || indexInfo->dim.empty()) {
+        return false;
+    }
+    // Same as ScatterNd: each index of indexDim numbers addresses a slice of the grad
+    const int indexDim = indexInfo->dim[indexInfo->dim.size() - 1];
+    const int number   = indexInfo->size / indexDim;
+    int sliceSize      = 1;
+    for (int i = indexDim; i < gradInfo->dim.size(); ++i) {
+        sliceSize *= gradInfo->dim[i];
+    }
+    if (indexDim > gradInfo->dim.size() || updateInfo->size != number * sliceSize) {
+        return false;
+    }
+    std::vector<std::pair<int, int>> offsets(number);
+    for (int i = 0; i < number; ++i) {
+        int offset = 0;
+        for (int j = 0; j < indexDim; ++j) {
+            auto index = indicesPtr[i * indexDim + j];
+            if (index < 0 || index >= gradInfo->dim[j]) {
+                return false;
+            }
+            offset = offset * gradInfo->dim[j] + index;
+        }
+        offsets[i] = std::make_pair(offset * sliceSize, i);
+    }
+    std::sort(offsets.begin(), offsets.end());
+    sparse.sliceSize = sliceSize;
+    sparse.offsets.clear();
+    sparse.values.clear();
+    for (int i = 0; i < number; ++i) {
+        auto src = updatesPtr + offsets[i].second * sliceSize;
+        if (i > 0 && offsets[i].first == offsets[i - 1].first) {
+            auto dst = sparse.values.data() + sparse.values.size() - sliceSize;
+            for (int k = 0; k < sliceSize; ++k) {
+                dst[k] += src[k];
+            }
+            continue;
+        }
+        sparse.offsets.emplace_back(offsets[i].first);
+        sparse.values.insert(sparse.values.end(), src, src + sliceSize);
+    }
+    return true;
+}
+
+void SGD::regularizeSparse(const float* param, SparseGrad& grad) {
+    if (0.0f == mWeightDecay) {
+        return;
+    }
+    const int sliceSize = grad.sliceSize;
+    for (int i = 0; i < grad.offsets.size(); ++i) {
+        auto p = param + grad.offsets[i];
+        auto g = grad.values.data() + i * sliceSize;
+        for (int k = 0; k < sliceSize; ++k) {
+            float decay = 0.0f;
+            if (mRegularizationMethod == L1 || mRegularizationMethod == L1L2) {
+                decay += p[k] > 0.0f ? 1.0f : (p[k] < 0.0f ? -1.0f : 0.0f);
+            }
+            if (mRegularizationMethod == L2 || mRegularizationMethod == L1L2) {
+                decay += p[k];
+            }
+            g[k] += mWeightDecay * decay;
+        }
+    }
+}
+
+void SGD::onSparseUpdate(Express::VARP param, SparseGrad& grad) {
+    auto paramPtr = param->writeMap<float>();
+    regularizeSparse(paramPtr, grad);
+    const int sliceSize = grad.sliceSize;
+    float* historyPtr   = nullptr;
+    if (0.0f != mMomentum) {
+        auto& history = mHistory[param];
+        if (nullptr != history->expr().first->get()) {
+            history.fix(Express::VARP::CONSTANT);
+        }
+        historyPtr = history->writeMap<float>();
+    }
+    for (int i = 0; i < grad.offsets.size(); ++i) {
+        auto p = paramPtr + grad.offsets[i];
+        auto g = grad.values.data() + i * sliceSize;
+        if (nullptr == historyPtr) {
+            for (int k = 0; k < sliceSize; ++k) {
+                p[k] -= mLearningRate * g[k];
+            }
+            continue;
+        }
+        auto h = historyPtr + grad.offsets[i];
+        for (int k = 0; k < sliceSize; ++k) {
+            h[k] = mLearningRate * g[k] + mMomentum * h[k];
+            p[k] -= h[k];
+        }
+    }
+}
+
 Express::VARP SGD::onComputeUpdateValue(Express::VARP param, Express::VARP grad) {
     auto lr         = _Const(mLearningRate, {}, NCHW);
     mHistory[param] = lr * grad + _Const(mMomentum, {}, NCHW) * mHistory[param];
@@ -76,8 +188,40 @@ Express::VARP SGD::onComputeUpdateValue(Express::VARP param, Express::VARP grad)
     return mHistory[param];
 }
 
-std::map<Express::VARP, Express::VARP> SGD::onGetNextParameter(Express::VARP loss) {
-    auto grad = OpGrad::grad(loss, trainable(), mGradBlockExprName);
+Express::VARP SGD::_staticLearningRate() {
+    if (nullptr == mStaticLearningRate) {
+        mStaticLearningRate = _Input({}, NCHW);
+        mStaticLearningRate->writeMap<float>()[0] = mLearningRate;
+    }
+    return mStaticLearningRate;
+}
+
+Express::VARP SGD::onBuildUpdate(Express::VARP parameter, Express::VARP grad,
+                                 std::vector<std::pair<Express::VARP, Express::VARP>>& states) {
+    auto iter = mHistory.find(parameter);
+    if (iter == mHistory.end()) {
+        return nullptr;
+    }
+    auto history = iter->second;
+    if (nullptr != history->expr().first->get()) {
+        history.fix(Express::VARP::CONSTANT);
+    }
+    auto addWeightDecayGrad = regularizeParameters(parameter, grad);
+    auto nextHistory = _staticLearningRate() * addWeightDecayGrad + _Const(mMomentum, {}, NCHW) * history;
+    states.emplace_back(std::make_pair(history, nextHistory));
+    return parameter - nextHistory;
+}
+
+void SGD::onPrepareStep() {
+    _staticLearningRate()->writeMap<float>()[0] = mLearningRate;
+}
+
+std::map<Express::VARP, Express::VARP> SGD::computeGradients(Express::VARP loss) {
+    std::vector<VARP> checkpoints;
+    if (0 != mCheckpointSegments) {
+        checkpoints = OpGrad::autoCheckpoints(loss, mCheckpointSegments);
+    }
+    auto grad = OpGrad::grad(loss, trainable(), checkpoints, mGradBlockExprName);
     auto parameters = module()->parameters();
     std::vector<VARP> prepareCompute;
     for (auto iter : parameters) {
@@ -86,6 +230,13 @@ std::map<Express::VARP, Express::VARP> SGD::onGetNextParameter(Express::VARP los
         }
     }
     for (auto& iter : grad) {
+        // Only the indices and rows of a sparse grad are computed
+        if (mSparseUpdate && isSparseGrad(iter.first, iter.second)) {
+            auto inputs = iter.second->expr().first->inputs();
+            prepareCompute.emplace_back(inputs[0]);
+            prepareCompute.emplace_back(inputs[1]);
+            continue;
+        }
         prepareCompute.emplace_back(iter.second);
     }
     Variable::prepareCompute(prepareCompute);
@@ -103,7 +254,22 @@ std::map<Express::VARP, Express::VARP> SGD::onGetNextParameter(Express::VARP los
     for (int i=0; i<prepareCompute.size(); ++i) {
         Variable::replace(prepareCompute[i], replaceOp[i]);
     }
+    return grad;
+}
 
+std::map<Express::VARP, Express::VARP> SGD::computeNextParameter(std::map<Express::VARP, Express::VARP> grad) {
+    SparseGrad sparse;
+    mUpdatedInPlace = 0;
+    for (auto iter = grad.begin(); iter != grad.end();) {
+        // Sparse grads are applied to the parameter in place, so they are not in the result
+        if (mSparseUpdate && isSparseGrad(iter->first, iter->second) && getSparseGrad(iter->second, sparse)) {
+            onSparseUpdate(iter->first, sparse);
+            mUpdatedInPlace++;
+            iter = grad.erase(iter);
+            continue;
+        }
+        iter++;
+    }
     for (auto& iter : grad) {
         // apply regularization
         auto addWeightDecayGrad = regularizeParameters(iter.first, iter.second);
@@ -117,5 +283,16 @@ std::map<Express::VARP, Express::VARP> SGD::onGetNextParameter(Express::VARP los
     return grad;
 }
 
+std::map<Express::VARP, Express::VARP> SGD::onGetNextParameter(Express::VARP loss) {
+    auto grad = computeGradients(loss);
+    return computeNextParameter(std::move(grad));
+}
+
+bool SGD::stepGradients(std::map<Express::VARP, Express::VARP> grad) {
+    setCurrentStep(currentStep() + 1);
+    auto res = computeNextParameter(std::move(grad));
+    return updateParameters(res);
+}
+
 } // namespace Train
 } // namespace MNN
@@ -23,10 +23,49 @@ public:
     virtual ~ SGD() = default;
     virtual std::map<Express::VARP, Express::VARP> onGetNextParameter(Express::VARP loss) override;
 
+    // Compute the gradients of trainable parameters, gradients and computed parameters are turned into constants
+    std::map<Express::VARP, Express::VARP> computeGradients(Express::VARP loss);
+
+    // Compute the next value of parameters from the gradients
+    std::map<Express::VARP, Express::VARP> computeNextParameter(std::map<Express::VARP, Express::VARP> grad);
+
+    // Update parameters with gradients computed outside, such as all-reduced gradients of data parallel
+    bool stepGradients(std::map<Express::VARP, Express::VARP> grad);
+
     Express::VARP regularizeParameters(Express::VARP param, Express::VARP grad);
 
+    /**
+     Sparse grad of a parameter: the touched slices of it and their summed grad. A grad produced by ScatterNd, such
+     as the grad of Gather, is not computed densely; only the touched slices of the parameter and its optimizer states
+     are updated in place (lazy update).
+     */
+    struct SparseGrad {
+        int sliceSize = 0;
+        // Element offset of each touched slice in the parameter, without duplicates
+        std::vector<int> offsets;
+        // [offsets.size(), sliceSize]
+        std::vector<float> values;
+    };
+
+    static bool isSparseGrad(Express::VARP param, Express::VARP grad);
+
+    // Read a computed sparse grad, the rows of duplicated indices are summed
+    static bool getSparseGrad(Express::VARP grad, SparseGrad& sparse);
+
+    virtual void onSparseUpdate(Express::VARP param, SparseGrad& grad);
+
+    // Update sparse grads lazily, enabled by default
+    void setSparseUpdate(bool sparse) {
+        mSparseUpdate = sparse;
+    }
+
     virtual Express::VARP onComputeUpdateValue(Express::VARP param, Express::VARP grad);
 
+    virtual Express::VARP onBuildUpdate(Express::VARP parameter, Express::VARP grad,
+                                        std::vector<std::pair<Express::VARP, Express::VARP>>& states) override;
+
+    virtual void onPrepareStep() override;
+
     void setLearningRate(float rate);
 
     float getMomentum();
@@ -47,6 +86,11 @@ public:
         mGradBlockExprName = std::move(block);
     }
 
+    // Activation checkpointing for backward: 0 means disable, negative means sqrt(n) segments
+    void setCheckpointSegments(int number) {
+        mCheckpointSegments = number;
+    }
+
 protected:
     float mLearningRate                        = 0.001f;
     float mMomentum                            = 0;
@@ -58,6 +102,15 @@ protected:
     const Express::Expr* mLoss = nullptr;
     int mLossFromIndex         = 0;
     std::string mGradBlockExprName;
+    int mCheckpointSegments = 0;
+    bool mSparseUpdate      = true;
+
+    // Add the weight decay of touched slices to the sparse grad
+    void regularizeSparse(const float* param, SparseGrad& grad);
+
+    // Learning rate input for TrainStep, refreshed by onPrepareStep
+    Express::VARP mStaticLearningRate;
+    Express::VARP _staticLearningRate();
 };
 
 } // namespace Train
@@ -0,0 +1,132 @@
+//
+//  TrainStep.cpp
+//  MNN
+//
+//  Created by MNN on 2020/12/01.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#include "TrainStep.hpp"
+#include <string.h>
+#include <MNN/expr/ExprCreator.hpp>
+#include "OpGrad.hpp"
+using namespace MNN::Express;
+
+namespace MNN {
+namespace Train {
+
+TrainStep* TrainStep::create(std::shared_ptr<Module> module, std::shared_ptr<ParameterOptimizer> optimizer,
+                             const std::vector<Variable::Info>& inputs, LossFunction lossFunc) {
+    std::unique_ptr<TrainStep> trainStep(new TrainStep);
+    trainStep->mModule    = module;
+    trainStep->mOptimizer = optimizer;
+
+    // Parameters computed by previous forward (such as running mean of batchnorm) become persistent buffers
+    auto originParameters = module->parameters();
+    for (auto& p : originParameters) {
+        if (nullptr == p.get()) {
+            continue;
+        }
+        if (nullptr != p->expr().first->get()) {
+            p.fix(VARP::CONSTANT);
+        }
+    }
+    for (auto& info : inputs) {
+        trainStep->mInputs.emplace_back(_Input(info.dim, info.order, info.type));
+    }
+    auto loss = lossFunc(trainStep->mInputs);
+    if (nullptr == loss.get() || nullptr == loss->getInfo() || loss->getInfo()->size != 1) {
+        MNN_ERROR("TrainStep: loss must be a scalar\n");
+        return nullptr;
+    }
+    trainStep->mLoss = loss;
+
+    // Forward may replace parameters by new expressions, keep the expression as next value and let the module
+    // still reference the persistent buffer
+    auto forwardParameters = module->parameters();
+    MNN_ASSERT(forwardParameters.size() == originParameters.size());
+    for (int i = 0; i < forwardParameters.size(); ++i) {
+        auto p = forwardParameters[i];
+        if (nullptr == p.get() || p.get() == originParameters[i].get()) {
+            continue;
+        }
+        if (nullptr == p->expr().first->get()) {
+            continue;
+        }
+        auto nextValue = Variable::create(p->expr().first, p->expr().second);
+        p->setExpr(originParameters[i]->expr().first, originParameters[i]->expr().second);
+        trainStep->mUpdates.emplace_back(std::make_pair(originParameters[i], nextValue));
+    }
+
+    auto grads = OpGrad::grad(loss, optimizer->trainable());
+    std::vector<std::pair<VARP, VARP>> states;
+    for (auto& iter : grads) {
+        if (nullptr == iter.second.get()) {
+            continue;
+        }
+        auto newParameter = optimizer->onBuildUpdate(iter.first, iter.second, states);
+        if (nullptr == newParameter.get()) {
+            MNN_ERROR("TrainStep: the optimizer don't support building static update\n");
+            return nullptr;
+        }
+        trainStep->mUpdates.emplace_back(std::make_pair(iter.first, newParameter));
+    }
+    trainStep->mUpdates.insert(trainStep->mUpdates.end(), states.begin(), states.end());
+
+    // Pack loss and all updates into one compute plan
+    std::vector<VARP> outputs{loss};
+    for (auto& iter : trainStep->mUpdates) {
+        outputs.emplace_back(iter.second);
+    }
+    Variable::prepareCompute(outputs);
+    return trainStep.release();
+}
+
+bool TrainStep::step(const std::vector<VARP>& inputs, float* loss) {
+    if (inputs.size() != mInputs.size()) {
+        MNN_ERROR("TrainStep: need %d inputs, but receive %d\n", (int)mInputs.size(), (int)inputs.size());
+        return false;
+    }
+    for (int i = 0; i < inputs.size(); ++i) {
+        auto srcInfo = inputs[i]->getInfo();
+        auto dstInfo = mInputs[i]->getInfo();
+        if (nullptr == srcInfo || srcInfo->size != dstInfo->size || srcInfo->type != dstInfo->type) {
+            MNN_ERROR("TrainStep: input %d's size or type not match\n", i);
+            return false;
+        }
+        auto srcPtr = inputs[i]->readMap<void>();
+        if (nullptr == srcPtr) {
+            MNN_ERROR("TrainStep: compute input %d error\n", i);
+            return false;
+        }
+        ::memcpy(mInputs[i]->writeMap<void>(), srcPtr, dstInfo->size * dstInfo->type.bytes());
+    }
+    mOptimizer->mStep++;
+    mOptimizer->onPrepareStep();
+
+    auto lossPtr = mLoss->readMap<float>();
+    if (nullptr == lossPtr) {
+        MNN_ERROR("TrainStep: compute error\n");
+        return false;
+    }
+    if (nullptr != loss) {
+        *loss = lossPtr[0];
+    }
+    // Map all results before write back, writing a buffer makes the compute plan dirty
+    std::vector<const void*> results(mUpdates.size());
+    for (int i = 0; i < mUpdates.size(); ++i) {
+        results[i] = mUpdates[i].second->readMap<void>();
+        if (nullptr == results[i]) {
+            MNN_ERROR("TrainStep: compute error for update %d\n", i);
+            return false;
+        }
+    }
+    for (int i = 0; i < mUpdates.size(); ++i) {
+        auto info = mUpdates[i].first->getInfo();
+        ::memcpy(mUpdates[i].first->writeMap<void>(), results[i], info->size * info->type.bytes());
+    }
+    return true;
+}
+
+} // namespace Train
+} // namespace MNN
@@ -0,0 +1,60 @@
+//
+//  TrainStep.hpp
+//  MNN
+//
+//  Created by MNN on 2020/12/01.
+//  Copyright © 2018, Alibaba Group Holding Limited
+//
+
+#ifndef TrainStep_hpp
+#define TrainStep_hpp
+
+#include <MNN/expr/Expr.hpp>
+#include <MNN/expr/Module.hpp>
+#include <functional>
+#include <vector>
+#include "ParameterOptimizer.hpp"
+
+namespace MNN {
+namespace Train {
+
+/**
+ A compiled train step: forward, backward and parameter update are derived once for fixed input shapes,
+ then every step only copies the batch into persistent inputs and replays the compute plan.
+ Parameters and optimizer states live in persistent buffers which are updated in place after each step.
+ */
+class MNN_PUBLIC TrainStep {
+public:
+    // Build loss from the input placeholders, usually call module's forward and a loss function
+    typedef std::function<Express::VARP(const std::vector<Express::VARP>&)> LossFunction;
+
+    static TrainStep* create(std::shared_ptr<Express::Module> module, std::shared_ptr<ParameterOptimizer> optimizer,
+                             const std::vector<Express::Variable::Info>& inputs, LossFunction lossFunc);
+    ~TrainStep() = default;
+
+    /**
+     Copy inputs into placeholders, run forward / backward / update and write back parameters and states.
+     @param inputs must have the same shape as the infos used in create.
+     @param loss if not nullptr, the loss value before update.
+     @return false if the inputs mismatch or compute failed.
+     */
+    bool step(const std::vector<Express::VARP>& inputs, float* loss = nullptr);
+
+    const std::vector<Express::VARP>& inputs() const {
+        return mInputs;
+    }
+
+private:
+    TrainStep() = default;
+    std::shared_ptr<Express::Module> mModule;
+    std::shared_ptr<ParameterOptimizer> mOptimizer;
+    std::vector<Express::VARP> mInputs;
+    Express::VARP mLoss;
+    // Persistent buffer, the value to write back after each step
+    std::vector<std::pair<Express::VARP, Express::VARP>> mUpdates;
+};
+
+} // namespace Train
+} // namespace MNN
+
+#endif // TrainStep_hpp